@@ -0,0 +1,45 @@
+#!/bin/bash
+# Builtin benchmark: validates and exports one variable N times (default 10000)
+# the way scripts do with a subprocess, export VAR=$(envil ... -p), and with
+# the bash builtin and --assign, and reports the mean wall time of each.
+#
+# Usage: bench/builtin.sh [N]    (ENVIL=path/to/envil, BUILTIN=path/to/envil.so)
+
+set -e
+
+ENVIL=${ENVIL:-./bin/envil}
+BUILTIN=${BUILTIN:-./lib/bash/envil.so}
+N=${1:-10000}
+
+# Mean nanoseconds per run of the loop body named by $1
+mean_ns() {
+    local i=0 start end
+    start=$(date +%s%N)
+    while [ $i -lt "$N" ]; do
+        "$1"
+        i=$((i + 1))
+    done
+    end=$(date +%s%N)
+    echo $(( (end - start) / N ))
+}
+
+subprocess() {
+    unset DB_PORT
+    export DB_PORT=$("$ENVIL" -e DB_PORT -d 5432 --type integer --gt 1024 --lt 65535 -p)
+}
+
+in_shell() {
+    unset DB_PORT
+    envil -e DB_PORT -d 5432 --type integer --gt 1024 --lt 65535 --assign
+}
+
+enable -f "$BUILTIN" envil
+in_shell
+[ "$DB_PORT" = 5432 ]
+
+forked=$(mean_ns subprocess)
+builtin=$(mean_ns in_shell)
+
+echo "runs:                      $N"
+echo "export DB_PORT=\$(envil -p): $((forked / 1000)) us"
+echo "envil --assign (builtin):  $((builtin / 1000)) us"
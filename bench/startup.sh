@@ -0,0 +1,44 @@
+#!/bin/sh
+# Startup latency benchmark: runs envil N times (default 10000) on the common
+# single-variable path and on a small config, and reports the mean wall time
+# per invocation with the cost of spawning /bin/true subtracted.
+#
+# Usage: bench/startup.sh [N]    (ENVIL=path/to/envil to pick the binary)
+
+set -e
+
+ENVIL=${ENVIL:-./bin/envil}
+N=${1:-10000}
+CONFIG=$(mktemp /tmp/envil_bench_XXXXXX.yml)
+trap 'rm -f "$CONFIG"' EXIT
+
+cat > "$CONFIG" <<'YAML'
+PORT:
+  checks:
+    type: integer
+    gt: 1024
+    lt: 65535
+YAML
+
+export PORT=8080
+
+# Mean nanoseconds per run of the given command
+mean_ns() {
+    i=0
+    start=$(date +%s%N)
+    while [ $i -lt "$N" ]; do
+        "$@" >/dev/null
+        i=$((i + 1))
+    done
+    end=$(date +%s%N)
+    echo $(( (end - start) / N ))
+}
+
+baseline=$(mean_ns /bin/true)
+single=$(mean_ns "$ENVIL" -e PORT --type integer --gt 1024 --lt 65535)
+config=$(mean_ns "$ENVIL" -c "$CONFIG")
+
+echo "runs:                $N"
+echo "spawn baseline:      $((baseline / 1000)) us"
+echo "envil -e PORT ...:   $(((single - baseline) / 1000)) us over baseline"
+echo "envil -c config.yml: $(((config - baseline) / 1000)) us over baseline"
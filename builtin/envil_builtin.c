@@ -0,0 +1,105 @@
+// envil as a bash loadable builtin: the same command line, run inside the
+// shell instead of a forked process.
+//
+//   make builtin
+//   enable -f lib/bash/envil.so envil
+//   envil -e DB_PORT -d 5432 --type integer --assign
+//
+// Bash's headers are not needed: the few declarations below are its stable
+// loadable builtin interface. Linked into bash, getenv and setenv resolve to
+// bash's own, which read and bind exported shell variables, so checks see
+// the shell's exports and --assign sets them in the shell.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cli.h"
+
+#define BUILTIN_ENABLED 0x01
+#define EXECUTION_FAILURE 1
+
+typedef struct word_desc {
+    char* word;
+    int flags;
+} WORD_DESC;
+
+typedef struct word_list {
+    struct word_list* next;
+    WORD_DESC* word;
+} WORD_LIST;
+
+struct builtin {
+    const char* name;
+    int (*function)(WORD_LIST*);
+    int flags;
+    const char* const* long_doc;
+    const char* short_doc;
+    char* handle;
+};
+
+// Bash keeps the environment of its exported variables in export_env, and
+// leaves environ as it was at startup
+extern char** environ;
+extern char** export_env;
+extern void maybe_make_export_env(void);
+
+static int envil_builtin(WORD_LIST* list) {
+    int argc = 1;
+    for (WORD_LIST* l = list; l; l = l->next) argc++;
+
+    // getopt permutes argv and option values are cut in place, so the words are copied
+    char** argv = calloc((size_t)argc + 1, sizeof(char*));
+    if (!argv) return EXECUTION_FAILURE;
+    argv[0] = strdup("envil");
+    int n = 1;
+    for (WORD_LIST* l = list; l; l = l->next) argv[n++] = strdup(l->word->word);
+    for (int i = 0; i < argc; i++) {
+        if (!argv[i]) {
+            for (int j = 0; j < argc; j++) free(argv[j]);
+            free(argv);
+            return EXECUTION_FAILURE;
+        }
+    }
+    // Copied first: getopt leaves argv reordered
+    char** words = malloc((size_t)argc * sizeof(char*));
+    if (!words) {
+        for (int i = 0; i < argc; i++) free(argv[i]);
+        free(argv);
+        return EXECUTION_FAILURE;
+    }
+    memcpy(words, argv, (size_t)argc * sizeof(char*));
+
+    // Pattern keys and --strict walk environ, which must hold the shell's exports
+    maybe_make_export_env();
+    char** saved_environ = environ;
+    environ = export_env;
+    int result = run_cli(argc, argv, true);
+    environ = saved_environ;
+
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < argc; i++) free(words[i]);
+    free(words);
+    free(argv);
+    return result;
+}
+
+static const char* const envil_doc[] = {
+    "Validate environment variables.",
+    "",
+    "Runs envil inside the shell, with the options of the envil command. With",
+    "--assign, the defaults of unset variables are exported once validation",
+    "passed. The values of -f files apply to the validation only. --watch and",
+    "-- APP are not available. Exits with envil's status.",
+    NULL
+};
+
+// Bash finds the builtin by this name
+__attribute__((visibility("default"))) struct builtin envil_struct = {
+    "envil",
+    envil_builtin,
+    BUILTIN_ENABLED,
+    envil_doc,
+    "envil [-c CONFIG | -e NAME [-d VALUE]] [--assign] [options]",
+    NULL
+};
@@ -6,22 +6,26 @@
 #include "types.h"
 #include "config.h"
 
+// Short options string for getopt_long; the long options are the static
+// long_options table from config.h
+extern const char short_options[];
+
 /**
  * @brief Creates option array for check-specific options
  * @param checks Array of check definitions
  * @param count Number of checks in the array
  * @return Dynamically allocated array of struct option, must be freed by caller
  */
-struct option* get_check_options(CheckDefinition checks[], int count);
+struct option* get_check_options(const CheckDefinition checks[], int count);
 
 /**
- * @brief Creates combined array of all long options (base + checks)
+ * @brief Creates a copy of long_options (base + checks)
  * @return Dynamically allocated array of struct option, must be freed by caller
  */
 struct option* create_long_options(void);
 
 /**
- * @brief Creates getopt_long option string for base options
+ * @brief Creates a copy of short_options
  * @return Dynamically allocated string, must be freed by caller
  */
 char* get_getopt_long_string(void);
@@ -32,7 +36,7 @@ char* get_getopt_long_string(void);
 void list_checks(void);
 
 /**
- * @brief Prints usage information and exits with status code 1
+ * @brief Prints usage information to stderr
  */
 void print_usage(void);
 
@@ -0,0 +1,39 @@
+#ifndef ENVIL_CACHE_H
+#define ENVIL_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "types.h"
+
+#define CACHE_KEY_SIZE 33  // 128-bit fingerprint as hex, plus terminator
+
+/**
+ * @brief Tells whether a config's verdict depends only on the config and values
+ * @return false if any cmd check is not declared pure
+ */
+bool config_is_cacheable(const Config* config);
+
+/**
+ * @brief The same for one variable, without logging why not
+ * @return false if a check may give another verdict for the same values
+ */
+bool variable_is_cacheable(const EnvVariable* var);
+
+/**
+ * @brief Fingerprints the normalized config and the values of the variables it references
+ * @param key Output buffer of at least CACHE_KEY_SIZE bytes
+ */
+void cache_fingerprint(const Config* config, bool print_value, char* key);
+
+/**
+ * @brief Writes the stored output of a previous passing run to stdout
+ * @return true on a cache hit
+ */
+bool cache_replay(const char* key);
+
+/**
+ * @brief Records the output of a passing run under the given key
+ */
+void cache_store(const char* key, const char* output, size_t output_len);
+
+#endif // ENVIL_CACHE_H
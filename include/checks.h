@@ -1,8 +1,20 @@
 #ifndef ENVIL_CHECKS_H
 #define ENVIL_CHECKS_H
 
+#include <regex.h>
 #include "types.h"
 
+// Argument of the regex check, compiled once when the check is parsed
+typedef struct RegexCheck {
+    char* pattern;
+    bool compiled;  // A pattern that does not compile fails every value
+    regex_t regex;
+} RegexCheck;
+
+// Logs a pattern that does not compile; returns NULL only if out of memory
+RegexCheck* compile_regex_check(const char* pattern);
+void free_regex_check(RegexCheck* regex);
+
 int check_mock(const char* value, const void* param);
 int check_cmd(const char* value, const void* cmd);
 int check_type(const char* value, const void* type_ptr);
@@ -16,9 +28,87 @@ int check_ge(const char* value, const void* threshold);
 int check_le(const char* value, const void* threshold);
 int check_lengt(const char* value, const void* length);
 int check_lenlt(const char* value, const void* length);
-int check_regex(const char* value, const void* pattern);
+int check_regex(const char* value, const void* regex);
+int check_ip(const char* value, const void* constraint);
+int check_ipv4(const char* value, const void* constraint);
+int check_ipv6(const char* value, const void* constraint);
+int check_cidr(const char* value, const void* constraint);
+int check_hostname(const char* value, const void* constraint);
+int check_hostport(const char* value, const void* constraint);
+int check_uuid(const char* value, const void* versions);
+int check_base64(const char* value, const void* length);
+int check_base64url(const char* value, const void* length);
+int check_hex(const char* value, const void* length);
+int check_semver(const char* value, const void* range);
+int check_url(const char* value, const void* url);
+int check_path_exists(const char* value, const void* expected);
+int check_file(const char* value, const void* expected);
+int check_dir(const char* value, const void* expected);
+int check_socket(const char* value, const void* expected);
+int check_readable(const char* value, const void* expected);
+int check_writable(const char* value, const void* expected);
+int check_max_size(const char* value, const void* size);
+int check_expr(const char* value, const void* expr);
+
+// Variants working on an analyzed value, so a variable's checks share one parse
+int check_type_value(ValueInfo* value, const void* type_ptr);
+int check_gt_value(ValueInfo* value, const void* threshold);
+int check_lt_value(ValueInfo* value, const void* threshold);
+int check_ge_value(ValueInfo* value, const void* threshold);
+int check_le_value(ValueInfo* value, const void* threshold);
+int check_len_value(ValueInfo* value, const void* length);
+int check_lengt_value(ValueInfo* value, const void* length);
+int check_lenlt_value(ValueInfo* value, const void* length);
+int check_ip_value(ValueInfo* value, const void* constraint);
+int check_ipv4_value(ValueInfo* value, const void* constraint);
+int check_ipv6_value(ValueInfo* value, const void* constraint);
+int check_cidr_value(ValueInfo* value, const void* constraint);
+int check_hostname_value(ValueInfo* value, const void* constraint);
+int check_hostport_value(ValueInfo* value, const void* constraint);
+int check_uuid_value(ValueInfo* value, const void* versions);
+int check_base64_value(ValueInfo* value, const void* length);
+int check_base64url_value(ValueInfo* value, const void* length);
+int check_hex_value(ValueInfo* value, const void* length);
+int check_semver_value(ValueInfo* value, const void* range);
+int check_url_value(ValueInfo* value, const void* url);
+// Validation deadline for the calling thread: once it passes, cmd checks are
+// killed and report ENVIL_TIMEOUT_ERROR. 0 clears it.
+void set_check_deadline(unsigned timeout_ms);
+bool check_deadline_passed(void);
+// Whether the calling thread's last cmd check reported ENVIL_TIMEOUT_ERROR
+// without starting its command, the deadline having already passed
+bool cmd_check_not_run(void);
+
+// Checks registered on top of the built-ins in checks[]. Lookups search the
+// built-ins first. Definitions never move once added, so loaded checks may
+// point into a registry.
+#define MAX_CHECKS 32
+
+// Assumed cost in nanoseconds of a registered check, which may do anything
+#define DEFAULT_CHECK_COST 1000
+
+// What a registered check may add to a plain function, carried in its
+// definition's custom_data (NULL for none)
+typedef struct {
+    void* (*parse)(const char* argument, char* error, size_t error_size);  // NULL: the argument string
+    void (*free)(void* argument);  // Releases what parse returned
+    bool pure;                     // Results depend on the value and argument only
+} CheckHooks;
+
+typedef struct CheckRegistry {
+    CheckDefinition definitions[MAX_CHECKS];
+    int count;
+} CheckRegistry;
+
+void init_check_registry(CheckRegistry* registry);
+const CheckDefinition* registry_add_check(CheckRegistry* registry, const char* name, const char* description, CheckFunction check_fn, void* custom_data, int has_arg, const char* error_message);
+const CheckDefinition* registry_find_check(const CheckRegistry* registry, const char* name);
+bool is_builtin_check(const char* name);
+
+// The same operations on the process-wide registry used by the command line
 const CheckDefinition* register_check(const char* name, const char* description, CheckFunction check_fn, void* custom_data, int has_arg, const char* error_message);
 const CheckDefinition* get_check_definition(const char* name);
 const CheckDefinition* get_check_definition_by_index(int index);
+CheckRegistry* get_default_registry(void);
 
 #endif // ENVIL_CHECKS_H
\ No newline at end of file
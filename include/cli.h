@@ -0,0 +1,18 @@
+#ifndef ENVIL_CLI_H
+#define ENVIL_CLI_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Runs an envil command line, as the executable or the bash builtin
+ *
+ * Never exits: every outcome is returned, so a shell can run it over and over.
+ *
+ * @param in_shell True inside bash: only --assign sets variables in the shell,
+ *                 the values of -f files are taken back, and --watch and
+ *                 -- APP, which would block or replace it, are refused
+ * @return The exit status of the command
+ */
+int run_cli(int argc, char** argv, bool in_shell);
+
+#endif // ENVIL_CLI_H
@@ -0,0 +1,28 @@
+#ifndef ENVIL_CODEGEN_H
+#define ENVIL_CODEGEN_H
+
+#include "types.h"
+
+/**
+ * @brief Writes a standalone C validator for a config
+ *
+ * For an output path such as gen/env_gen.c, writes gen/env_gen.h with a struct
+ * EnvGen holding each variable as its type (int64_t for integers, durations in
+ * nanoseconds and sizes in bytes, double for floats, const char* otherwise)
+ * and env_gen_load(), and gen/env_gen.c implementing it with every check
+ * specialized: thresholds as constants, enums as a switch on the length, and
+ * regexes as DFA tables. The files need nothing but the C library, and report
+ * the failures, messages and exit code envil would.
+ *
+ * Covers the type (but json and boolean), gt, lt, ge, le, eq, ne, enum, len,
+ * lengt, lenlt and regex checks; a config with other checks or with pattern
+ * keys is rejected.
+ *
+ * @param config_path Named in the header comment of the files
+ * @param output_path The .c or .h file to write, or the path without extension
+ * @return ENVIL_OK, or ENVIL_CONFIG_ERROR if the config is not covered or a
+ *         file cannot be written
+ */
+int generate_code(const Config* config, const char* config_path, const char* output_path);
+
+#endif // ENVIL_CODEGEN_H
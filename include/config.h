@@ -7,10 +7,27 @@
 #include <stdbool.h>
 #include "types.h"
 #include "checks.h"
+#include "stats.h"
+#include "expr.h"
 
-extern struct option check_options[];
-extern CheckDefinition checks[];
-extern struct option base_options[];
+// Option values for base options without a short equivalent
+enum {
+    OPT_CACHE = 256,
+    OPT_STATS,
+    OPT_DEADLINE,
+    OPT_PLUGIN,
+    OPT_CHECK,
+    OPT_MANIFESTS,
+    OPT_PROFILES,
+    OPT_SINCE,
+    OPT_STRICT,
+    OPT_ASSIGN,
+};
+
+extern const struct option check_options[];
+extern const CheckDefinition checks[];
+extern const struct option base_options[];
+extern const struct option long_options[];
 
 // Base configuration functions
 size_t get_base_options_count();
@@ -18,10 +35,54 @@ size_t get_check_options_count();
 size_t get_options_count();
 
 // Configuration file handling functions
-int handle_config_option(const char* config_path, bool print_value);
+// stats_path, when set, names the --stats file used to order checks;
+// strict_prefix, when set, is the scope of the --strict check (see strict.h);
+// export_defaults sets the defaults of unset variables in the environment once
+// validation passed
+int handle_config_option(const char* config_path, bool print_value, bool use_cache, const char* stats_path,
+                         const char* strict_prefix, bool export_defaults);
+// Sets each unset variable that has a default to it, for a program run afterwards
+void export_config_defaults(const Config* config);
 int handle_yaml_config(FILE* config_file, bool print_value, ValidationErrors* errors);
 int handle_json_config(FILE* config_file, bool print_value, ValidationErrors* errors);
 
+// Configuration loading, separated from validation so a loaded config can be
+// validated more than once (e.g. by watch mode)
+Config* load_config(const char* config_path);
+Config* load_config_with_registry(const char* config_path, CheckRegistry* registry);
+int load_yaml_config(FILE* config_file, Config* config);
+int load_json_config(FILE* config_file, Config* config);
+int validate_config(const Config* config, bool print_value, ValidationErrors* errors);
+int validate_config_with_stats(const Config* config, bool print_value, ValidationErrors* errors, CheckStats* stats);
+// The same with values from lookup, getenv when NULL. Variables are validated
+// after those their expr checks read; --print lines keep the config order.
+// Pattern keys are matched against environ, and only without a lookup.
+int validate_config_lookup(const Config* config, ExprLookupFunction lookup, void* lookup_data,
+                           bool print_value, ValidationErrors* errors, CheckStats* stats);
+// The same with one value per variable, defaults applied. known (may be NULL)
+// holds a result per variable: a variable whose result is not VERDICT_PENDING
+// is not validated, and that result stands for it in the expr checks reading
+// it and for --print, without counting toward the one returned. The config's
+// pattern keys are matched against the NAME=VALUE entries of envp (NULL for
+// none). lookup serves the names expr checks read that are not in the config.
+#define VERDICT_PENDING (-1)
+int validate_config_values(const Config* config, const char* const* values, const int* known,
+                           char* const* envp, ExprLookupFunction lookup, void* lookup_data,
+                           bool print_value, ValidationErrors* errors, CheckStats* stats);
+// Marks, transitively, each variable with an expr check reading a marked one:
+// recheck holds a flag per variable of the config
+void spread_rechecks(const Config* config, bool* recheck);
+void free_config(Config* config);
+
+// Parses a duration such as 500ms, 5s, 2m or 5 (seconds) into milliseconds
+bool parse_timeout(const char* str, unsigned* timeout_ms);
+
+// Parses a check argument (from the CLI or a config file) into a Check
+int process_check(const char* check_name, const char* check_value, Check* check, EnvType* var_type);
+int process_registry_check(const CheckRegistry* registry, const char* check_name, const char* check_value, Check* check, EnvType* var_type);
+// Frees what process_check allocated for a check's argument
+void free_check_value(Check* check);
+
 // Environment variable validation helper
 int validate_and_print_env(const char* var_name, const char* env_value, 
                           const char* default_value, bool print_value,
@@ -0,0 +1,43 @@
+#ifndef ENVIL_DFA_H
+#define ENVIL_DFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Transition targets other than states
+#define DFA_MATCHED -1  // The pattern matched somewhere: the search is over
+#define DFA_DEAD -2     // No match is possible any more
+
+// A regex compiled for the search the regex check does: true when the pattern
+// matches anywhere in the value, as regexec() without REG_NOTBOL/REG_NOTEOL.
+// Bytes the pattern cannot tell apart share a class, so the table stays small.
+typedef struct {
+    int start;                    // State 0, or DFA_MATCHED/DFA_DEAD
+    int state_count;
+    int class_count;
+    unsigned char class_of[256];  // Byte class of each byte
+    int* next;                    // next[state * class_count + class]
+    bool* accept_at_end;          // By state: matches if the value ends here
+} Dfa;
+
+/**
+ * @brief Compiles a POSIX extended regex into a DFA
+ *
+ * Covers the ERE syntax with byte semantics of the C locale: literals, ., bracket
+ * expressions with ranges and [:class:], groups, |, *, +, ?, {m,n}, the
+ * \w \W \s \S shorthands, and ^ and $ at the edges of a match. Back-references,
+ * word boundaries, collating elements and patterns needing more than a thousand
+ * states are rejected, as is anything POSIX leaves undefined, so a compiled DFA
+ * agrees with regexec().
+ *
+ * @param error Receives the reason when NULL is returned
+ * @return The DFA, or NULL if the pattern is invalid or not covered
+ */
+Dfa* compile_dfa(const char* pattern, char* error, size_t error_size);
+
+// Runs the DFA over the len bytes of str
+bool dfa_match(const Dfa* dfa, const char* str, size_t len);
+
+void free_dfa(Dfa* dfa);
+
+#endif // ENVIL_DFA_H
@@ -0,0 +1,30 @@
+#ifndef ENVIL_DOTENV_H
+#define ENVIL_DOTENV_H
+
+typedef struct {
+    char *name;
+    char *value;
+} EnvEntry;
+
+typedef struct {
+    EnvEntry *entries;
+    int count;
+    int capacity;
+} EnvFile;
+
+/**
+ * @brief Parses a dotenv file (KEY=VALUE lines, optional `export`, quotes and # comments)
+ * @param path Path to the file
+ * @return Parsed entries, NULL if the file cannot be read. Must be freed with free_env_file
+ */
+EnvFile* load_env_file(const char* path);
+
+/**
+ * @brief Looks up a variable in a parsed dotenv file, later definitions win
+ * @return The value, or NULL if the file does not define the variable
+ */
+const char* env_file_get(const EnvFile* file, const char* name);
+
+void free_env_file(EnvFile* file);
+
+#endif // ENVIL_DOTENV_H
@@ -0,0 +1,114 @@
+#ifndef ENVIL_H
+#define ENVIL_H
+
+/*
+ * libenvil: validate an environment against an envil config from inside a
+ * program, without running the envil binary.
+ *
+ *   EnvilContext* ctx = envil_context_new();
+ *   EnvilPlan* plan = envil_plan_load(ctx, "env.yml");
+ *   int result = envil_validate(plan, NULL, NULL, report, NULL);
+ *   envil_plan_free(plan);
+ *   envil_context_free(ctx);
+ *
+ * A context holds the settings shared by its plans: log level, log callback
+ * and registered checks, plugins included. A plan is a loaded config; it is
+ * never modified after envil_plan_load, so any number of threads may validate
+ * with it at once.
+ * Configure a context before loading plans from it, and free its plans before
+ * freeing it.
+ */
+
+#if defined(__GNUC__)
+#define ENVIL_API __attribute__((visibility("default")))
+#else
+#define ENVIL_API
+#endif
+
+// Results, the same as the envil exit codes
+#ifndef ENVIL_OK
+#define ENVIL_OK 0
+#define ENVIL_CONFIG_ERROR 1
+#define ENVIL_MISSING_VAR 2
+#define ENVIL_TYPE_ERROR 3
+#define ENVIL_VALUE_ERROR 4
+#define ENVIL_CUSTOM_ERROR 5
+#define ENVIL_TIMEOUT_ERROR 6
+#endif
+
+// Log levels, the same order as envil -v/-vv
+#define ENVIL_LOG_NONE 0
+#define ENVIL_LOG_ERROR 1
+#define ENVIL_LOG_WARNING 2
+#define ENVIL_LOG_INFO 3
+#define ENVIL_LOG_DEBUG 4
+#define ENVIL_LOG_TRACE 5
+
+typedef struct EnvilContext EnvilContext;
+typedef struct EnvilPlan EnvilPlan;
+
+// Returns the value of a variable, or NULL when it is not set
+typedef const char* (*EnvilLookupFunction)(const char* name, void* user_data);
+// Receives one validation failure
+typedef void (*EnvilSinkFunction)(const char* name, const char* message, int error_code, void* user_data);
+// Receives one log message, without a trailing newline
+typedef void (*EnvilLogFunction)(int level, const char* message, void* user_data);
+// A custom check: returns ENVIL_OK or an error code. argument is the check's
+// value from the config as a string, NULL for checks without an argument
+typedef int (*EnvilCheckFunction)(const char* value, const void* argument);
+
+ENVIL_API EnvilContext* envil_context_new(void);
+ENVIL_API void envil_context_free(EnvilContext* ctx);
+
+/**
+ * @brief Sets where the context's plans log, by default errors go to stderr
+ *
+ * @param level Most verbose ENVIL_LOG_* level to emit
+ * @param log_fn Callback for each message, NULL to print to stderr
+ */
+ENVIL_API void envil_context_set_log(EnvilContext* ctx, int level, EnvilLogFunction log_fn, void* user_data);
+
+/**
+ * @brief Adds a check that configs loaded with this context may use
+ *
+ * The name and description are copied.
+ *
+ * @return ENVIL_OK, or ENVIL_CONFIG_ERROR if the name is taken or the
+ *         registry is full
+ */
+ENVIL_API int envil_context_register_check(EnvilContext* ctx, const char* name, const char* description,
+                                           EnvilCheckFunction check_fn, int has_arg);
+
+/**
+ * @brief Loads a check plugin (see envil_plugin.h) into the context
+ *
+ * A config's `plugins:` list is loaded the same way by envil_plan_load.
+ *
+ * @return ENVIL_OK, or ENVIL_CONFIG_ERROR if the object cannot be loaded,
+ *         was built for another version or fails to register its checks
+ */
+ENVIL_API int envil_context_load_plugin(EnvilContext* ctx, const char* path);
+
+/**
+ * @brief Loads and compiles a YAML or JSON config
+ *
+ * @return The plan, or NULL if the file cannot be read or is invalid (the
+ *         reason is logged through the context)
+ */
+ENVIL_API EnvilPlan* envil_plan_load(EnvilContext* ctx, const char* config_path);
+ENVIL_API void envil_plan_free(EnvilPlan* plan);
+
+/**
+ * @brief Validates every variable of a plan
+ *
+ * Reentrant: all state lives in the plan, its context and the call.
+ *
+ * @param lookup Value source, NULL for getenv; pattern keys are only matched
+ *               against the process environment, so only without a lookup
+ * @param sink Called for each failure, may be NULL
+ * @return ENVIL_OK, or the error code of the last failing variable
+ */
+ENVIL_API int envil_validate(const EnvilPlan* plan, EnvilLookupFunction lookup, void* lookup_data,
+                             EnvilSinkFunction sink, void* sink_data);
+
+#endif // ENVIL_H
@@ -0,0 +1,76 @@
+#ifndef ENVIL_PLUGIN_H
+#define ENVIL_PLUGIN_H
+
+/*
+ * envil plugins: shared objects adding native checks, loaded with
+ * `envil --plugin ./luhn.so` or a `plugins:` list in a config.
+ *
+ *   static const EnvilPluginCheck luhn = {
+ *       .name = "luhn",
+ *       .description = "Check a Luhn checksum",
+ *       .check = check_luhn,
+ *       .has_arg = 1,
+ *       .parse = parse_length,
+ *       .free = free,
+ *   };
+ *
+ *   ENVIL_PLUGIN_EXPORT int envil_plugin_init_v1(EnvilPluginHost* host) {
+ *       return host->register_check(host, &luhn);
+ *   }
+ *
+ * The entry point carries the ABI version in its name; a host that cannot
+ * serve that version does not find it and refuses the plugin. Build with
+ * `cc -shared -fPIC -Iinclude luhn.c -o luhn.so`. A plugin is never unloaded.
+ */
+
+#include <stddef.h>
+#include "envil.h"
+
+#define ENVIL_PLUGIN_ABI 1
+
+#if defined(__GNUC__)
+#define ENVIL_PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#define ENVIL_PLUGIN_EXPORT
+#endif
+
+// The check only looks at its value and argument, so results may be cached
+#define ENVIL_PLUGIN_CHECK_PURE 0x1
+
+/**
+ * @brief Turns a check's argument into what its check function receives
+ *
+ * Runs once when the check is loaded, not per validation.
+ *
+ * @param error Receives the reason on failure
+ * @return The parsed argument, or NULL when it is invalid
+ */
+typedef void* (*EnvilArgumentParser)(const char* argument, char* error, size_t error_size);
+typedef void (*EnvilArgumentFree)(void* argument);
+
+typedef struct {
+    const char* name;
+    const char* description;
+    EnvilCheckFunction check;
+    int has_arg;
+    EnvilArgumentParser parse;  // NULL to receive the argument as a string
+    EnvilArgumentFree free;     // Releases what parse returned, may be NULL
+    const char* error_message;  // NULL for "Invalid value"; must outlive the plugin's use
+    unsigned cost;              // Rough nanoseconds per call, 0 for the default
+    unsigned flags;             // ENVIL_PLUGIN_CHECK_*
+} EnvilPluginCheck;
+
+typedef struct EnvilPluginHost {
+    int abi;  // ENVIL_PLUGIN_ABI of the host
+    // Copies the name and description; ENVIL_OK, or ENVIL_CONFIG_ERROR if
+    // the name is taken or too many checks are registered
+    int (*register_check)(struct EnvilPluginHost* host, const EnvilPluginCheck* check);
+    void* host_data;
+} EnvilPluginHost;
+
+// The entry point a plugin exports; anything but ENVIL_OK fails the load and
+// withdraws the checks it registered
+typedef int (*EnvilPluginInit)(EnvilPluginHost* host);
+#define ENVIL_PLUGIN_ENTRY "envil_plugin_init_v1"
+
+#endif // ENVIL_PLUGIN_H
@@ -0,0 +1,61 @@
+#ifndef ENVIL_EXPR_H
+#define ENVIL_EXPR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// The expr check: an expression over the value and other variables, compiled
+// once at load time to bytecode for a small stack machine, e.g.
+//
+//   value <= MAX_POOL
+//   ENV != "prod" || defined(TLS_CERT)
+//   len(USER) + len(PASSWORD) < 255
+//
+// Operands are strings, numbers (with an optional duration or size unit, as
+// in 30s or 512Mi), true, false and the result of len(), defined() and num().
+// Variables hold strings; comparisons are numeric when both sides read as
+// numbers in the same unit, and byte-wise otherwise. A variable that is not
+// set is null: only defined(), len() (0) and == / != accept it.
+
+typedef struct Expr Expr;
+
+/**
+ * @brief Compiles an expression
+ * @param error Receives a message with the column on failure
+ * @return NULL on a syntax error or when out of memory
+ */
+Expr* compile_expr(const char* source, char* error, size_t error_size);
+void free_expr(Expr* expr);
+const char* expr_source(const Expr* expr);
+
+// Variables an expression refers to, "value" excluded. Binding one to a
+// config variable makes it read that variable's value, default included;
+// unbound names are looked up in the environment.
+int expr_name_count(const Expr* expr);
+const char* expr_name(const Expr* expr, int index);
+void bind_expr_name(Expr* expr, int index, int variable);
+int expr_name_binding(const Expr* expr, int index);  // -1 when unbound
+
+typedef const char* (*ExprLookupFunction)(const char* name, void* user_data);
+
+// Values seen by expressions evaluated on the calling thread
+typedef struct {
+    const char* const* values;  // Per config variable, NULL when not set
+    const bool* invalid;        // Per config variable, set once it failed its own checks
+    ExprLookupFunction lookup;  // For unbound names, getenv when NULL
+    void* lookup_data;
+} ExprEnv;
+
+// env is not copied and must outlive its use; NULL restores plain getenv
+void set_expr_env(const ExprEnv* env);
+
+typedef enum {
+    EXPR_TRUE,
+    EXPR_FALSE,
+    EXPR_SKIPPED,  // Refers to a variable that already failed validation
+    EXPR_ERROR     // Arithmetic on something that is not a number, division by zero
+} ExprResult;
+
+ExprResult eval_expr(const Expr* expr, const char* value);
+
+#endif // ENVIL_EXPR_H
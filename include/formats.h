@@ -0,0 +1,72 @@
+#ifndef ENVIL_FORMATS_H
+#define ENVIL_FORMATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Parsers behind the uuid, base64, base64url, hex and semver checks. Character
+// classes come from one 256-entry table; long base64 and hex values are
+// scanned 16 bytes at a time where SSE2 is available.
+
+/**
+ * @brief Checks the 8-4-4-4-12 hex form of a UUID
+ * @param version Set to the version, or 0 when the variant is not the RFC 9562 one;
+ * may be NULL
+ */
+bool parse_uuid(const char* str, size_t len, int* version);
+
+/**
+ * @brief Checks non-empty, canonical base64 (RFC 4648): padding as the alphabet requires and
+ * no stray bits in the last character
+ * @param url Use the URL-safe alphabet, where padding is optional
+ * @param decoded_len Set to the number of bytes encoded, may be NULL
+ */
+bool parse_base64(const char* str, size_t len, bool url, size_t* decoded_len);
+
+/**
+ * @brief Checks a non-empty, even number of hex digits, either case
+ */
+bool parse_hex(const char* str, size_t len, size_t* decoded_len);
+
+// A version as in Semantic Versioning 2.0.0. Ranges may give fewer parts
+// (">=2", "<3.1"); the missing ones then match anything.
+typedef struct {
+    uint64_t major;
+    uint64_t minor;
+    uint64_t patch;
+    const char* prerelease;  // Not terminated, prerelease_len bytes, NULL if none
+    size_t prerelease_len;
+    int parts;
+} Semver;
+
+bool parse_semver(const char* str, size_t len, Semver* version);
+
+/**
+ * @brief Orders a full version against a possibly partial one by semver precedence
+ * @return <0, 0 or >0 like strcmp
+ */
+int compare_semver(const Semver* a, const Semver* b);
+
+typedef struct {
+    char op;  // '=', '<', '>', 'l' (<=) or 'g' (>=)
+    Semver version;
+    bool starts_set;  // First comparator after "||"
+} SemverComparator;
+
+// Comparators separated by spaces must all match; "||" separates alternatives
+typedef struct SemverRange {
+    char* text;  // Owned copy of the range, the comparators point into it
+    int count;
+    SemverComparator comparators[];
+} SemverRange;
+
+/**
+ * @brief Parses a range such as ">=2.0.0 <3 || =1.4.2"; "any" matches every version
+ * @return NULL on a syntax error or when out of memory
+ */
+SemverRange* parse_semver_range(const char* str);
+bool semver_in_range(const SemverRange* range, const Semver* version);
+void free_semver_range(SemverRange* range);
+
+#endif // ENVIL_FORMATS_H
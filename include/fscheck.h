@@ -0,0 +1,31 @@
+#ifndef ENVIL_FSCHECK_H
+#define ENVIL_FSCHECK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <linux/stat.h>  // struct statx without _GNU_SOURCE
+
+// Filesystem lookups behind the path_exists, file, dir, socket, readable,
+// writable and max_size checks
+
+// Whether a check takes a path as its value
+bool is_fs_check(const char* check_name);
+
+/**
+ * @brief Stats a batch of paths up front, so the checks that follow read the
+ * results instead of making one system call each
+ *
+ * Large batches go through io_uring when the kernel allows it, so the lookups
+ * overlap; otherwise the paths are stat'ed one after another. The results are
+ * per thread and stay valid until clear_path_stats(). The paths must outlive them.
+ */
+void prefetch_path_stats(const char* const* paths, int count);
+void clear_path_stats(void);
+
+/**
+ * @brief statx() of a path, served from the prefetched batch when it is there
+ * @return 0, or the errno of the lookup
+ */
+int stat_path(const char* path, struct statx* stx);
+
+#endif // ENVIL_FSCHECK_H
@@ -0,0 +1,13 @@
+#ifndef ENVIL_HASH_H
+#define ENVIL_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HASH_SEED 0xcbf29ce484222325ULL
+
+// FNV-1a hashing used to fingerprint config definitions and values
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t len);
+uint64_t hash_string(uint64_t hash, const char* str);
+
+#endif // ENVIL_HASH_H
@@ -0,0 +1,27 @@
+#ifndef ENVIL_JSONSCAN_H
+#define ENVIL_JSONSCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Same limit as json-c's default tokener: a value may not start once this
+// many arrays/objects are open
+#define JSON_MAX_DEPTH 32
+
+/**
+ * @brief Validates a JSON document without building it, accepting exactly
+ *        what json-c's json_tokener_parse() returns an object for
+ *
+ * That is json-c's lenient grammar: single-quoted strings, comments, trailing
+ * commas, case-insensitive literals, NaN and Infinity, and anything after the
+ * top-level value. A top-level null is rejected, as json-c returns NULL for it.
+ * Allocates nothing: nesting is tracked in a bit stack and string bodies are
+ * scanned 16 bytes at a time where SSE2 is available.
+ *
+ * @param str Document text, read up to len bytes or the first NUL
+ * @param len Length of the document in bytes
+ * @return true if json-c would accept the document
+ */
+bool json_validate(const char* str, size_t len);
+
+#endif // ENVIL_JSONSCAN_H
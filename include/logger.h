@@ -4,6 +4,20 @@
 #include "types.h"
 #include "config.h"
 
+typedef void (*LogFunction)(LogLevel level, const char* message, void* user_data);
+
+// Where log messages go: messages above level are dropped, the rest are passed
+// to log_fn, or printed to stderr with a level prefix when log_fn is NULL
+typedef struct {
+    LogLevel level;
+    LogFunction log_fn;
+    void* user_data;
+} LogTarget;
+
 void logger(LogLevel level, const char* message, ...);
 
-#endif // ENVIL_LOGGER_H
\ No newline at end of file
+// Routes the calling thread's messages to target instead of g_log_level and
+// stderr, until called again. Returns the previous target (NULL for the default).
+const LogTarget* logger_use(const LogTarget* target);
+
+#endif // ENVIL_LOGGER_H
@@ -0,0 +1,59 @@
+#ifndef ENVIL_MANIFEST_H
+#define ENVIL_MANIFEST_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "types.h"
+
+// The env blocks of Kubernetes manifests (every containers: and
+// initContainers: list, whatever the resource) and docker-compose files
+// (services.*.environment), validated against one config.
+
+typedef struct {
+    char* name;
+    char* value;  // NULL when not literal: valueFrom, ${VAR}, or taken from the host
+} ManifestVar;
+
+typedef struct {
+    char* resource;   // "Deployment/api"; NULL for a compose service
+    char* container;  // Container or service name, NULL if the container has none
+    unsigned line;
+    bool open_env;    // envFrom or env_file may set variables that are not listed
+    ManifestVar* vars;
+    int var_count;
+    int var_capacity;
+} ManifestContainer;
+
+typedef struct {
+    ManifestContainer* containers;
+    int count;
+    int capacity;
+} ManifestFile;
+
+/**
+ * @brief Extracts the containers of a YAML stream, all documents included
+ *
+ * The file is read event by event; no document tree is built.
+ *
+ * @param error Receives the reason on failure
+ * @return ENVIL_OK, or ENVIL_CONFIG_ERROR if the YAML is invalid
+ */
+int parse_manifest(FILE* file, ManifestFile* manifest, char* error, size_t error_size);
+void free_manifest(ManifestFile* manifest);
+
+/**
+ * @brief Validates every container of the .yml/.yaml files under path
+ *
+ * Files are parsed and validated by a pool of threads; the report lists each
+ * container, in file order, followed by a summary line. A variable a container
+ * sets without a literal value is not validated; one it does not set counts as
+ * unset, unless envFrom or env_file may provide it.
+ *
+ * @param path A directory, searched recursively, or a single file
+ * @param deadline_ms Bounds the checks of each worker, 0 for none
+ * @return ENVIL_OK, the error code of the last failing container, or
+ *         ENVIL_CONFIG_ERROR if a manifest cannot be read
+ */
+int validate_manifests(const Config* config, const char* path, unsigned deadline_ms, FILE* out);
+
+#endif // ENVIL_MANIFEST_H
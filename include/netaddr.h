@@ -0,0 +1,50 @@
+#ifndef ENVIL_NETADDR_H
+#define ENVIL_NETADDR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h"
+
+// Allocation-free parsers behind the ip, ipv4, ipv6, cidr, hostname and
+// hostport checks. Inputs are (pointer, length) pairs and need not be
+// NUL-terminated.
+
+// Address classes, combined in NetConstraint::classes
+#define NET_LOOPBACK   (1u << 0)  // 127.0.0.0/8, ::1
+#define NET_PRIVATE    (1u << 1)  // RFC 1918, 100.64.0.0/10, fc00::/7
+#define NET_LINK_LOCAL (1u << 2)  // 169.254.0.0/16, fe80::/10
+#define NET_PUBLIC     (1u << 3)  // Globally routable unicast
+#define NET_OTHER      (1u << 4)  // Unspecified, multicast, documentation, reserved
+#define NET_ANY        (NET_LOOPBACK | NET_PRIVATE | NET_LINK_LOCAL | NET_PUBLIC | NET_OTHER)
+#define NET_FQDN       (1u << 5)  // hostname: at least two labels
+
+bool parse_ipv4(const char* str, size_t len, uint8_t addr[4]);
+bool parse_ipv6(const char* str, size_t len, uint8_t addr[16]);
+
+/**
+ * @brief Checks a DNS hostname (RFC 1123): dot-separated labels of letters,
+ * digits and inner hyphens, 63 bytes each and 253 in total, one trailing dot allowed
+ * @param labels Set to the number of labels, may be NULL
+ */
+bool parse_hostname(const char* str, size_t len, int* labels);
+
+// Classifies an address as one of the NET_* classes. IPv4-mapped IPv6
+// addresses are classified as the IPv4 address they carry.
+unsigned classify_ipv4(const uint8_t addr[4]);
+unsigned classify_ipv6(const uint8_t addr[16]);
+
+// Whether a check takes a NetConstraint (ip, ipv4, ipv6, cidr, hostname, hostport)
+bool is_net_check(const char* check_name);
+
+/**
+ * @brief Parses a check argument: comma-separated classes (any, private, public,
+ * loopback, link-local, fqdn) and, for hostport, a port or port range (1024-65535)
+ * @return false on an unknown word, or one check_name does not accept
+ */
+bool parse_net_constraint(const char* check_name, const char* str, NetConstraint* constraint);
+
+// Describes a constraint for error messages, e.g. "private or loopback, port 1-1023"
+const char* format_net_constraint(const NetConstraint* constraint, char* buf, size_t size);
+
+#endif // ENVIL_NETADDR_H
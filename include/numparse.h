@@ -0,0 +1,37 @@
+#ifndef ENVIL_NUMPARSE_H
+#define ENVIL_NUMPARSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Parses a whole string as a decimal int64
+ *
+ * Accepts an optional '-' followed by one or more digits, nothing else.
+ * Digits are validated and converted eight at a time.
+ *
+ * @param str Text to parse, need not be NUL-terminated
+ * @param len Length of the text in bytes
+ * @param out Receives the value on success
+ * @return false on syntax errors and on values outside the int64 range
+ */
+bool parse_int64(const char* str, size_t len, int64_t* out);
+
+/**
+ * @brief Parses a whole string as a correctly rounded double
+ *
+ * Accepts the decimal forms strtod accepts in the C locale, whatever the
+ * process locale is: an optional sign, digits with an optional '.', an
+ * optional exponent, or "inf", "infinity" and "nan" in any case. Leading
+ * whitespace and hexadecimal floats are rejected. Out-of-range values round
+ * to infinity or zero like strtod does.
+ *
+ * @param str Text to parse, need not be NUL-terminated
+ * @param len Length of the text in bytes
+ * @param out Receives the value on success
+ * @return false if the text is not a number
+ */
+bool parse_double(const char* str, size_t len, double* out);
+
+#endif // ENVIL_NUMPARSE_H
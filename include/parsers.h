@@ -0,0 +1,52 @@
+#ifndef ENVIL_PARSERS_H
+#define ENVIL_PARSERS_H
+
+#include <yaml.h>
+#include <json-c/json.h>
+
+// libyaml and json-c are loaded with dlopen the first time a config of their
+// format is read, so runs that never parse a config (e.g. -e) never map them
+
+typedef struct {
+    __typeof__(yaml_parser_initialize)* parser_initialize;
+    __typeof__(yaml_parser_set_input_file)* parser_set_input_file;
+    __typeof__(yaml_parser_load)* parser_load;
+    __typeof__(yaml_parser_parse)* parser_parse;
+    __typeof__(yaml_event_delete)* event_delete;
+    __typeof__(yaml_parser_delete)* parser_delete;
+    __typeof__(yaml_document_get_root_node)* document_get_root_node;
+    __typeof__(yaml_document_get_node)* document_get_node;
+    __typeof__(yaml_document_delete)* document_delete;
+} YamlLibrary;
+
+typedef struct {
+    __typeof__(json_tokener_parse_verbose)* tokener_parse_verbose;
+    __typeof__(json_tokener_error_desc)* tokener_error_desc;
+    __typeof__(json_object_put)* object_put;
+    __typeof__(json_object_get_type)* object_get_type;
+    __typeof__(json_object_get_string)* object_get_string;
+    __typeof__(json_object_object_get_ex)* object_object_get_ex;
+    __typeof__(json_object_object_length)* object_object_length;
+    __typeof__(json_object_iter_begin)* iter_begin;
+    __typeof__(json_object_iter_end)* iter_end;
+    __typeof__(json_object_iter_next)* iter_next;
+    __typeof__(json_object_iter_equal)* iter_equal;
+    __typeof__(json_object_iter_peek_name)* iter_peek_name;
+    __typeof__(json_object_iter_peek_value)* iter_peek_value;
+    __typeof__(json_object_array_length)* array_length;
+    __typeof__(json_object_array_get_idx)* array_get_idx;
+} JsonLibrary;
+
+/**
+ * @brief Returns the libyaml entry points, loading the library on first use
+ * @return NULL (and an error is logged) if the library cannot be loaded
+ */
+const YamlLibrary* yaml_library(void);
+
+/**
+ * @brief Returns the json-c entry points, loading the library on first use
+ * @return NULL (and an error is logged) if the library cannot be loaded
+ */
+const JsonLibrary* json_library(void);
+
+#endif // ENVIL_PARSERS_H
@@ -0,0 +1,32 @@
+#ifndef ENVIL_PATTERN_H
+#define ENVIL_PATTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Glob keys such as FEATURE_* or QUEUE_*_URL, compiled together: a trie of
+// their literal prefixes leads each name to the few patterns that can match
+// it, so an environment is matched in one pass whatever the number of
+// patterns. * matches any run of characters, ? any one character.
+
+typedef struct PatternSet PatternSet;
+
+// True when a config key is a pattern rather than a variable name
+bool is_pattern(const char* key);
+
+/**
+ * @brief Compiles patterns into one set; the strings are copied
+ * @return The set, or NULL if out of memory
+ */
+PatternSet* compile_patterns(const char* const* patterns, int count);
+
+/**
+ * @brief Finds the patterns a name matches
+ * @param matches Receives their indexes, ascending; room for every pattern
+ * @return The number of matches
+ */
+int match_patterns(const PatternSet* set, const char* name, size_t name_len, int* matches);
+
+void free_patterns(PatternSet* set);
+
+#endif // ENVIL_PATTERN_H
@@ -0,0 +1,24 @@
+#ifndef ENVIL_PLUGIN_LOADER_H
+#define ENVIL_PLUGIN_LOADER_H
+
+#include "checks.h"
+
+// Loading of check plugins, see envil_plugin.h for the interface they export
+
+/**
+ * @brief Loads a plugin and registers its checks
+ *
+ * Loading an object again into the same registry does nothing, so a config
+ * listing a plugin can be reloaded (watch mode).
+ *
+ * @param registry Where the checks go, NULL for the process-wide registry
+ * @param path Passed to dlopen: a path, or a name searched like a library
+ * @return ENVIL_OK, or ENVIL_CONFIG_ERROR after logging why
+ */
+int load_plugin(CheckRegistry* registry, const char* path);
+
+// Called before a registry goes away, so one reusing its memory starts empty.
+// The registry's checks are the caller's to free, the objects stay loaded.
+void forget_plugins(const CheckRegistry* registry);
+
+#endif // ENVIL_PLUGIN_LOADER_H
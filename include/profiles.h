@@ -0,0 +1,25 @@
+#ifndef ENVIL_PROFILES_H
+#define ENVIL_PROFILES_H
+
+#include <stdio.h>
+#include "types.h"
+
+// One config validated against several environment profiles (dotenv files)
+// at once, reported as a matrix of variables by profiles.
+
+/**
+ * @brief Validates a config against each profile in spec
+ *
+ * A profile's variables override the process environment, which fills in
+ * the rest. Profiles are validated concurrently against the one loaded
+ * config, sharing its compiled checks.
+ *
+ * @param spec Comma-separated dotenv files; a directory stands for the
+ *        .env files in it
+ * @param deadline_ms Bounds the checks of each profile, 0 for none
+ * @return ENVIL_OK, the error code of the last failing profile, or
+ *         ENVIL_CONFIG_ERROR if a profile cannot be read
+ */
+int validate_profiles(const Config* config, const char* spec, unsigned deadline_ms, FILE* out);
+
+#endif // ENVIL_PROFILES_H
@@ -0,0 +1,32 @@
+#ifndef ENVIL_SNAPSHOT_H
+#define ENVIL_SNAPSHOT_H
+
+#include <stdbool.h>
+#include "types.h"
+#include "stats.h"
+
+/*
+ * A snapshot records the verdict of each variable of a validated run, keyed
+ * by the fingerprints of its definition and of its value, so a later run can
+ * revalidate only what changed. Values themselves are never stored.
+ */
+
+/**
+ * @brief Validates a config, optionally reusing and recording verdicts
+ *
+ * With since_path, a variable keeps the verdict recorded there unless it is
+ * new, its definition or value changed, a check of it can change its mind
+ * for the same value (an impure cmd or plugin check, a filesystem check, an
+ * expr reading outside the config), its recorded run timed out, or an expr
+ * check of it reads a variable that is revalidated.
+ *
+ * @param since_path Snapshot to diff against, NULL to validate everything
+ * @param snapshot_path Where to record the verdicts, NULL for nowhere
+ * @param errors Receives the failures, recorded ones included, in config order
+ * @return The validation result, or ENVIL_CONFIG_ERROR if a snapshot cannot
+ *         be read or written
+ */
+int validate_snapshot(const Config* config, const char* since_path, const char* snapshot_path,
+                      bool print_value, ValidationErrors* errors, CheckStats* stats);
+
+#endif // ENVIL_SNAPSHOT_H
@@ -0,0 +1,55 @@
+#ifndef ENVIL_STATS_H
+#define ENVIL_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "types.h"
+
+// Per-check run statistics, kept between runs with --stats FILE so the
+// validator can order each variable's checks by measured cost and by how
+// often they reject a value
+
+// Counters are halved past this many runs, so old behavior fades out
+#define STATS_MAX_RUNS 1024
+
+typedef struct {
+    uint64_t key;       // Check::stats_key
+    uint64_t runs;
+    uint64_t rejections;
+    uint64_t total_ns;
+} CheckStat;
+
+typedef struct {
+    CheckStat* entries;  // Sorted by key
+    int count;
+    int capacity;
+    bool dirty;
+} CheckStats;
+
+/**
+ * @brief Reads a stats file; a missing or invalid file gives empty stats
+ * @return NULL only when out of memory
+ */
+CheckStats* load_check_stats(const char* path);
+
+/**
+ * @brief Writes the stats back if they changed, replacing the file atomically
+ */
+void save_check_stats(const CheckStats* stats, const char* path);
+
+void free_check_stats(CheckStats* stats);
+
+/**
+ * @brief Estimates a check's cost in nanoseconds and its rejection rate
+ *
+ * Starts from the definition's static cost and an even rejection rate, and
+ * moves towards the recorded figures as runs accumulate. stats may be NULL.
+ */
+void estimate_check(const CheckStats* stats, const Check* check, double* cost, double* reject_rate);
+
+/**
+ * @brief Records one run of a check
+ */
+void record_check_run(CheckStats* stats, const Check* check, bool rejected, uint64_t ns);
+
+#endif // ENVIL_STATS_H
@@ -0,0 +1,23 @@
+#ifndef ENVIL_STRICT_H
+#define ENVIL_STRICT_H
+
+#include "types.h"
+
+/**
+ * @brief Reports the variables of an environment that the config does not declare
+ *
+ * The declared names and the names in scope are sorted and merged, and near
+ * misses are looked up in an index of the declared names with each byte left
+ * out in turn, so the check stays linear in the size of the environment.
+ *
+ * @param prefix Only names starting with it are in scope; "" for the names
+ *               sharing a declared name's prefix up to its first _
+ * @param envp NAME=VALUE entries, such as environ
+ * @param errors Receives one error per undeclared name, in name order, with a
+ *               suggestion when a declared name is one edit away
+ * @return ENVIL_OK, ENVIL_VALUE_ERROR if a name is undeclared, or
+ *         ENVIL_CONFIG_ERROR if out of memory
+ */
+int check_undeclared(const Config* config, const char* prefix, char* const* envp, ValidationErrors* errors);
+
+#endif // ENVIL_STRICT_H
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum {
     LOG_NONE,      // No logging
@@ -18,32 +19,96 @@ typedef enum {
     TYPE_INTEGER,
     TYPE_BOOLEAN,
     TYPE_FLOAT,
-    TYPE_JSON
+    TYPE_JSON,
+    TYPE_DURATION,  // 30s, 1h30m; compared in nanoseconds
+    TYPE_BYTESIZE   // 512Mi, 2GB; compared in bytes
 } EnvType;
 
+typedef enum {
+    UNIT_NONE,
+    UNIT_DURATION,  // int_value is nanoseconds
+    UNIT_BYTES
+} NumberUnit;
+
+// Numeric check argument, kept exact: 64-bit limits and fractional thresholds
+// such as `ge: -10.0` survive parsing unchanged. A threshold written with a
+// unit (`gt: 30s`) is compared against the value read in that unit.
+typedef struct {
+    bool is_float;
+    int64_t int_value;
+    double float_value;
+    NumberUnit unit;
+} Number;
+
+// Facts about a value computed on first use and shared by all checks of a variable
+#define VALUE_LENGTH_KNOWN  (1u << 0)
+#define VALUE_NUMBER_PARSED (1u << 1)
+#define VALUE_IS_NUMBER     (1u << 2)  // Whole string is a decimal number
+#define VALUE_IS_INTEGER    (1u << 3)  // Optional '-' followed by digits only
+#define VALUE_DURATION_PARSED (1u << 4)
+#define VALUE_IS_DURATION     (1u << 5)
+#define VALUE_BYTESIZE_PARSED (1u << 6)
+#define VALUE_IS_BYTESIZE     (1u << 7)
+
+typedef struct {
+    const char* str;
+    size_t length;
+    unsigned flags;
+    Number number;
+    Number duration;  // Valid with VALUE_IS_DURATION
+    Number bytesize;  // Valid with VALUE_IS_BYTESIZE
+} ValueInfo;
+
 typedef int (*CheckFunction)(const char* value, const void* check_value);
+typedef int (*ValueCheckFunction)(ValueInfo* value, const void* check_value);
 
 typedef struct {
     const char* name;
     const char* description;
     CheckFunction callback;
-    void* custom_data;
+    void* custom_data;  // Registered checks: CheckHooks, or NULL
     int has_arg;
     const char* error_message;
+    ValueCheckFunction value_callback;  // Optional, preferred when validating with a ValueInfo
+    unsigned cost;                      // Rough nanoseconds per call, orders a variable's checks
 } CheckDefinition;
 
+typedef struct {
+    char* cmd;
+    size_t cmd_len;
+    bool pure;            // Declared side-effect free, so results may be cached
+    unsigned timeout_ms;  // The command is killed after this long, 0 for no limit
+} CmdCheck;
+
+struct SemverRange;  // See formats.h
+struct UrlCheck;     // See url.h
+struct RegexCheck;   // See checks.h
+struct Expr;         // See expr.h
+
+// Argument of the network address checks, see netaddr.h
+typedef struct {
+    unsigned classes;   // NET_* classes an address may fall in
+    uint16_t port_min;  // hostport only
+    uint16_t port_max;
+} NetConstraint;
+
 typedef struct {
     const CheckDefinition* definition;
     union {
         int int_value;
+        Number number_value;
+        size_t size_value;
         char* str_value;
         char** enum_values;
-        struct {
-            char* cmd;
-            size_t cmd_len;
-        } cmd_value;
+        CmdCheck cmd_value;
+        NetConstraint net_value;
+        struct SemverRange* semver_range;
+        struct UrlCheck* url_check;
+        struct RegexCheck* regex_check;
+        struct Expr* expr;
         void* custom_value;
     } value;
+    uint64_t stats_key;  // Identifies the check across runs in a stats file, 0 outside configs
 } Check;
 
 typedef struct {
@@ -53,11 +118,21 @@ typedef struct {
     EnvType type;
     Check* checks;
     int check_count;
+    uint64_t definition_hash;  // Fingerprint of the name, default and raw checks
 } EnvVariable;
 
+struct CheckRegistry;
+
 typedef struct {
     EnvVariable *variables;
     int variable_count; 
+    int variable_capacity;
+    struct CheckRegistry *registry;  // Resolves check names and takes plugins, NULL for the process-wide one
+    int *validation_order;  // Variables after those their expr checks read, NULL for config order
+    EnvVariable *patterns;  // Glob keys (FEATURE_*), validated for each name they match
+    int pattern_count;
+    int pattern_capacity;
+    struct PatternSet *pattern_set;  // The patterns compiled for matching, NULL without patterns
 } Config;
 
 typedef struct {
@@ -0,0 +1,32 @@
+#ifndef ENVIL_UNITS_H
+#define ENVIL_UNITS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Quantities with units, parsed into canonical integers so that the numeric
+// comparisons work on them: durations in nanoseconds, sizes in bytes.
+
+/**
+ * @brief Parses a duration such as 30s, 1.5h, 250ms or 1h30m
+ *
+ * Units are ns, us (or µs), ms, s, m, h and d. A unit is required except for
+ * a bare 0. A leading '-' gives a negative duration.
+ */
+bool parse_duration(const char* str, size_t len, int64_t* ns);
+
+/**
+ * @brief Parses a size such as 512, 64K, 512Mi, 2GB or 1.5GiB
+ *
+ * B or no unit is bytes. Ki/KiB, Mi/MiB, ... and the single letters K, M, G,
+ * T, P, E are powers of 1024; k/kB, KB, MB, GB, ... are powers of 1000.
+ */
+bool parse_byte_size(const char* str, size_t len, int64_t* bytes);
+
+// Writes a duration in the largest unit that divides it, e.g. "90s" or "5m"
+const char* format_duration(int64_t ns, char* buf, size_t size);
+// Writes a size in the largest unit that divides it, e.g. "512MiB" or "2GB"
+const char* format_byte_size(int64_t bytes, char* buf, size_t size);
+
+#endif // ENVIL_UNITS_H
@@ -0,0 +1,66 @@
+#ifndef ENVIL_URL_H
+#define ENVIL_URL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "types.h"
+
+// The url check: a value is split once into RFC 3986 components, then
+// ordinary checks run on the components that are present.
+
+typedef enum {
+    URL_SCHEME,
+    URL_USERINFO,
+    URL_HOST,  // Without the brackets of an IPv6 literal
+    URL_PORT,
+    URL_PATH,
+    URL_QUERY,
+    URL_COMPONENT_COUNT
+} UrlComponent;
+
+typedef struct {
+    const char* start;  // Points into the parsed string, not terminated
+    size_t len;
+    bool present;
+} UrlSpan;
+
+typedef struct {
+    UrlSpan parts[URL_COMPONENT_COUNT];
+} UrlParts;
+
+/**
+ * @brief Splits scheme://userinfo@host:port/path?query#fragment
+ *
+ * Only the scheme is mandatory. Components are left percent-encoded.
+ * @return false when there is no scheme, the port is not numeric or the
+ * value contains spaces or control characters
+ */
+bool parse_url(const char* str, size_t len, UrlParts* parts);
+
+const char* url_component_name(UrlComponent component);
+bool find_url_component(const char* name, size_t len, UrlComponent* component);
+
+typedef struct {
+    UrlComponent component;
+    Check check;  // definition is NULL for "required: true", which only asks for the component
+} UrlComponentCheck;
+
+// Argument of the url check, built by the config loader from text such as
+// "scheme.enum=postgresql,postgres;port.le=65535"
+typedef struct UrlCheck {
+    char* text;  // The text it was built from, for messages
+    int count;
+    UrlComponentCheck checks[];
+} UrlCheck;
+
+#define URL_INVALID (-2)
+
+/**
+ * @brief Runs the component checks of a url check, skipping absent components
+ * @param result Set to the result of the failing check
+ * @return Index of the first failing component check, -1 if all pass, or
+ * URL_INVALID when the value is not a URL
+ */
+int find_url_failure(const UrlCheck* url, const char* str, size_t len, int* result);
+
+#endif // ENVIL_URL_H
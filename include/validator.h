@@ -2,6 +2,7 @@
 #define ENVIL_VALIDATOR_H
 
 #include "types.h"
+#include "stats.h"
 
 // Return codes
 #define ENVIL_OK 0
@@ -10,6 +11,7 @@
 #define ENVIL_TYPE_ERROR 3
 #define ENVIL_VALUE_ERROR 4
 #define ENVIL_CUSTOM_ERROR 5
+#define ENVIL_TIMEOUT_ERROR 6
 
 // Validation functions
 int validate_variable(const EnvVariable *var, const char *value);
@@ -17,14 +19,40 @@ int validate_type(EnvType type, const char *value);
 int validate_check(const Check *check, const char *value);
 char *get_env_value(const EnvVariable *var);
 
+// Validation against an analyzed value, shared across the checks of a variable
+int validate_type_value(EnvType type, ValueInfo *value);
+int validate_check_value(const Check *check, ValueInfo *value);
+
 // New validation function with error collection
 int validate_variable_with_errors(const EnvVariable *var, const char *value, ValidationErrors* errors);
 
+// The same, ordering checks by the recorded statistics and recording each run;
+// stats may be NULL. The error reported does not depend on the order.
+int validate_variable_with_stats(const EnvVariable *var, const char *value, ValidationErrors* errors, CheckStats* stats);
+
 // Utility functions
 bool is_integer(const char *str);
 bool is_json(const char *str);
 bool is_float(const char *str);
 
+// Value analysis: each fact is computed on first use and cached in the ValueInfo
+void analyze_value(ValueInfo *info, const char *str);
+size_t value_length(ValueInfo *info);
+bool value_is_integer(ValueInfo *info);
+const Number *value_number(ValueInfo *info);
+// The value as a duration or a size, NULL when it is not one
+const Number *value_quantity(ValueInfo *info, NumberUnit unit);
+
+// Exact numbers: int64 when the text is an in-range integer, double otherwise
+bool parse_number(const char *str, Number *number);
+// A number, or a duration or size with its unit, as gt, lt, ge and le take
+bool parse_threshold(const char *str, Number *number);
+bool compare_numbers(const Number *a, const Number *b, int *result);
+const char *format_number(const Number *number, char *buf, size_t size);
+// The message of a failed check other than type, for the checks whose message
+// does not depend on the value (all but url)
+void describe_check_failure(const Check *check, char *message, size_t size);
+
 // Error handling functions
 ValidationErrors* create_validation_errors(void);
 void add_validation_error(ValidationErrors* errors, const char* var_name, const char* message, int error_code);
@@ -0,0 +1,60 @@
+#ifndef ENVIL_WATCH_H
+#define ENVIL_WATCH_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "types.h"
+
+// The verdicts of a watch session, kept between changes to the config and its
+// dotenv sources. watch_config() drives it from inotify events.
+typedef struct WatchState WatchState;
+
+/**
+ * @brief Starts a watch session, loading the dotenv files
+ *
+ * @param env_files Dotenv files overlaid on the environment, later files win.
+ *                  Borrowed for the life of the state.
+ * @param print_value Report NAME=value instead of "ok" for passing variables
+ * @param report Receives the delta reports
+ * @return The state, or NULL if out of memory
+ */
+WatchState* create_watch_state(char** env_files, int env_file_count, bool print_value, FILE* report);
+
+/**
+ * @brief Swaps in a freshly loaded config, which the state then owns
+ *
+ * Variables whose definition hash and value are unchanged keep their previous
+ * verdict; everything else is revalidated and reported as added (+) or
+ * rechecked (~), and variables no longer in the config as removed (-).
+ *
+ * @return false if out of memory, the previous config staying in place
+ */
+bool watch_apply_config(WatchState* state, Config* config);
+
+// Rereads dotenv file index; a missing file contributes no values until it reappears
+void watch_reload_env_file(WatchState* state, int index);
+
+// Revalidates the variables whose resolved value changed, and reports them
+void watch_refresh_values(WatchState* state);
+
+// Exit code of the current verdicts
+int watch_result(const WatchState* state);
+
+void free_watch_state(WatchState* state);
+
+/**
+ * @brief Validates a config, then watches it and its dotenv sources for changes
+ *
+ * After the initial run only the variables whose definition or value changed
+ * are revalidated, and a delta report is written to stdout for each change.
+ * Returns when interrupted by SIGINT or SIGTERM.
+ *
+ * @param config_path Path to the YAML/JSON configuration file
+ * @param env_files Dotenv files overlaid on the environment, later files win
+ * @param env_file_count Number of entries in env_files
+ * @param print_value Print NAME=value instead of "ok" for passing variables
+ * @return Exit code of the last revalidation
+ */
+int watch_config(const char* config_path, char** env_files, int env_file_count, bool print_value);
+
+#endif // ENVIL_WATCH_H
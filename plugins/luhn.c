@@ -0,0 +1,57 @@
+// Example envil plugin: the Luhn checksum of card numbers and IMEIs.
+//
+//   make plugins
+//   envil --plugin bin/plugins/luhn.so -e CARD --check luhn=16
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "envil_plugin.h"
+
+// The argument is "any" or the number of digits required
+static void* parse_length(const char* argument, char* error, size_t error_size) {
+    size_t* length = malloc(sizeof(size_t));
+    if (!length) return NULL;
+
+    char* end;
+    *length = strcmp(argument, "any") == 0 ? 0 : strtoul(argument, &end, 10);
+    if (strcmp(argument, "any") != 0 && (*argument == '\0' || *end != '\0' || *length == 0)) {
+        snprintf(error, error_size, "expected any or a digit count");
+        free(length);
+        return NULL;
+    }
+    return length;
+}
+
+static int check_luhn(const char* value, const void* argument) {
+    size_t len = strlen(value);
+    size_t expected = *(const size_t*)argument;
+    if (len < 2 || (expected && len != expected)) return ENVIL_VALUE_ERROR;
+
+    // Every second digit from the right is doubled
+    unsigned sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = value[len - 1 - i];
+        if (c < '0' || c > '9') return ENVIL_VALUE_ERROR;
+        unsigned digit = (unsigned)(c - '0');
+        if (i % 2 == 1) digit = digit * 2 > 9 ? digit * 2 - 9 : digit * 2;
+        sum += digit;
+    }
+    return sum % 10 == 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+static const EnvilPluginCheck luhn = {
+    .name = "luhn",
+    .description = "Check a Luhn checksum (any, or the digit count)",
+    .check = check_luhn,
+    .has_arg = 1,
+    .parse = parse_length,
+    .free = free,
+    .error_message = "Invalid checksum",
+    .cost = 40,
+    .flags = ENVIL_PLUGIN_CHECK_PURE,
+};
+
+ENVIL_PLUGIN_EXPORT int envil_plugin_init_v1(EnvilPluginHost* host) {
+    return host->register_check(host, &luhn);
+}
@@ -0,0 +1,42 @@
+// Validates a program's own environment before its main runs, for programs
+// envil cannot wrap. The configuration is the one $ENVIL_CONFIG names:
+//
+//   make lib
+//   ENVIL_CONFIG=config.yml LD_PRELOAD=lib/libenvil_preload.so app
+//
+// A failure prints the usual report and exits with the usual code before the
+// program starts; nothing else changes in the process.
+
+#define _GNU_SOURCE  // program_invocation_short_name
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "envil.h"
+
+static void report_failure(const char* name, const char* message, int error_code, void* user_data) {
+    (void)error_code;
+    (void)user_data;
+    fprintf(stderr, "Error %s: %s\n", name, message);
+}
+
+__attribute__((constructor))
+static void envil_preload(void) {
+    const char* config_path = getenv("ENVIL_CONFIG");
+    if (!config_path || !*config_path) return;
+
+    EnvilContext* ctx = envil_context_new();
+    EnvilPlan* plan = ctx ? envil_plan_load(ctx, config_path) : NULL;
+    // Without a lookup the plan reads this process's environ, pattern keys included
+    int result = plan ? envil_validate(plan, NULL, NULL, report_failure, NULL) : ENVIL_CONFIG_ERROR;
+    envil_plan_free(plan);
+    envil_context_free(ctx);
+
+    if (result != ENVIL_OK) {
+        fprintf(stderr, "envil: not starting %s, %s %s\n", program_invocation_short_name,
+                plan ? "its environment does not match" : "cannot load", config_path);
+        _exit(result);
+    }
+    // The programs this one runs inherit LD_PRELOAD; the check is done once
+    unsetenv("ENVIL_CONFIG");
+}
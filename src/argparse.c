@@ -12,7 +12,7 @@
  * Creates an array of check options from the provided checks array.
  * Caller is responsible for freeing the returned array.
  */
-struct option* get_check_options(CheckDefinition checks[], int count) {
+struct option* get_check_options(const CheckDefinition checks[], int count) {
     if (count <= 0 || !checks) {
         return NULL;
     }
@@ -33,54 +33,34 @@ struct option* get_check_options(CheckDefinition checks[], int count) {
     return options;
 }
 
+// Short options for getopt_long, colon after options that require arguments
+const char short_options[] = "c:e:pvlhC:d:wf:o:";
+
 /**
- * Creates the complete array of long options by combining base and check options.
- * Caller is responsible for freeing the returned array and the check_options.
+ * Creates a heap copy of the static long_options table.
+ * Caller is responsible for freeing the returned array.
  */
 struct option* create_long_options() {
-    // Get the number of base options and check options
-    size_t num_base = get_base_options_count();
-    size_t num_checks = get_check_options_count();
-    
-    // Allocate space for the combined array (+1 for NULL terminator)
-    struct option* long_options = calloc(num_base + num_checks + 1, sizeof(struct option));
-    if (!long_options) {
+    size_t count = get_options_count() + 1;  // Including the terminator
+    struct option* options = malloc(count * sizeof(struct option));
+    if (!options) {
         logger(LOG_ERROR, "Memory allocation failed for long options\n");
         return NULL;
     }
-
-    // Copy base options
-    memcpy(long_options, base_options, num_base * sizeof(struct option));
-    
-    // Add check options
-    for (size_t i = 0; i < num_checks; i++) {
-        struct option* opt = &long_options[num_base + i];
-        opt->name = checks[i].name;
-        opt->has_arg = required_argument;
-        opt->flag = NULL;
-        opt->val = 0;  // Use 0 for check options to distinguish from base options
-    }
-
-    // Last element is already zeroed by calloc
-    return long_options;
+    memcpy(options, long_options, count * sizeof(struct option));
+    return options;
 }
 
 /**
- * Creates the getopt_long option string for base options.
+ * Creates a heap copy of the short options string.
  * Caller is responsible for freeing the returned string.
  */
 char* get_getopt_long_string() {
-    char* getopt_str = calloc(256, sizeof(char));
+    char* getopt_str = strdup(short_options);
     if (!getopt_str) {
         logger(LOG_ERROR, "Memory allocation failed for getopt string\n");
         return NULL;
     }
-
-    const char* valid_options = "c:e:pvlhC:d:"; // Colon after options that require arguments
-
-    // Copy valid options to getopt string
-    strcpy(getopt_str, valid_options);
-
     return getopt_str;
 }
 
@@ -92,15 +72,24 @@ void list_checks() {
     for (size_t i = 0; i < get_check_options_count(); i++) {
         fprintf(stderr, "  --%s: %s\n", checks[i].name, checks[i].description);
     }
+    // Checks from --plugin, given as --check NAME=VALUE
+    const CheckRegistry* registry = get_default_registry();
+    for (int i = 0; i < registry->count; i++) {
+        fprintf(stderr, "  --check %s: %s\n", registry->definitions[i].name, registry->definitions[i].description);
+    }
 }
 
 /**
- * Prints usage information and exits with status code 1.
+ * Prints usage information.
  */
 void print_usage() {
     fprintf(stderr, "Usage:\n");
     fprintf(stderr, "  Single variable: envil -e VAR_NAME [-d VALUE] [-p]\n");
     fprintf(stderr, "  Config file: envil -c config.yml\n");
+    fprintf(stderr, "  Run an application: envil -c config.yml -- APP [ARGS...]\n");
+    fprintf(stderr, "  Watch config: envil -c config.yml -w [-f .env]\n");
+    fprintf(stderr, "  Record verdicts: envil snapshot -c config.yml [--since OLD] FILE\n");
+    fprintf(stderr, "  Generate a C validator: envil codegen config.yml -o env_gen.c\n");
     fprintf(stderr, "  List checks: envil -l\n");
     fprintf(stderr, "  Generate completion: envil -C <shell>\n");
     fprintf(stderr, "\nOptions:\n");
@@ -110,7 +99,23 @@ void print_usage() {
     fprintf(stderr, "  -p, --print          Print value if validation passes\n");
     fprintf(stderr, "  -v, --verbose        Enable verbose output\n");
     fprintf(stderr, "  -l, --list-checks    List available check types and descriptions\n");
+    fprintf(stderr, "  -f, --env-file FILE  Load variables from a dotenv file (repeatable, later files win)\n");
+    fprintf(stderr, "  -w, --watch          Revalidate on config or env file changes, reporting deltas\n");
+    fprintf(stderr, "      --cache          Reuse the verdict of an identical passing config run\n");
+    fprintf(stderr, "      --stats FILE     Learn check costs in FILE and run cheap, likely failing checks first\n");
+    fprintf(stderr, "      --deadline TIME  Kill cmd checks still running after TIME (e.g. 30s) and exit with 6\n");
+    fprintf(stderr, "      --plugin FILE    Load checks from a shared object (repeatable)\n");
+    fprintf(stderr, "      --check NAME=VALUE  Run a check by name, such as one from a plugin\n");
+    fprintf(stderr, "      --manifests PATH  Validate the env of every container in the Kubernetes and\n");
+    fprintf(stderr, "                       compose YAML files under PATH against the -c config\n");
+    fprintf(stderr, "      --profiles LIST  Validate the -c config against each dotenv file in LIST\n");
+    fprintf(stderr, "                       (comma-separated, or a directory of .env files) as a matrix\n");
+    fprintf(stderr, "      --since FILE     Revalidate only what changed since the snapshot in FILE\n");
+    fprintf(stderr, "      --strict[=PREFIX]  Fail on variables starting with PREFIX that the config does\n");
+    fprintf(stderr, "                       not declare (default: the prefixes of the declared names)\n");
+    fprintf(stderr, "      --assign         In the bash builtin, once validation passed, export the\n");
+    fprintf(stderr, "                       defaults of unset variables to the calling shell\n");
+    fprintf(stderr, "  -o, --output FILE    With codegen, the .c file to write, next to its .h\n");
     fprintf(stderr, "  -C, --completion <shell>  Generate shell completion script (bash|zsh)\n");
     fprintf(stderr, "  -h, --help           Show this help message\n");
-    exit(1);
 }
\ No newline at end of file
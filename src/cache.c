@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "hash.h"
+#include "logger.h"
+#include "checks.h"
+#include "fscheck.h"
+#include "url.h"
+#include "expr.h"
+#include "pattern.h"
+
+extern char** environ;
+
+#define CACHE_HEADER "envil-cache 1\n"
+#define CACHE_SECOND_SEED 0x84222325cbf29ce4ULL
+
+// var_name names the variable in the log when the check is not cacheable, NULL for no log
+static bool check_is_cacheable(const Check* check, const char* var_name) {
+    const char* name = check->definition->name;
+    if (strcmp(name, "cmd") == 0 && !check->value.cmd_value.pure) {
+        if (var_name) logger(LOG_INFO, "Not caching: cmd check of '%s' is not declared pure", var_name);
+        return false;
+    }
+    // The filesystem can change while the environment stays the same
+    if (is_fs_check(name)) {
+        if (var_name) logger(LOG_INFO, "Not caching: '%s' has a filesystem check", var_name);
+        return false;
+    }
+    if (!is_builtin_check(name)) {
+        const CheckHooks* hooks = check->definition->custom_data;
+        if (!hooks || !hooks->pure) {
+            if (var_name) {
+                logger(LOG_INFO, "Not caching: %s check of '%s' is not declared pure", name, var_name);
+            }
+            return false;
+        }
+    }
+    // The fingerprint covers the config's variables only
+    if (strcmp(name, "expr") == 0) {
+        const Expr* expr = check->value.expr;
+        for (int i = 0; i < expr_name_count(expr); i++) {
+            if (expr_name_binding(expr, i) < 0) {
+                if (var_name) {
+                    logger(LOG_INFO, "Not caching: expr check of '%s' reads %s, which is not in the config",
+                           var_name, expr_name(expr, i));
+                }
+                return false;
+            }
+        }
+    }
+    if (strcmp(name, "url") == 0) {
+        const UrlCheck* url = check->value.url_check;
+        for (int i = 0; i < url->count; i++) {
+            if (url->checks[i].check.definition && !check_is_cacheable(&url->checks[i].check, var_name)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool variable_is_cacheable(const EnvVariable* var) {
+    for (int j = 0; j < var->check_count; j++) {
+        if (!check_is_cacheable(&var->checks[j], NULL)) return false;
+    }
+    return true;
+}
+
+bool config_is_cacheable(const Config* config) {
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        for (int j = 0; j < var->check_count; j++) {
+            if (!check_is_cacheable(&var->checks[j], var->name)) return false;
+        }
+    }
+    for (int i = 0; i < config->pattern_count; i++) {
+        const EnvVariable* var = &config->patterns[i];
+        for (int j = 0; j < var->check_count; j++) {
+            if (!check_is_cacheable(&var->checks[j], var->name)) return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t fingerprint_with_seed(const Config* config, bool print_value, uint64_t hash) {
+    hash = hash_string(hash, CACHE_HEADER);
+    hash = hash_string(hash, print_value ? "print" : NULL);
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        hash = hash_bytes(hash, &var->definition_hash, sizeof(var->definition_hash));
+        hash = hash_string(hash, getenv(var->name));
+    }
+    if (config->pattern_count == 0) return hash;
+
+    // Pattern keys make every matching entry of the environment part of the input
+    for (int i = 0; i < config->pattern_count; i++) {
+        const EnvVariable* var = &config->patterns[i];
+        hash = hash_bytes(hash, &var->definition_hash, sizeof(var->definition_hash));
+    }
+    int* matches = malloc((size_t)config->pattern_count * sizeof(int));
+    for (char** entry = environ; matches && *entry; entry++) {
+        const char* equals = strchr(*entry, '=');
+        if (equals && match_patterns(config->pattern_set, *entry, (size_t)(equals - *entry), matches) > 0) {
+            hash = hash_string(hash, *entry);
+        }
+    }
+    free(matches);
+    return hash;
+}
+
+void cache_fingerprint(const Config* config, bool print_value, char* key) {
+    // Two independently seeded passes give a 128-bit key, keeping accidental
+    // collisions (which would replay a wrong verdict) out of reach
+    uint64_t hi = fingerprint_with_seed(config, print_value, HASH_SEED);
+    uint64_t lo = fingerprint_with_seed(config, print_value, CACHE_SECOND_SEED);
+    snprintf(key, CACHE_KEY_SIZE, "%016llx%016llx", (unsigned long long)hi, (unsigned long long)lo);
+}
+
+// Resolves $ENVIL_CACHE_DIR, $XDG_CACHE_HOME/envil or ~/.cache/envil
+static bool get_cache_dir(char* dir, size_t size) {
+    const char* env_dir = getenv("ENVIL_CACHE_DIR");
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    int len;
+
+    if (env_dir && *env_dir) {
+        len = snprintf(dir, size, "%s", env_dir);
+    } else if (xdg && *xdg) {
+        len = snprintf(dir, size, "%s/envil", xdg);
+    } else if (home && *home) {
+        len = snprintf(dir, size, "%s/.cache/envil", home);
+    } else {
+        return false;
+    }
+    return len > 0 && (size_t)len < size;
+}
+
+static bool get_cache_path(const char* key, char* path, size_t size) {
+    char dir[PATH_MAX];
+    if (!get_cache_dir(dir, sizeof(dir))) return false;
+
+    int len = snprintf(path, size, "%s/%s", dir, key);
+    return len > 0 && (size_t)len < size;
+}
+
+static bool make_dirs(const char* dir) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s", dir);
+
+    for (char* p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(path, 0700) != 0 && errno != EEXIST) return false;
+        *p = '/';
+    }
+    return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+bool cache_replay(const char* key) {
+    char path[PATH_MAX];
+    if (!get_cache_path(key, path, sizeof(path))) return false;
+
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char header[sizeof(CACHE_HEADER)];
+    if (!fgets(header, sizeof(header), file) || strcmp(header, CACHE_HEADER) != 0) {
+        logger(LOG_WARNING, "Ignoring invalid cache entry %s", path);
+        fclose(file);
+        return false;
+    }
+
+    logger(LOG_INFO, "Cache hit: %s", key);
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        fwrite(buf, 1, n, stdout);
+    }
+    fclose(file);
+    return true;
+}
+
+void cache_store(const char* key, const char* output, size_t output_len) {
+    char dir[PATH_MAX];
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX + 16];
+
+    if (!get_cache_dir(dir, sizeof(dir)) || !get_cache_path(key, path, sizeof(path))) return;
+    if (!make_dirs(dir)) {
+        logger(LOG_WARNING, "Cannot create cache directory %s: %s", dir, strerror(errno));
+        return;
+    }
+
+    // Entries may hold printed values, so keep them private to the user
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+    int fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        logger(LOG_WARNING, "Cannot write cache entry %s: %s", path, strerror(errno));
+        return;
+    }
+
+    FILE* file = fdopen(fd, "w");
+    if (!file) {
+        close(fd);
+        unlink(tmp_path);
+        return;
+    }
+
+    bool ok = fputs(CACHE_HEADER, file) >= 0 &&
+              fwrite(output, 1, output_len, file) == output_len;
+    ok = (fclose(file) == 0) && ok;
+
+    // Rename into place so concurrent runs never see a partial entry
+    if (!ok || rename(tmp_path, path) != 0) {
+        logger(LOG_WARNING, "Cannot write cache entry %s", path);
+        unlink(tmp_path);
+        return;
+    }
+    logger(LOG_INFO, "Cached passing run: %s", key);
+}
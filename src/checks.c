@@ -3,6 +3,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
@@ -12,6 +16,11 @@
 #include "validator.h"
 #include "checks.h"
 #include "logger.h"
+#include "netaddr.h"
+#include "formats.h"
+#include "fscheck.h"
+#include "url.h"
+#include "expr.h"
 
 int check_mock(const char* value, const void* param) {
     printf("Mock check called with value: %s and param: %s\n", value, (char*) param);
@@ -19,21 +28,16 @@ int check_mock(const char* value, const void* param) {
 }
 
 
-#define MAX_CHECKS 32
-
-typedef struct {
-    CheckDefinition definitions[MAX_CHECKS];
-    int count;
-} CheckRegistry;
-
+// Checks registered by the command line through register_check; the built-ins
+// live in the static checks[] table and need no setup
 static CheckRegistry registry = {0};
 
-// Helper function for numeric comparisons
-static bool parse_numeric_value(const char* value, double* result) {
-    if (!value) return false;
-    char* endptr;
-    *result = strtod(value, &endptr);
-    return *endptr == '\0';
+// Helper for the numeric comparisons: orders the value against the threshold,
+// reading the value in the threshold's unit if it has one
+static bool compare_to_threshold(ValueInfo* value, const void* threshold, int* result) {
+    const Number* number = value_quantity(value, ((const Number*)threshold)->unit);
+    if (!number) return false;
+    return compare_numbers(number, (const Number*)threshold, result);
 }
 
 // Built-in check functions
@@ -42,24 +46,103 @@ int check_type(const char* value, const void* type_ptr) {
     return validate_type(type, value);
 }
 
-int check_gt(const char* value, const void* threshold) {
-    double val, threshold_val = *(int*)threshold;
-    if (!parse_numeric_value(value, &val)) {
+int check_type_value(ValueInfo* value, const void* type_ptr) {
+    EnvType type = *(EnvType*)type_ptr;
+    return validate_type_value(type, value);
+}
+
+int check_gt_value(ValueInfo* value, const void* threshold) {
+    int cmp;
+    if (!compare_to_threshold(value, threshold, &cmp)) {
         return ENVIL_VALUE_ERROR;
     }
-    return val > threshold_val ? ENVIL_OK : ENVIL_VALUE_ERROR;
+    return cmp > 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
 }
 
-int check_lt(const char* value, const void* threshold) {
-    double val, threshold_val = *(int*)threshold;
-    if (!parse_numeric_value(value, &val)) {
+int check_lt_value(ValueInfo* value, const void* threshold) {
+    int cmp;
+    if (!compare_to_threshold(value, threshold, &cmp)) {
+        return ENVIL_VALUE_ERROR;
+    }
+    return cmp < 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_ge_value(ValueInfo* value, const void* threshold) {
+    int cmp;
+    if (!compare_to_threshold(value, threshold, &cmp)) {
         return ENVIL_VALUE_ERROR;
     }
-    return val < threshold_val ? ENVIL_OK : ENVIL_VALUE_ERROR;
+    return cmp >= 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_le_value(ValueInfo* value, const void* threshold) {
+    int cmp;
+    if (!compare_to_threshold(value, threshold, &cmp)) {
+        return ENVIL_VALUE_ERROR;
+    }
+    return cmp <= 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_len_value(ValueInfo* value, const void* length) {
+    return value_length(value) == *(size_t*)length ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_lengt_value(ValueInfo* value, const void* length) {
+    return value_length(value) > *(size_t*)length ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_lenlt_value(ValueInfo* value, const void* length) {
+    return value_length(value) < *(size_t*)length ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+// String entry points for the checks above, analyzing the value on the spot
+int check_gt(const char* value, const void* threshold) {
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_gt_value(&info, threshold);
+}
+
+int check_lt(const char* value, const void* threshold) {
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_lt_value(&info, threshold);
+}
+
+int check_ge(const char* value, const void* threshold) {
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_ge_value(&info, threshold);
+}
+
+int check_le(const char* value, const void* threshold) {
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_le_value(&info, threshold);
 }
 
 int check_len(const char* value, const void* length) {
-    return strlen(value) == *(size_t*)length ? ENVIL_OK : ENVIL_VALUE_ERROR;
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_len_value(&info, length);
+}
+
+int check_lengt(const char* value, const void* length) {
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_lengt_value(&info, length);
+}
+
+int check_lenlt(const char* value, const void* length) {
+    if (!value) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_lenlt_value(&info, length);
 }
 
 int check_enum(const char* value, const void* values) {
@@ -75,25 +158,80 @@ int check_enum(const char* value, const void* values) {
     return ENVIL_VALUE_ERROR;
 }
 
+// Absolute CLOCK_MONOTONIC time in ns past which no check may run, 0 for none.
+// Per thread, like the active log target, so library callers are independent.
+static _Thread_local int64_t deadline_ns = 0;
+static _Thread_local bool cmd_not_run = false;
+
+static int64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void set_check_deadline(unsigned timeout_ms) {
+    deadline_ns = timeout_ms ? monotonic_ns() + (int64_t)timeout_ms * 1000000 : 0;
+}
+
+bool check_deadline_passed(void) {
+    return deadline_ns && monotonic_ns() >= deadline_ns;
+}
+
+bool cmd_check_not_run(void) {
+    return cmd_not_run;
+}
+
+// Milliseconds left until expiry for poll(), rounded up; -1 when there is no limit
+static int remaining_ms(int64_t expiry_ns) {
+    if (!expiry_ns) return -1;
+    int64_t left = expiry_ns - monotonic_ns();
+    if (left <= 0) return 0;
+    int64_t ms = (left + 999999) / 1000000;
+    return ms > INT_MAX ? INT_MAX : (int)ms;
+}
+
+// Waits for the child, giving up at expiry (0 for never). Returns like
+// waitpid(): the pid once it exited, 0 on timeout, -1 on error.
+static pid_t wait_until(pid_t pid, int* status, int64_t expiry_ns) {
+    struct timespec pause = {0, 1000000};
+    for (;;) {
+        pid_t done = waitpid(pid, status, expiry_ns ? WNOHANG : 0);
+        if (done == -1 && errno == EINTR) continue;
+        if (done != 0) return done;
+        if (remaining_ms(expiry_ns) == 0) return 0;
+        nanosleep(&pause, NULL);
+        if (pause.tv_nsec < 16000000) pause.tv_nsec *= 2;
+    }
+}
+
 int check_cmd(const char* value, const void* cmd_data) {
+    cmd_not_run = false;
     if (!value || !cmd_data) return ENVIL_CUSTOM_ERROR;
     
-    const struct {
-        char* cmd;
-        size_t cmd_len;
-    } *cmd_value = cmd_data;
+    const CmdCheck *cmd_value = cmd_data;
 
     if (!cmd_value->cmd || !cmd_value->cmd_len) {  // Check for empty command
         fprintf(stderr, "Empty command provided\n");
         return ENVIL_CUSTOM_ERROR;
     }
 
+    if (check_deadline_passed()) {
+        cmd_not_run = true;
+        return ENVIL_TIMEOUT_ERROR;
+    }
+
+    // The earlier of the check's own timeout and the validation deadline
+    int64_t expiry_ns = cmd_value->timeout_ms ? monotonic_ns() + (int64_t)cmd_value->timeout_ms * 1000000 : 0;
+    if (deadline_ns && (!expiry_ns || deadline_ns < expiry_ns)) {
+        expiry_ns = deadline_ns;
+    }
+
     // Print command for debugging
     logger(LOG_INFO, "Executing command: %s", cmd_value->cmd);
     
     int pipefd[2];
     pid_t pid;
-    int status;
+    int status = 0;
 
     if (pipe(pipefd) == -1) {
         fprintf(stderr, "Failed to create pipe: %s\n", strerror(errno));
@@ -109,6 +247,9 @@ int check_cmd(const char* value, const void* cmd_data) {
     }
 
     if (pid == 0) {  // Child process
+        // Own process group, so a timeout kills everything the command started
+        setpgid(0, 0);
+
         // Set up environment
         setenv("VALUE", value, 1);
         
@@ -133,14 +274,25 @@ int check_cmd(const char* value, const void* cmd_data) {
         _exit(1);  // Use _exit() in child process
     }
 
-    // Parent process continues here
+    // Parent process continues here; set the group here too so kill() cannot
+    // race the child's own setpgid
+    setpgid(pid, pid);
     close(pipefd[1]);  // Close write end
 
-    // Read command output
+    // Read command output until EOF or expiry
     char buf[1024];
     ssize_t n;
-    
-    while ((n = read(pipefd[0], buf, sizeof(buf)-1)) > 0) {
+    bool timed_out = false;
+    struct pollfd pfd = {pipefd[0], POLLIN, 0};
+
+    for (;;) {
+        int ready = poll(&pfd, 1, remaining_ms(expiry_ns));
+        if (ready == -1 && errno == EINTR) continue;
+        if (ready == 0) {
+            timed_out = true;
+            break;
+        }
+        if (ready == -1 || (n = read(pipefd[0], buf, sizeof(buf)-1)) <= 0) break;
         buf[n] = '\0';
         fprintf(stderr, "Command output: %s", buf);
     }
@@ -148,7 +300,14 @@ int check_cmd(const char* value, const void* cmd_data) {
     close(pipefd[0]);
 
     // Wait for child and get status
-    if (waitpid(pid, &status, 0) == -1) {
+    pid_t waited = timed_out ? 0 : wait_until(pid, &status, expiry_ns);
+    if (waited == 0) {
+        kill(-pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        logger(LOG_INFO, "Command timed out and was killed: %s", cmd_value->cmd);
+        return ENVIL_TIMEOUT_ERROR;
+    }
+    if (waited == -1) {
         fprintf(stderr, "Wait failed: %s\n", strerror(errno));
         return ENVIL_CUSTOM_ERROR;
     }
@@ -173,91 +332,405 @@ int check_ne(const char* value, const void* target) {
     return strcmp(value, (const char*)target) != 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
 }
 
-int check_ge(const char* value, const void* threshold) {
-    double val, threshold_val = *(int*)threshold;
-    if (!parse_numeric_value(value, &val)) {
-        return ENVIL_VALUE_ERROR;
+
+
+
+
+RegexCheck* compile_regex_check(const char* pattern) {
+    RegexCheck* regex = malloc(sizeof(RegexCheck));
+    if (!regex) return NULL;
+    regex->pattern = strdup(pattern);
+    if (!regex->pattern) {
+        free(regex);
+        return NULL;
+    }
+
+    int ret = regcomp(&regex->regex, pattern, REG_EXTENDED | REG_NOSUB);
+    regex->compiled = ret == 0;
+    if (!regex->compiled) {
+        char error_buf[100];
+        regerror(ret, &regex->regex, error_buf, sizeof(error_buf));
+        logger(LOG_ERROR, "Failed to compile regex: %s", error_buf);
     }
-    return val >= threshold_val ? ENVIL_OK : ENVIL_VALUE_ERROR;
+    return regex;
 }
 
-int check_le(const char* value, const void* threshold) {
-    double val, threshold_val = *(int*)threshold;
-    if (!parse_numeric_value(value, &val)) {
-        return ENVIL_VALUE_ERROR;
+void free_regex_check(RegexCheck* regex) {
+    if (!regex) return;
+    if (regex->compiled) regfree(&regex->regex);
+    free(regex->pattern);
+    free(regex);
+}
+
+// The argument is a RegexCheck; regexec() only reads it, so threads may share one
+int check_regex(const char* value, const void* regex) {
+    const RegexCheck* compiled = regex;
+    if (!value || !compiled || !compiled->compiled) return ENVIL_VALUE_ERROR;
+    return regexec(&compiled->regex, value, 0, NULL, 0) == 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+// Network address checks; the argument is a NetConstraint
+static int allow_class(const NetConstraint* constraint, unsigned address_class) {
+    return (constraint->classes & address_class) ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_ipv4_value(ValueInfo* value, const void* constraint) {
+    uint8_t addr[4];
+    if (!parse_ipv4(value->str, value_length(value), addr)) return ENVIL_VALUE_ERROR;
+    return allow_class(constraint, classify_ipv4(addr));
+}
+
+int check_ipv6_value(ValueInfo* value, const void* constraint) {
+    uint8_t addr[16];
+    if (!parse_ipv6(value->str, value_length(value), addr)) return ENVIL_VALUE_ERROR;
+    return allow_class(constraint, classify_ipv6(addr));
+}
+
+int check_ip_value(ValueInfo* value, const void* constraint) {
+    // IPv6 text always has a ':', IPv4 never does
+    if (memchr(value->str, ':', value_length(value))) return check_ipv6_value(value, constraint);
+    return check_ipv4_value(value, constraint);
+}
+
+int check_cidr_value(ValueInfo* value, const void* constraint) {
+    size_t len = value_length(value);
+    const char* slash = memchr(value->str, '/', len);
+    if (!slash) return ENVIL_VALUE_ERROR;
+
+    uint8_t first[16];
+    size_t addr_len = (size_t)(slash - value->str);
+    size_t bytes;
+    if (parse_ipv4(value->str, addr_len, first)) bytes = 4;
+    else if (parse_ipv6(value->str, addr_len, first)) bytes = 16;
+    else return ENVIL_VALUE_ERROR;
+
+    const char* digits = slash + 1;
+    size_t digit_count = len - addr_len - 1;
+    if (digit_count == 0 || digit_count > 3 || (digits[0] == '0' && digit_count > 1)) return ENVIL_VALUE_ERROR;
+    unsigned prefix = 0;
+    for (size_t i = 0; i < digit_count; i++) {
+        if (digits[i] < '0' || digits[i] > '9') return ENVIL_VALUE_ERROR;
+        prefix = prefix * 10 + (unsigned)(digits[i] - '0');
+    }
+    if (prefix > bytes * 8) return ENVIL_VALUE_ERROR;
+
+    // A network, not an interface address: host bits must be zero. The whole
+    // block has to fall in an allowed class, so its last address is checked too.
+    uint8_t last[16];
+    for (size_t i = 0; i < bytes; i++) {
+        unsigned bits = prefix > i * 8 ? prefix - (unsigned)i * 8 : 0;
+        uint8_t mask = bits >= 8 ? 0xff : (uint8_t)(0xff00 >> bits);
+        if (first[i] & ~mask) return ENVIL_VALUE_ERROR;
+        last[i] = first[i] | (uint8_t)~mask;
+    }
+
+    if (bytes == 4) {
+        if (allow_class(constraint, classify_ipv4(first)) != ENVIL_OK) return ENVIL_VALUE_ERROR;
+        return allow_class(constraint, classify_ipv4(last));
     }
-    return val <= threshold_val ? ENVIL_OK : ENVIL_VALUE_ERROR;
+    if (allow_class(constraint, classify_ipv6(first)) != ENVIL_OK) return ENVIL_VALUE_ERROR;
+    return allow_class(constraint, classify_ipv6(last));
 }
 
-int check_lengt(const char* value, const void* length) {
-    return strlen(value) > *(size_t*)length ? ENVIL_OK : ENVIL_VALUE_ERROR;
+int check_hostname_value(ValueInfo* value, const void* constraint) {
+    int labels;
+    if (!parse_hostname(value->str, value_length(value), &labels)) return ENVIL_VALUE_ERROR;
+    if ((((const NetConstraint*)constraint)->classes & NET_FQDN) && labels < 2) return ENVIL_VALUE_ERROR;
+    return ENVIL_OK;
 }
 
-int check_lenlt(const char* value, const void* length) {
-    return strlen(value) < *(size_t*)length ? ENVIL_OK : ENVIL_VALUE_ERROR;
+int check_hostport_value(ValueInfo* value, const void* constraint_ptr) {
+    const NetConstraint* constraint = constraint_ptr;
+    const char* str = value->str;
+    size_t len = value_length(value);
+
+    // The port follows the last ':'; an IPv6 host must be bracketed
+    const char* colon = NULL;
+    for (size_t i = len; i > 0; i--) {
+        if (str[i - 1] == ':') {
+            colon = &str[i - 1];
+            break;
+        }
+    }
+    if (!colon) return ENVIL_VALUE_ERROR;
+
+    const char* port_str = colon + 1;
+    size_t port_len = len - (size_t)(port_str - str);
+    if (port_len == 0 || port_len > 5 || port_str[0] == '0') return ENVIL_VALUE_ERROR;
+    unsigned port = 0;
+    for (size_t i = 0; i < port_len; i++) {
+        if (port_str[i] < '0' || port_str[i] > '9') return ENVIL_VALUE_ERROR;
+        port = port * 10 + (unsigned)(port_str[i] - '0');
+    }
+    if (port < constraint->port_min || port > constraint->port_max) return ENVIL_VALUE_ERROR;
+
+    const char* host = str;
+    size_t host_len = (size_t)(colon - str);
+    uint8_t addr[16];
+    if (host_len >= 2 && host[0] == '[' && host[host_len - 1] == ']') {
+        if (!parse_ipv6(host + 1, host_len - 2, addr)) return ENVIL_VALUE_ERROR;
+        return allow_class(constraint, classify_ipv6(addr));
+    }
+    if (parse_ipv4(host, host_len, addr)) return allow_class(constraint, classify_ipv4(addr));
+
+    // Names cannot be classified without resolving them, only fqdn applies
+    int labels;
+    if (!parse_hostname(host, host_len, &labels)) return ENVIL_VALUE_ERROR;
+    if ((constraint->classes & NET_FQDN) && labels < 2) return ENVIL_VALUE_ERROR;
+    return ENVIL_OK;
 }
 
-int check_regex(const char* value, const void* pattern) {
-    if (!value || !pattern) return ENVIL_VALUE_ERROR;
-    
-    regex_t regex;
-    int ret = regcomp(&regex, (const char*)pattern, REG_EXTENDED | REG_NOSUB);
-    if (ret != 0) {
-        char error_buf[100];
-        regerror(ret, &regex, error_buf, sizeof(error_buf));
-        logger(LOG_ERROR, "Failed to compile regex: %s", error_buf);
+int check_ip(const char* value, const void* constraint) {
+    if (!value || !constraint) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_ip_value(&info, constraint);
+}
+
+int check_ipv4(const char* value, const void* constraint) {
+    if (!value || !constraint) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_ipv4_value(&info, constraint);
+}
+
+int check_ipv6(const char* value, const void* constraint) {
+    if (!value || !constraint) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_ipv6_value(&info, constraint);
+}
+
+int check_cidr(const char* value, const void* constraint) {
+    if (!value || !constraint) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_cidr_value(&info, constraint);
+}
+
+int check_hostname(const char* value, const void* constraint) {
+    if (!value || !constraint) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_hostname_value(&info, constraint);
+}
+
+int check_hostport(const char* value, const void* constraint) {
+    if (!value || !constraint) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_hostport_value(&info, constraint);
+}
+
+// Format checks. uuid takes a mask of allowed versions (bit n for version n,
+// 0 for any); base64, base64url and hex an encoded byte count (0 for any)
+int check_uuid_value(ValueInfo* value, const void* versions) {
+    int version;
+    if (!parse_uuid(value->str, value_length(value), &version)) return ENVIL_VALUE_ERROR;
+    int mask = *(const int*)versions;
+    return (!mask || (mask & (1 << version))) ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+static int check_encoded_length(bool valid, size_t decoded_len, const void* length) {
+    size_t expected = *(const size_t*)length;
+    return valid && (!expected || decoded_len == expected) ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_base64_value(ValueInfo* value, const void* length) {
+    size_t decoded_len;
+    bool valid = parse_base64(value->str, value_length(value), false, &decoded_len);
+    return check_encoded_length(valid, decoded_len, length);
+}
+
+int check_base64url_value(ValueInfo* value, const void* length) {
+    size_t decoded_len;
+    bool valid = parse_base64(value->str, value_length(value), true, &decoded_len);
+    return check_encoded_length(valid, decoded_len, length);
+}
+
+int check_hex_value(ValueInfo* value, const void* length) {
+    size_t decoded_len;
+    bool valid = parse_hex(value->str, value_length(value), &decoded_len);
+    return check_encoded_length(valid, decoded_len, length);
+}
+
+int check_semver_value(ValueInfo* value, const void* range) {
+    Semver version;
+    if (!parse_semver(value->str, value_length(value), &version) || version.parts != 3) {
         return ENVIL_VALUE_ERROR;
     }
-    
-    ret = regexec(&regex, value, 0, NULL, 0);
-    regfree(&regex);
-    
-    return ret == 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+    return semver_in_range(range, &version) ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_uuid(const char* value, const void* versions) {
+    if (!value || !versions) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_uuid_value(&info, versions);
+}
+
+int check_base64(const char* value, const void* length) {
+    if (!value || !length) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_base64_value(&info, length);
+}
+
+int check_base64url(const char* value, const void* length) {
+    if (!value || !length) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_base64url_value(&info, length);
+}
+
+int check_hex(const char* value, const void* length) {
+    if (!value || !length) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_hex_value(&info, length);
+}
+
+int check_semver(const char* value, const void* range) {
+    if (!value || !range) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_semver_value(&info, range);
 }
 
-// Initialize built-in checks
-__attribute__((constructor))
-static void init_registry(void) {
-    // Register checks directly from the checks array
-    extern CheckDefinition checks[];
+// url splits the value once and runs its component checks on the pieces
+int check_url_value(ValueInfo* value, const void* url) {
+    int result;
+    find_url_failure(url, value->str, value_length(value), &result);
+    return result;
+}
+
+int check_url(const char* value, const void* url) {
+    if (!value || !url) return ENVIL_VALUE_ERROR;
+    ValueInfo info;
+    analyze_value(&info, value);
+    return check_url_value(&info, url);
+}
+
+// Filesystem checks read the value as a path. path_exists, file, dir, socket,
+// readable and writable take whether the property must hold; max_size a byte count.
+static int check_path_type(const char* path, const void* expected, mode_t type) {
+    if (!path || !expected) return ENVIL_VALUE_ERROR;
+    struct statx stx;
+    bool holds = stat_path(path, &stx) == 0 && (!type || (stx.stx_mode & S_IFMT) == type);
+    return holds == (*(const int*)expected != 0) ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_path_exists(const char* value, const void* expected) {
+    return check_path_type(value, expected, 0);
+}
+
+int check_file(const char* value, const void* expected) {
+    return check_path_type(value, expected, S_IFREG);
+}
+
+int check_dir(const char* value, const void* expected) {
+    return check_path_type(value, expected, S_IFDIR);
+}
+
+int check_socket(const char* value, const void* expected) {
+    return check_path_type(value, expected, S_IFSOCK);
+}
+
+// Access is checked against the effective IDs, which are what the process will open the path with
+static int check_access(const char* path, const void* expected, int mode) {
+    if (!path || !expected) return ENVIL_VALUE_ERROR;
+    bool holds = faccessat(AT_FDCWD, path, mode, AT_EACCESS) == 0;
+    return holds == (*(const int*)expected != 0) ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+int check_readable(const char* value, const void* expected) {
+    return check_access(value, expected, R_OK);
+}
+
+int check_writable(const char* value, const void* expected) {
+    return check_access(value, expected, W_OK);
+}
+
+int check_max_size(const char* value, const void* size) {
+    if (!value || !size) return ENVIL_VALUE_ERROR;
+    struct statx stx;
+    if (stat_path(value, &stx) != 0) return ENVIL_VALUE_ERROR;
+    return stx.stx_size <= *(const size_t*)size ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+// expr holds unless it is false or cannot be evaluated. An expression reading a
+// variable that already failed its own checks is skipped rather than reported twice.
+int check_expr(const char* value, const void* expr) {
+    if (!expr) return ENVIL_VALUE_ERROR;
+    ExprResult result = eval_expr(expr, value);
+    return result == EXPR_TRUE || result == EXPR_SKIPPED ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+bool is_builtin_check(const char* name) {
     size_t checks_count = get_check_options_count();
-    for (int i = 0; i < checks_count; i++) {
-        register_check(checks[i].name, checks[i].description, checks[i].callback, 
-                      checks[i].custom_data, checks[i].has_arg, checks[i].error_message);
+    for (size_t i = 0; i < checks_count; i++) {
+        if (strcmp(checks[i].name, name) == 0) return true;
     }
+    return false;
 }
 
-const CheckDefinition* register_check(const char* name, const char* description, CheckFunction check_fn, void* custom_data, int has_arg, const char* error_message) {
-    if (registry.count >= MAX_CHECKS) return NULL;
-    
-    CheckDefinition* def = &registry.definitions[registry.count++];
+void init_check_registry(CheckRegistry* target) {
+    target->count = 0;
+}
+
+const CheckDefinition* registry_add_check(CheckRegistry* target, const char* name, const char* description, CheckFunction check_fn, void* custom_data, int has_arg, const char* error_message) {
+    if (target->count >= MAX_CHECKS) return NULL;
+
+    CheckDefinition* def = &target->definitions[target->count++];
     def->name = name;
     def->description = description;
     def->callback = check_fn;
     def->custom_data = custom_data;
     def->has_arg = has_arg;
     def->error_message = error_message;
-    
+    def->value_callback = NULL;
+    def->cost = DEFAULT_CHECK_COST;
+
     return def;
 }
 
-const CheckDefinition* get_check_definition(const char* name) {
-    for (int i = 0; i < registry.count; i++) {
-        if (strcmp(registry.definitions[i].name, name) == 0) {
-            return &registry.definitions[i];
+const CheckDefinition* registry_find_check(const CheckRegistry* source, const char* name) {
+    // Built-ins first, straight from the static table
+    size_t checks_count = get_check_options_count();
+    for (size_t i = 0; i < checks_count; i++) {
+        if (strcmp(checks[i].name, name) == 0) return &checks[i];
+    }
+
+    for (int i = 0; i < source->count; i++) {
+        if (strcmp(source->definitions[i].name, name) == 0) {
+            return &source->definitions[i];
         }
     }
     return NULL;
 }
 
+const CheckDefinition* register_check(const char* name, const char* description, CheckFunction check_fn, void* custom_data, int has_arg, const char* error_message) {
+    return registry_add_check(&registry, name, description, check_fn, custom_data, has_arg, error_message);
+}
+
+const CheckDefinition* get_check_definition(const char* name) {
+    return registry_find_check(&registry, name);
+}
+
+CheckRegistry* get_default_registry(void) {
+    return &registry;
+}
+
 const CheckDefinition* get_check_definition_by_index(int index) {
-    if (index < 0 || index >= registry.count) return NULL;
-    return &registry.definitions[index];
+    int checks_count = (int)get_check_options_count();
+    if (index < 0 || index >= checks_count + registry.count) return NULL;
+    return index < checks_count ? &checks[index] : &registry.definitions[index - checks_count];
 }
 
 void list_available_checks(void) {
     printf("Available checks:\n\n");
-    for (int i = 0; i < registry.count; i++) {
-        printf("  %-10s %s\n", registry.definitions[i].name, registry.definitions[i].description);
+    const CheckDefinition* def;
+    for (int i = 0; (def = get_check_definition_by_index(i)) != NULL; i++) {
+        printf("  %-10s %s\n", def->name, def->description);
     }
 }
\ No newline at end of file
@@ -0,0 +1,531 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdbool.h>
+#include "cli.h"
+#include "argparse.h"
+#include "codegen.h"
+#include "types.h"
+#include "validator.h"
+#include "logger.h"
+#include "completion.h"
+#include "config.h"
+#include "dotenv.h"
+#include "watch.h"
+#include "plugin.h"
+#include "manifest.h"
+#include "profiles.h"
+#include "snapshot.h"
+#include "strict.h"
+#include "stats.h"
+
+extern char** environ;
+
+// Helper function to cleanup check resources
+static void cleanup_checks(Check* checks, int check_count) {
+    if (!checks) return;
+
+    for (int i = 0; i < check_count; i++) {
+        free_check_value(&checks[i]);
+    }
+    free(checks);
+}
+
+// The exported value a dotenv entry replaced, NULL if there was none
+typedef struct {
+    char* name;
+    char* previous;
+} SavedVariable;
+
+typedef struct {
+    SavedVariable* variables;
+    int count;
+    int capacity;
+} SavedEnv;
+
+// Records the current value of name, unless an earlier entry already did
+static bool save_variable(SavedEnv* saved, const char* name) {
+    for (int i = 0; i < saved->count; i++) {
+        if (strcmp(saved->variables[i].name, name) == 0) return true;
+    }
+    if (saved->count == saved->capacity) {
+        int capacity = saved->capacity ? saved->capacity * 2 : 16;
+        SavedVariable* grown = realloc(saved->variables, (size_t)capacity * sizeof(SavedVariable));
+        if (!grown) return false;
+        saved->variables = grown;
+        saved->capacity = capacity;
+    }
+
+    const char* previous = getenv(name);
+    SavedVariable* variable = &saved->variables[saved->count];
+    variable->name = strdup(name);
+    variable->previous = previous ? strdup(previous) : NULL;
+    if (!variable->name || (previous && !variable->previous)) {
+        free(variable->name);
+        free(variable->previous);
+        return false;
+    }
+    saved->count++;
+    return true;
+}
+
+// Puts back what the dotenv entries replaced. bash's getenv() sees exported
+// variables only, so one set in the shell but not exported is unset here too.
+static void restore_env(SavedEnv* saved) {
+    for (int i = 0; i < saved->count; i++) {
+        SavedVariable* variable = &saved->variables[i];
+        if (variable->previous) setenv(variable->name, variable->previous, 1);
+        else unsetenv(variable->name);
+        free(variable->name);
+        free(variable->previous);
+    }
+    free(saved->variables);
+}
+
+// Exports the entries of each dotenv file, later files overriding earlier ones.
+// With saved, records what they replace for restore_env().
+static int apply_env_files(char** env_files, int env_file_count, SavedEnv* saved) {
+    for (int i = 0; i < env_file_count; i++) {
+        EnvFile* file = load_env_file(env_files[i]);
+        if (!file) return 0;
+
+        for (int j = 0; j < file->count; j++) {
+            if (saved && !save_variable(saved, file->entries[j].name)) {
+                logger(LOG_ERROR, "Failed to allocate memory for env file values\n");
+                free_env_file(file);
+                return 0;
+            }
+            setenv(file->entries[j].name, file->entries[j].value, 1);
+        }
+        free_env_file(file);
+    }
+    return 1;
+}
+
+static int handle_env_option(const char* env_name, const char* default_value, bool print_value, int check_count, Check* checks) {
+    ValidationErrors* errors = create_validation_errors();
+    if (!errors) {
+        logger(LOG_ERROR, "Failed to create validation errors structure\n");
+        return 1;
+    }
+
+    char* env_value = getenv(env_name);
+    int result = validate_and_print_env(env_name, env_value, default_value, print_value, checks, check_count, errors);
+
+    if (result != ENVIL_OK && errors->count > 0) {
+        for (int i = 0; i < errors->count; i++) {
+            fprintf(stderr, "Error %s: %s\n", errors->errors[i].name, errors->errors[i].message);
+        }
+    }
+
+    free_validation_errors(errors);
+    return result;
+}
+
+// Validates a config against a snapshot and/or records one; either path may be NULL
+static int handle_snapshot_option(const char* config_path, const char* since_path, const char* snapshot_path,
+                                  bool print_value, const char* stats_path, const char* strict_prefix,
+                                  bool export_defaults) {
+    Config* config = load_config(config_path);
+    if (!config) {
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    CheckStats* stats = stats_path ? load_check_stats(stats_path) : NULL;
+    ValidationErrors* errors = create_validation_errors();
+    int strict_result = strict_prefix ? check_undeclared(config, strict_prefix, environ, errors) : ENVIL_OK;
+    int result = validate_snapshot(config, since_path, snapshot_path, print_value && strict_result == ENVIL_OK,
+                                   errors, stats);
+    if (result == ENVIL_OK) result = strict_result;
+    if (result == ENVIL_OK && export_defaults) export_config_defaults(config);
+    if (stats) {
+        save_check_stats(stats, stats_path);
+        free_check_stats(stats);
+    }
+
+    for (int i = 0; errors && i < errors->count; i++) {
+        fprintf(stderr, "Error %s: %s\n", errors->errors[i].name, errors->errors[i].message);
+    }
+    free_validation_errors(errors);
+    free_config(config);
+    return result;
+}
+
+// Replaces envil with the application once validation passed; returns only on failure
+static int exec_application(int result, char** app_argv) {
+    if (!app_argv || result != ENVIL_OK) return result;
+
+    fflush(stdout);
+    execvp(app_argv[0], app_argv);
+    // Exit like a shell that could not run the command
+    fprintf(stderr, "Error: Cannot run %s: %s\n", app_argv[0], strerror(errno));
+    return errno == ENOENT ? 127 : 126;
+}
+
+int run_cli(int argc, char **argv, bool in_shell) {
+    if (argc < 2) {
+        print_usage();
+        return 1;
+    }
+
+    // envil snapshot [options] FILE validates like -c, then records the verdicts in FILE
+    bool snapshot = strcmp(argv[1], "snapshot") == 0;
+    // envil codegen [-c] CONFIG -o FILE writes a standalone C validator for the config
+    bool codegen = strcmp(argv[1], "codegen") == 0;
+    if (snapshot || codegen) {
+        argc--;
+        argv++;
+    }
+    // A full getopt reset: in a shell, every run parses a new command line
+    optind = 0;
+
+    int option, option_index = 0;
+    bool has_config = false;
+    bool has_env = false;
+    char *env_name = NULL;
+    char *default_value = NULL;
+    char *config_path = NULL;
+    bool print_value = false;
+    bool watch = false;
+    bool use_cache = false;
+    bool assign = false;
+    const char *stats_path = NULL;
+    const char *manifests_path = NULL;
+    const char *profiles = NULL;
+    const char *since_path = NULL;
+    const char *strict_prefix = NULL;  // "" for the prefixes of the declared names
+    const char *output_path = NULL;
+    unsigned deadline_ms = 0;
+    int verbosity = 0;  // Count of -v flags
+    int env_file_count = 0;
+
+    // Pre-allocate checks array
+    Check *checks = malloc((argc / 2) * sizeof(Check)); // Maximum possible number of checks
+    if (!checks) {
+        logger(LOG_ERROR, "Failed to allocate memory for checks\n");
+        return 1;
+    }
+    int check_count = 0;
+    EnvType var_type = TYPE_STRING; // Default type
+
+    char **env_files = calloc(argc, sizeof(char*));
+    if (!env_files) {
+        logger(LOG_ERROR, "Failed to allocate memory for env files\n");
+        free(checks);
+        return 1;
+    }
+
+    // Single pass over the static option tables; the log level is applied once
+    // all -v flags are counted, nothing before that logs below LOG_ERROR
+    while ((option = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1) {
+        switch (option) {
+        case 'C': {
+            // Handle shell completion generation
+            ShellType shell = get_shell_type(optarg);
+            if (shell == SHELL_UNKNOWN) {
+                fprintf(stderr, "Error: Unsupported shell type '%s'. Supported types: bash, zsh\n", optarg);
+                free(checks);
+                free(env_files);
+                return 1;
+            }
+            int result = generate_completion_script(shell, stdout);
+            free(checks);
+            free(env_files);
+            return result == 0 ? 0 : 1;
+        }
+        case 'c':
+            has_config = true;
+            config_path = optarg;
+            break;
+        case 'e':
+            has_env = true;
+            env_name = optarg;
+            break;
+        case 'd':
+            default_value = optarg;
+            break;
+        case 'p':
+            print_value = true;
+            break;
+        case 'w':
+            watch = true;
+            break;
+        case 'f':
+            env_files[env_file_count++] = optarg;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case OPT_CACHE:
+            use_cache = true;
+            break;
+        case OPT_STATS:
+            stats_path = optarg;
+            break;
+        case OPT_DEADLINE:
+            if (!parse_timeout(optarg, &deadline_ms)) {
+                fprintf(stderr, "Error: Invalid deadline '%s' (e.g. 30s, 500ms, 2m)\n", optarg);
+                free(checks);
+                free(env_files);
+                return 1;
+            }
+            break;
+        case OPT_PLUGIN:
+            if (load_plugin(NULL, optarg) != ENVIL_OK) {
+                cleanup_checks(checks, check_count);
+                free(env_files);
+                return ENVIL_CONFIG_ERROR;
+            }
+            break;
+        case OPT_MANIFESTS:
+            manifests_path = optarg;
+            break;
+        case OPT_PROFILES:
+            profiles = optarg;
+            break;
+        case OPT_SINCE:
+            since_path = optarg;
+            break;
+        case OPT_ASSIGN:
+            assign = true;
+            break;
+        case OPT_STRICT:
+            strict_prefix = optarg ? optarg : "";
+            break;
+        case OPT_CHECK: {
+            // NAME=VALUE, or NAME alone for a check without an argument
+            char* equals = strchr(optarg, '=');
+            if (equals) *equals = '\0';
+            if (!process_check(optarg, equals ? equals + 1 : "", &checks[check_count], &var_type)) {
+                cleanup_checks(checks, check_count);
+                free(env_files);
+                return 1;
+            }
+            check_count++;
+            break;
+        }
+        case 'l':
+            list_checks();
+            free(checks);
+            free(env_files);
+            return 0;
+        case 'v':
+            verbosity++;
+            break;
+        case 'h':
+        case '?':
+            free(checks);
+            free(env_files);
+            print_usage();
+            return 1;
+        case 0: // Long option without a short equivalent
+            const char* check_name = long_options[option_index].name;
+            if (!process_check(check_name, optarg, &checks[check_count], &var_type)) {
+                cleanup_checks(checks, check_count);
+                free(env_files);
+                return 1;
+            }
+            check_count++;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Set log level based on verbosity count
+    switch (verbosity) {
+        case 0:
+            g_log_level = LOG_ERROR;  // Default - only errors
+            break;
+        case 1:
+            g_log_level = LOG_INFO;   // -v - standard info
+            break;
+        case 2:
+            g_log_level = LOG_DEBUG;  // -vv - debug info
+            break;
+        default:
+            g_log_level = LOG_ERROR;  // -vvv or more - trace level
+            break;
+    }
+
+    if (codegen && !has_config && optind < argc) {
+        has_config = true;
+        config_path = argv[optind++];
+    }
+    if (codegen != (output_path != NULL) || (codegen && (!has_config || has_env || optind < argc || watch ||
+                                                         manifests_path || profiles || since_path))) {
+        fprintf(stderr, "Error: envil codegen takes a config and -o FILE, and -o only applies to codegen\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+    if (codegen) {
+        Config* config = load_config(config_path);
+        int result = config ? generate_code(config, config_path, output_path) : ENVIL_CONFIG_ERROR;
+        free_config(config);
+        free(checks);
+        free(env_files);
+        return result;
+    }
+
+    // Validate arguments
+    if (!has_config && !has_env) {
+        fprintf(stderr, "Error: Must specify either -c CONFIG or -e ENV_NAME\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (has_config && has_env) {
+        fprintf(stderr, "Error: Cannot specify both -c and -e options\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (watch && !has_config) {
+        fprintf(stderr, "Error: --watch requires -c CONFIG\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (watch && deadline_ms) {
+        fprintf(stderr, "Error: --deadline cannot be combined with --watch\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (manifests_path && (!has_config || watch || use_cache || stats_path || print_value)) {
+        fprintf(stderr, "Error: --manifests requires -c CONFIG and cannot be combined with "
+                        "--watch, --cache, --stats or --print\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    // envil [options] -- APP ARGS... runs APP in place of envil once validation passed
+    char** app_argv = !snapshot && optind < argc && strcmp(argv[optind - 1], "--") == 0 ? &argv[optind] : NULL;
+    if (app_argv && (watch || manifests_path || profiles || print_value)) {
+        fprintf(stderr, "Error: -- APP cannot be combined with --watch, --manifests, --profiles or --print\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    // Neither can run inside a shell, which would block or be replaced
+    if (in_shell && (watch || app_argv)) {
+        fprintf(stderr, "Error: the envil builtin cannot %s\n", watch ? "--watch" : "run an application");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+    if (assign && (!in_shell || watch || manifests_path || profiles)) {
+        fprintf(stderr, "Error: --assign only works in the envil bash builtin, with -e or -c\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    const char* snapshot_path = snapshot && optind < argc ? argv[optind] : NULL;
+    if (snapshot && !snapshot_path) {
+        fprintf(stderr, "Error: envil snapshot requires the path of the snapshot to write\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+    if ((snapshot || since_path) && (!has_config || manifests_path || profiles || watch || use_cache)) {
+        fprintf(stderr, "Error: %s requires -c CONFIG and cannot be combined with "
+                        "--manifests, --profiles, --watch or --cache\n", snapshot ? "snapshot" : "--since");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (strict_prefix && (!has_config || manifests_path || profiles || watch)) {
+        fprintf(stderr, "Error: --strict requires -c CONFIG and cannot be combined with "
+                        "--manifests, --profiles or --watch\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (profiles && (!has_config || manifests_path || watch || use_cache || stats_path || print_value)) {
+        fprintf(stderr, "Error: --profiles requires -c CONFIG and cannot be combined with "
+                        "--manifests, --watch, --cache, --stats or --print\n");
+        free(checks);
+        free(env_files);
+        return 1;
+    }
+
+    if (watch) {
+        int result = watch_config(config_path, env_files, env_file_count, print_value);
+        free(checks);
+        free(env_files);
+        return result;
+    }
+
+    // Only cmd checks honor the deadline: a running one is killed when it passes
+    // and none starts after. Config parsing and the other checks are not bounded.
+    set_check_deadline(deadline_ms);
+
+    // Inside bash, setenv() binds shell variables: the dotenv values are taken
+    // back once validated, so only --assign changes the shell
+    SavedEnv saved = {0};
+    if (!apply_env_files(env_files, env_file_count, in_shell ? &saved : NULL)) {
+        restore_env(&saved);
+        free(checks);
+        free(env_files);
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    int result = 0;
+    // Handle single environment variable validation
+    if (has_env) {
+        // Verify that env_name is provided
+        if (!env_name) {
+            fprintf(stderr, "Error: No environment variable name provided with -e option\n");
+            result = 1;
+        } else {
+            result = handle_env_option(env_name, default_value, print_value, check_count, checks);
+            // The application or the shell sees the default, as a value set by hand
+            if (result == ENVIL_OK && (app_argv || assign) && default_value) setenv(env_name, default_value, 0);
+            result = exec_application(result, app_argv);
+        }
+        cleanup_checks(checks, check_count);
+        checks = NULL;
+    }
+    // Validate the env blocks of manifests instead of this environment
+    else if (manifests_path) {
+        Config* config = load_config(config_path);
+        result = config ? validate_manifests(config, manifests_path, deadline_ms, stdout) : ENVIL_CONFIG_ERROR;
+        free_config(config);
+    }
+    // Reuse the verdicts of a snapshot, or record them
+    else if (snapshot || since_path) {
+        result = handle_snapshot_option(config_path, since_path, snapshot_path, print_value, stats_path,
+                                        strict_prefix, app_argv || assign);
+        result = exec_application(result, app_argv);
+    }
+    // Validate each profile, with this environment under it
+    else if (profiles) {
+        Config* config = load_config(config_path);
+        result = config ? validate_profiles(config, profiles, deadline_ms, stdout) : ENVIL_CONFIG_ERROR;
+        free_config(config);
+    }
+    // Handle config file validation
+    else if (has_config) {
+        result = handle_config_option(config_path, print_value, use_cache, stats_path, strict_prefix,
+                                      app_argv || assign);
+        result = exec_application(result, app_argv);
+    }
+
+    restore_env(&saved);
+    free(checks);
+    free(env_files);
+    return result;
+}
\ No newline at end of file
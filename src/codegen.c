@@ -0,0 +1,862 @@
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codegen.h"
+#include "checks.h"
+#include "dfa.h"
+#include "logger.h"
+#include "validator.h"
+
+// Runtime pieces of the generated file, each written once if a check uses it
+#define NEED_NUMBER       (1u << 0)
+#define NEED_DURATION     (1u << 1)
+#define NEED_BYTES        (1u << 2)
+#define NEED_INT_DOUBLE   (1u << 3)  // compare_int_double
+#define NEED_ORDER_INT    (1u << 4)
+#define NEED_ORDER_DOUBLE (1u << 5)
+
+// Per variable, beyond the above
+#define USES_LENGTH (1u << 8)
+#define USES_ORDER  (1u << 9)
+
+#define MAX_FIELD 128
+
+static const char digit_helper[] =
+    "static bool is_digit(char c) {\n"
+    "    return c >= '0' && c <= '9';\n"
+    "}\n\n";
+
+static const char number_helpers[] =
+    "// A number as envil reads it: int64 when the text is an in-range integer,\n"
+    "// double otherwise\n"
+    "typedef struct {\n"
+    "    bool is_float;\n"
+    "    int64_t i;\n"
+    "    double d;\n"
+    "} Number;\n\n"
+    "// Optional '-' followed by digits only\n"
+    "static bool parse_integer(const char* s, size_t len, int64_t* out) {\n"
+    "    bool negative = len > 0 && s[0] == '-';\n"
+    "    size_t i = negative;\n"
+    "    if (i == len) return false;\n"
+    "\n"
+    "    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;\n"
+    "    uint64_t value = 0;\n"
+    "    for (; i < len; i++) {\n"
+    "        if (!is_digit(s[i])) return false;\n"
+    "        unsigned digit = (unsigned)(s[i] - '0');\n"
+    "        if (value > (limit - digit) / 10) return false;\n"
+    "        value = value * 10 + digit;\n"
+    "    }\n"
+    "    *out = negative ? (value == 0 ? 0 : -(int64_t)(value - 1) - 1) : (int64_t)value;\n"
+    "    return true;\n"
+    "}\n\n"
+    "// The decimal forms strtod() takes, without leading space or hex:\n"
+    "// [+-]digits[.digits][e[+-]digits] with digits on either side of the point,\n"
+    "// inf, infinity or nan. strtod() reads them as in the C locale unless the\n"
+    "// program changed LC_NUMERIC.\n"
+    "static bool parse_float(const char* s, size_t len, double* out) {\n"
+    "    size_t i = len > 0 && (s[0] == '-' || s[0] == '+');\n"
+    "    if (i == len) return false;\n"
+    "\n"
+    "    if (!is_digit(s[i]) && s[i] != '.') {\n"
+    "        char word[9] = {0};\n"
+    "        if (len - i >= sizeof(word)) return false;\n"
+    "        for (size_t k = 0; k < len - i; k++) word[k] = (char)(s[i + k] | 0x20);\n"
+    "        if (strcmp(word, \"inf\") != 0 && strcmp(word, \"infinity\") != 0 && strcmp(word, \"nan\") != 0) {\n"
+    "            return false;\n"
+    "        }\n"
+    "    } else {\n"
+    "        size_t digits = 0;\n"
+    "        for (; i < len && is_digit(s[i]); i++) digits++;\n"
+    "        if (i < len && s[i] == '.') {\n"
+    "            for (i++; i < len && is_digit(s[i]); i++) digits++;\n"
+    "        }\n"
+    "        if (digits == 0) return false;\n"
+    "        if (i < len && (s[i] == 'e' || s[i] == 'E')) {\n"
+    "            i++;\n"
+    "            if (i < len && (s[i] == '-' || s[i] == '+')) i++;\n"
+    "            if (i == len) return false;\n"
+    "            while (i < len && is_digit(s[i])) i++;\n"
+    "        }\n"
+    "        if (i != len) return false;\n"
+    "    }\n"
+    "    *out = strtod(s, NULL);\n"
+    "    return true;\n"
+    "}\n\n"
+    "static bool parse_number(const char* s, size_t len, Number* number) {\n"
+    "    number->is_float = !parse_integer(s, len, &number->i);\n"
+    "    return !number->is_float || parse_float(s, len, &number->d);\n"
+    "}\n\n";
+
+static const char int_double_helper[] =
+    "// Exact int64 vs double comparison, no rounding of the integer to double\n"
+    "static int compare_int_double(int64_t i, double d) {\n"
+    "    if (d >= 9223372036854775808.0) return -1;\n"
+    "    if (d < -9223372036854775808.0) return 1;\n"
+    "\n"
+    "    int64_t truncated = (int64_t)d;\n"
+    "    if (i != truncated) return i < truncated ? -1 : 1;\n"
+    "\n"
+    "    double fraction = d - (double)truncated;\n"
+    "    return fraction > 0 ? -1 : (fraction < 0 ? 1 : 0);\n"
+    "}\n\n";
+
+static const char order_int_helper[] =
+    "// Orders a number against a constant; false when unordered (NaN)\n"
+    "static bool order_int(const Number* number, int64_t constant, int* order) {\n"
+    "    if (!number->is_float) {\n"
+    "        *order = (number->i > constant) - (number->i < constant);\n"
+    "        return true;\n"
+    "    }\n"
+    "    if (isnan(number->d)) return false;\n"
+    "    *order = -compare_int_double(constant, number->d);\n"
+    "    return true;\n"
+    "}\n\n";
+
+static const char order_double_helper[] =
+    "// Orders a number against a constant; false when unordered (NaN)\n"
+    "static bool order_double(const Number* number, double constant, int* order) {\n"
+    "    if (!number->is_float) {\n"
+    "        *order = compare_int_double(number->i, constant);\n"
+    "        return true;\n"
+    "    }\n"
+    "    if (isnan(number->d)) return false;\n"
+    "    *order = (number->d > constant) - (number->d < constant);\n"
+    "    return true;\n"
+    "}\n\n";
+
+static const char decimal_helpers[] =
+    "typedef struct {\n"
+    "    const char* name;\n"
+    "    int64_t scale;\n"
+    "} Unit;\n\n"
+    "// Positions of the digits of \"12.5\", scaled exactly once the unit is known\n"
+    "typedef struct {\n"
+    "    size_t int_start, int_end;\n"
+    "    size_t frac_start, frac_end;\n"
+    "} Decimal;\n\n"
+    "// Reads digits[.digits] at *pos\n"
+    "static bool read_decimal(const char* s, size_t len, size_t* pos, Decimal* decimal) {\n"
+    "    size_t i = *pos;\n"
+    "    decimal->int_start = i;\n"
+    "    while (i < len && is_digit(s[i])) i++;\n"
+    "    decimal->int_end = i;\n"
+    "    decimal->frac_start = decimal->frac_end = i;\n"
+    "    if (i < len && s[i] == '.') {\n"
+    "        decimal->frac_start = ++i;\n"
+    "        while (i < len && is_digit(s[i])) i++;\n"
+    "        decimal->frac_end = i;\n"
+    "        if (decimal->frac_end == decimal->frac_start) return false;\n"
+    "    }\n"
+    "    if (decimal->int_end == decimal->int_start && decimal->frac_end == decimal->frac_start) return false;\n"
+    "    *pos = i;\n"
+    "    return true;\n"
+    "}\n\n"
+    "// value * scale, truncated below 1, or false on overflow\n"
+    "static bool scale_decimal(const char* s, const Decimal* decimal, int64_t scale, int64_t* value) {\n"
+    "    int64_t total = 0;\n"
+    "    for (size_t i = decimal->int_start; i < decimal->int_end; i++) {\n"
+    "        if (__builtin_mul_overflow(total, 10, &total) || __builtin_add_overflow(total, s[i] - '0', &total)) {\n"
+    "            return false;\n"
+    "        }\n"
+    "    }\n"
+    "    if (__builtin_mul_overflow(total, scale, &total)) return false;\n"
+    "\n"
+    "    int64_t fraction = 0, denominator = 1;\n"
+    "    for (size_t i = decimal->frac_start; i < decimal->frac_end && denominator <= 100000000000000000; i++) {\n"
+    "        fraction = fraction * 10 + (s[i] - '0');\n"
+    "        denominator *= 10;\n"
+    "    }\n"
+    "    __extension__ typedef __int128 Wide;\n"
+    "    int64_t fraction_part = (int64_t)((Wide)fraction * scale / denominator);\n"
+    "    if (__builtin_add_overflow(total, fraction_part, &total)) return false;\n"
+    "    *value = total;\n"
+    "    return true;\n"
+    "}\n\n";
+
+static const char duration_helpers[] =
+    "static const Unit duration_units[] = {\n"
+    "    {\"ns\", 1}, {\"us\", 1000}, {\"\\302\\265s\", 1000}, {\"ms\", 1000000}, {\"s\", 1000000000},\n"
+    "    {\"m\", 60 * (int64_t)1000000000}, {\"h\", 3600 * (int64_t)1000000000}, {\"d\", 86400 * (int64_t)1000000000},\n"
+    "};\n\n"
+    "// 30s, 1.5h, 1h30m or a bare 0, in nanoseconds\n"
+    "static bool parse_duration(const char* s, size_t len, int64_t* ns) {\n"
+    "    size_t i = 0;\n"
+    "    bool negative = false;\n"
+    "    if (i < len && (s[i] == '-' || s[i] == '+')) negative = s[i++] == '-';\n"
+    "    if (i == len) return false;\n"
+    "    if (len - i == 1 && s[i] == '0') {\n"
+    "        *ns = 0;\n"
+    "        return true;\n"
+    "    }\n"
+    "\n"
+    "    int64_t total = 0;\n"
+    "    while (i < len) {\n"
+    "        Decimal decimal;\n"
+    "        if (!read_decimal(s, len, &i, &decimal)) return false;\n"
+    "\n"
+    "        // The longest unit name\n"
+    "        const Unit* unit = NULL;\n"
+    "        size_t unit_len = 0;\n"
+    "        for (size_t u = 0; u < sizeof(duration_units) / sizeof(duration_units[0]); u++) {\n"
+    "            size_t name_len = strlen(duration_units[u].name);\n"
+    "            if (name_len >= unit_len && name_len <= len - i && strncmp(s + i, duration_units[u].name, name_len) == 0) {\n"
+    "                unit = &duration_units[u];\n"
+    "                unit_len = name_len;\n"
+    "            }\n"
+    "        }\n"
+    "        if (!unit) return false;\n"
+    "        i += unit_len;\n"
+    "\n"
+    "        int64_t part;\n"
+    "        if (!scale_decimal(s, &decimal, unit->scale, &part) || __builtin_add_overflow(total, part, &total)) {\n"
+    "            return false;\n"
+    "        }\n"
+    "    }\n"
+    "    *ns = negative ? -total : total;\n"
+    "    return true;\n"
+    "}\n\n";
+
+static const char bytes_helpers[] =
+    "#define KIB ((int64_t)1 << 10)\n\n"
+    "static const Unit size_units[] = {\n"
+    "    {\"\", 1}, {\"B\", 1},\n"
+    "    {\"k\", 1000}, {\"kB\", 1000}, {\"KB\", 1000},\n"
+    "    {\"MB\", 1000000}, {\"GB\", 1000000000},\n"
+    "    {\"TB\", 1000000000000}, {\"PB\", 1000000000000000}, {\"EB\", 1000000000000000000},\n"
+    "    {\"K\", KIB}, {\"Ki\", KIB}, {\"KiB\", KIB},\n"
+    "    {\"M\", KIB << 10}, {\"Mi\", KIB << 10}, {\"MiB\", KIB << 10},\n"
+    "    {\"G\", KIB << 20}, {\"Gi\", KIB << 20}, {\"GiB\", KIB << 20},\n"
+    "    {\"T\", KIB << 30}, {\"Ti\", KIB << 30}, {\"TiB\", KIB << 30},\n"
+    "    {\"P\", KIB << 40}, {\"Pi\", KIB << 40}, {\"PiB\", KIB << 40},\n"
+    "    {\"E\", KIB << 50}, {\"Ei\", KIB << 50}, {\"EiB\", KIB << 50},\n"
+    "};\n\n"
+    "// 512, 64K, 512Mi, 2GB or 1.5GiB, in bytes\n"
+    "static bool parse_byte_size(const char* s, size_t len, int64_t* bytes) {\n"
+    "    size_t i = 0;\n"
+    "    Decimal decimal;\n"
+    "    if (!read_decimal(s, len, &i, &decimal)) return false;\n"
+    "\n"
+    "    for (size_t u = 0; u < sizeof(size_units) / sizeof(size_units[0]); u++) {\n"
+    "        if (strlen(size_units[u].name) == len - i && strncmp(s + i, size_units[u].name, len - i) == 0) {\n"
+    "            return scale_decimal(s, &decimal, size_units[u].scale, bytes);\n"
+    "        }\n"
+    "    }\n"
+    "    return false;\n"
+    "}\n\n";
+
+// Names derived from the output file: env_gen gives env_gen_load and EnvGen
+typedef struct {
+    char prefix[MAX_FIELD];
+    char type[MAX_FIELD];
+    char guard[MAX_FIELD + 2];
+    char header[MAX_FIELD + 2];  // File name of the .h, as the .c includes it
+} Names;
+
+typedef struct {
+    const EnvVariable* var;
+    char field[MAX_FIELD];
+    EnvType field_type;
+    int order[64];  // Check indices, type checks first, then config order
+    int check_count;
+} Variable;
+
+static const char* const c_keywords[] = {
+    "auto", "bool", "break", "case", "char", "const", "continue", "default", "do", "double", "else",
+    "enum", "extern", "false", "float", "for", "goto", "if", "inline", "int", "long", "register",
+    "restrict", "return", "short", "signed", "sizeof", "static", "struct", "switch", "true",
+    "typedef", "union", "unsigned", "void", "volatile", "while",
+};
+
+// A C identifier from arbitrary text, lower-cased, kept clear of keywords
+static void make_identifier(const char* text, size_t len, char* out, size_t size) {
+    size_t n = 0;
+    if (len == 0 || isdigit((unsigned char)text[0])) out[n++] = '_';
+    for (size_t i = 0; i < len && n + 2 < size; i++) {
+        unsigned char c = (unsigned char)text[i];
+        out[n++] = isalnum(c) && c < 0x80 ? (char)tolower(c) : '_';
+    }
+    out[n] = '\0';
+    for (size_t k = 0; k < sizeof(c_keywords) / sizeof(c_keywords[0]); k++) {
+        if (strcmp(out, c_keywords[k]) == 0) {
+            strcat(out, "_");
+            break;
+        }
+    }
+}
+
+static void make_names(const char* stem, Names* names) {
+    const char* base = strrchr(stem, '/');
+    base = base ? base + 1 : stem;
+    make_identifier(base, strlen(base), names->prefix, sizeof(names->prefix));
+    snprintf(names->header, sizeof(names->header), "%s.h", base);
+
+    size_t n = 0, g = 0;
+    bool upper = true;
+    for (const char* p = names->prefix; *p && n + 1 < sizeof(names->type); p++) {
+        names->guard[g++] = (char)toupper((unsigned char)*p);
+        if (*p == '_') {
+            upper = true;
+        } else {
+            names->type[n++] = upper ? (char)toupper((unsigned char)*p) : *p;
+            upper = false;
+        }
+    }
+    names->type[n] = '\0';
+    if (n == 0 || isdigit((unsigned char)names->type[0])) snprintf(names->type, sizeof(names->type), "Env");
+    snprintf(names->guard + g, sizeof(names->guard) - g, "_H");
+}
+
+// A C string literal; no trigraphs, and octal escapes are always three digits
+static void write_string(FILE* out, const char* s, size_t len) {
+    fputc('"', out);
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            fprintf(out, "\\%c", c);
+        } else if (c == '?') {
+            fputs("\\?", out);
+        } else if (c < 0x20 || c >= 0x7f) {
+            fprintf(out, "\\%03o", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void write_int64(FILE* out, int64_t value) {
+    if (value == INT64_MIN) {
+        fputs("INT64_MIN", out);
+    } else {
+        fprintf(out, "INT64_C(%lld)", (long long)value);
+    }
+}
+
+static void write_double(FILE* out, double value) {
+    if (isinf(value)) {
+        fputs(value < 0 ? "-INFINITY" : "INFINITY", out);
+        return;
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    fprintf(out, "%s%s", buf, strpbrk(buf, ".e") ? "" : ".0");
+}
+
+static const char* check_name(const Variable* v, int j) {
+    return v->var->checks[j].definition->name;
+}
+
+static bool is_type(const Variable* v, int j) {
+    return strcmp(check_name(v, j), "type") == 0;
+}
+
+static bool is_comparison(const char* name) {
+    return strcmp(name, "gt") == 0 || strcmp(name, "lt") == 0 || strcmp(name, "ge") == 0 || strcmp(name, "le") == 0;
+}
+
+// Orders the checks as the validator reports them, rejecting what cannot be generated
+static bool plan_variable(const EnvVariable* var, Variable* v) {
+    static const char* const supported[] = {
+        "type", "gt", "lt", "ge", "le", "eq", "ne", "enum", "len", "lengt", "lenlt", "regex",
+    };
+    v->var = var;
+    v->field_type = TYPE_STRING;
+    v->check_count = 0;
+    if (var->check_count > (int)(sizeof(v->order) / sizeof(v->order[0]))) {
+        logger(LOG_ERROR, "Error: codegen supports at most %d checks per variable (%s)\n",
+               (int)(sizeof(v->order) / sizeof(v->order[0])), var->name);
+        return false;
+    }
+
+    for (int j = 0; j < var->check_count; j++) {
+        const char* name = var->checks[j].definition->name;
+        bool known = false;
+        for (size_t k = 0; k < sizeof(supported) / sizeof(supported[0]) && !known; k++) {
+            known = strcmp(name, supported[k]) == 0;
+        }
+        if (!known || !is_builtin_check(name)) {
+            logger(LOG_ERROR, "Error: codegen does not support the %s check (%s)\n", name, var->name);
+            return false;
+        }
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int j = 0; j < var->check_count; j++) {
+            if (is_type(v, j) != (pass == 0)) continue;
+            v->order[v->check_count++] = j;
+            if (pass != 0) continue;
+
+            EnvType type = (EnvType)var->checks[j].value.int_value;
+            if (type == TYPE_JSON || type == TYPE_BOOLEAN) {
+                logger(LOG_ERROR, "Error: codegen does not support the %s type (%s)\n", get_type_name(type), var->name);
+                return false;
+            }
+            // The first type that is not a string gives the field its type
+            if (v->field_type == TYPE_STRING) v->field_type = type;
+        }
+    }
+    return true;
+}
+
+// Facts established by the type checks, which run before the others
+typedef struct {
+    bool integer, number, duration, bytes;
+} Known;
+
+// Writes the condition under which a check passes, adding to *uses what it needs
+static bool write_condition(FILE* out, const Variable* v, int j, const Known* known, unsigned* uses) {
+    const Check* check = &v->var->checks[j];
+    const char* name = check->definition->name;
+
+    if (strcmp(name, "type") == 0) {
+        switch ((EnvType)check->value.int_value) {
+        case TYPE_INTEGER:
+            *uses |= NEED_NUMBER | USES_LENGTH;
+            fputs("is_number && !number.is_float", out);
+            return true;
+        case TYPE_FLOAT:
+            *uses |= NEED_NUMBER | USES_LENGTH;
+            fputs("is_number", out);
+            return true;
+        case TYPE_DURATION:
+            *uses |= NEED_DURATION | USES_LENGTH;
+            fputs("is_duration", out);
+            return true;
+        case TYPE_BYTESIZE:
+            *uses |= NEED_BYTES | USES_LENGTH;
+            fputs("is_bytes", out);
+            return true;
+        default:
+            return false;  // Strings always pass
+        }
+    }
+
+    if (is_comparison(name)) {
+        const Number* threshold = &check->value.number_value;
+        const char* op = strcmp(name, "gt") == 0 ? ">" : strcmp(name, "lt") == 0 ? "<" :
+                         strcmp(name, "ge") == 0 ? ">=" : "<=";
+        if (threshold->unit != UNIT_NONE) {
+            // Both sides are whole nanoseconds or bytes
+            bool duration = threshold->unit == UNIT_DURATION;
+            *uses |= duration ? NEED_DURATION : NEED_BYTES;
+            if (!(duration ? known->duration : known->bytes)) fputs(duration ? "is_duration && " : "is_bytes && ", out);
+            fprintf(out, "%s %s ", duration ? "duration" : "bytes", op);
+            write_int64(out, threshold->int_value);
+            return true;
+        }
+
+        if (threshold->is_float && isnan(threshold->float_value)) {
+            fputs("false", out);  // Nothing orders against NaN
+            return true;
+        }
+        *uses |= NEED_NUMBER;
+        if (known->integer && !threshold->is_float) {
+            fprintf(out, "number.i %s ", op);
+            write_int64(out, threshold->int_value);
+        } else if (known->integer) {
+            *uses |= NEED_INT_DOUBLE;
+            fputs("compare_int_double(number.i, ", out);
+            write_double(out, threshold->float_value);
+            fprintf(out, ") %s 0", op);
+        } else {
+            *uses |= USES_ORDER | NEED_INT_DOUBLE | (threshold->is_float ? NEED_ORDER_DOUBLE : NEED_ORDER_INT);
+            if (!known->number) fputs("is_number && ", out);
+            fprintf(out, "order_%s(&number, ", threshold->is_float ? "double" : "int");
+            if (threshold->is_float) {
+                write_double(out, threshold->float_value);
+            } else {
+                write_int64(out, threshold->int_value);
+            }
+            fprintf(out, ", &order) && order %s 0", op);
+        }
+        return true;
+    }
+
+    // lenlt 0 is the one check here that needs no length
+    if (strcmp(name, "lenlt") != 0 || check->value.size_value != 0) *uses |= USES_LENGTH;
+    if (strcmp(name, "eq") == 0 || strcmp(name, "ne") == 0) {
+        const char* target = check->value.str_value;
+        size_t len = strlen(target);
+        bool eq = strcmp(name, "eq") == 0;
+        fprintf(out, eq ? "len == %zu" : "len != %zu", len);
+        if (len > 0) {
+            fprintf(out, eq ? " && memcmp(value, " : " || memcmp(value, ");
+            write_string(out, target, len);
+            fprintf(out, ", %zu) %s 0", len, eq ? "==" : "!=");
+        }
+    } else if (strcmp(name, "len") == 0) {
+        fprintf(out, "len == %zu", check->value.size_value);
+    } else if (strcmp(name, "lengt") == 0) {
+        fprintf(out, "len > %zu", check->value.size_value);
+    } else if (strcmp(name, "lenlt") == 0) {
+        if (check->value.size_value == 0) {
+            fputs("false", out);
+        } else {
+            fprintf(out, "len < %zu", check->value.size_value);
+        }
+    } else if (strcmp(name, "enum") == 0) {
+        fprintf(out, "in_%s_%d(value, len)", v->field, j);
+    } else {
+        fprintf(out, "match_%s_%d(value, len)", v->field, j);
+    }
+    return true;
+}
+
+// enum as a switch on the length, then memcmp against the values that long
+static void write_enum_function(FILE* out, const Variable* v, int j) {
+    char** values = v->var->checks[j].value.enum_values;
+    fprintf(out, "static bool in_%s_%d(const char* s, size_t len) {\n", v->field, j);
+    fprintf(out, "    switch (len) {\n");
+    for (char** value = values; *value; value++) {
+        size_t len = strlen(*value);
+        bool seen = false;
+        for (char** earlier = values; earlier < value && !seen; earlier++) seen = strlen(*earlier) == len;
+        if (seen) continue;
+
+        fprintf(out, "    case %zu:\n        return ", len);
+        bool first = true;
+        for (char** same = value; *same; same++) {
+            if (strlen(*same) != len) continue;
+            if (!first) fputs(" ||\n               ", out);
+            if (len == 0) {
+                fputs("true", out);
+            } else {
+                fputs("memcmp(s, ", out);
+                write_string(out, *same, len);
+                fprintf(out, ", %zu) == 0", len);
+            }
+            first = false;
+        }
+        fputs(";\n", out);
+    }
+    fprintf(out, "    default:\n        return false;\n    }\n}\n\n");
+}
+
+static bool write_regex_function(FILE* out, const Variable* v, int j) {
+    const char* pattern = v->var->checks[j].value.regex_check->pattern;
+    char error[256];
+    Dfa* dfa = compile_dfa(pattern, error, sizeof(error));
+    if (!dfa) {
+        logger(LOG_ERROR, "Error: codegen cannot compile the regex of %s: %s\n", v->var->name, error);
+        return false;
+    }
+
+    fputs("// regex ", out);
+    write_string(out, pattern, strlen(pattern));
+    fputc('\n', out);
+    if (dfa->start < 0) {
+        // Decided before reading a byte
+        fprintf(out, "static bool match_%s_%d(const char* s, size_t len) {\n", v->field, j);
+        fprintf(out, "    (void)s;\n    (void)len;\n    return %s;\n}\n\n", dfa->start == DFA_MATCHED ? "true" : "false");
+        free_dfa(dfa);
+        return true;
+    }
+
+    fprintf(out, "static const unsigned char %s_%d_classes[256] = {", v->field, j);
+    for (int b = 0; b < 256; b++) {
+        fprintf(out, "%s%d,", b % 16 == 0 ? "\n    " : " ", dfa->class_of[b]);
+    }
+    fprintf(out, "\n};\n");
+    // -1 once the pattern matched, -2 once it cannot match any more
+    fprintf(out, "static const int16_t %s_%d_next[%d][%d] = {\n", v->field, j, dfa->state_count, dfa->class_count);
+    for (int state = 0; state < dfa->state_count; state++) {
+        fputs("    {", out);
+        for (int k = 0; k < dfa->class_count; k++) {
+            fprintf(out, "%s%d", k ? ", " : "", dfa->next[state * dfa->class_count + k]);
+        }
+        fputs("},\n", out);
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "static const bool %s_%d_accept_at_end[%d] = {", v->field, j, dfa->state_count);
+    for (int state = 0; state < dfa->state_count; state++) {
+        fprintf(out, "%s%s", state ? ", " : "", dfa->accept_at_end[state] ? "true" : "false");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static bool match_%s_%d(const char* s, size_t len) {\n", v->field, j);
+    fprintf(out, "    int state = 0;\n");
+    fprintf(out, "    for (size_t i = 0; i < len; i++) {\n");
+    fprintf(out, "        state = %s_%d_next[state][%s_%d_classes[(unsigned char)s[i]]];\n", v->field, j, v->field, j);
+    fprintf(out, "        if (state < 0) return state == -1;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    return %s_%d_accept_at_end[state];\n}\n\n", v->field, j);
+    free_dfa(dfa);
+    return true;
+}
+
+// The function reading one variable into its field; adds to *needs what it uses
+static bool write_variable(FILE* out, const Names* names, const Variable* v, unsigned* needs) {
+    const EnvVariable* var = v->var;
+    for (int j = 0; j < var->check_count; j++) {
+        if (strcmp(check_name(v, j), "enum") == 0) write_enum_function(out, v, j);
+        if (strcmp(check_name(v, j), "regex") == 0 && !write_regex_function(out, v, j)) return false;
+    }
+
+    // The checks in order, as "if (!(condition)) return fail(...);" lines
+    char* body = NULL;
+    size_t body_size = 0;
+    FILE* checks = open_memstream(&body, &body_size);
+    if (!checks) return false;
+
+    Known known = {false, false, false, false};
+    unsigned uses = 0;
+    for (int k = 0; k < v->check_count; k++) {
+        int j = v->order[k];
+        char* condition = NULL;
+        size_t condition_size = 0;
+        FILE* cond = open_memstream(&condition, &condition_size);
+        if (!cond) {
+            fclose(checks);
+            free(body);
+            return false;
+        }
+        bool emitted = write_condition(cond, v, j, &known, &uses);
+        fclose(cond);
+
+        if (emitted) {
+            const Check* check = &var->checks[j];
+            char message[512];
+            int code = ENVIL_VALUE_ERROR;
+            if (is_type(v, j)) {
+                snprintf(message, sizeof(message), "invalid type - expected %s", get_type_name(check->value.int_value));
+                code = ENVIL_TYPE_ERROR;
+            } else {
+                describe_check_failure(check, message, sizeof(message));
+            }
+            bool compound = strpbrk(condition, "&|<>=") != NULL;
+            fprintf(checks, compound ? "    if (!(%s)) return fail(reporter, " : "    if (!%s) return fail(reporter, ",
+                    condition);
+            write_string(checks, var->name, strlen(var->name));
+            fputs(", ", checks);
+            write_string(checks, message, strlen(message));
+            fprintf(checks, ", %d);\n", code);
+        }
+        free(condition);
+
+        if (is_type(v, j)) {
+            EnvType type = (EnvType)var->checks[j].value.int_value;
+            known.integer |= type == TYPE_INTEGER;
+            known.number |= type == TYPE_INTEGER || type == TYPE_FLOAT;
+            known.duration |= type == TYPE_DURATION;
+            known.bytes |= type == TYPE_BYTESIZE;
+        }
+    }
+    fclose(checks);
+
+    fprintf(out, "// %s\n", var->name);
+    fprintf(out, "static int load_%s(%s* env, const char* value, const Reporter* reporter) {\n", v->field, names->type);
+    if (var->default_value) {
+        fputs("    if (!value) value = ", out);
+        write_string(out, var->default_value, strlen(var->default_value));
+        fputs(";\n", out);
+    } else {
+        fputs("    if (!value) return fail(reporter, ", out);
+        write_string(out, var->name, strlen(var->name));
+        fprintf(out, ", \"variable is required but not set\", %d);\n", ENVIL_MISSING_VAR);
+    }
+    if (uses & (USES_LENGTH | NEED_NUMBER | NEED_DURATION | NEED_BYTES)) fputs("    size_t len = strlen(value);\n", out);
+    if (uses & NEED_NUMBER) fputs("    Number number;\n    bool is_number = parse_number(value, len, &number);\n", out);
+    if (uses & NEED_DURATION) fputs("    int64_t duration;\n    bool is_duration = parse_duration(value, len, &duration);\n", out);
+    if (uses & NEED_BYTES) fputs("    int64_t bytes;\n    bool is_bytes = parse_byte_size(value, len, &bytes);\n", out);
+    if (uses & USES_ORDER) fputs("    int order;\n", out);
+    fputs(body, out);
+    free(body);
+
+    switch (v->field_type) {
+    case TYPE_INTEGER:
+        fprintf(out, "    env->%s = number.i;\n", v->field);
+        break;
+    case TYPE_FLOAT:
+        fprintf(out, "    env->%s = number.is_float ? number.d : (double)number.i;\n", v->field);
+        break;
+    case TYPE_DURATION:
+        fprintf(out, "    env->%s = duration;\n", v->field);
+        break;
+    case TYPE_BYTESIZE:
+        fprintf(out, "    env->%s = bytes;\n", v->field);
+        break;
+    default:
+        fprintf(out, "    env->%s = value;\n", v->field);
+        break;
+    }
+    fputs("    return 0;\n}\n\n", out);
+    *needs |= uses;
+    return true;
+}
+
+static void write_header(FILE* out, const Names* names, const char* config_path, const Variable* vars, int count) {
+    fprintf(out, "// Generated by envil codegen from %s; do not edit.\n", config_path);
+    fprintf(out, "#ifndef %s\n#define %s\n\n", names->guard, names->guard);
+    fprintf(out, "#include <stdint.h>\n\n");
+    fprintf(out, "typedef struct {\n");
+    for (int i = 0; i < count; i++) {
+        switch (vars[i].field_type) {
+        case TYPE_INTEGER:
+            fprintf(out, "    int64_t %s;\n", vars[i].field);
+            break;
+        case TYPE_FLOAT:
+            fprintf(out, "    double %s;\n", vars[i].field);
+            break;
+        case TYPE_DURATION:
+            fprintf(out, "    int64_t %s;  // Nanoseconds\n", vars[i].field);
+            break;
+        case TYPE_BYTESIZE:
+            fprintf(out, "    int64_t %s;  // Bytes\n", vars[i].field);
+            break;
+        default:
+            fprintf(out, "    const char* %s;\n", vars[i].field);
+            break;
+        }
+    }
+    fprintf(out, "} %s;\n\n", names->type);
+    fprintf(out, "// Returns the value of a variable, or NULL when it is not set\n");
+    fprintf(out, "typedef const char* (*%sLookupFunction)(const char* name, void* data);\n", names->type);
+    fprintf(out, "// Receives each failure with the message and exit code envil would report\n");
+    fprintf(out, "typedef void (*%sErrorFunction)(const char* name, const char* message, int code, void* data);\n\n",
+            names->type);
+    fprintf(out, "/**\n");
+    fprintf(out, " * @brief Validates the variables of %s and reads them into env\n", config_path);
+    fprintf(out, " *\n");
+    fprintf(out, " * Strings point at what lookup returned or at a default. The fields of the\n");
+    fprintf(out, " * variables that fail are left zero.\n");
+    fprintf(out, " *\n");
+    fprintf(out, " * @param lookup NULL to read the process environment\n");
+    fprintf(out, " * @param on_error May be NULL\n");
+    fprintf(out, " * @return 0, or the exit code envil would give: 2 for a missing variable, 3\n");
+    fprintf(out, " *         for a wrong type, 4 for another failed check, of the last failure\n");
+    fprintf(out, " */\n");
+    fprintf(out, "int %s_load(%s* env, %sLookupFunction lookup, void* lookup_data,\n", names->prefix, names->type, names->type);
+    fprintf(out, "%*s%sErrorFunction on_error, void* error_data);\n\n", (int)strlen(names->prefix) + 10, "", names->type);
+    fprintf(out, "#endif // %s\n", names->guard);
+}
+
+static void write_source(FILE* out, const Names* names, const char* config_path, const Variable* vars, int count,
+                         unsigned needs, const char* functions) {
+    fprintf(out, "// Generated by envil codegen from %s; do not edit.\n", config_path);
+    fprintf(out, "#include <math.h>\n#include <stdbool.h>\n#include <stdint.h>\n#include <stdlib.h>\n#include <string.h>\n");
+    fprintf(out, "#include \"%s\"\n\n", names->header);
+
+    fprintf(out, "typedef struct {\n    %sErrorFunction on_error;\n    void* data;\n} Reporter;\n\n", names->type);
+    fprintf(out, "static int fail(const Reporter* reporter, const char* name, const char* message, int code) {\n");
+    fprintf(out, "    if (reporter->on_error) reporter->on_error(name, message, code, reporter->data);\n");
+    fprintf(out, "    return code;\n}\n\n");
+
+    if (needs & (NEED_NUMBER | NEED_DURATION | NEED_BYTES)) fputs(digit_helper, out);
+    if (needs & NEED_NUMBER) fputs(number_helpers, out);
+    if (needs & NEED_INT_DOUBLE) fputs(int_double_helper, out);
+    if (needs & NEED_ORDER_INT) fputs(order_int_helper, out);
+    if (needs & NEED_ORDER_DOUBLE) fputs(order_double_helper, out);
+    if (needs & (NEED_DURATION | NEED_BYTES)) fputs(decimal_helpers, out);
+    if (needs & NEED_DURATION) fputs(duration_helpers, out);
+    if (needs & NEED_BYTES) fputs(bytes_helpers, out);
+    fputs(functions, out);
+
+    fprintf(out, "static const char* lookup_environment(const char* name, void* data) {\n");
+    fprintf(out, "    (void)data;\n    return getenv(name);\n}\n\n");
+    fprintf(out, "int %s_load(%s* env, %sLookupFunction lookup, void* lookup_data,\n", names->prefix, names->type, names->type);
+    fprintf(out, "%*s%sErrorFunction on_error, void* error_data) {\n", (int)strlen(names->prefix) + 10, "", names->type);
+    fprintf(out, "    Reporter reporter = {on_error, error_data};\n");
+    fprintf(out, "    int result = 0, code;\n");
+    fprintf(out, "    if (!lookup) lookup = lookup_environment;\n");
+    fprintf(out, "    memset(env, 0, sizeof(*env));\n\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "    if ((code = load_%s(env, lookup(", vars[i].field);
+        write_string(out, vars[i].var->name, strlen(vars[i].var->name));
+        fprintf(out, ", lookup_data), &reporter)) != 0) result = code;\n");
+    }
+    fprintf(out, "    return result;\n}\n");
+}
+
+static bool write_file(const char* path, const char* content, size_t size) {
+    FILE* file = fopen(path, "w");
+    bool ok = file && fwrite(content, 1, size, file) == size;
+    if (file && fclose(file) != 0) ok = false;
+    if (!ok) logger(LOG_ERROR, "Error: Cannot write %s: %s\n", path, strerror(errno));
+    return ok;
+}
+
+int generate_code(const Config* config, const char* config_path, const char* output_path) {
+    if (config->pattern_count > 0) {
+        logger(LOG_ERROR, "Error: codegen does not support pattern keys (%s)\n", config->patterns[0].name);
+        return ENVIL_CONFIG_ERROR;
+    }
+    if (config->variable_count == 0) {
+        logger(LOG_ERROR, "Error: %s declares no variables to generate code for\n", config_path);
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    // The paths of both files, from either of them or the path without extension
+    size_t stem_len = strlen(output_path);
+    if (stem_len > 2 && output_path[stem_len - 2] == '.' &&
+        (output_path[stem_len - 1] == 'c' || output_path[stem_len - 1] == 'h')) {
+        stem_len -= 2;
+    }
+    char* stem = strndup(output_path, stem_len);
+    char* c_path = malloc(stem_len + 3);
+    char* h_path = malloc(stem_len + 3);
+    Variable* vars = calloc((size_t)config->variable_count, sizeof(Variable));
+    char *functions = NULL, *source = NULL, *header = NULL;
+    size_t functions_size = 0, source_size = 0, header_size = 0;
+    int result = ENVIL_CONFIG_ERROR;
+    if (!stem || !c_path || !h_path || !vars) {
+        logger(LOG_ERROR, "Failed to allocate memory for codegen\n");
+        goto cleanup;
+    }
+    snprintf(c_path, stem_len + 3, "%s.c", stem);
+    snprintf(h_path, stem_len + 3, "%s.h", stem);
+
+    Names names;
+    make_names(stem, &names);
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        if (!plan_variable(var, &vars[i])) goto cleanup;
+        make_identifier(var->name, strlen(var->name), vars[i].field, sizeof(vars[i].field));
+        for (int k = 0; k < i; k++) {
+            if (strcmp(vars[k].field, vars[i].field) == 0) {
+                logger(LOG_ERROR, "Error: %s and %s would both be the field %s\n",
+                       vars[k].var->name, var->name, vars[i].field);
+                goto cleanup;
+            }
+        }
+    }
+
+    // Everything is written to memory first, so nothing is left half done on an error
+    unsigned needs = 0;
+    FILE* out = open_memstream(&functions, &functions_size);
+    if (!out) goto cleanup;
+    bool ok = true;
+    for (int i = 0; i < config->variable_count && ok; i++) {
+        ok = write_variable(out, &names, &vars[i], &needs);
+    }
+    fclose(out);
+    if (!ok) goto cleanup;
+
+    out = open_memstream(&source, &source_size);
+    if (!out) goto cleanup;
+    write_source(out, &names, config_path, vars, config->variable_count, needs, functions);
+    fclose(out);
+
+    out = open_memstream(&header, &header_size);
+    if (!out) goto cleanup;
+    write_header(out, &names, config_path, vars, config->variable_count);
+    fclose(out);
+
+    if (write_file(h_path, header, header_size) && write_file(c_path, source, source_size)) {
+        logger(LOG_INFO, "Wrote %s and %s", h_path, c_path);
+        result = ENVIL_OK;
+    }
+
+cleanup:
+    free(stem);
+    free(c_path);
+    free(h_path);
+    free(vars);
+    free(functions);
+    free(source);
+    free(header);
+    return result;
+}
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include "completion.h"
 #include "config.h"
 #include "checks.h"
@@ -13,6 +14,11 @@ ShellType get_shell_type(const char* shell_name) {
     return SHELL_UNKNOWN;
 }
 
+// Long-only options use values outside the char range
+static bool has_short_option(const struct option* opt) {
+    return opt->val > 0 && opt->val < 128 && isalpha(opt->val);
+}
+
 static void write_bash_completion(FILE* out) {
     fprintf(out, "_envil() {\n");
     fprintf(out, "    local cur prev words cword split\n");
@@ -28,8 +34,16 @@ static void write_bash_completion(FILE* out) {
     fprintf(out, "            COMPREPLY=($(compgen -e -- \"${cur}\"))\n");
     fprintf(out, "            return\n");
     fprintf(out, "            ;;\n");
+    fprintf(out, "        --plugin)\n");
+    fprintf(out, "            _filedir so\n");
+    fprintf(out, "            return\n");
+    fprintf(out, "            ;;\n");
+    fprintf(out, "        --manifests|--profiles|--since)\n");
+    fprintf(out, "            _filedir\n");
+    fprintf(out, "            return\n");
+    fprintf(out, "            ;;\n");
     fprintf(out, "        --type)\n");
-    fprintf(out, "            COMPREPLY=($(compgen -W \"string integer float json\" -- \"${cur}\"))\n");
+    fprintf(out, "            COMPREPLY=($(compgen -W \"string integer float json duration bytesize\" -- \"${cur}\"))\n");
     fprintf(out, "            return\n");
     fprintf(out, "            ;;\n");
     fprintf(out, "    esac\n\n");
@@ -42,7 +56,7 @@ static void write_bash_completion(FILE* out) {
     for (size_t i = 0; i < get_base_options_count(); i++) {
         if (base_options[i].name) {
             fprintf(out, "--%s ", base_options[i].name);
-            if (base_options[i].val) {
+            if (has_short_option(&base_options[i])) {
                 fprintf(out, "-%c ", (char)base_options[i].val);
             }
         }
@@ -71,22 +85,27 @@ static void write_zsh_completion(FILE* out) {
     // Define base options
     fprintf(out, "    options=(\n");
     for (size_t i = 0; i < get_base_options_count(); i++) {
-        if (base_options[i].name) {
-            if (base_options[i].has_arg == required_argument) {
-                fprintf(out, "        '(--%s -%c)'{--%s,-%c}'[%s]:value:_files'\n",
-                    base_options[i].name,
-                    (char)base_options[i].val,
-                    base_options[i].name,
-                    (char)base_options[i].val,
-                    base_options[i].name);
-            } else {
-                fprintf(out, "        '(--%s -%c)'{--%s,-%c}'[%s]'\n",
-                    base_options[i].name,
-                    (char)base_options[i].val,
-                    base_options[i].name,
-                    (char)base_options[i].val,
-                    base_options[i].name);
-            }
+        if (!base_options[i].name) continue;
+
+        const char* arg_spec = base_options[i].has_arg == required_argument ? ":value:_files" : "";
+        if (has_short_option(&base_options[i])) {
+            fprintf(out, "        '(--%s -%c)'{--%s,-%c}'[%s]%s'\n",
+                base_options[i].name,
+                (char)base_options[i].val,
+                base_options[i].name,
+                (char)base_options[i].val,
+                base_options[i].name,
+                arg_spec);
+        } else if (base_options[i].has_arg == optional_argument) {
+            // The argument, when given, is joined with =
+            fprintf(out, "        '--%s=-[%s]::value:'\n",
+                base_options[i].name,
+                base_options[i].name);
+        } else {
+            fprintf(out, "        '--%s[%s]%s'\n",
+                base_options[i].name,
+                base_options[i].name,
+                arg_spec);
         }
     }
     fprintf(out, "    )\n\n");
@@ -105,7 +124,7 @@ static void write_zsh_completion(FILE* out) {
     // Special case completions
     fprintf(out, "    case $words[CURRENT-1] in\n");
     fprintf(out, "        --type)\n");
-    fprintf(out, "            _values 'types' string integer float json\n");
+    fprintf(out, "            _values 'types' string integer float json duration bytesize\n");
     fprintf(out, "            return\n");
     fprintf(out, "            ;;\n");
     fprintf(out, "        -c|--config)\n");
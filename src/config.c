@@ -1,81 +1,190 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <yaml.h>
-#include <json-c/json.h>
+#include <errno.h>
+#include <limits.h>
 #include "config.h"
 #include "logger.h"
 #include "validator.h"
+#include "hash.h"
+#include "cache.h"
+#include "parsers.h"
+#include "netaddr.h"
+#include "formats.h"
+#include "fscheck.h"
+#include "url.h"
+#include "units.h"
+#include "expr.h"
+#include "plugin.h"
+#include "pattern.h"
+#include "strict.h"
 
-struct option check_options[] = {
-    {"type", required_argument, 0, 0},
-    {"gt", required_argument, 0, 0},
-    {"lt", required_argument, 0, 0},
-    {"enum", required_argument, 0, 0},
-    {"len", required_argument, 0, 0},
-    {"cmd", required_argument, 0, 0},
-    {"eq", required_argument, 0, 0},
-    {"ne", required_argument, 0, 0},
-    {"ge", required_argument, 0, 0},
-    {"le", required_argument, 0, 0},
-    {"lengt", required_argument, 0, 0},
-    {"lenlt", required_argument, 0, 0},
-    {"regex", required_argument, 0, 0},
-};
+extern char** environ;
 
-CheckDefinition checks[] = {
-    {"type", "Check the type of the variable (integer,string,json,float,boolean)", check_type, NULL, 1, "Invalid type"},
-    {"gt", "Check if greater than a value", check_gt, NULL, 1, "Invalid length"},
-    {"lt", "Check if less than a value", check_lt, NULL, 1, "Invalid length"},
-    {"enum", "Check if in a set of values (foo,bar,baz)", check_enum, NULL, 1, "Invalid enum value"},
-    {"len", "Check the length of the variable", check_len, NULL, 1, "Invalid length"},
-    {"cmd", "Run a command to validate the variable", check_cmd, NULL, 1, "Invalid command"},
-    {"eq", "Check if equal to a value", check_eq, NULL, 1, "Invalid target"},
-    {"ne", "Check if not equal to a value", check_ne, NULL, 1, "Invalid target"},
-    {"ge", "Check if greater than or equal to a value", check_ge, NULL, 1, "Invalid length"},
-    {"le", "Check if less than or equal to a value", check_le, NULL, 1, "Invalid length"},
-    {"lengt", "Check if string length is greater than specified length", check_lengt, NULL, 1, "Invalid length"},
-    {"lenlt", "Check if string length is less than specified length", check_lenlt, NULL, 1, "Invalid length"},
-    {"regex", "Check if value matches regular expression pattern", check_regex, NULL, 1, "Invalid pattern"},
-};
+// Option tables, kept as lists so the combined getopt_long table below is
+// built at compile time too
+#define CHECK_OPTIONS \
+    {"type", required_argument, 0, 0}, \
+    {"gt", required_argument, 0, 0}, \
+    {"lt", required_argument, 0, 0}, \
+    {"enum", required_argument, 0, 0}, \
+    {"len", required_argument, 0, 0}, \
+    {"cmd", required_argument, 0, 0}, \
+    {"eq", required_argument, 0, 0}, \
+    {"ne", required_argument, 0, 0}, \
+    {"ge", required_argument, 0, 0}, \
+    {"le", required_argument, 0, 0}, \
+    {"lengt", required_argument, 0, 0}, \
+    {"lenlt", required_argument, 0, 0}, \
+    {"regex", required_argument, 0, 0}, \
+    {"ip", required_argument, 0, 0}, \
+    {"ipv4", required_argument, 0, 0}, \
+    {"ipv6", required_argument, 0, 0}, \
+    {"cidr", required_argument, 0, 0}, \
+    {"hostname", required_argument, 0, 0}, \
+    {"hostport", required_argument, 0, 0}, \
+    {"uuid", required_argument, 0, 0}, \
+    {"base64", required_argument, 0, 0}, \
+    {"base64url", required_argument, 0, 0}, \
+    {"hex", required_argument, 0, 0}, \
+    {"semver", required_argument, 0, 0}, \
+    {"url", required_argument, 0, 0}, \
+    {"path_exists", required_argument, 0, 0}, \
+    {"file", required_argument, 0, 0}, \
+    {"dir", required_argument, 0, 0}, \
+    {"socket", required_argument, 0, 0}, \
+    {"readable", required_argument, 0, 0}, \
+    {"writable", required_argument, 0, 0}, \
+    {"max_size", required_argument, 0, 0}, \
+    {"expr", required_argument, 0, 0},
 
-struct option base_options[] = {
-    {"config", required_argument, 0, 'c'},
-    {"env", required_argument, 0, 'e'},
-    {"default", required_argument, 0, 'd'},
-    {"print", no_argument, 0, 'p'},
-    {"list-checks", no_argument, 0, 'l'},
-    {"verbose", no_argument, 0, 'v'},
-    {"completion", required_argument, 0, 'C'},
+#define BASE_OPTIONS \
+    {"config", required_argument, 0, 'c'}, \
+    {"env", required_argument, 0, 'e'}, \
+    {"default", required_argument, 0, 'd'}, \
+    {"print", no_argument, 0, 'p'}, \
+    {"list-checks", no_argument, 0, 'l'}, \
+    {"verbose", no_argument, 0, 'v'}, \
+    {"completion", required_argument, 0, 'C'}, \
+    {"watch", no_argument, 0, 'w'}, \
+    {"env-file", required_argument, 0, 'f'}, \
+    {"cache", no_argument, 0, OPT_CACHE}, \
+    {"stats", required_argument, 0, OPT_STATS}, \
+    {"deadline", required_argument, 0, OPT_DEADLINE}, \
+    {"plugin", required_argument, 0, OPT_PLUGIN}, \
+    {"check", required_argument, 0, OPT_CHECK}, \
+    {"manifests", required_argument, 0, OPT_MANIFESTS}, \
+    {"profiles", required_argument, 0, OPT_PROFILES}, \
+    {"since", required_argument, 0, OPT_SINCE}, \
+    {"strict", optional_argument, 0, OPT_STRICT}, \
+    {"assign", no_argument, 0, OPT_ASSIGN}, \
+    {"output", required_argument, 0, 'o'}, \
     {"help", no_argument, 0, 'h'},
+
+const struct option check_options[] = { CHECK_OPTIONS };
+
+// The last column is a rough cost in nanoseconds per call; the validator runs
+// cheap checks first and refines these figures from --stats
+const CheckDefinition checks[] = {
+    {"type", "Check the type of the variable (integer,string,json,float,duration,bytesize)", check_type, NULL, 1, "Invalid type", check_type_value, 50},
+    {"gt", "Check if greater than a value", check_gt, NULL, 1, "Invalid length", check_gt_value, 50},
+    {"lt", "Check if less than a value", check_lt, NULL, 1, "Invalid length", check_lt_value, 50},
+    {"enum", "Check if in a set of values (foo,bar,baz)", check_enum, NULL, 1, "Invalid enum value", NULL, 60},
+    {"len", "Check the length of the variable", check_len, NULL, 1, "Invalid length", check_len_value, 20},
+    {"cmd", "Run a command to validate the variable", check_cmd, NULL, 1, "Invalid command", NULL, 2000000},
+    {"eq", "Check if equal to a value", check_eq, NULL, 1, "Invalid target", NULL, 30},
+    {"ne", "Check if not equal to a value", check_ne, NULL, 1, "Invalid target", NULL, 30},
+    {"ge", "Check if greater than or equal to a value", check_ge, NULL, 1, "Invalid length", check_ge_value, 50},
+    {"le", "Check if less than or equal to a value", check_le, NULL, 1, "Invalid length", check_le_value, 50},
+    {"lengt", "Check if string length is greater than specified length", check_lengt, NULL, 1, "Invalid length", check_lengt_value, 20},
+    {"lenlt", "Check if string length is less than specified length", check_lenlt, NULL, 1, "Invalid length", check_lenlt_value, 20},
+    {"regex", "Check if value matches regular expression pattern", check_regex, NULL, 1, "Invalid pattern", NULL, 5000},
+    {"ip", "Check for an IPv4 or IPv6 address (any,private,public,loopback,link-local)", check_ip, NULL, 1, "Invalid address", check_ip_value, 40},
+    {"ipv4", "Check for an IPv4 address (any,private,public,loopback,link-local)", check_ipv4, NULL, 1, "Invalid address", check_ipv4_value, 30},
+    {"ipv6", "Check for an IPv6 address (any,private,public,loopback,link-local)", check_ipv6, NULL, 1, "Invalid address", check_ipv6_value, 60},
+    {"cidr", "Check for a network in CIDR notation (any,private,public,...)", check_cidr, NULL, 1, "Invalid network", check_cidr_value, 60},
+    {"hostname", "Check for a DNS hostname (any,fqdn)", check_hostname, NULL, 1, "Invalid hostname", check_hostname_value, 40},
+    {"hostport", "Check for host:port (classes, fqdn, port range like 1024-65535)", check_hostport, NULL, 1, "Invalid host and port", check_hostport_value, 60},
+    {"uuid", "Check for a UUID (any, or versions such as 4,7)", check_uuid, NULL, 1, "Invalid UUID", check_uuid_value, 40},
+    {"base64", "Check for padded base64 (any, or the encoded byte count)", check_base64, NULL, 1, "Invalid base64", check_base64_value, 60},
+    {"base64url", "Check for URL-safe base64 (any, or the encoded byte count)", check_base64url, NULL, 1, "Invalid base64url", check_base64url_value, 60},
+    {"hex", "Check for hex digits (any, or the encoded byte count)", check_hex, NULL, 1, "Invalid hex", check_hex_value, 40},
+    {"semver", "Check for a semantic version (any, or a range such as >=2.0.0 <3)", check_semver, NULL, 1, "Invalid version", check_semver_value, 80},
+    {"url", "Check for a URL, with checks on its parts (scheme.enum=https;port.le=65535)", check_url, NULL, 1, "Invalid URL", check_url_value, 300},
+    {"path_exists", "Check that the path exists (true or false)", check_path_exists, NULL, 1, "Invalid path", NULL, 2000},
+    {"file", "Check that the path is a regular file (true or false)", check_file, NULL, 1, "Invalid file", NULL, 2000},
+    {"dir", "Check that the path is a directory (true or false)", check_dir, NULL, 1, "Invalid directory", NULL, 2000},
+    {"socket", "Check that the path is a Unix socket (true or false)", check_socket, NULL, 1, "Invalid socket", NULL, 2000},
+    {"readable", "Check that the path is readable (true or false)", check_readable, NULL, 1, "Invalid path", NULL, 3000},
+    {"writable", "Check that the path is writable (true or false)", check_writable, NULL, 1, "Invalid path", NULL, 3000},
+    {"max_size", "Check that the file is at most a size (such as 512K, 10M)", check_max_size, NULL, 1, "Invalid size", NULL, 2000},
+    {"expr", "Check that an expression over the value and other variables holds (value <= MAX_POOL)", check_expr, NULL, 1, "Invalid value", NULL, 200},
 };
 
+const struct option base_options[] = { BASE_OPTIONS };
+
+// Base options then check options, terminated for getopt_long
+const struct option long_options[] = { BASE_OPTIONS CHECK_OPTIONS {0, 0, 0, 0} };
+
 size_t get_base_options_count() {
-    return sizeof(base_options) / sizeof(struct option);
+    return sizeof(base_options) / sizeof(base_options[0]);
 }
 
 size_t get_check_options_count() {
-    return sizeof(check_options) / sizeof(struct option);
+    return sizeof(check_options) / sizeof(check_options[0]);
 }
 
 size_t get_options_count() {
     return get_base_options_count() + get_check_options_count();
 }
 
-static int process_check(const char* check_name, const char* check_value, Check* check, EnvType* var_type) {
-    const CheckDefinition* check_def = get_check_definition(check_name);
+static bool is_true_value(const char* value) {
+    return value && (strcmp(value, "true") == 0 || strcmp(value, "yes") == 0 || strcmp(value, "1") == 0);
+}
+
+bool parse_timeout(const char* str, unsigned* timeout_ms) {
+    if (!str || *str < '0' || *str > '9') return false;
+
+    char* end;
+    errno = 0;
+    unsigned long long amount = strtoull(str, &end, 10);
+    if (errno == ERANGE) return false;
+
+    unsigned long long scale;
+    if (strcmp(end, "ms") == 0) scale = 1;
+    else if (*end == '\0' || strcmp(end, "s") == 0) scale = 1000;
+    else if (strcmp(end, "m") == 0) scale = 60 * 1000;
+    else return false;
+
+    if (amount == 0 || amount > UINT_MAX / scale) return false;
+    *timeout_ms = (unsigned)(amount * scale);
+    return true;
+}
+
+static UrlCheck* parse_url_check(const CheckRegistry* registry, const char* spec);
+
+int process_check(const char* check_name, const char* check_value, Check* check, EnvType* var_type) {
+    return process_registry_check(NULL, check_name, check_value, check, var_type);
+}
+
+int process_registry_check(const CheckRegistry* registry, const char* check_name, const char* check_value, Check* check, EnvType* var_type) {
+    const CheckDefinition* check_def = registry ? registry_find_check(registry, check_name)
+                                                : get_check_definition(check_name);
     if (!check_def) {
         logger(LOG_ERROR, "Unknown check '%s'\n", check_name);
         return 0;
     }
 
     check->definition = check_def;
+    check->stats_key = 0;
 
     if (strcmp(check_name, "type") == 0) {
         if (strcmp(check_value, "string") == 0) *var_type = TYPE_STRING;
         else if (strcmp(check_value, "integer") == 0) *var_type = TYPE_INTEGER;
         else if (strcmp(check_value, "float") == 0) *var_type = TYPE_FLOAT;
         else if (strcmp(check_value, "json") == 0) *var_type = TYPE_JSON;
+        else if (strcmp(check_value, "duration") == 0) *var_type = TYPE_DURATION;
+        else if (strcmp(check_value, "bytesize") == 0) *var_type = TYPE_BYTESIZE;
         else {
             logger(LOG_ERROR, "Invalid type: %s\n", check_value);
             return 0;
@@ -83,13 +192,29 @@ static int process_check(const char* check_name, const char* check_value, Check*
         check->value.int_value = *var_type;
     }
     else if (strcmp(check_name, "gt") == 0 || strcmp(check_name, "lt") == 0 ||
-             strcmp(check_name, "ge") == 0 || strcmp(check_name, "le") == 0 ||
-             strcmp(check_name, "len") == 0 || strcmp(check_name, "lengt") == 0 ||
+             strcmp(check_name, "ge") == 0 || strcmp(check_name, "le") == 0) {
+        if (!parse_threshold(check_value, &check->value.number_value)) {
+            logger(LOG_ERROR, "Invalid threshold for %s: %s\n", check_name, check_value);
+            return 0;
+        }
+    }
+    else if (strcmp(check_name, "len") == 0 || strcmp(check_name, "lengt") == 0 ||
              strcmp(check_name, "lenlt") == 0) {
-        check->value.int_value = atoi(check_value);
+        Number length;
+        if (!parse_number(check_value, &length) || length.is_float || length.int_value < 0) {
+            logger(LOG_ERROR, "Invalid length for %s: %s\n", check_name, check_value);
+            return 0;
+        }
+        check->value.size_value = (size_t)length.int_value;
+    }
+    else if (strcmp(check_name, "regex") == 0) {
+        check->value.regex_check = compile_regex_check(check_value);
+        if (!check->value.regex_check) {
+            logger(LOG_ERROR, "Failed to allocate memory for regex\n");
+            return 0;
+        }
     }
-    else if (strcmp(check_name, "eq") == 0 || strcmp(check_name, "ne") == 0 ||
-             strcmp(check_name, "regex") == 0) {
+    else if (strcmp(check_name, "eq") == 0 || strcmp(check_name, "ne") == 0) {
         check->value.str_value = strdup(check_value);
         if (!check->value.str_value) {
             logger(LOG_ERROR, "Failed to allocate memory for string value\n");
@@ -122,6 +247,80 @@ static int process_check(const char* check_name, const char* check_value, Check*
         check->value.enum_values = values;
         free(enum_copy);
     }
+    else if (is_net_check(check_name)) {
+        if (!parse_net_constraint(check_name, check_value, &check->value.net_value)) {
+            logger(LOG_ERROR, "Invalid constraint for %s: %s\n", check_name, check_value);
+            return 0;
+        }
+    }
+    else if (strcmp(check_name, "uuid") == 0) {
+        check->value.int_value = 0;
+        if (strcmp(check_value, "any") != 0) {
+            // Comma-separated versions 1-8
+            for (const char* p = check_value; *p; p++) {
+                if (*p >= '1' && *p <= '8' && (p[1] == ',' || p[1] == '\0')) {
+                    check->value.int_value |= 1 << (*p - '0');
+                } else if (*p != ',' && *p != ' ') {
+                    logger(LOG_ERROR, "Invalid UUID versions: %s\n", check_value);
+                    return 0;
+                }
+            }
+            if (!check->value.int_value) {
+                logger(LOG_ERROR, "Invalid UUID versions: %s\n", check_value);
+                return 0;
+            }
+        }
+    }
+    else if (strcmp(check_name, "base64") == 0 || strcmp(check_name, "base64url") == 0 ||
+             strcmp(check_name, "hex") == 0) {
+        check->value.size_value = 0;
+        if (strcmp(check_value, "any") != 0) {
+            Number length;
+            if (!parse_number(check_value, &length) || length.is_float || length.int_value <= 0) {
+                logger(LOG_ERROR, "Invalid byte count for %s: %s\n", check_name, check_value);
+                return 0;
+            }
+            check->value.size_value = (size_t)length.int_value;
+        }
+    }
+    else if (strcmp(check_name, "semver") == 0) {
+        check->value.semver_range = parse_semver_range(check_value);
+        if (!check->value.semver_range) {
+            logger(LOG_ERROR, "Invalid version range: %s\n", check_value);
+            return 0;
+        }
+    }
+    else if (strcmp(check_name, "url") == 0) {
+        check->value.url_check = parse_url_check(registry, check_value);
+        if (!check->value.url_check) {
+            logger(LOG_ERROR, "Invalid url checks: %s\n", check_value);
+            return 0;
+        }
+    }
+    else if (strcmp(check_name, "expr") == 0) {
+        char error[128];
+        check->value.expr = compile_expr(check_value, error, sizeof(error));
+        if (!check->value.expr) {
+            logger(LOG_ERROR, "Invalid expression %s: %s\n", check_value, error);
+            return 0;
+        }
+    }
+    else if (strcmp(check_name, "max_size") == 0) {
+        int64_t size;
+        if (!parse_byte_size(check_value, strlen(check_value), &size)) {
+            logger(LOG_ERROR, "Invalid size: %s\n", check_value);
+            return 0;
+        }
+        check->value.size_value = (size_t)size;
+    }
+    else if (is_fs_check(check_name)) {
+        if (!is_true_value(check_value) && strcmp(check_value, "false") != 0 &&
+            strcmp(check_value, "no") != 0 && strcmp(check_value, "0") != 0) {
+            logger(LOG_ERROR, "Invalid value for %s, expected true or false: %s\n", check_name, check_value);
+            return 0;
+        }
+        check->value.int_value = is_true_value(check_value);
+    }
     else if (strcmp(check_name, "cmd") == 0) {
         size_t cmd_len = strlen(check_value);
         char* cmd_copy = malloc(cmd_len + 1);
@@ -133,39 +332,193 @@ static int process_check(const char* check_name, const char* check_value, Check*
         cmd_copy[cmd_len] = '\0';
         check->value.cmd_value.cmd = cmd_copy;
         check->value.cmd_value.cmd_len = cmd_len;
+        check->value.cmd_value.pure = false;
+        check->value.cmd_value.timeout_ms = 0;
+    }
+    else if (!is_builtin_check(check_name)) {
+        // Registered checks receive their argument as a string, or parsed by their hook
+        const CheckHooks* hooks = check_def->custom_data;
+        if (check_def->has_arg && hooks && hooks->parse) {
+            char error[128] = "";
+            check->value.custom_value = hooks->parse(check_value, error, sizeof(error));
+            if (!check->value.custom_value) {
+                logger(LOG_ERROR, "Invalid argument for %s: %s%s%s\n", check_name, check_value,
+                       *error ? ": " : "", error);
+                return 0;
+            }
+            return 1;
+        }
+        check->value.custom_value = check_def->has_arg ? strdup(check_value) : NULL;
+        if (check_def->has_arg && !check->value.custom_value) {
+            logger(LOG_ERROR, "Failed to allocate memory for check argument\n");
+            return 0;
+        }
     }
 
     return 1;
 }
 
+static void free_url_check(UrlCheck* url) {
+    if (!url) return;
+    for (int i = 0; i < url->count; i++) {
+        free_check_value(&url->checks[i].check);
+    }
+    free(url->text);
+    free(url);
+}
+
+// Builds the argument of a url check from "component.check=value" entries
+// separated by ';' (a ';' or '\' in a value is escaped with '\'), or
+// "any" to only require a URL
+static UrlCheck* parse_url_check(const CheckRegistry* registry, const char* spec) {
+    int capacity = 1;
+    for (const char* p = spec; *p; p++) {
+        if (*p == ';') capacity++;
+    }
+
+    UrlCheck* url = calloc(1, sizeof(UrlCheck) + (size_t)capacity * sizeof(UrlComponentCheck));
+    char* entry = malloc(strlen(spec) + 1);
+    if (!url || !entry || !(url->text = strdup(spec))) {
+        free(entry);
+        free(url);
+        return NULL;
+    }
+    if (strcmp(spec, "any") == 0) {
+        free(entry);
+        return url;
+    }
+
+    bool ok = true;
+    const char* p = spec;
+    while (ok && *p) {
+        // Unescape one entry into the scratch buffer
+        size_t len = 0;
+        for (; *p && *p != ';'; p++) {
+            if (*p == '\\' && (p[1] == ';' || p[1] == '\\')) p++;
+            entry[len++] = *p;
+        }
+        entry[len] = '\0';
+        if (*p == ';') p++;
+
+        char* name = entry;
+        while (*name == ' ') name++;
+        if (*name == '\0') continue;
+
+        char* dot = strchr(name, '.');
+        char* equals = dot ? strchr(dot, '=') : NULL;
+        UrlComponent component;
+        if (!equals || !find_url_component(name, (size_t)(dot - name), &component)) {
+            logger(LOG_ERROR, "Expected component.check=value in url checks: %s\n", name);
+            ok = false;
+            break;
+        }
+        *equals = '\0';
+        const char* check_name = dot + 1;
+        const char* check_value = equals + 1;
+
+        UrlComponentCheck* item = &url->checks[url->count];
+        item->component = component;
+        if (strcmp(check_name, "required") == 0) {
+            if (!is_true_value(check_value)) continue;  // "required: false" is the default
+            item->check.definition = NULL;
+            url->count++;
+            continue;
+        }
+        if (strcmp(check_name, "url") == 0) {
+            logger(LOG_ERROR, "url checks cannot be nested\n");
+            ok = false;
+            break;
+        }
+
+        EnvType component_type = TYPE_STRING;
+        ok = process_registry_check(registry, check_name, check_value, &item->check, &component_type);
+        if (ok) url->count++;
+    }
+
+    free(entry);
+    if (!ok) {
+        free_url_check(url);
+        return NULL;
+    }
+    return url;
+}
+
+void free_check_value(Check* check) {
+    if (!check->definition) return;
+
+    const char* name = check->definition->name;
+    if (strcmp(name, "enum") == 0) {
+        char** values = check->value.enum_values;
+        if (values) {
+            for (int j = 0; values[j]; j++) {
+                free(values[j]);
+            }
+            free(values);
+        }
+    }
+    else if (strcmp(name, "cmd") == 0) {
+        free(check->value.cmd_value.cmd);
+    }
+    else if (strcmp(name, "eq") == 0 || strcmp(name, "ne") == 0) {
+        free(check->value.str_value);
+    }
+    else if (strcmp(name, "regex") == 0) {
+        free_regex_check(check->value.regex_check);
+    }
+    else if (strcmp(name, "semver") == 0) {
+        free_semver_range(check->value.semver_range);
+    }
+    else if (strcmp(name, "url") == 0) {
+        free_url_check(check->value.url_check);
+    }
+    else if (strcmp(name, "expr") == 0) {
+        free_expr(check->value.expr);
+    }
+    else if (!is_builtin_check(name)) {
+        const CheckHooks* hooks = check->definition->custom_data;
+        if (!hooks || !hooks->parse) free(check->value.custom_value);
+        else if (hooks->free && check->value.custom_value) hooks->free(check->value.custom_value);
+    }
+}
+
 // Helper function to cleanup check resources
 static void cleanup_checks(Check* checks, int check_count) {
     if (!checks) return;
-    
+
     for (int i = 0; i < check_count; i++) {
-        if (checks[i].definition) {
-            if (strcmp(checks[i].definition->name, "enum") == 0) {
-                char** values = checks[i].value.enum_values;
-                if (values) {
-                    for (int j = 0; values[j]; j++) {
-                        free(values[j]);
-                    }
-                    free(values);
-                }
-            }
-            else if (strcmp(checks[i].definition->name, "cmd") == 0) {
-                free(checks[i].value.cmd_value.cmd);
-            }
-            else if (strcmp(checks[i].definition->name, "eq") == 0 ||
-                     strcmp(checks[i].definition->name, "ne") == 0 ||
-                     strcmp(checks[i].definition->name, "regex") == 0) {
-                free(checks[i].value.str_value);
-            }
-        }
+        free_check_value(&checks[i]);
     }
     free(checks);
 }
 
+// Appends one component check of a url mapping to its text form, escaping ';' and '\'
+static bool append_url_spec(char** spec, size_t* len, const char* component, const char* check, const char* value) {
+    size_t needed = *len + strlen(component) + strlen(check) + 2 * strlen(value) + 4;
+    char* grown = realloc(*spec, needed);
+    if (!grown) return false;
+    *spec = grown;
+
+    char* out = grown + *len;
+    if (*len) *out++ = ';';
+    out += sprintf(out, "%s.%s=", component, check);
+    for (const char* v = value; *v; v++) {
+        if (*v == ';' || *v == '\\') *out++ = '\\';
+        *out++ = *v;
+    }
+    *out = '\0';
+    *len = (size_t)(out - grown);
+    return true;
+}
+
+// Names a config check across runs: the same check on the same variable keeps
+// its statistics, an edited one starts afresh
+static uint64_t check_stats_key(const char* var_name, const char* check_name, const char* check_str) {
+    uint64_t key = hash_string(HASH_SEED, var_name);
+    key = hash_string(key, check_name);
+    key = hash_string(key, check_str);
+    return key ? key : 1;
+}
+
 // Helper function to validate and print environment variable
 int validate_and_print_env(const char* var_name, const char* env_value, 
                           const char* default_value, bool print_value,
@@ -194,18 +547,75 @@ int validate_and_print_env(const char* var_name, const char* env_value,
     return result;
 }
 
-int handle_config_option(const char* config_path, bool print_value) {
+// Glob keys are kept apart: they name no variable until matched against an environment
+static int add_pattern(Config* config, const EnvVariable* var) {
+    if (var->default_value) {
+        logger(LOG_ERROR, "Error: %s is a pattern and cannot have a default\n", var->name);
+        return 0;
+    }
+    if (config->pattern_count >= config->pattern_capacity) {
+        int new_capacity = config->pattern_capacity ? config->pattern_capacity * 2 : 4;
+        EnvVariable* new_patterns = realloc(config->patterns, new_capacity * sizeof(EnvVariable));
+        if (!new_patterns) {
+            logger(LOG_ERROR, "Failed to allocate memory for config patterns\n");
+            return 0;
+        }
+        config->patterns = new_patterns;
+        config->pattern_capacity = new_capacity;
+    }
+    config->patterns[config->pattern_count++] = *var;
+    return 1;
+}
+
+static int add_variable(Config* config, const EnvVariable* var) {
+    if (is_pattern(var->name)) return add_pattern(config, var);
+    if (config->variable_count >= config->variable_capacity) {
+        int new_capacity = config->variable_capacity ? config->variable_capacity * 2 : 8;
+        EnvVariable* new_variables = realloc(config->variables, new_capacity * sizeof(EnvVariable));
+        if (!new_variables) {
+            logger(LOG_ERROR, "Failed to allocate memory for config variables\n");
+            return 0;
+        }
+        config->variables = new_variables;
+        config->variable_capacity = new_capacity;
+    }
+    config->variables[config->variable_count++] = *var;
+    return 1;
+}
+
+static void clear_config(Config* config) {
+    for (int i = 0; i < config->variable_count; i++) {
+        free(config->variables[i].name);
+        free(config->variables[i].default_value);
+        cleanup_checks(config->variables[i].checks, config->variables[i].check_count);
+    }
+    free(config->variables);
+    free(config->validation_order);
+    for (int i = 0; i < config->pattern_count; i++) {
+        free(config->patterns[i].name);
+        cleanup_checks(config->patterns[i].checks, config->patterns[i].check_count);
+    }
+    free(config->patterns);
+    free_patterns(config->pattern_set);
+}
+
+void free_config(Config* config) {
+    if (!config) return;
+    clear_config(config);
+    free(config);
+}
+
+Config* load_config(const char* config_path) {
+    return load_config_with_registry(config_path, NULL);
+}
+
+Config* load_config_with_registry(const char* config_path, CheckRegistry* registry) {
     if (!config_path) {
         logger(LOG_ERROR, "Error: No configuration file path provided\n");
-        return ENVIL_CONFIG_ERROR;
+        return NULL;
     }
     
     logger(LOG_TRACE, "Loading config file: %s", config_path);
-    FILE *config_file = fopen(config_path, "r");
-    if (!config_file) {
-        logger(LOG_ERROR, "Error: Cannot open config file: %s\n", config_path);
-        return ENVIL_CONFIG_ERROR;
-    }
 
     // Determine file format from extension
     const char* ext = strrchr(config_path, '.');
@@ -214,17 +624,277 @@ int handle_config_option(const char* config_path, bool print_value) {
 
     if (!is_yaml && !is_json) {
         logger(LOG_ERROR, "Error: Config file must be .yml, .yaml, or .json\n");
+        return NULL;
+    }
+
+    FILE *config_file = fopen(config_path, "r");
+    if (!config_file) {
+        logger(LOG_ERROR, "Error: Cannot open config file: %s\n", config_path);
+        return NULL;
+    }
+
+    Config* config = calloc(1, sizeof(Config));
+    if (!config) {
+        logger(LOG_ERROR, "Failed to allocate memory for config\n");
         fclose(config_file);
+        return NULL;
+    }
+    config->registry = registry;
+
+    int result = is_yaml ? load_yaml_config(config_file, config)
+                         : load_json_config(config_file, config);
+    fclose(config_file);
+
+    if (result != ENVIL_OK) {
+        free_config(config);
+        return NULL;
+    }
+    return config;
+}
+
+int validate_config(const Config* config, bool print_value, ValidationErrors* errors) {
+    return validate_config_with_stats(config, print_value, errors, NULL);
+}
+
+// Stats the values of all variables with filesystem checks in one batch
+static void prefetch_config_paths(const Config* config, const char* const* values, const int* known) {
+    const char** paths = malloc((size_t)config->variable_count * sizeof(char*));
+    if (!paths) return;
+
+    int count = 0;
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        if (!values[i] || (known && known[i] != VERDICT_PENDING)) continue;
+        for (int j = 0; j < var->check_count; j++) {
+            if (is_fs_check(var->checks[j].definition->name)) {
+                paths[count++] = values[i];
+                break;
+            }
+        }
+    }
+    if (count > 0) prefetch_path_stats(paths, count);
+    free(paths);
+}
+
+int validate_config_with_stats(const Config* config, bool print_value, ValidationErrors* errors, CheckStats* stats) {
+    return validate_config_lookup(config, NULL, NULL, print_value, errors, stats);
+}
+
+int validate_config_lookup(const Config* config, ExprLookupFunction lookup, void* lookup_data,
+                           bool print_value, ValidationErrors* errors, CheckStats* stats) {
+    int count = config->variable_count;
+    const char** values = malloc((size_t)(count ? count : 1) * sizeof(char*));
+    if (!values) {
+        logger(LOG_ERROR, "Failed to allocate memory for config values\n");
         return ENVIL_CONFIG_ERROR;
     }
 
-    ValidationErrors* errors = create_validation_errors();
+    // One value per variable, shared by its own checks and the expr checks reading it
+    for (int i = 0; i < count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        values[i] = lookup ? lookup(var->name, lookup_data) : getenv(var->name);
+        if (!values[i]) values[i] = var->default_value;
+    }
+    // Patterns are matched against the process environment, which a lookup replaces
+    int result = validate_config_values(config, values, NULL, lookup ? NULL : environ, lookup, lookup_data,
+                                        print_value, errors, stats);
+    free(values);
+    return result;
+}
+
+// Validates each name of envp against the patterns it matches, in one pass
+static int validate_config_patterns(const Config* config, char* const* envp, bool print_value,
+                                    ValidationErrors* errors, CheckStats* stats) {
+    int* matches = malloc((size_t)config->pattern_count * sizeof(int));
+    if (!matches) {
+        logger(LOG_ERROR, "Failed to allocate memory for pattern matches\n");
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    int result = ENVIL_OK, matched = 0;
+    for (char* const* entry = envp; *entry; entry++) {
+        const char* equals = strchr(*entry, '=');
+        if (!equals) continue;
+        size_t name_len = (size_t)(equals - *entry);
+        int match_count = match_patterns(config->pattern_set, *entry, name_len, matches);
+        if (match_count == 0) continue;
+
+        char* name = strndup(*entry, name_len);
+        if (!name) {
+            result = ENVIL_CONFIG_ERROR;
+            break;
+        }
+        bool passed = true;
+        for (int m = 0; m < match_count; m++) {
+            // The pattern's definition, under the matched name
+            EnvVariable member = config->patterns[matches[m]];
+            member.name = name;
+            int var_result = validate_variable_with_stats(&member, equals + 1, errors, stats);
+            passed = passed && var_result == ENVIL_OK;
+            if (var_result != ENVIL_OK && result != ENVIL_TIMEOUT_ERROR) {
+                result = var_result;
+            }
+        }
+        if (passed && print_value) printf("%s=%s\n", name, equals + 1);
+        free(name);
+        matched++;
+    }
+    logger(LOG_DEBUG, "%d variables matched %d patterns", matched, config->pattern_count);
+    free(matches);
+    return result;
+}
+
+int validate_config_values(const Config* config, const char* const* values, const int* known,
+                           char* const* envp, ExprLookupFunction lookup, void* lookup_data,
+                           bool print_value, ValidationErrors* errors, CheckStats* stats) {
+    int count = config->variable_count;
+    bool* invalid = calloc((size_t)(count ? count : 1), sizeof(bool));
+    if (!invalid) {
+        logger(LOG_ERROR, "Failed to allocate memory for config values\n");
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    prefetch_config_paths(config, values, known);
+    ExprEnv env = {values, invalid, lookup, lookup_data};
+    set_expr_env(&env);
+
     int result = ENVIL_OK;
+    for (int k = 0; k < count; k++) {
+        int i = config->validation_order ? config->validation_order[k] : k;
+        if (known && known[i] != VERDICT_PENDING) {
+            invalid[i] = known[i] != ENVIL_OK;
+            continue;
+        }
+        int var_result = validate_variable_with_stats(&config->variables[i], values[i], errors, stats);
+        invalid[i] = var_result != ENVIL_OK;
+        // A timeout outranks other failures: the report is incomplete
+        if (var_result != ENVIL_OK && result != ENVIL_TIMEOUT_ERROR) {
+            result = var_result;
+        }
+    }
+    clear_path_stats();
+
+    for (int i = 0; i < count && print_value; i++) {
+        if (!invalid[i] && values[i]) printf("%s=%s\n", config->variables[i].name, values[i]);
+    }
+    // Members of pattern keys come last, with every variable their expr checks read settled
+    if (envp && config->pattern_set) {
+        int pattern_result = validate_config_patterns(config, envp, print_value, errors, stats);
+        if (pattern_result != ENVIL_OK && result != ENVIL_TIMEOUT_ERROR) result = pattern_result;
+    }
+    set_expr_env(NULL);
+    free(invalid);
+    return result;
+}
+
+// True when an expr check of var reads a variable marked in recheck
+static bool reads_rechecked(const EnvVariable* var, const bool* recheck) {
+    for (int j = 0; j < var->check_count; j++) {
+        if (strcmp(var->checks[j].definition->name, "expr") != 0) continue;
+        const Expr* expr = var->checks[j].value.expr;
+        for (int k = 0; k < expr_name_count(expr); k++) {
+            int binding = expr_name_binding(expr, k);
+            if (binding >= 0 && recheck[binding]) return true;
+        }
+    }
+    return false;
+}
 
-    if (is_yaml) {
-        result = handle_yaml_config(config_file, print_value, errors);
+void spread_rechecks(const Config* config, bool* recheck) {
+    // Rechecking a variable can change the verdict of the expr checks reading it
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int i = 0; i < config->variable_count; i++) {
+            if (!recheck[i] && reads_rechecked(&config->variables[i], recheck)) {
+                recheck[i] = true;
+                changed = true;
+            }
+        }
+    }
+}
+
+// Writes the NAME=value lines a passing run prints with --print
+static void print_config_values(const Config* config, FILE* out) {
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        const char* value = getenv(var->name);
+        if (!value) value = var->default_value;
+        if (value) {
+            fprintf(out, "%s=%s\n", var->name, value);
+        }
+    }
+    // Only a passing run prints, so every member of a pattern passed
+    int* matches = config->pattern_count ? malloc((size_t)config->pattern_count * sizeof(int)) : NULL;
+    for (char** entry = environ; matches && *entry; entry++) {
+        const char* equals = strchr(*entry, '=');
+        if (equals && match_patterns(config->pattern_set, *entry, (size_t)(equals - *entry), matches) > 0) {
+            fprintf(out, "%s\n", *entry);
+        }
+    }
+    free(matches);
+}
+
+void export_config_defaults(const Config* config) {
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        if (var->default_value) setenv(var->name, var->default_value, 0);
+    }
+}
+
+int handle_config_option(const char* config_path, bool print_value, bool use_cache, const char* stats_path,
+                         const char* strict_prefix, bool export_defaults) {
+    Config* config = load_config(config_path);
+    if (!config) {
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    ValidationErrors* errors = create_validation_errors();
+    // Undeclared names fail the run, so nothing is printed for it to export
+    int strict_result = strict_prefix ? check_undeclared(config, strict_prefix, environ, errors) : ENVIL_OK;
+    if (strict_result != ENVIL_OK) print_value = false;
+
+    char cache_key[CACHE_KEY_SIZE];
+    bool caching = use_cache && config_is_cacheable(config);
+    if (caching) {
+        cache_fingerprint(config, print_value, cache_key);
+        if (strict_result == ENVIL_OK && cache_replay(cache_key)) {
+            if (export_defaults) export_config_defaults(config);
+            free_validation_errors(errors);
+            free_config(config);
+            return ENVIL_OK;
+        }
+    }
+
+    CheckStats* stats = stats_path ? load_check_stats(stats_path) : NULL;
+    int result;
+
+    if (caching) {
+        // Validate first, then emit the output in one piece so it can be stored
+        result = validate_config_with_stats(config, false, errors, stats);
+        if (result == ENVIL_OK) {
+            char* output = NULL;
+            size_t output_len = 0;
+            FILE* out = open_memstream(&output, &output_len);
+            if (out) {
+                if (print_value) print_config_values(config, out);
+                fclose(out);
+                fwrite(output, 1, output_len, stdout);
+                cache_store(cache_key, output, output_len);
+                free(output);
+            } else if (print_value) {
+                print_config_values(config, stdout);
+            }
+        }
     } else {
-        result = handle_json_config(config_file, print_value, errors);
+        result = validate_config_with_stats(config, print_value, errors, stats);
+    }
+    if (result == ENVIL_OK) result = strict_result;
+    // Exported only once validated, for the application or shell that comes next
+    if (result == ENVIL_OK && export_defaults) export_config_defaults(config);
+
+    if (stats) {
+        save_check_stats(stats, stats_path);
+        free_check_stats(stats);
     }
 
     // Print any validation errors
@@ -234,34 +904,177 @@ int handle_config_option(const char* config_path, bool print_value) {
         }
     }
 
-    fclose(config_file);
     free_validation_errors(errors);
+    free_config(config);
     return result;
 }
 
 int handle_yaml_config(FILE* config_file, bool print_value, ValidationErrors* errors) {
+    Config config = {0};
+    int result = load_yaml_config(config_file, &config);
+    if (result == ENVIL_OK) {
+        result = validate_config(&config, print_value, errors);
+    }
+
+    clear_config(&config);
+    return result;
+}
+
+int handle_json_config(FILE* config_file, bool print_value, ValidationErrors* errors) {
+    Config config = {0};
+    int result = load_json_config(config_file, &config);
+    if (result == ENVIL_OK) {
+        result = validate_config(&config, print_value, errors);
+    }
+
+    clear_config(&config);
+    return result;
+}
+
+// True once every variable the expr checks of variables[index] read is placed
+static bool expr_inputs_placed(const EnvVariable* var, int index, const bool* placed) {
+    for (int j = 0; j < var->check_count; j++) {
+        if (strcmp(var->checks[j].definition->name, "expr") != 0) continue;
+        const Expr* expr = var->checks[j].value.expr;
+        for (int k = 0; k < expr_name_count(expr); k++) {
+            int input = expr_name_binding(expr, k);
+            if (input >= 0 && input != index && !placed[input]) return false;
+        }
+    }
+    return true;
+}
+
+// Binds the names expr checks read to the config's variables, and orders the
+// variables so that those read are validated first: an expression then sees
+// whether its inputs passed and skips those that failed instead of reporting
+// them again. Config order is kept wherever the dependencies allow.
+static int link_expr_checks(Config* config) {
+    int count = config->variable_count;
+    bool reads_others = false;
+    for (int i = 0; i < count + config->pattern_count; i++) {
+        // Patterns are validated after every variable, so they need no place in the order
+        const EnvVariable* var = i < count ? &config->variables[i] : &config->patterns[i - count];
+        for (int j = 0; j < var->check_count; j++) {
+            if (strcmp(var->checks[j].definition->name, "expr") != 0) continue;
+            Expr* expr = var->checks[j].value.expr;
+            for (int k = 0; k < expr_name_count(expr); k++) {
+                for (int v = 0; v < count; v++) {
+                    if (strcmp(config->variables[v].name, expr_name(expr, k)) == 0) {
+                        bind_expr_name(expr, k, v);
+                        reads_others = reads_others || (v != i && i < count);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if (!reads_others) return ENVIL_OK;
+
+    int* order = malloc((size_t)count * sizeof(int));
+    bool* placed = calloc((size_t)count, sizeof(bool));
+    if (!order || !placed) {
+        logger(LOG_ERROR, "Failed to allocate memory for the validation order\n");
+        free(order);
+        free(placed);
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    for (int placed_count = 0; placed_count < count; placed_count++) {
+        int next = -1, first = -1;
+        for (int i = 0; i < count && next < 0; i++) {
+            if (placed[i]) continue;
+            if (first < 0) first = i;
+            if (expr_inputs_placed(&config->variables[i], i, placed)) next = i;
+        }
+        if (next < 0) {
+            // A cycle: its first variable goes ahead and sees the others unvalidated
+            logger(LOG_WARNING, "expr checks of %s and the variables it reads depend on each other\n",
+                   config->variables[first].name);
+            next = first;
+        }
+        placed[next] = true;
+        order[placed_count] = next;
+    }
+    free(placed);
+    config->validation_order = order;
+    return ENVIL_OK;
+}
+
+static int compile_config_patterns(Config* config) {
+    if (config->pattern_count == 0) return ENVIL_OK;
+
+    const char** names = malloc((size_t)config->pattern_count * sizeof(char*));
+    if (names) {
+        for (int i = 0; i < config->pattern_count; i++) names[i] = config->patterns[i].name;
+        config->pattern_set = compile_patterns(names, config->pattern_count);
+        free(names);
+    }
+    if (!config->pattern_set) {
+        logger(LOG_ERROR, "Failed to allocate memory for config patterns\n");
+        return ENVIL_CONFIG_ERROR;
+    }
+    return ENVIL_OK;
+}
+
+// Loads the plugins a YAML config lists under plugins:, a path or a sequence of them
+static int load_yaml_plugins(const YamlLibrary* yaml, yaml_document_t* document, yaml_node_t* root, Config* config) {
+    for (yaml_node_pair_t* pair = root->data.mapping.pairs.start; pair < root->data.mapping.pairs.top; pair++) {
+        yaml_node_t* key = yaml->document_get_node(document, pair->key);
+        if (key->type != YAML_SCALAR_NODE || strcmp((char*)key->data.scalar.value, "plugins") != 0) continue;
+
+        yaml_node_t* value = yaml->document_get_node(document, pair->value);
+        if (value->type == YAML_SCALAR_NODE) {
+            return load_plugin(config->registry, (char*)value->data.scalar.value);
+        }
+        if (value->type != YAML_SEQUENCE_NODE) {
+            logger(LOG_ERROR, "Error: plugins must be a path or a list of paths\n");
+            return ENVIL_CONFIG_ERROR;
+        }
+        for (yaml_node_item_t* item = value->data.sequence.items.start; item < value->data.sequence.items.top; item++) {
+            yaml_node_t* path = yaml->document_get_node(document, *item);
+            if (path->type != YAML_SCALAR_NODE) {
+                logger(LOG_ERROR, "Error: plugins must be a path or a list of paths\n");
+                return ENVIL_CONFIG_ERROR;
+            }
+            if (load_plugin(config->registry, (char*)path->data.scalar.value) != ENVIL_OK) return ENVIL_CONFIG_ERROR;
+        }
+    }
+    return ENVIL_OK;
+}
+
+int load_yaml_config(FILE* config_file, Config* config) {
     yaml_parser_t parser;
     yaml_document_t document;
     int result = ENVIL_OK;
 
-    if (!yaml_parser_initialize(&parser)) {
+    const YamlLibrary* yaml = yaml_library();
+    if (!yaml) return ENVIL_CONFIG_ERROR;
+
+    if (!yaml->parser_initialize(&parser)) {
         logger(LOG_ERROR, "Failed to initialize YAML parser\n");
         return ENVIL_CONFIG_ERROR;
     }
 
-    yaml_parser_set_input_file(&parser, config_file);
+    yaml->parser_set_input_file(&parser, config_file);
 
-    if (!yaml_parser_load(&parser, &document)) {
+    if (!yaml->parser_load(&parser, &document)) {
         logger(LOG_ERROR, "Failed to parse YAML file\n");
-        yaml_parser_delete(&parser);
+        yaml->parser_delete(&parser);
         return ENVIL_CONFIG_ERROR;
     }
 
-    yaml_node_t* root = yaml_document_get_root_node(&document);
+    yaml_node_t* root = yaml->document_get_root_node(&document);
     if (!root || root->type != YAML_MAPPING_NODE) {
         logger(LOG_ERROR, "Error: YAML root must be a mapping\n");
-        yaml_document_delete(&document);
-        yaml_parser_delete(&parser);
+        yaml->document_delete(&document);
+        yaml->parser_delete(&parser);
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    // Plugins first, so that variables can use their checks
+    if (load_yaml_plugins(yaml, &document, root, config) != ENVIL_OK) {
+        yaml->document_delete(&document);
+        yaml->parser_delete(&parser);
         return ENVIL_CONFIG_ERROR;
     }
 
@@ -270,8 +1083,8 @@ int handle_yaml_config(FILE* config_file, bool print_value, ValidationErrors* er
          pair < root->data.mapping.pairs.top;
          pair++) {
         
-        yaml_node_t* key = yaml_document_get_node(&document, pair->key);
-        yaml_node_t* value_node = yaml_document_get_node(&document, pair->value);
+        yaml_node_t* key = yaml->document_get_node(&document, pair->key);
+        yaml_node_t* value_node = yaml->document_get_node(&document, pair->value);
 
         if (key->type != YAML_SCALAR_NODE || value_node->type != YAML_MAPPING_NODE) {
             continue;
@@ -282,19 +1095,21 @@ int handle_yaml_config(FILE* config_file, bool print_value, ValidationErrors* er
         Check* checks = NULL;
         int check_count = 0;
         EnvType var_type = TYPE_STRING;
+        uint64_t definition_hash = hash_string(HASH_SEED, var_name);
 
         // Process variable configuration
         for (yaml_node_pair_t* var_pair = value_node->data.mapping.pairs.start;
              var_pair < value_node->data.mapping.pairs.top;
              var_pair++) {
             
-            yaml_node_t* var_key = yaml_document_get_node(&document, var_pair->key);
-            yaml_node_t* var_value = yaml_document_get_node(&document, var_pair->value);
+            yaml_node_t* var_key = yaml->document_get_node(&document, var_pair->key);
+            yaml_node_t* var_value = yaml->document_get_node(&document, var_pair->value);
             
             if (var_key->type != YAML_SCALAR_NODE) continue;
 
             const char* key_name = (char*)var_key->data.scalar.value;
             if (strcmp(key_name, "default") == 0 && var_value->type == YAML_SCALAR_NODE) {
+                free(default_value);
                 default_value = strdup((char*)var_value->data.scalar.value);
             } else if (strcmp(key_name, "checks") == 0 && var_value->type == YAML_MAPPING_NODE) {
                 int num_checks = var_value->data.mapping.pairs.top - var_value->data.mapping.pairs.start;
@@ -306,45 +1121,147 @@ int handle_yaml_config(FILE* config_file, bool print_value, ValidationErrors* er
                          check_pair < var_value->data.mapping.pairs.top;
                          check_pair++) {
                         
-                        yaml_node_t* check_key = yaml_document_get_node(&document, check_pair->key);
-                        yaml_node_t* check_value = yaml_document_get_node(&document, check_pair->value);
+                        yaml_node_t* check_key = yaml->document_get_node(&document, check_pair->key);
+                        yaml_node_t* check_value = yaml->document_get_node(&document, check_pair->value);
 
-                        if (check_key->type != YAML_SCALAR_NODE || check_value->type != YAML_SCALAR_NODE) {
+                        if (check_key->type != YAML_SCALAR_NODE) {
                             continue;
                         }
 
-                        if (process_check((char*)check_key->data.scalar.value,
-                                        (char*)check_value->data.scalar.value,
-                                        &checks[check_count],
-                                        &var_type)) {
+                        const char* check_name = (char*)check_key->data.scalar.value;
+                        const char* check_str = NULL;
+                        const char* timeout_str = NULL;
+                        char* url_spec = NULL;
+                        bool pure = false;
+
+                        if (check_value->type == YAML_SCALAR_NODE) {
+                            check_str = (char*)check_value->data.scalar.value;
+                        } else if (check_value->type == YAML_MAPPING_NODE && strcmp(check_name, "cmd") == 0) {
+                            // Long form: cmd: {run: "...", pure: true, timeout: 5s}
+                            for (yaml_node_pair_t* opt_pair = check_value->data.mapping.pairs.start;
+                                 opt_pair < check_value->data.mapping.pairs.top;
+                                 opt_pair++) {
+                                yaml_node_t* opt_key = yaml->document_get_node(&document, opt_pair->key);
+                                yaml_node_t* opt_value = yaml->document_get_node(&document, opt_pair->value);
+                                if (opt_key->type != YAML_SCALAR_NODE || opt_value->type != YAML_SCALAR_NODE) continue;
+
+                                const char* opt_name = (char*)opt_key->data.scalar.value;
+                                if (strcmp(opt_name, "run") == 0) {
+                                    check_str = (char*)opt_value->data.scalar.value;
+                                } else if (strcmp(opt_name, "pure") == 0) {
+                                    pure = is_true_value((char*)opt_value->data.scalar.value);
+                                } else if (strcmp(opt_name, "timeout") == 0) {
+                                    timeout_str = (char*)opt_value->data.scalar.value;
+                                }
+                            }
+                        } else if (check_value->type == YAML_MAPPING_NODE && strcmp(check_name, "url") == 0) {
+                            // url: {scheme: {enum: postgresql,postgres}, port: {le: 65535}}
+                            size_t spec_len = 0;
+                            bool valid = true;
+                            for (yaml_node_pair_t* part_pair = check_value->data.mapping.pairs.start;
+                                 valid && part_pair < check_value->data.mapping.pairs.top;
+                                 part_pair++) {
+                                yaml_node_t* part_key = yaml->document_get_node(&document, part_pair->key);
+                                yaml_node_t* part_checks = yaml->document_get_node(&document, part_pair->value);
+                                valid = part_key->type == YAML_SCALAR_NODE && part_checks->type == YAML_MAPPING_NODE;
+                                for (yaml_node_pair_t* sub_pair = valid ? part_checks->data.mapping.pairs.start : NULL;
+                                     valid && sub_pair < part_checks->data.mapping.pairs.top;
+                                     sub_pair++) {
+                                    yaml_node_t* sub_key = yaml->document_get_node(&document, sub_pair->key);
+                                    yaml_node_t* sub_value = yaml->document_get_node(&document, sub_pair->value);
+                                    valid = sub_key->type == YAML_SCALAR_NODE && sub_value->type == YAML_SCALAR_NODE &&
+                                            append_url_spec(&url_spec, &spec_len, (char*)part_key->data.scalar.value,
+                                                            (char*)sub_key->data.scalar.value,
+                                                            (char*)sub_value->data.scalar.value);
+                                }
+                            }
+                            check_str = valid && url_spec ? url_spec : valid ? "any" : NULL;
+                        }
+
+                        if (!check_str) {
+                            logger(LOG_ERROR, "Invalid value for check '%s' of '%s'\n", check_name, var_name);
+                            free(url_spec);
+                            continue;
+                        }
+
+                        unsigned timeout_ms = 0;
+                        if (timeout_str && !parse_timeout(timeout_str, &timeout_ms)) {
+                            logger(LOG_ERROR, "Invalid timeout for check '%s' of '%s': %s\n", check_name, var_name, timeout_str);
+                            free(url_spec);
+                            continue;
+                        }
+
+                        if (process_registry_check(config->registry, check_name, check_str, &checks[check_count], &var_type)) {
+                            if (pure) checks[check_count].value.cmd_value.pure = true;
+                            if (timeout_ms) checks[check_count].value.cmd_value.timeout_ms = timeout_ms;
+                            checks[check_count].stats_key = check_stats_key(var_name, check_name, check_str);
+                            definition_hash = hash_string(definition_hash, check_name);
+                            definition_hash = hash_string(definition_hash, check_str);
+                            definition_hash = hash_string(definition_hash, pure ? "pure" : NULL);
+                            definition_hash = hash_string(definition_hash, timeout_str);
                             check_count++;
                         }
+                        free(url_spec);
                     }
                 }
             }
         }
 
-        // Validate the variable
-        char* env_value = getenv(var_name);
-        int var_result = validate_and_print_env(var_name, env_value, default_value,
-                                              print_value, checks, check_count, errors);
-        if (var_result != ENVIL_OK) {
-            result = var_result;
+        EnvVariable var = {
+            .name = strdup(var_name),
+            .default_value = default_value,
+            .required = (default_value == NULL),
+            .type = var_type,
+            .checks = checks,
+            .check_count = check_count,
+            .definition_hash = hash_string(definition_hash, default_value)
+        };
+        if (!var.name || !add_variable(config, &var)) {
+            free(var.name);
+            free(default_value);
+            cleanup_checks(checks, check_count);
+            result = ENVIL_CONFIG_ERROR;
+            break;
         }
-
-        free(default_value);
-        cleanup_checks(checks, check_count);
     }
 
-    yaml_document_delete(&document);
-    yaml_parser_delete(&parser);
+    yaml->document_delete(&document);
+    yaml->parser_delete(&parser);
+    if (result == ENVIL_OK) result = link_expr_checks(config);
+    if (result == ENVIL_OK) result = compile_config_patterns(config);
     return result;
 }
 
-int handle_json_config(FILE* config_file, bool print_value, ValidationErrors* errors) {
+// Loads the plugins a JSON config lists under "plugins", a path or an array of them
+static int load_json_plugins(const JsonLibrary* json, struct json_object* root, Config* config) {
+    struct json_object* plugins;
+    if (!json->object_object_get_ex(root, "plugins", &plugins)) return ENVIL_OK;
+
+    if (json->object_get_type(plugins) == json_type_string) {
+        return load_plugin(config->registry, json->object_get_string(plugins));
+    }
+    if (json->object_get_type(plugins) != json_type_array) {
+        logger(LOG_ERROR, "Error: plugins must be a path or a list of paths\n");
+        return ENVIL_CONFIG_ERROR;
+    }
+    for (size_t i = 0; i < json->array_length(plugins); i++) {
+        struct json_object* path = json->array_get_idx(plugins, i);
+        if (json->object_get_type(path) != json_type_string) {
+            logger(LOG_ERROR, "Error: plugins must be a path or a list of paths\n");
+            return ENVIL_CONFIG_ERROR;
+        }
+        if (load_plugin(config->registry, json->object_get_string(path)) != ENVIL_OK) return ENVIL_CONFIG_ERROR;
+    }
+    return ENVIL_OK;
+}
+
+int load_json_config(FILE* config_file, Config* config) {
     struct json_object *root;
     enum json_tokener_error jerr = json_tokener_success;
 
+    const JsonLibrary* json = json_library();
+    if (!json) return ENVIL_CONFIG_ERROR;
+
     // Read entire file
     fseek(config_file, 0, SEEK_END);
     long fsize = ftell(config_file);
@@ -363,26 +1280,35 @@ int handle_json_config(FILE* config_file, bool print_value, ValidationErrors* er
     }
     json_str[fsize] = 0;
 
-    root = json_tokener_parse_verbose(json_str, &jerr);
+    root = json->tokener_parse_verbose(json_str, &jerr);
     free(json_str);
 
     if (!root || jerr != json_tokener_success) {
-        logger(LOG_ERROR, "Failed to parse JSON: %s\n", json_tokener_error_desc(jerr));
-        if (root) json_object_put(root);
+        logger(LOG_ERROR, "Failed to parse JSON: %s\n", json->tokener_error_desc(jerr));
+        if (root) json->object_put(root);
         return ENVIL_CONFIG_ERROR;
     }
 
-    if (json_object_get_type(root) != json_type_object) {
+    if (json->object_get_type(root) != json_type_object) {
         logger(LOG_ERROR, "Error: JSON root must be an object\n");
-        json_object_put(root);
+        json->object_put(root);
         return ENVIL_CONFIG_ERROR;
     }
 
-    int result = ENVIL_OK;
+    // Plugins first, so that variables can use their checks
+    int result = load_json_plugins(json, root, config);
+    if (result != ENVIL_OK) {
+        json->object_put(root);
+        return result;
+    }
 
     // Process each variable in the JSON
-    json_object_object_foreach(root, var_name, var_obj) {
-        if (json_object_get_type(var_obj) != json_type_object) {
+    struct json_object_iterator var_it = json->iter_begin(root);
+    struct json_object_iterator var_end = json->iter_end(root);
+    for (; !json->iter_equal(&var_it, &var_end); json->iter_next(&var_it)) {
+        const char* var_name = json->iter_peek_name(&var_it);
+        struct json_object* var_obj = json->iter_peek_value(&var_it);
+        if (json->object_get_type(var_obj) != json_type_object) {
             continue;
         }
 
@@ -390,46 +1316,120 @@ int handle_json_config(FILE* config_file, bool print_value, ValidationErrors* er
         Check* checks = NULL;
         int check_count = 0;
         EnvType var_type = TYPE_STRING;
+        uint64_t definition_hash = hash_string(HASH_SEED, var_name);
 
         // Get default value if present
         struct json_object* default_obj;
-        if (json_object_object_get_ex(var_obj, "default", &default_obj)) {
-            default_value = strdup(json_object_get_string(default_obj));
+        if (json->object_object_get_ex(var_obj, "default", &default_obj)) {
+            default_value = strdup(json->object_get_string(default_obj));
         }
 
         // Process checks if present
         struct json_object* checks_obj;
-        if (json_object_object_get_ex(var_obj, "checks", &checks_obj) &&
-            json_object_get_type(checks_obj) == json_type_object) {
+        if (json->object_object_get_ex(var_obj, "checks", &checks_obj) &&
+            json->object_get_type(checks_obj) == json_type_object) {
             
-            int num_checks = json_object_object_length(checks_obj);
+            int num_checks = json->object_object_length(checks_obj);
             if (num_checks > 0) {
                 checks = malloc(num_checks * sizeof(Check));
                 if (checks) {
-                    json_object_object_foreach(checks_obj, check_name, check_value) {
-                        if (process_check(check_name,
-                                        json_object_get_string(check_value),
+                    struct json_object_iterator check_it = json->iter_begin(checks_obj);
+                    struct json_object_iterator check_end = json->iter_end(checks_obj);
+                    for (; !json->iter_equal(&check_it, &check_end); json->iter_next(&check_it)) {
+                        const char* check_name = json->iter_peek_name(&check_it);
+                        struct json_object* check_value = json->iter_peek_value(&check_it);
+                        const char* check_str = json->object_get_string(check_value);
+                        const char* timeout_str = NULL;
+                        char* url_spec = NULL;
+                        bool pure = false;
+
+                        if (json->object_get_type(check_value) == json_type_object && strcmp(check_name, "cmd") == 0) {
+                            // Long form: "cmd": {"run": "...", "pure": true, "timeout": "5s"}
+                            struct json_object* opt_obj;
+                            check_str = json->object_object_get_ex(check_value, "run", &opt_obj)
+                                        ? json->object_get_string(opt_obj) : NULL;
+                            if (json->object_object_get_ex(check_value, "pure", &opt_obj)) {
+                                pure = is_true_value(json->object_get_string(opt_obj));
+                            }
+                            if (json->object_object_get_ex(check_value, "timeout", &opt_obj)) {
+                                timeout_str = json->object_get_string(opt_obj);
+                            }
+                        } else if (json->object_get_type(check_value) == json_type_object && strcmp(check_name, "url") == 0) {
+                            // "url": {"scheme": {"enum": "postgresql,postgres"}, "port": {"le": 65535}}
+                            size_t spec_len = 0;
+                            bool valid = true;
+                            struct json_object_iterator part_it = json->iter_begin(check_value);
+                            struct json_object_iterator part_end = json->iter_end(check_value);
+                            for (; valid && !json->iter_equal(&part_it, &part_end); json->iter_next(&part_it)) {
+                                struct json_object* part_checks = json->iter_peek_value(&part_it);
+                                valid = json->object_get_type(part_checks) == json_type_object;
+                                if (!valid) break;
+                                struct json_object_iterator sub_it = json->iter_begin(part_checks);
+                                struct json_object_iterator sub_end = json->iter_end(part_checks);
+                                for (; valid && !json->iter_equal(&sub_it, &sub_end); json->iter_next(&sub_it)) {
+                                    struct json_object* sub_value = json->iter_peek_value(&sub_it);
+                                    valid = json->object_get_type(sub_value) != json_type_object &&
+                                            json->object_get_type(sub_value) != json_type_array &&
+                                            append_url_spec(&url_spec, &spec_len, json->iter_peek_name(&part_it),
+                                                            json->iter_peek_name(&sub_it),
+                                                            json->object_get_string(sub_value));
+                                }
+                            }
+                            check_str = valid && url_spec ? url_spec : valid ? "any" : NULL;
+                        }
+
+                        if (!check_str) {
+                            logger(LOG_ERROR, "Invalid value for check '%s' of '%s'\n", check_name, var_name);
+                            free(url_spec);
+                            continue;
+                        }
+
+                        unsigned timeout_ms = 0;
+                        if (timeout_str && !parse_timeout(timeout_str, &timeout_ms)) {
+                            logger(LOG_ERROR, "Invalid timeout for check '%s' of '%s': %s\n", check_name, var_name, timeout_str);
+                            free(url_spec);
+                            continue;
+                        }
+
+                        if (process_registry_check(config->registry, check_name,
+                                        check_str,
                                         &checks[check_count],
                                         &var_type)) {
+                            if (pure) checks[check_count].value.cmd_value.pure = true;
+                            if (timeout_ms) checks[check_count].value.cmd_value.timeout_ms = timeout_ms;
+                            checks[check_count].stats_key = check_stats_key(var_name, check_name, check_str);
+                            definition_hash = hash_string(definition_hash, check_name);
+                            definition_hash = hash_string(definition_hash, check_str);
+                            definition_hash = hash_string(definition_hash, pure ? "pure" : NULL);
+                            definition_hash = hash_string(definition_hash, timeout_str);
                             check_count++;
                         }
+                        free(url_spec);
                     }
                 }
             }
         }
 
-        // Validate the variable
-        char* env_value = getenv(var_name);
-        int var_result = validate_and_print_env(var_name, env_value, default_value,
-                                              print_value, checks, check_count, errors);
-        if (var_result != ENVIL_OK) {
-            result = var_result;
+        EnvVariable var = {
+            .name = strdup(var_name),
+            .default_value = default_value,
+            .required = (default_value == NULL),
+            .type = var_type,
+            .checks = checks,
+            .check_count = check_count,
+            .definition_hash = hash_string(definition_hash, default_value)
+        };
+        if (!var.name || !add_variable(config, &var)) {
+            free(var.name);
+            free(default_value);
+            cleanup_checks(checks, check_count);
+            result = ENVIL_CONFIG_ERROR;
+            break;
         }
-
-        free(default_value);
-        cleanup_checks(checks, check_count);
     }
 
-    json_object_put(root);
+    json->object_put(root);
+    if (result == ENVIL_OK) result = link_expr_checks(config);
+    if (result == ENVIL_OK) result = compile_config_patterns(config);
     return result;
-}
\ No newline at end of file
+}
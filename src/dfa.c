@@ -0,0 +1,642 @@
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dfa.h"
+#include "hash.h"
+
+#define MAX_STATES 1000
+#define MAX_NODES 20000
+#define MAX_REPEAT 255
+#define MAX_DEPTH 64
+#define STATE_TABLE_SIZE 4096  // Power of two, over twice MAX_STATES
+
+typedef struct {
+    uint64_t bits[4];
+} ByteSet;
+
+static void set_add(ByteSet* set, unsigned char c) {
+    set->bits[c >> 6] |= 1ULL << (c & 63);
+}
+
+static bool set_has(const ByteSet* set, unsigned char c) {
+    return (set->bits[c >> 6] >> (c & 63)) & 1;
+}
+
+static void set_complement(ByteSet* set) {
+    for (int i = 0; i < 4; i++) set->bits[i] = ~set->bits[i];
+}
+
+typedef enum { AST_SET, AST_CONCAT, AST_ALT, AST_REPEAT, AST_BOL, AST_EOL } AstType;
+
+typedef struct {
+    AstType type;
+    int left, right;  // Operands by index; AST_REPEAT has left only
+    int set;          // AST_SET
+    int min, max;     // AST_REPEAT, max -1 for no limit
+} AstNode;
+
+typedef enum { NFA_SET, NFA_SPLIT, NFA_BOL, NFA_EOL, NFA_MATCH } NfaType;
+
+// Thompson NFA node; SET consumes a byte, the others are epsilon moves
+typedef struct {
+    NfaType type;
+    int set;
+    int out, out1;  // out1 for NFA_SPLIT only
+} NfaNode;
+
+typedef struct {
+    const char* pattern;
+    const char* p;
+    char* error;
+    size_t error_size;
+    bool failed;
+    ByteSet* sets;
+    int set_count, set_capacity;
+    AstNode* ast;
+    int ast_count, ast_capacity;
+    NfaNode* nfa;
+    int nfa_count, nfa_capacity;
+} Compiler;
+
+// Records the first error; returns -1 for the callers to pass on
+static int fail(Compiler* c, const char* reason) {
+    if (!c->failed) {
+        snprintf(c->error, c->error_size, "%s at offset %d", reason, (int)(c->p - c->pattern));
+        c->failed = true;
+    }
+    return -1;
+}
+
+static bool reserve(Compiler* c, void** items, int count, int* capacity, size_t size) {
+    if (count < *capacity) return true;
+    int new_capacity = *capacity ? *capacity * 2 : 32;
+    void* grown = realloc(*items, (size_t)new_capacity * size);
+    if (!grown) {
+        fail(c, "out of memory");
+        return false;
+    }
+    *items = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static int new_ast(Compiler* c, AstType type, int left, int right) {
+    if (!reserve(c, (void**)&c->ast, c->ast_count, &c->ast_capacity, sizeof(AstNode))) return -1;
+    c->ast[c->ast_count] = (AstNode){type, left, right, -1, 0, 0};
+    return c->ast_count++;
+}
+
+static int new_set(Compiler* c, const ByteSet* set) {
+    if (!reserve(c, (void**)&c->sets, c->set_count, &c->set_capacity, sizeof(ByteSet))) return -1;
+    c->sets[c->set_count] = *set;
+    int node = new_ast(c, AST_SET, -1, -1);
+    if (node >= 0) c->ast[node].set = c->set_count++;
+    return node;
+}
+
+static int new_nfa(Compiler* c, NfaType type, int set, int out, int out1) {
+    if (c->nfa_count >= MAX_NODES) return fail(c, "pattern too large");
+    if (!reserve(c, (void**)&c->nfa, c->nfa_count, &c->nfa_capacity, sizeof(NfaNode))) return -1;
+    c->nfa[c->nfa_count] = (NfaNode){type, set, out, out1};
+    return c->nfa_count++;
+}
+
+// Character classes of the C locale, which the regex check runs in
+static const struct {
+    const char* name;
+    int (*test)(int);
+} char_classes[] = {
+    {"alpha", isalpha}, {"digit", isdigit}, {"alnum", isalnum}, {"upper", isupper},
+    {"lower", islower}, {"space", isspace}, {"blank", isblank}, {"punct", ispunct},
+    {"print", isprint}, {"graph", isgraph}, {"cntrl", iscntrl}, {"xdigit", isxdigit},
+};
+
+static bool add_class(Compiler* c, const char* name, size_t len, ByteSet* set) {
+    for (size_t i = 0; i < sizeof(char_classes) / sizeof(char_classes[0]); i++) {
+        if (strlen(char_classes[i].name) == len && strncmp(char_classes[i].name, name, len) == 0) {
+            for (int b = 1; b < 256; b++) {
+                if (char_classes[i].test(b)) set_add(set, (unsigned char)b);
+            }
+            return true;
+        }
+    }
+    fail(c, "unknown character class");
+    return false;
+}
+
+// After the [; a ] first is literal, as is a - first or last
+static int parse_bracket(Compiler* c) {
+    ByteSet set = {{0}};
+    bool negate = *c->p == '^';
+    if (negate) c->p++;
+
+    for (bool first = true;; first = false) {
+        unsigned char lo = (unsigned char)*c->p;
+        if (!lo) return fail(c, "unterminated bracket expression");
+        if (lo == ']' && !first) {
+            c->p++;
+            break;
+        }
+        if (lo == '[' && (c->p[1] == '.' || c->p[1] == '=')) return fail(c, "collating elements are not supported");
+        if (lo == '[' && c->p[1] == ':') {
+            const char* name = c->p + 2;
+            const char* end = strstr(name, ":]");
+            if (!end) return fail(c, "unterminated character class");
+            if (!add_class(c, name, (size_t)(end - name), &set)) return -1;
+            c->p = end + 2;
+            if (*c->p == '-' && c->p[1] != ']') return fail(c, "range from a character class");
+            continue;
+        }
+
+        c->p++;
+        unsigned char hi = lo;
+        if (*c->p == '-' && c->p[1] && c->p[1] != ']') {
+            // Ranges follow byte order, which only ASCII shares with every collation
+            hi = (unsigned char)c->p[1];
+            if (lo == '-' || hi == '-' || hi == '[' || lo >= 0x80 || hi >= 0x80 || lo > hi) {
+                return fail(c, "unsupported range");
+            }
+            c->p += 2;
+            if (*c->p == '-' && c->p[1] != ']') return fail(c, "unsupported range");
+        }
+        for (int b = lo; b <= hi; b++) set_add(&set, (unsigned char)b);
+    }
+
+    if (negate) set_complement(&set);
+    return new_set(c, &set);
+}
+
+// After the backslash: the GNU shorthands, or a punctuation character taken literally
+static int parse_escape(Compiler* c) {
+    unsigned char e = (unsigned char)*c->p;
+    if (!e) return fail(c, "trailing backslash");
+    c->p++;
+
+    ByteSet set = {{0}};
+    char lower = (char)tolower(e);
+    if (lower == 'w' || lower == 's') {
+        for (int b = 1; b < 256; b++) {
+            if (lower == 'w' ? isalnum(b) || b == '_' : isspace(b)) set_add(&set, (unsigned char)b);
+        }
+        if (e != lower) set_complement(&set);
+        return new_set(c, &set);
+    }
+    // Back-references, word boundaries and the like
+    if (isalnum(e) || e >= 0x80) {
+        c->p -= 2;  // Point at the backslash
+        return fail(c, "unsupported escape");
+    }
+    set_add(&set, e);
+    return new_set(c, &set);
+}
+
+static int parse_alternation(Compiler* c, int depth);
+
+static int parse_atom(Compiler* c, int depth) {
+    unsigned char ch = (unsigned char)*c->p;
+    ByteSet set = {{0}};
+    switch (ch) {
+    case '(': {
+        c->p++;
+        int inner = parse_alternation(c, depth + 1);
+        if (inner < 0) return -1;
+        if (*c->p != ')') return fail(c, "unmatched (");
+        c->p++;
+        return inner;
+    }
+    case '*': case '+': case '?': case '{':
+        return fail(c, "repetition without an operand");
+    case '[':
+        c->p++;
+        return parse_bracket(c);
+    case '\\':
+        c->p++;
+        return parse_escape(c);
+    case '^':
+        c->p++;
+        return new_ast(c, AST_BOL, -1, -1);
+    case '$':
+        c->p++;
+        return new_ast(c, AST_EOL, -1, -1);
+    case '.':
+        c->p++;
+        set_complement(&set);
+        return new_set(c, &set);
+    default:
+        c->p++;
+        set_add(&set, ch);
+        return new_set(c, &set);
+    }
+}
+
+// After the {: m}, m,} or m,n}; returns 0, or -1 on error
+static int parse_interval(Compiler* c, int* min, int* max) {
+    if (!isdigit((unsigned char)*c->p)) return fail(c, "invalid interval");
+    char* end;
+    long lo = strtol(c->p, &end, 10);
+    long hi = lo;
+    c->p = end;
+    if (*c->p == ',') {
+        c->p++;
+        hi = -1;
+        if (isdigit((unsigned char)*c->p)) {
+            hi = strtol(c->p, &end, 10);
+            c->p = end;
+        }
+    }
+    if (*c->p != '}') return fail(c, "invalid interval");
+    c->p++;
+    if (lo > MAX_REPEAT || hi > MAX_REPEAT || (hi >= 0 && hi < lo)) return fail(c, "unsupported interval");
+    *min = (int)lo;
+    *max = (int)hi;
+    return 0;
+}
+
+static int parse_piece(Compiler* c, int depth) {
+    int atom = parse_atom(c, depth);
+    while (atom >= 0) {
+        int min, max;
+        char ch = *c->p;
+        if (ch == '*' || ch == '+' || ch == '?') {
+            c->p++;
+            min = ch == '+';
+            max = ch == '?' ? 1 : -1;
+        } else if (ch == '{') {
+            c->p++;
+            if (parse_interval(c, &min, &max) < 0) return -1;
+        } else {
+            break;
+        }
+        if (c->ast[atom].type == AST_BOL || c->ast[atom].type == AST_EOL) return fail(c, "repeated anchor");
+
+        int repeat = new_ast(c, AST_REPEAT, atom, -1);
+        if (repeat >= 0) {
+            c->ast[repeat].min = min;
+            c->ast[repeat].max = max;
+        }
+        atom = repeat;
+    }
+    return atom;
+}
+
+static int parse_branch(Compiler* c, int depth) {
+    int branch = -1;
+    while (*c->p && *c->p != '|' && *c->p != ')') {
+        int piece = parse_piece(c, depth);
+        if (piece < 0) return -1;
+        branch = branch < 0 ? piece : new_ast(c, AST_CONCAT, branch, piece);
+        if (branch < 0) return -1;
+    }
+    return branch < 0 ? fail(c, "empty alternative") : branch;
+}
+
+static int parse_alternation(Compiler* c, int depth) {
+    if (depth > MAX_DEPTH) return fail(c, "groups nested too deeply");
+    int alternation = parse_branch(c, depth);
+    while (alternation >= 0 && *c->p == '|') {
+        c->p++;
+        int branch = parse_branch(c, depth);
+        alternation = branch < 0 ? -1 : new_ast(c, AST_ALT, alternation, branch);
+    }
+    return alternation;
+}
+
+// Builds the NFA of an AST node backwards, leading to out; returns its entry
+static int emit(Compiler* c, int index, int out) {
+    AstNode node = c->ast[index];
+    switch (node.type) {
+    case AST_SET:
+        return new_nfa(c, NFA_SET, node.set, out, -1);
+    case AST_BOL:
+        return new_nfa(c, NFA_BOL, -1, out, -1);
+    case AST_EOL:
+        return new_nfa(c, NFA_EOL, -1, out, -1);
+    case AST_CONCAT: {
+        int right = emit(c, node.right, out);
+        return right < 0 ? -1 : emit(c, node.left, right);
+    }
+    case AST_ALT: {
+        int left = emit(c, node.left, out);
+        int right = left < 0 ? -1 : emit(c, node.right, out);
+        return right < 0 ? -1 : new_nfa(c, NFA_SPLIT, -1, left, right);
+    }
+    case AST_REPEAT: {
+        int next = out;
+        if (node.max < 0) {
+            int loop = new_nfa(c, NFA_SPLIT, -1, -1, out);
+            int body = loop < 0 ? -1 : emit(c, node.left, loop);
+            if (body < 0) return -1;
+            c->nfa[loop].out = body;
+            next = loop;
+        } else {
+            // Each optional copy either runs and goes on to the next, or skips to the end
+            for (int i = node.min; i < node.max; i++) {
+                int body = emit(c, node.left, next);
+                next = body < 0 ? -1 : new_nfa(c, NFA_SPLIT, -1, body, out);
+                if (next < 0) return -1;
+            }
+        }
+        for (int i = 0; i < node.min && next >= 0; i++) {
+            next = emit(c, node.left, next);
+        }
+        return next;
+    }
+    }
+    return -1;
+}
+
+// Marks the nodes reached without consuming a byte from the outs of the
+// nodes of type from; true when one of them has type to
+static bool reaches(Compiler* c, NfaType from, NfaType to, int* mark, int* stack) {
+    int top = 0;
+    memset(mark, 0, (size_t)c->nfa_count * sizeof(int));
+    for (int n = 0; n < c->nfa_count; n++) {
+        int out = c->nfa[n].out;
+        if (c->nfa[n].type == from && out >= 0 && !mark[out]) {
+            mark[out] = 1;
+            stack[top++] = out;
+        }
+    }
+    while (top > 0) {
+        const NfaNode* node = &c->nfa[stack[--top]];
+        if (node->type == to) return true;
+        if (node->type == NFA_SET || node->type == NFA_MATCH) continue;
+        int follow[2] = {node->out, node->type == NFA_SPLIT ? node->out1 : -1};
+        for (int f = 0; f < 2; f++) {
+            if (follow[f] >= 0 && !mark[follow[f]]) {
+                mark[follow[f]] = 1;
+                stack[top++] = follow[f];
+            }
+        }
+    }
+    return false;
+}
+
+// glibc lets ^ and $ match next to a newline the match itself consumed, so
+// only anchors at the edges of a match are compiled
+static int check_anchors(Compiler* c) {
+    int* mark = malloc((size_t)c->nfa_count * sizeof(int));
+    int* stack = malloc((size_t)c->nfa_count * sizeof(int));
+    int result = 0;
+    if (!mark || !stack) {
+        result = fail(c, "out of memory");
+    } else if (reaches(c, NFA_SET, NFA_BOL, mark, stack)) {
+        result = fail(c, "^ after other characters is not supported");
+    } else if (reaches(c, NFA_EOL, NFA_SET, mark, stack)) {
+        result = fail(c, "$ before other characters is not supported");
+    }
+    free(mark);
+    free(stack);
+    return result;
+}
+
+// Subset construction state
+typedef struct {
+    const NfaNode* nfa;
+    int nfa_count;
+    int* mark;
+    int generation;
+    int* stack;
+    int* members;          // Sorted NFA nodes of each state, one after another
+    int* offsets;          // State i owns members[offsets[i]..offsets[i + 1])
+    size_t member_capacity;
+    int state_count;
+    int table[STATE_TABLE_SIZE];  // State + 1 by hash of its members, 0 for empty
+} Builder;
+
+static int compare_ints(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// The nodes reachable from seeds without consuming a byte, sorted: SET nodes,
+// MATCH, and EOL nodes unless allow_eol passes through them
+static int closure(Builder* b, const int* seeds, int seed_count, int extra, bool allow_bol, bool allow_eol,
+                   int* result) {
+    b->generation++;
+    int top = 0, count = 0;
+    for (int i = 0; i <= seed_count; i++) {
+        int node = i < seed_count ? seeds[i] : extra;
+        if (node >= 0 && b->mark[node] != b->generation) {
+            b->mark[node] = b->generation;
+            b->stack[top++] = node;
+        }
+    }
+    while (top > 0) {
+        int n = b->stack[--top];
+        const NfaNode* node = &b->nfa[n];
+        int follow[2] = {-1, -1};
+        if (node->type == NFA_SPLIT) {
+            follow[0] = node->out;
+            follow[1] = node->out1;
+        } else if ((node->type == NFA_BOL && allow_bol) || (node->type == NFA_EOL && allow_eol)) {
+            follow[0] = node->out;
+        } else if (node->type != NFA_BOL) {
+            result[count++] = n;
+        }
+        for (int f = 0; f < 2; f++) {
+            if (follow[f] >= 0 && b->mark[follow[f]] != b->generation) {
+                b->mark[follow[f]] = b->generation;
+                b->stack[top++] = follow[f];
+            }
+        }
+    }
+    qsort(result, (size_t)count, sizeof(int), compare_ints);
+    return count;
+}
+
+static bool has_match(const Builder* b, const int* nodes, int count) {
+    for (int i = 0; i < count; i++) {
+        if (b->nfa[nodes[i]].type == NFA_MATCH) return true;
+    }
+    return false;
+}
+
+static int add_state(Builder* b, const int* nodes, int count) {
+    size_t used = (size_t)b->offsets[b->state_count];
+    if (used + (size_t)count > b->member_capacity) {
+        size_t capacity = (used + (size_t)count) * 2;
+        int* members = realloc(b->members, capacity * sizeof(int));
+        if (!members) return -1;
+        b->members = members;
+        b->member_capacity = capacity;
+    }
+    memcpy(b->members + used, nodes, (size_t)count * sizeof(int));
+    b->offsets[b->state_count + 1] = (int)(used + (size_t)count);
+    return b->state_count++;
+}
+
+// The state with these members, added if new; -1 when out of states or memory
+static int find_state(Builder* b, const int* nodes, int count) {
+    uint64_t hash = hash_bytes(HASH_SEED, nodes, (size_t)count * sizeof(int));
+    for (size_t slot = hash & (STATE_TABLE_SIZE - 1);; slot = (slot + 1) & (STATE_TABLE_SIZE - 1)) {
+        int state = b->table[slot] - 1;
+        if (state < 0) {
+            if (b->state_count >= MAX_STATES) return -1;
+            state = add_state(b, nodes, count);
+            if (state >= 0) b->table[slot] = state + 1;
+            return state;
+        }
+        int start = b->offsets[state];
+        if (b->offsets[state + 1] - start == count && memcmp(b->members + start, nodes, (size_t)count * sizeof(int)) == 0) {
+            return state;
+        }
+    }
+}
+
+// Splits the bytes into the classes no set of the pattern tells apart
+static int byte_classes(const Compiler* c, unsigned char* class_of, int* representative) {
+    int classes[256] = {0};
+    int class_count = 1;
+    for (int s = 0; s < c->set_count; s++) {
+        int moved[256];
+        for (int k = 0; k < class_count; k++) moved[k] = -1;
+        int count = class_count;
+        for (int b = 0; b < 256; b++) {
+            if (!set_has(&c->sets[s], (unsigned char)b)) continue;
+            int old = classes[b];
+            if (moved[old] < 0) moved[old] = count++;
+            classes[b] = moved[old];
+        }
+        // Renumber by first byte, dropping the classes a set took whole
+        int renumber[512];
+        for (int k = 0; k < count; k++) renumber[k] = -1;
+        class_count = 0;
+        for (int b = 0; b < 256; b++) {
+            if (renumber[classes[b]] < 0) renumber[classes[b]] = class_count++;
+            classes[b] = renumber[classes[b]];
+        }
+    }
+    for (int k = 0; k < class_count; k++) representative[k] = -1;
+    for (int b = 0; b < 256; b++) {
+        class_of[b] = (unsigned char)classes[b];
+        if (representative[classes[b]] < 0) representative[classes[b]] = b;
+    }
+    return class_count;
+}
+
+static Dfa* build_dfa(Compiler* c, int start) {
+    Dfa* dfa = calloc(1, sizeof(Dfa));
+    Builder* b = calloc(1, sizeof(Builder));
+    int* nodes = malloc((size_t)c->nfa_count * sizeof(int));
+    int* seeds = malloc((size_t)c->nfa_count * sizeof(int));
+    int representative[256];
+    if (b) {
+        b->nfa = c->nfa;
+        b->nfa_count = c->nfa_count;
+        b->mark = calloc((size_t)c->nfa_count, sizeof(int));
+        b->stack = malloc((size_t)c->nfa_count * sizeof(int));
+        b->offsets = malloc((MAX_STATES + 1) * sizeof(int));
+    }
+    if (!dfa || !b || !nodes || !seeds || !b->mark || !b->stack || !b->offsets) {
+        fail(c, "out of memory");
+        goto failed;
+    }
+    dfa->class_count = byte_classes(c, dfa->class_of, representative);
+    b->offsets[0] = 0;
+
+    // Only the first position sees ^
+    int count = closure(b, NULL, 0, start, true, false, nodes);
+    if (has_match(b, nodes, count) || count == 0) {
+        dfa->start = count ? DFA_MATCHED : DFA_DEAD;
+        goto done;
+    }
+    if (add_state(b, nodes, count) < 0) {
+        fail(c, "out of memory");
+        goto failed;
+    }
+
+    dfa->next = malloc((size_t)MAX_STATES * (size_t)dfa->class_count * sizeof(int));
+    dfa->accept_at_end = malloc(MAX_STATES * sizeof(bool));
+    if (!dfa->next || !dfa->accept_at_end) {
+        fail(c, "out of memory");
+        goto failed;
+    }
+
+    for (int state = 0; state < b->state_count; state++) {
+        int first = b->offsets[state], end = b->offsets[state + 1];
+        memcpy(seeds, b->members + first, (size_t)(end - first) * sizeof(int));
+        count = closure(b, seeds, end - first, -1, state == 0, true, nodes);
+        dfa->accept_at_end[state] = has_match(b, nodes, count);
+
+        for (int k = 0; k < dfa->class_count; k++) {
+            // A match may also begin at the next position
+            int seed_count = 0;
+            for (int m = b->offsets[state]; m < b->offsets[state + 1]; m++) {
+                const NfaNode* node = &c->nfa[b->members[m]];
+                if (node->type == NFA_SET && set_has(&c->sets[node->set], (unsigned char)representative[k])) {
+                    seeds[seed_count++] = node->out;
+                }
+            }
+            count = closure(b, seeds, seed_count, start, false, false, nodes);
+
+            int target;
+            if (has_match(b, nodes, count)) {
+                target = DFA_MATCHED;
+            } else if (count == 0) {
+                target = DFA_DEAD;
+            } else if ((target = find_state(b, nodes, count)) < 0) {
+                fail(c, b->state_count >= MAX_STATES ? "pattern needs too many states" : "out of memory");
+                goto failed;
+            }
+            dfa->next[(size_t)state * (size_t)dfa->class_count + (size_t)k] = target;
+        }
+    }
+    dfa->start = 0;
+
+done:
+    dfa->state_count = b->state_count;
+    free(nodes);
+    free(seeds);
+    free(b->mark);
+    free(b->stack);
+    free(b->offsets);
+    free(b->members);
+    free(b);
+    return dfa;
+
+failed:
+    free(nodes);
+    free(seeds);
+    if (b) {
+        free(b->mark);
+        free(b->stack);
+        free(b->offsets);
+        free(b->members);
+        free(b);
+    }
+    free_dfa(dfa);
+    return NULL;
+}
+
+Dfa* compile_dfa(const char* pattern, char* error, size_t error_size) {
+    Compiler c = {.pattern = pattern, .p = pattern, .error = error, .error_size = error_size};
+
+    int ast = parse_alternation(&c, 0);
+    if (ast >= 0 && *c.p) ast = fail(&c, "unmatched )");
+    int match = ast < 0 ? -1 : new_nfa(&c, NFA_MATCH, -1, -1, -1);
+    int start = match < 0 ? -1 : emit(&c, ast, match);
+    if (start >= 0 && check_anchors(&c) < 0) start = -1;
+    Dfa* dfa = start < 0 ? NULL : build_dfa(&c, start);
+
+    free(c.sets);
+    free(c.ast);
+    free(c.nfa);
+    return dfa;
+}
+
+bool dfa_match(const Dfa* dfa, const char* str, size_t len) {
+    int state = dfa->start;
+    for (size_t i = 0; i < len && state >= 0; i++) {
+        state = dfa->next[(size_t)state * (size_t)dfa->class_count + dfa->class_of[(unsigned char)str[i]]];
+    }
+    return state == DFA_MATCHED || (state >= 0 && dfa->accept_at_end[state]);
+}
+
+void free_dfa(Dfa* dfa) {
+    if (!dfa) return;
+    free(dfa->next);
+    free(dfa->accept_at_end);
+    free(dfa);
+}
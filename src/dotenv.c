@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "dotenv.h"
+#include "logger.h"
+
+static int add_entry(EnvFile* file, const char* name, size_t name_len, char* value) {
+    // Later definitions override earlier ones, as in a shell
+    for (int i = 0; i < file->count; i++) {
+        if (strlen(file->entries[i].name) == name_len &&
+            strncmp(file->entries[i].name, name, name_len) == 0) {
+            free(file->entries[i].value);
+            file->entries[i].value = value;
+            return 1;
+        }
+    }
+
+    if (file->count >= file->capacity) {
+        int new_capacity = file->capacity ? file->capacity * 2 : 16;
+        EnvEntry* new_entries = realloc(file->entries, new_capacity * sizeof(EnvEntry));
+        if (!new_entries) return 0;
+        file->entries = new_entries;
+        file->capacity = new_capacity;
+    }
+
+    char* name_copy = strndup(name, name_len);
+    if (!name_copy) return 0;
+
+    file->entries[file->count].name = name_copy;
+    file->entries[file->count].value = value;
+    file->count++;
+    return 1;
+}
+
+// Parses the right-hand side of KEY=VALUE into a newly allocated string
+static char* parse_value(const char* p) {
+    while (*p == ' ' || *p == '\t') p++;
+
+    size_t len = strlen(p);
+    char* value = malloc(len + 1);
+    if (!value) return NULL;
+
+    char* out = value;
+    if (*p == '"' || *p == '\'') {
+        char quote = *p++;
+        while (*p && *p != quote) {
+            if (quote == '"' && *p == '\\' && p[1]) {
+                p++;
+                switch (*p) {
+                    case 'n': *out++ = '\n'; break;
+                    case 't': *out++ = '\t'; break;
+                    default: *out++ = *p; break;
+                }
+                p++;
+                continue;
+            }
+            *out++ = *p++;
+        }
+    } else {
+        // Unquoted values end at an inline comment; trailing blanks are dropped
+        while (*p && !(*p == '#' && out > value && isspace((unsigned char)out[-1]))) {
+            *out++ = *p++;
+        }
+        while (out > value && isspace((unsigned char)out[-1])) out--;
+    }
+    *out = '\0';
+    return value;
+}
+
+EnvFile* load_env_file(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        logger(LOG_ERROR, "Error: Cannot open env file: %s\n", path);
+        return NULL;
+    }
+
+    EnvFile* file = calloc(1, sizeof(EnvFile));
+    if (!file) {
+        fclose(fp);
+        return NULL;
+    }
+
+    char* line = NULL;
+    size_t line_cap = 0;
+    ssize_t line_len;
+    int line_no = 0;
+
+    while ((line_len = getline(&line, &line_cap, fp)) != -1) {
+        line_no++;
+        while (line_len > 0 && (line[line_len - 1] == '\n' || line[line_len - 1] == '\r')) {
+            line[--line_len] = '\0';
+        }
+
+        const char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '#') continue;
+
+        if (strncmp(p, "export", 6) == 0 && (p[6] == ' ' || p[6] == '\t')) {
+            p += 6;
+            while (*p == ' ' || *p == '\t') p++;
+        }
+
+        const char* name = p;
+        while (*p && (isalnum((unsigned char)*p) || *p == '_' || *p == '.' || *p == '-')) p++;
+        size_t name_len = p - name;
+        while (*p == ' ' || *p == '\t') p++;
+
+        if (name_len == 0 || *p != '=') {
+            logger(LOG_WARNING, "Ignoring malformed line %d in %s", line_no, path);
+            continue;
+        }
+
+        char* value = parse_value(p + 1);
+        if (!value || !add_entry(file, name, name_len, value)) {
+            free(value);
+            logger(LOG_ERROR, "Failed to allocate memory for env file entry\n");
+            free(line);
+            fclose(fp);
+            free_env_file(file);
+            return NULL;
+        }
+    }
+
+    free(line);
+    fclose(fp);
+    return file;
+}
+
+const char* env_file_get(const EnvFile* file, const char* name) {
+    if (!file || !name) return NULL;
+
+    for (int i = 0; i < file->count; i++) {
+        if (strcmp(file->entries[i].name, name) == 0) {
+            return file->entries[i].value;
+        }
+    }
+    return NULL;
+}
+
+void free_env_file(EnvFile* file) {
+    if (!file) return;
+
+    for (int i = 0; i < file->count; i++) {
+        free(file->entries[i].name);
+        free(file->entries[i].value);
+    }
+    free(file->entries);
+    free(file);
+}
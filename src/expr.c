@@ -0,0 +1,674 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "expr.h"
+#include "types.h"
+#include "validator.h"
+
+// Deepest operand stack a compiled expression may need, checked at compile time
+#define EXPR_MAX_STACK 32
+// Deepest nesting of parentheses and unary operators the parser recurses into
+#define EXPR_MAX_NESTING 64
+
+typedef enum {
+    OP_CONST,    // u16 constant index
+    OP_SELF,     // The validated value
+    OP_VAR,      // u16 name index
+    OP_NOT,
+    OP_NEG,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_LEN,
+    OP_DEFINED,
+    OP_NUM,
+    OP_JUMP_IF_FALSE,  // u16 target; keeps the operand when jumping, pops it otherwise
+    OP_JUMP_IF_TRUE,
+    OP_END
+} Opcode;
+
+typedef enum {
+    VAL_NULL,
+    VAL_BOOL,
+    VAL_NUMBER,
+    VAL_STRING
+} ValueKind;
+
+typedef struct {
+    ValueKind kind;
+    union {
+        bool boolean;
+        Number number;
+        const char* string;  // Terminated: a constant or an environment value
+    };
+} ExprValue;
+
+typedef struct {
+    char* name;
+    int variable;  // Config variable index, -1 when looked up by name
+} ExprName;
+
+struct Expr {
+    char* source;
+    uint8_t* code;
+    size_t code_len;
+    size_t code_capacity;
+    ExprValue* constants;
+    int constant_count;
+    int constant_capacity;
+    char* strings;  // Unescaped string literals; never longer than the source
+    size_t strings_len;
+    ExprName* names;
+    int name_count;
+    int name_capacity;
+};
+
+static _Thread_local const ExprEnv* current_env = NULL;
+
+void set_expr_env(const ExprEnv* env) {
+    current_env = env;
+}
+
+// --- Compiler ---
+
+typedef struct {
+    Expr* expr;
+    const char* src;
+    size_t pos;
+    int depth;  // Operands on the stack at this point of the program
+    int nesting;
+    char* error;
+    size_t error_size;
+    bool failed;
+} Compiler;
+
+static void compile_error(Compiler* c, const char* message) {
+    if (c->failed) return;
+    c->failed = true;
+    snprintf(c->error, c->error_size, "%s at column %zu", message, c->pos + 1);
+}
+
+static void skip_space(Compiler* c) {
+    while (c->src[c->pos] == ' ' || c->src[c->pos] == '\t' || c->src[c->pos] == '\n') c->pos++;
+}
+
+// Consumes an operator if it comes next
+static bool accept(Compiler* c, const char* token) {
+    skip_space(c);
+    size_t len = strlen(token);
+    if (strncmp(c->src + c->pos, token, len) != 0) return false;
+    c->pos += len;
+    return true;
+}
+
+static void emit_byte(Compiler* c, uint8_t byte) {
+    Expr* e = c->expr;
+    if (e->code_len == e->code_capacity) {
+        size_t capacity = e->code_capacity ? e->code_capacity * 2 : 32;
+        uint8_t* code = capacity <= UINT16_MAX + 1 ? realloc(e->code, capacity) : NULL;
+        if (!code) {
+            compile_error(c, "expression too long");
+            return;
+        }
+        e->code = code;
+        e->code_capacity = capacity;
+    }
+    e->code[e->code_len++] = byte;
+}
+
+static void emit_u16(Compiler* c, size_t value) {
+    emit_byte(c, (uint8_t)(value & 0xff));
+    emit_byte(c, (uint8_t)(value >> 8));
+}
+
+// Emits an instruction and tracks how it changes the stack depth
+static void emit_op(Compiler* c, Opcode op, int stack_effect) {
+    emit_byte(c, (uint8_t)op);
+    c->depth += stack_effect;
+    if (c->depth > EXPR_MAX_STACK) compile_error(c, "expression too deep");
+}
+
+static void emit_constant(Compiler* c, ExprValue value) {
+    Expr* e = c->expr;
+    if (e->constant_count == e->constant_capacity) {
+        int capacity = e->constant_capacity ? e->constant_capacity * 2 : 8;
+        ExprValue* constants = capacity <= UINT16_MAX ? realloc(e->constants, (size_t)capacity * sizeof(ExprValue)) : NULL;
+        if (!constants) {
+            compile_error(c, "too many constants");
+            return;
+        }
+        e->constants = constants;
+        e->constant_capacity = capacity;
+    }
+    e->constants[e->constant_count] = value;
+    emit_op(c, OP_CONST, 1);
+    emit_u16(c, (size_t)e->constant_count++);
+}
+
+static void emit_variable(Compiler* c, const char* name, size_t len) {
+    Expr* e = c->expr;
+    int index = 0;
+    while (index < e->name_count && (strlen(e->names[index].name) != len || strncmp(e->names[index].name, name, len) != 0)) {
+        index++;
+    }
+    if (index == e->name_count) {
+        if (e->name_count == e->name_capacity) {
+            int capacity = e->name_capacity ? e->name_capacity * 2 : 4;
+            ExprName* names = capacity <= UINT16_MAX ? realloc(e->names, (size_t)capacity * sizeof(ExprName)) : NULL;
+            if (!names) {
+                compile_error(c, "too many variables");
+                return;
+            }
+            e->names = names;
+            e->name_capacity = capacity;
+        }
+        char* copy = strndup(name, len);
+        if (!copy) {
+            compile_error(c, "out of memory");
+            return;
+        }
+        e->names[e->name_count++] = (ExprName){copy, -1};
+    }
+    emit_op(c, OP_VAR, 1);
+    emit_u16(c, (size_t)index);
+}
+
+// Emits a jump with a placeholder target, returning where to patch it
+static size_t emit_jump(Compiler* c, Opcode op) {
+    emit_op(c, op, -1);  // Pops the operand when not jumping
+    size_t at = c->expr->code_len;
+    emit_u16(c, 0);
+    return at;
+}
+
+static void patch_jump(Compiler* c, size_t at) {
+    if (c->failed) return;
+    size_t target = c->expr->code_len;
+    c->expr->code[at] = (uint8_t)(target & 0xff);
+    c->expr->code[at + 1] = (uint8_t)(target >> 8);
+}
+
+static bool is_ident_start(char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+static bool is_ident_char(char ch) {
+    return is_ident_start(ch) || (ch >= '0' && ch <= '9');
+}
+
+static void parse_or(Compiler* c);
+
+static void parse_string(Compiler* c) {
+    Expr* e = c->expr;
+    char quote = c->src[c->pos++];
+    char* out = e->strings + e->strings_len;
+    size_t len = 0;
+    while (c->src[c->pos] != quote) {
+        if (c->src[c->pos] == '\0') {
+            compile_error(c, "unterminated string");
+            return;
+        }
+        if (c->src[c->pos] == '\\' && c->src[c->pos + 1] != '\0') c->pos++;
+        out[len++] = c->src[c->pos++];
+    }
+    c->pos++;
+    out[len] = '\0';
+    e->strings_len += len + 1;
+    emit_constant(c, (ExprValue){.kind = VAL_STRING, .string = out});
+}
+
+static void parse_number_literal(Compiler* c) {
+    // Digits, a fraction and units, e.g. 42, 0.5, 30s, 1h30m, 512Mi or 5µs
+    size_t start = c->pos;
+    while (is_ident_char(c->src[c->pos]) || c->src[c->pos] == '.' ||
+           (unsigned char)c->src[c->pos] == 0xc2 || (unsigned char)c->src[c->pos] == 0xb5) {
+        c->pos++;
+    }
+
+    char token[64];
+    size_t len = c->pos - start;
+    ExprValue value = {.kind = VAL_NUMBER};
+    if (len >= sizeof(token)) {
+        compile_error(c, "invalid number");
+        return;
+    }
+    memcpy(token, c->src + start, len);
+    token[len] = '\0';
+    if (!parse_threshold(token, &value.number)) {
+        c->pos = start;
+        compile_error(c, "invalid number");
+        return;
+    }
+    emit_constant(c, value);
+}
+
+static void parse_call(Compiler* c, const char* name, size_t len) {
+    Opcode op;
+    if (len == 3 && strncmp(name, "len", 3) == 0) op = OP_LEN;
+    else if (len == 7 && strncmp(name, "defined", 7) == 0) op = OP_DEFINED;
+    else if (len == 3 && strncmp(name, "num", 3) == 0) op = OP_NUM;
+    else {
+        compile_error(c, "unknown function");
+        return;
+    }
+
+    c->pos++;  // The '('
+    parse_or(c);
+    if (!accept(c, ")")) {
+        compile_error(c, "expected ')'");
+        return;
+    }
+    emit_op(c, op, 0);
+}
+
+static void parse_primary(Compiler* c) {
+    skip_space(c);
+    char ch = c->src[c->pos];
+
+    if (ch == '(') {
+        c->pos++;
+        parse_or(c);
+        if (!accept(c, ")")) compile_error(c, "expected ')'");
+    } else if (ch == '"' || ch == '\'') {
+        parse_string(c);
+    } else if ((ch >= '0' && ch <= '9') || (ch == '.' && c->src[c->pos + 1] >= '0' && c->src[c->pos + 1] <= '9')) {
+        parse_number_literal(c);
+    } else if (is_ident_start(ch)) {
+        const char* name = c->src + c->pos;
+        size_t len = 0;
+        while (is_ident_char(name[len])) len++;
+        c->pos += len;
+
+        if (len == 4 && strncmp(name, "true", 4) == 0) {
+            emit_constant(c, (ExprValue){.kind = VAL_BOOL, .boolean = true});
+        } else if (len == 5 && strncmp(name, "false", 5) == 0) {
+            emit_constant(c, (ExprValue){.kind = VAL_BOOL, .boolean = false});
+        } else if (len == 4 && strncmp(name, "null", 4) == 0) {
+            emit_constant(c, (ExprValue){.kind = VAL_NULL});
+        } else if (len == 5 && strncmp(name, "value", 5) == 0) {
+            emit_op(c, OP_SELF, 1);
+        } else {
+            skip_space(c);
+            if (c->src[c->pos] == '(') parse_call(c, name, len);
+            else emit_variable(c, name, len);
+        }
+    } else {
+        compile_error(c, ch ? "unexpected character" : "unexpected end of expression");
+    }
+}
+
+static void parse_unary(Compiler* c) {
+    if (++c->nesting > EXPR_MAX_NESTING) {
+        compile_error(c, "expression nested too deeply");
+        return;
+    }
+    if (accept(c, "!")) {
+        if (c->src[c->pos] == '=') {
+            compile_error(c, "unexpected '='");
+            return;
+        }
+        parse_unary(c);
+        emit_op(c, OP_NOT, 0);
+    } else if (accept(c, "-")) {
+        parse_unary(c);
+        emit_op(c, OP_NEG, 0);
+    } else {
+        parse_primary(c);
+    }
+    c->nesting--;
+}
+
+static void parse_multiplicative(Compiler* c) {
+    parse_unary(c);
+    while (!c->failed) {
+        Opcode op;
+        if (accept(c, "*")) op = OP_MUL;
+        else if (accept(c, "/")) op = OP_DIV;
+        else if (accept(c, "%")) op = OP_MOD;
+        else break;
+        parse_unary(c);
+        emit_op(c, op, -1);
+    }
+}
+
+static void parse_additive(Compiler* c) {
+    parse_multiplicative(c);
+    while (!c->failed) {
+        Opcode op;
+        if (accept(c, "+")) op = OP_ADD;
+        else if (accept(c, "-")) op = OP_SUB;
+        else break;
+        parse_multiplicative(c);
+        emit_op(c, op, -1);
+    }
+}
+
+static bool accept_comparison(Compiler* c, Opcode* op) {
+    if (accept(c, "==")) *op = OP_EQ;
+    else if (accept(c, "!=")) *op = OP_NE;
+    else if (accept(c, "<=")) *op = OP_LE;
+    else if (accept(c, ">=")) *op = OP_GE;
+    else if (accept(c, "<")) *op = OP_LT;
+    else if (accept(c, ">")) *op = OP_GT;
+    else return false;
+    return true;
+}
+
+static void parse_comparison(Compiler* c) {
+    parse_additive(c);
+    Opcode op;
+    if (!c->failed && accept_comparison(c, &op)) {
+        parse_additive(c);
+        emit_op(c, op, -1);
+        if (!c->failed && accept_comparison(c, &op)) compile_error(c, "comparisons do not chain, use &&");
+    }
+}
+
+static void parse_and(Compiler* c) {
+    parse_comparison(c);
+    while (!c->failed && accept(c, "&&")) {
+        size_t jump = emit_jump(c, OP_JUMP_IF_FALSE);
+        parse_comparison(c);
+        patch_jump(c, jump);
+    }
+}
+
+static void parse_or(Compiler* c) {
+    parse_and(c);
+    while (!c->failed && accept(c, "||")) {
+        size_t jump = emit_jump(c, OP_JUMP_IF_TRUE);
+        parse_and(c);
+        patch_jump(c, jump);
+    }
+}
+
+Expr* compile_expr(const char* source, char* error, size_t error_size) {
+    Expr* expr = calloc(1, sizeof(Expr));
+    if (!expr) return NULL;
+    expr->source = strdup(source);
+    expr->strings = malloc(strlen(source) + 1);
+    if (!expr->source || !expr->strings) {
+        snprintf(error, error_size, "out of memory");
+        free_expr(expr);
+        return NULL;
+    }
+
+    Compiler c = {.expr = expr, .src = source, .error = error, .error_size = error_size};
+    parse_or(&c);
+    skip_space(&c);
+    if (!c.failed && source[c.pos] != '\0') compile_error(&c, "unexpected character");
+    emit_op(&c, OP_END, 0);
+
+    if (c.failed) {
+        free_expr(expr);
+        return NULL;
+    }
+    return expr;
+}
+
+void free_expr(Expr* expr) {
+    if (!expr) return;
+    for (int i = 0; i < expr->name_count; i++) {
+        free(expr->names[i].name);
+    }
+    free(expr->names);
+    free(expr->constants);
+    free(expr->strings);
+    free(expr->code);
+    free(expr->source);
+    free(expr);
+}
+
+const char* expr_source(const Expr* expr) {
+    return expr->source;
+}
+
+int expr_name_count(const Expr* expr) {
+    return expr->name_count;
+}
+
+const char* expr_name(const Expr* expr, int index) {
+    return expr->names[index].name;
+}
+
+void bind_expr_name(Expr* expr, int index, int variable) {
+    expr->names[index].variable = variable;
+}
+
+int expr_name_binding(const Expr* expr, int index) {
+    return expr->names[index].variable;
+}
+
+// --- Virtual machine ---
+
+// "true", "yes", "1", "on" and their opposites; -1 for anything else
+static int bool_word(const char* str) {
+    if (strcmp(str, "true") == 0 || strcmp(str, "yes") == 0 || strcmp(str, "1") == 0 || strcmp(str, "on") == 0) return 1;
+    if (strcmp(str, "false") == 0 || strcmp(str, "no") == 0 || strcmp(str, "0") == 0 ||
+        strcmp(str, "off") == 0 || *str == '\0') {
+        return 0;
+    }
+    return -1;
+}
+
+static bool is_truthy(const ExprValue* v) {
+    switch (v->kind) {
+        case VAL_BOOL: return v->boolean;
+        case VAL_NUMBER: return v->number.is_float ? v->number.float_value != 0 : v->number.int_value != 0;
+        case VAL_STRING: return bool_word(v->string) != 0;
+        default: return false;
+    }
+}
+
+static bool to_number(const ExprValue* v, Number* number) {
+    switch (v->kind) {
+        case VAL_NUMBER:
+            *number = v->number;
+            return true;
+        case VAL_BOOL:
+            *number = (Number){.int_value = v->boolean, .float_value = v->boolean};
+            return true;
+        case VAL_STRING:
+            return parse_threshold(v->string, number);
+        default:
+            return false;
+    }
+}
+
+// Orders two values; false when they are unordered (null, mixed units, a string and a number)
+static bool order_values(const ExprValue* a, const ExprValue* b, int* cmp) {
+    if (a->kind == VAL_NULL || b->kind == VAL_NULL) return false;
+
+    Number x, y;
+    if (a->kind == VAL_STRING && b->kind == VAL_STRING) {
+        if (parse_threshold(a->string, &x) && parse_threshold(b->string, &y) && x.unit == y.unit) {
+            return compare_numbers(&x, &y, cmp);
+        }
+        int order = strcmp(a->string, b->string);
+        *cmp = (order > 0) - (order < 0);
+        return true;
+    }
+    if (!to_number(a, &x) || !to_number(b, &y) || x.unit != y.unit) return false;
+    return compare_numbers(&x, &y, cmp);
+}
+
+static bool values_equal(const ExprValue* a, const ExprValue* b) {
+    if (a->kind == VAL_NULL || b->kind == VAL_NULL) return a->kind == b->kind;
+    if (a->kind == VAL_BOOL || b->kind == VAL_BOOL) {
+        const ExprValue* other = a->kind == VAL_BOOL ? b : a;
+        if (other->kind == VAL_STRING && bool_word(other->string) < 0) return false;
+        return is_truthy(a) == is_truthy(b);
+    }
+    int cmp;
+    return order_values(a, b, &cmp) && cmp == 0;
+}
+
+static double as_double(const Number* n) {
+    return n->is_float ? n->float_value : (double)n->int_value;
+}
+
+static bool arithmetic(Opcode op, const Number* a, const Number* b, Number* out) {
+    if (a->unit != UNIT_NONE && b->unit != UNIT_NONE && a->unit != b->unit) return false;
+    *out = (Number){.unit = a->unit != UNIT_NONE ? a->unit : b->unit};
+
+    if (!a->is_float && !b->is_float) {
+        int64_t x = a->int_value, y = b->int_value, r = 0;
+        bool overflow = false;
+        switch (op) {
+            case OP_ADD: overflow = __builtin_add_overflow(x, y, &r); break;
+            case OP_SUB: overflow = __builtin_sub_overflow(x, y, &r); break;
+            case OP_MUL: overflow = __builtin_mul_overflow(x, y, &r); break;
+            case OP_DIV:
+            case OP_MOD:
+                if (y == 0) return false;
+                // Exact quotients stay integers, others fall through to doubles
+                overflow = (x == INT64_MIN && y == -1) || (op == OP_DIV && x % y != 0);
+                if (!overflow) r = op == OP_DIV ? x / y : x % y;
+                break;
+            default: return false;
+        }
+        if (!overflow) {
+            out->int_value = r;
+            out->float_value = (double)r;
+            return true;
+        }
+    }
+
+    double x = as_double(a), y = as_double(b), r;
+    switch (op) {
+        case OP_ADD: r = x + y; break;
+        case OP_SUB: r = x - y; break;
+        case OP_MUL: r = x * y; break;
+        case OP_DIV: if (y == 0) return false; r = x / y; break;
+        case OP_MOD: if (y == 0) return false; r = fmod(x, y); break;
+        default: return false;
+    }
+    out->is_float = true;
+    out->float_value = r;
+    return true;
+}
+
+static ExprValue string_or_null(const char* str) {
+    return str ? (ExprValue){.kind = VAL_STRING, .string = str} : (ExprValue){.kind = VAL_NULL};
+}
+
+ExprResult eval_expr(const Expr* expr, const char* value) {
+    ExprValue stack[EXPR_MAX_STACK];
+    int sp = 0;
+    const uint8_t* code = expr->code;
+    size_t pc = 0;
+    const ExprEnv* env = current_env;
+
+    for (;;) {
+        Opcode op = (Opcode)code[pc++];
+        switch (op) {
+            case OP_CONST: {
+                unsigned index = code[pc] | code[pc + 1] << 8;
+                pc += 2;
+                stack[sp++] = expr->constants[index];
+                break;
+            }
+            case OP_SELF:
+                stack[sp++] = string_or_null(value);
+                break;
+            case OP_VAR: {
+                const ExprName* name = &expr->names[code[pc] | code[pc + 1] << 8];
+                pc += 2;
+                const char* str;
+                if (env && name->variable >= 0) {
+                    if (env->invalid && env->invalid[name->variable]) return EXPR_SKIPPED;
+                    str = env->values[name->variable];
+                } else if (env && env->lookup) {
+                    str = env->lookup(name->name, env->lookup_data);
+                } else {
+                    str = getenv(name->name);
+                }
+                stack[sp++] = string_or_null(str);
+                break;
+            }
+            case OP_NOT:
+                stack[sp - 1] = (ExprValue){.kind = VAL_BOOL, .boolean = !is_truthy(&stack[sp - 1])};
+                break;
+            case OP_NEG: {
+                Number n;
+                if (!to_number(&stack[sp - 1], &n)) return EXPR_ERROR;
+                if (n.is_float || n.int_value == INT64_MIN) {
+                    n.float_value = -as_double(&n);
+                    n.is_float = true;
+                } else {
+                    n.int_value = -n.int_value;
+                    n.float_value = (double)n.int_value;
+                }
+                stack[sp - 1] = (ExprValue){.kind = VAL_NUMBER, .number = n};
+                break;
+            }
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+            case OP_DIV:
+            case OP_MOD: {
+                Number a, b, r;
+                sp--;
+                if (!to_number(&stack[sp - 1], &a) || !to_number(&stack[sp], &b) || !arithmetic(op, &a, &b, &r)) {
+                    return EXPR_ERROR;
+                }
+                stack[sp - 1] = (ExprValue){.kind = VAL_NUMBER, .number = r};
+                break;
+            }
+            case OP_EQ:
+            case OP_NE: {
+                sp--;
+                bool equal = values_equal(&stack[sp - 1], &stack[sp]);
+                stack[sp - 1] = (ExprValue){.kind = VAL_BOOL, .boolean = op == OP_EQ ? equal : !equal};
+                break;
+            }
+            case OP_LT:
+            case OP_LE:
+            case OP_GT:
+            case OP_GE: {
+                sp--;
+                int cmp;
+                bool holds = order_values(&stack[sp - 1], &stack[sp], &cmp) &&
+                             (op == OP_LT ? cmp < 0 : op == OP_LE ? cmp <= 0 : op == OP_GT ? cmp > 0 : cmp >= 0);
+                stack[sp - 1] = (ExprValue){.kind = VAL_BOOL, .boolean = holds};
+                break;
+            }
+            case OP_LEN: {
+                ExprValue* v = &stack[sp - 1];
+                if (v->kind != VAL_STRING && v->kind != VAL_NULL) return EXPR_ERROR;
+                int64_t len = v->kind == VAL_STRING ? (int64_t)strlen(v->string) : 0;
+                *v = (ExprValue){.kind = VAL_NUMBER, .number = {.int_value = len, .float_value = (double)len}};
+                break;
+            }
+            case OP_DEFINED:
+                stack[sp - 1] = (ExprValue){.kind = VAL_BOOL, .boolean = stack[sp - 1].kind != VAL_NULL};
+                break;
+            case OP_NUM: {
+                Number n;
+                if (!to_number(&stack[sp - 1], &n)) return EXPR_ERROR;
+                stack[sp - 1] = (ExprValue){.kind = VAL_NUMBER, .number = n};
+                break;
+            }
+            case OP_JUMP_IF_FALSE:
+            case OP_JUMP_IF_TRUE: {
+                size_t target = code[pc] | code[pc + 1] << 8;
+                pc += 2;
+                if (is_truthy(&stack[sp - 1]) == (op == OP_JUMP_IF_TRUE)) pc = target;
+                else sp--;
+                break;
+            }
+            case OP_END:
+                return is_truthy(&stack[sp - 1]) ? EXPR_TRUE : EXPR_FALSE;
+        }
+    }
+}
@@ -0,0 +1,327 @@
+#include <stdlib.h>
+#include <string.h>
+#include "formats.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define CHAR_HEX      (1u << 0)
+#define CHAR_BASE64   (1u << 1)  // A-Z a-z 0-9 + /
+#define CHAR_BASE64URL (1u << 2) // A-Z a-z 0-9 - _
+#define CHAR_DIGIT    (1u << 3)
+#define CHAR_IDENT    (1u << 4)  // semver identifiers: A-Z a-z 0-9 -
+
+static const uint8_t char_class[256] = {
+    ['0' ... '9'] = CHAR_HEX | CHAR_BASE64 | CHAR_BASE64URL | CHAR_DIGIT | CHAR_IDENT,
+    ['A' ... 'F'] = CHAR_HEX | CHAR_BASE64 | CHAR_BASE64URL | CHAR_IDENT,
+    ['a' ... 'f'] = CHAR_HEX | CHAR_BASE64 | CHAR_BASE64URL | CHAR_IDENT,
+    ['G' ... 'Z'] = CHAR_BASE64 | CHAR_BASE64URL | CHAR_IDENT,
+    ['g' ... 'z'] = CHAR_BASE64 | CHAR_BASE64URL | CHAR_IDENT,
+    ['+'] = CHAR_BASE64,
+    ['/'] = CHAR_BASE64,
+    ['-'] = CHAR_BASE64URL | CHAR_IDENT,
+    ['_'] = CHAR_BASE64URL,
+};
+
+// Value of a base64 digit in either alphabet
+static unsigned base64_value(unsigned char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    return (c == '+' || c == '-') ? 62 : 63;
+}
+
+static unsigned hex_digit(unsigned char c) {
+    if (c <= '9') return c - '0';
+    return (c | 0x20) - 'a' + 10;
+}
+
+#ifdef __SSE2__
+// Bytes of v within [lo, hi]; all bounds are ASCII, so bytes >= 0x80, which
+// compare as negative, never match
+static inline __m128i in_range(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(lo - 1))),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8((char)(hi + 1))));
+}
+#endif
+
+// Length of the prefix made of characters in class, 16 bytes at a time when possible
+static size_t span_class(const char* str, size_t len, unsigned class) {
+    size_t i = 0;
+#ifdef __SSE2__
+    if (class == CHAR_HEX || class == CHAR_BASE64 || class == CHAR_BASE64URL) {
+        for (; i + 16 <= len; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+            __m128i ok = in_range(v, '0', '9');
+            if (class == CHAR_HEX) {
+                // Setting 0x20 folds A-F onto a-f and nothing else onto them
+                ok = _mm_or_si128(ok, in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'f'));
+            } else {
+                ok = _mm_or_si128(ok, in_range(v, 'A', 'Z'));
+                ok = _mm_or_si128(ok, in_range(v, 'a', 'z'));
+                char c62 = class == CHAR_BASE64 ? '+' : '-';
+                char c63 = class == CHAR_BASE64 ? '/' : '_';
+                ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8(c62)));
+                ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8(c63)));
+            }
+            if (_mm_movemask_epi8(ok) != 0xffff) break;
+        }
+    }
+#endif
+    while (i < len && (char_class[(unsigned char)str[i]] & class)) i++;
+    return i;
+}
+
+bool parse_uuid(const char* str, size_t len, int* version) {
+    static const size_t group_ends[] = {8, 13, 18, 23, 36};
+    if (len != 36) return false;
+
+    size_t start = 0;
+    for (int g = 0; g < 5; g++) {
+        size_t end = group_ends[g];
+        if (span_class(str + start, end - start, CHAR_HEX) != end - start) return false;
+        if (g < 4 && str[end] != '-') return false;
+        start = end + 1;
+    }
+
+    // Versions are only defined for the RFC 9562 variant (10xx)
+    bool rfc_variant = (hex_digit((unsigned char)str[19]) & 0xc) == 0x8;
+    if (version) *version = rfc_variant ? (int)hex_digit((unsigned char)str[14]) : 0;
+    return true;
+}
+
+bool parse_base64(const char* str, size_t len, bool url, size_t* decoded_len) {
+    unsigned class = url ? CHAR_BASE64URL : CHAR_BASE64;
+
+    if (len == 0) return false;
+
+    size_t padding = 0;
+    while (padding < 2 && padding < len && str[len - 1 - padding] == '=') padding++;
+    size_t digits = len - padding;
+
+    // Standard base64 is always padded; in base64url padding is optional,
+    // but when present it must complete the last group
+    if (!url || padding) {
+        if (len % 4 != 0) return false;
+    }
+    if (digits % 4 == 1) return false;
+    if (padding && digits % 4 != 4 - padding) return false;
+    if (span_class(str, digits, class) != digits) return false;
+
+    // Canonical form: bits past the encoded bytes are zero
+    size_t tail = digits % 4;
+    if (tail) {
+        unsigned last = base64_value((unsigned char)str[digits - 1]);
+        if (last & (tail == 2 ? 0x0f : 0x03)) return false;
+    }
+
+    if (decoded_len) *decoded_len = digits / 4 * 3 + (tail ? tail - 1 : 0);
+    return true;
+}
+
+bool parse_hex(const char* str, size_t len, size_t* decoded_len) {
+    if (len == 0 || len % 2 != 0 || span_class(str, len, CHAR_HEX) != len) return false;
+    if (decoded_len) *decoded_len = len / 2;
+    return true;
+}
+
+// Parses a numeric identifier: digits, no leading zero, no overflow
+static bool parse_numeric(const char* str, size_t len, uint64_t* value) {
+    if (len == 0 || (str[0] == '0' && len > 1)) return false;
+    uint64_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!(char_class[(unsigned char)str[i]] & CHAR_DIGIT)) return false;
+        unsigned digit = (unsigned)(str[i] - '0');
+        if (n > (UINT64_MAX - digit) / 10) return false;
+        n = n * 10 + digit;
+    }
+    *value = n;
+    return true;
+}
+
+// Checks dot-separated identifiers; numeric ones may not have leading zeros
+static bool valid_identifiers(const char* str, size_t len, bool check_numeric) {
+    size_t start = 0;
+    for (size_t i = 0; i <= len; i++) {
+        if (i < len && str[i] != '.') {
+            if (!(char_class[(unsigned char)str[i]] & CHAR_IDENT)) return false;
+            continue;
+        }
+        size_t id_len = i - start;
+        if (id_len == 0) return false;
+        if (check_numeric && span_class(str + start, id_len, CHAR_DIGIT) == id_len &&
+            str[start] == '0' && id_len > 1) {
+            return false;
+        }
+        start = i + 1;
+    }
+    return true;
+}
+
+bool parse_semver(const char* str, size_t len, Semver* version) {
+    memset(version, 0, sizeof(*version));
+
+    // Build metadata does not take part in precedence, only its syntax is checked
+    const char* plus = memchr(str, '+', len);
+    if (plus) {
+        if (!valid_identifiers(plus + 1, len - (size_t)(plus + 1 - str), false)) return false;
+        len = (size_t)(plus - str);
+    }
+
+    const char* dash = memchr(str, '-', len);
+    size_t core_len = dash ? (size_t)(dash - str) : len;
+    if (dash) {
+        version->prerelease = dash + 1;
+        version->prerelease_len = len - core_len - 1;
+        if (!valid_identifiers(version->prerelease, version->prerelease_len, true)) return false;
+    }
+
+    // A pre-release or build needs all three parts; ranges may give fewer otherwise
+    uint64_t* fields[] = {&version->major, &version->minor, &version->patch};
+    size_t start = 0;
+    for (int part = 0; part < 3; part++) {
+        size_t end = start;
+        while (end < core_len && str[end] != '.') end++;
+        if (!parse_numeric(str + start, end - start, fields[part])) return false;
+        version->parts = part + 1;
+        if (end == core_len) return version->parts == 3 || (!dash && !plus);
+        start = end + 1;
+    }
+    return false;  // A fourth part
+}
+
+// Orders two pre-release identifiers: numeric ones numerically and below alphanumeric ones
+static int compare_identifier(const char* a, size_t a_len, const char* b, size_t b_len) {
+    uint64_t a_num, b_num;
+    bool a_numeric = parse_numeric(a, a_len, &a_num);
+    bool b_numeric = parse_numeric(b, b_len, &b_num);
+    if (a_numeric && b_numeric) return a_num < b_num ? -1 : a_num > b_num;
+    if (a_numeric != b_numeric) return a_numeric ? -1 : 1;
+
+    int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp) return cmp;
+    return a_len < b_len ? -1 : a_len > b_len;
+}
+
+static int compare_prerelease(const Semver* a, const Semver* b) {
+    // A version without pre-release ranks above any with one
+    if (!a->prerelease || !b->prerelease) return !a->prerelease - !b->prerelease;
+
+    const char* pa = a->prerelease;
+    const char* pb = b->prerelease;
+    const char* a_end = pa + a->prerelease_len;
+    const char* b_end = pb + b->prerelease_len;
+    while (pa < a_end && pb < b_end) {
+        const char* a_dot = memchr(pa, '.', (size_t)(a_end - pa));
+        const char* b_dot = memchr(pb, '.', (size_t)(b_end - pb));
+        if (!a_dot) a_dot = a_end;
+        if (!b_dot) b_dot = b_end;
+        int cmp = compare_identifier(pa, (size_t)(a_dot - pa), pb, (size_t)(b_dot - pb));
+        if (cmp) return cmp;
+        pa = a_dot + 1;
+        pb = b_dot + 1;
+    }
+    // More identifiers rank higher when all before are equal
+    return (pa < a_end) - (pb < b_end);
+}
+
+int compare_semver(const Semver* a, const Semver* b) {
+    if (a->major != b->major) return a->major < b->major ? -1 : 1;
+    if (b->parts < 2) return 0;
+    if (a->minor != b->minor) return a->minor < b->minor ? -1 : 1;
+    if (b->parts < 3) return 0;
+    if (a->patch != b->patch) return a->patch < b->patch ? -1 : 1;
+    return compare_prerelease(a, b);
+}
+
+SemverRange* parse_semver_range(const char* str) {
+    // Every comparator takes at least one character and a separator
+    size_t text_len = strlen(str);
+    size_t max_count = text_len / 2 + 1;
+    SemverRange* range = malloc(sizeof(SemverRange) + max_count * sizeof(SemverComparator));
+    if (!range) return NULL;
+    range->text = strdup(str);
+    range->count = 0;
+    if (!range->text) {
+        free(range);
+        return NULL;
+    }
+    if (strcmp(str, "any") == 0) return range;
+
+    const char* p = range->text;
+    bool starts_set = true;
+    while (*p) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+
+        if (p[0] == '|' && p[1] == '|') {
+            // An empty alternative is a mistake, not "any"
+            if (starts_set) break;
+            starts_set = true;
+            p += 2;
+            continue;
+        }
+
+        char op = '=';
+        if ((p[0] == '>' || p[0] == '<') && p[1] == '=') {
+            op = p[0] == '>' ? 'g' : 'l';
+            p += 2;
+        } else if (*p == '>' || *p == '<' || *p == '=') {
+            op = *p++;
+        }
+
+        const char* end = p;
+        while (*end && *end != ' ' && *end != '|') end++;
+
+        SemverComparator* comparator = &range->comparators[range->count];
+        if (end == p || !parse_semver(p, (size_t)(end - p), &comparator->version)) {
+            free_semver_range(range);
+            return NULL;
+        }
+        comparator->op = op;
+        comparator->starts_set = starts_set;
+        starts_set = false;
+        range->count++;
+        p = end;
+    }
+
+    // Trailing "||" or nothing but separators
+    if (starts_set) {
+        free_semver_range(range);
+        return NULL;
+    }
+    return range;
+}
+
+static bool comparator_matches(const SemverComparator* comparator, const Semver* version) {
+    int cmp = compare_semver(version, &comparator->version);
+    switch (comparator->op) {
+        case '<': return cmp < 0;
+        case '>': return cmp > 0;
+        case 'l': return cmp <= 0;
+        case 'g': return cmp >= 0;
+        default: return cmp == 0;
+    }
+}
+
+bool semver_in_range(const SemverRange* range, const Semver* version) {
+    if (range->count == 0) return true;
+
+    bool set_matches = false;
+    for (int i = 0; i < range->count; i++) {
+        const SemverComparator* comparator = &range->comparators[i];
+        if (comparator->starts_set) {
+            if (i > 0 && set_matches) return true;
+            set_matches = true;
+        }
+        if (set_matches && !comparator_matches(comparator, version)) set_matches = false;
+    }
+    return set_matches;
+}
+
+void free_semver_range(SemverRange* range) {
+    if (!range) return;
+    free(range->text);
+    free(range);
+}
@@ -0,0 +1,178 @@
+#define _GNU_SOURCE  // statx()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "fscheck.h"
+#include "logger.h"
+
+#if __has_include(<linux/io_uring.h>) && defined(SYS_io_uring_setup)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+
+// Below this many paths, setting up a ring costs more than it saves
+#define URING_MIN_BATCH 4
+#define URING_ENTRIES 64
+
+#define STATX_WANTED (STATX_TYPE | STATX_MODE | STATX_SIZE)
+
+typedef struct {
+    const char* path;
+    int error;
+    struct statx stx;
+} PathStat;
+
+typedef struct {
+    PathStat* entries;
+    int count;
+} PathStats;
+
+static _Thread_local PathStats prefetched = {0};
+
+bool is_fs_check(const char* check_name) {
+    return strcmp(check_name, "path_exists") == 0 || strcmp(check_name, "file") == 0 ||
+           strcmp(check_name, "dir") == 0 || strcmp(check_name, "socket") == 0 ||
+           strcmp(check_name, "readable") == 0 || strcmp(check_name, "writable") == 0 ||
+           strcmp(check_name, "max_size") == 0;
+}
+
+static void stat_one(PathStat* entry) {
+    entry->error = statx(AT_FDCWD, entry->path, 0, STATX_WANTED, &entry->stx) == 0 ? 0 : errno;
+}
+
+#ifdef HAVE_IO_URING
+// Issues all statx calls through one ring, URING_ENTRIES at a time
+static bool stat_batch_uring(PathStat* entries, int count) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ring_fd = (int)syscall(SYS_io_uring_setup, URING_ENTRIES, &params);
+    if (ring_fd < 0) return false;  // Unsupported or forbidden (e.g. by seccomp)
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap && cq_size > sq_size) sq_size = cq_size;
+
+    uint8_t* sq_ring = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd, IORING_OFF_SQ_RING);
+    uint8_t* cq_ring = single_mmap ? sq_ring
+                                   : mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                          ring_fd, IORING_OFF_CQ_RING);
+    size_t sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    struct io_uring_sqe* sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                     ring_fd, IORING_OFF_SQES);
+
+    bool ok = sq_ring != MAP_FAILED && cq_ring != MAP_FAILED && sqes != MAP_FAILED;
+    for (int done = 0; ok && done < count;) {
+        int batch = count - done < (int)params.sq_entries ? count - done : (int)params.sq_entries;
+
+        unsigned* sq_tail = (unsigned*)(sq_ring + params.sq_off.tail);
+        unsigned sq_mask = *(unsigned*)(sq_ring + params.sq_off.ring_mask);
+        unsigned* sq_array = (unsigned*)(sq_ring + params.sq_off.array);
+        unsigned tail = *sq_tail;
+        for (int i = 0; i < batch; i++) {
+            PathStat* entry = &entries[done + i];
+            unsigned index = tail & sq_mask;
+            struct io_uring_sqe* sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (uintptr_t)entry->path;
+            sqe->len = STATX_WANTED;
+            sqe->off = (uintptr_t)&entry->stx;
+            sqe->user_data = (uint64_t)(done + i);
+            sq_array[index] = index;
+            tail++;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        unsigned* cq_head = (unsigned*)(cq_ring + params.cq_off.head);
+        unsigned* cq_tail = (unsigned*)(cq_ring + params.cq_off.tail);
+        unsigned cq_mask = *(unsigned*)(cq_ring + params.cq_off.ring_mask);
+        struct io_uring_cqe* cqes = (struct io_uring_cqe*)(cq_ring + params.cq_off.cqes);
+
+        int to_submit = batch;
+        int reaped = 0;
+        while (reaped < batch) {
+            int entered = (int)syscall(SYS_io_uring_enter, ring_fd, to_submit, batch - reaped,
+                                       IORING_ENTER_GETEVENTS, NULL, 0);
+            if (entered < 0) {
+                if (errno == EINTR) continue;
+                ok = false;
+                break;
+            }
+            to_submit -= entered < to_submit ? entered : to_submit;
+
+            unsigned head = *cq_head;
+            while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                struct io_uring_cqe* cqe = &cqes[head & cq_mask];
+                PathStat* entry = &entries[cqe->user_data];
+                if (cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP) {
+                    stat_one(entry);  // Kernel without IORING_OP_STATX
+                } else {
+                    entry->error = cqe->res < 0 ? -cqe->res : 0;
+                }
+                head++;
+                reaped++;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        done += batch;
+    }
+
+    if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+    if (!single_mmap && cq_ring != MAP_FAILED) munmap(cq_ring, cq_size);
+    if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_size);
+    close(ring_fd);
+    return ok;
+}
+#endif
+
+void prefetch_path_stats(const char* const* paths, int count) {
+    clear_path_stats();
+    if (count <= 0) return;
+
+    PathStat* entries = calloc((size_t)count, sizeof(PathStat));
+    if (!entries) return;  // The checks stat on their own
+    for (int i = 0; i < count; i++) {
+        entries[i].path = paths[i];
+    }
+
+    bool batched = false;
+#ifdef HAVE_IO_URING
+    if (count >= URING_MIN_BATCH) {
+        batched = stat_batch_uring(entries, count);
+        logger(LOG_DEBUG, "Stat'ed %d paths %s", count, batched ? "through io_uring" : "one by one");
+    }
+#endif
+    if (!batched) {
+        for (int i = 0; i < count; i++) stat_one(&entries[i]);
+    }
+
+    prefetched.entries = entries;
+    prefetched.count = count;
+}
+
+void clear_path_stats(void) {
+    free(prefetched.entries);
+    prefetched.entries = NULL;
+    prefetched.count = 0;
+}
+
+int stat_path(const char* path, struct statx* stx) {
+    for (int i = 0; i < prefetched.count; i++) {
+        const PathStat* entry = &prefetched.entries[i];
+        if (entry->path == path || strcmp(entry->path, path) == 0) {
+            if (entry->error == 0) *stx = entry->stx;
+            return entry->error;
+        }
+    }
+    return statx(AT_FDCWD, path, 0, STATX_WANTED, stx) == 0 ? 0 : errno;
+}
@@ -0,0 +1,20 @@
+#include <string.h>
+#include "hash.h"
+
+#define HASH_PRIME 0x100000001b3ULL
+
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t len) {
+    const unsigned char* p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+uint64_t hash_string(uint64_t hash, const char* str) {
+    // Hash the terminator too, so that ("ab", "c") and ("a", "bc") differ
+    // and NULL hashes differently from ""
+    if (!str) return hash_bytes(hash, "\xff", 1);
+    return hash_bytes(hash, str, strlen(str) + 1);
+}
@@ -0,0 +1,281 @@
+#include <stdint.h>
+#include <string.h>
+#include "jsonscan.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Outcome of skipping the space between two tokens
+enum {
+    SPACE_OK,
+    SPACE_BAD_COMMENT,   // A '/' that starts no comment
+    SPACE_OPEN_COMMENT,  // The input ends inside a comment
+};
+
+static inline bool is_ws(unsigned char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline bool is_digit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool is_hex(unsigned char c) {
+    return is_digit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+// Skips whitespace, /* */ and // comments
+static const unsigned char* skip_space(const unsigned char* p, const unsigned char* end, int* status) {
+    *status = SPACE_OK;
+    for (;;) {
+        while (p < end && is_ws(*p)) p++;
+        if (p >= end || *p != '/') return p;
+
+        if (end - p < 2 || (p[1] != '*' && p[1] != '/')) {
+            *status = SPACE_BAD_COMMENT;
+            return p;
+        }
+        if (p[1] == '/') {
+            p = memchr(p + 2, '\n', end - p - 2);
+        } else {
+            // As in json-c, the byte after a '*' is consumed with it: "/***/" is
+            // still open
+            const unsigned char* q = p + 2;
+            p = NULL;
+            while (q < end && (q = memchr(q, '*', end - q)) && end - q > 1) {
+                if (q[1] == '/') {
+                    p = q + 1;
+                    break;
+                }
+                q += 2;
+            }
+        }
+        if (!p) {
+            *status = SPACE_OPEN_COMMENT;
+            return end;
+        }
+        p++;
+    }
+}
+
+// Scans a string body after the opening quote, returns the position after the closing quote
+static const unsigned char* scan_string(const unsigned char* p, const unsigned char* end, unsigned char quote) {
+    for (;;) {
+#ifdef __SSE2__
+        // Skip plain runs 16 bytes at a time
+        const __m128i quotes = _mm_set1_epi8((char)quote);
+        const __m128i escape = _mm_set1_epi8('\\');
+        while (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+            unsigned mask = (unsigned)_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, escape)));
+            if (mask) {
+                p += __builtin_ctz(mask);
+                break;
+            }
+            p += 16;
+        }
+#endif
+        while (p < end && *p != quote && *p != '\\') p++;
+        if (p >= end) return NULL;
+        if (*p == quote) return p + 1;
+
+        if (end - p < 2) return NULL;
+        switch (p[1]) {
+            case '"': case '\\': case '/': case 'b':
+            case 'f': case 'n': case 'r': case 't':
+                p += 2;
+                break;
+            case 'u':
+                if (end - p < 6 || !is_hex(p[2]) || !is_hex(p[3]) ||
+                    !is_hex(p[4]) || !is_hex(p[5])) {
+                    return NULL;
+                }
+                p += 6;
+                break;
+            default:
+                return NULL;
+        }
+    }
+}
+
+// Matches literal case-insensitively, as json-c does outside strict mode
+static const unsigned char* scan_literal(const unsigned char* p, const unsigned char* end,
+                                         const char* literal, size_t len) {
+    if ((size_t)(end - p) < len) return NULL;
+    for (size_t i = 0; i < len; i++) {
+        if ((p[i] | 0x20) != literal[i]) return NULL;
+    }
+    return p + len;
+}
+
+// Full match of strtod's decimal syntax, which json-c requires of a number
+// with a fraction or exponent: -?([0-9]+\.?[0-9]*|\.[0-9]+)([eE][+-]?[0-9]+)?
+static bool is_decimal(const unsigned char* p, const unsigned char* end) {
+    if (*p == '-') p++;
+    const unsigned char* digits = p;
+    while (p < end && is_digit(*p)) p++;
+    size_t mantissa = p - digits;
+    if (p < end && *p == '.') {
+        p++;
+        digits = p;
+        while (p < end && is_digit(*p)) p++;
+        mantissa += p - digits;
+    }
+    if (mantissa == 0) return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) p++;
+        if (p >= end || !is_digit(*p)) return false;
+        while (p < end && is_digit(*p)) p++;
+    }
+    return p == end;
+}
+
+// Takes the characters json-c's tokener takes for a number, then checks them
+// the way json-c converts them. Integers are not range checked: json-c clamps.
+static const unsigned char* scan_number(const unsigned char* p, const unsigned char* end, bool nested) {
+    const unsigned char* start = p;
+    bool is_double = false, is_exponent = false;
+    bool neg_sign_ok = true, pos_sign_ok = false;
+
+    while (p < end && (is_digit(*p) || (!is_exponent && (*p == 'e' || *p == 'E')) ||
+                       (neg_sign_ok && *p == '-') || (pos_sign_ok && *p == '+') ||
+                       (!is_double && *p == '.'))) {
+        neg_sign_ok = pos_sign_ok = false;
+        if (*p == '.') {
+            is_double = true;
+            neg_sign_ok = pos_sign_ok = true;
+        } else if (*p == 'e' || *p == 'E') {
+            is_double = is_exponent = true;
+            neg_sign_ok = pos_sign_ok = true;
+        }
+        p++;
+    }
+
+    // Inside a container the number must end on a delimiter; at the top level
+    // whatever follows is left unread
+    unsigned char next = p < end ? *p : '\0';
+    if (nested && next != ',' && next != ']' && next != '}' && next != '/' &&
+        next != 'I' && next != 'i' && !is_ws(next)) {
+        return NULL;
+    }
+    if (p - start == 1 && *start == '-' && (next == 'I' || next == 'i')) {
+        return scan_literal(p, end, "infinity", 8);
+    }
+    if (is_double) {
+        // Dangling exponent and sign characters are dropped, so "1e+" reads as 1
+        const unsigned char* last = p;
+        while (last - start > 1 && (last[-1] == 'e' || last[-1] == 'E' ||
+                                    last[-1] == '+' || last[-1] == '-')) {
+            last--;
+        }
+        return is_decimal(start, last) ? p : NULL;
+    }
+    return p - start > (*start == '-') ? p : NULL;
+}
+
+bool json_validate(const char* str, size_t len) {
+    if (!str) return false;
+
+    const unsigned char* p = (const unsigned char*)str;
+    // json-c reads up to the first NUL
+    const unsigned char* end = p + strnlen(str, len);
+    uint32_t stack = 0;  // Bit per open container: 1 = object, 0 = array
+    int depth = 0;
+    bool is_null = false;  // The last complete value, which json-c returns as NULL
+    int status;
+
+    p = skip_space(p, end, &status);
+    if (status != SPACE_OK) return false;
+
+value:
+    if (p >= end || depth >= JSON_MAX_DEPTH) return false;
+    is_null = false;
+    switch (*p) {
+        case '{':
+            p = skip_space(p + 1, end, &status);
+            if (status != SPACE_OK) return false;
+            if (p < end && *p == '}') {
+                p++;
+                goto after_value;
+            }
+            stack = (stack << 1) | 1;
+            depth++;
+            goto object_key;
+        case '[':
+            p = skip_space(p + 1, end, &status);
+            if (status != SPACE_OK) return false;
+            if (p < end && *p == ']') {
+                p++;
+                goto after_value;
+            }
+            stack <<= 1;
+            depth++;
+            goto value;
+        case '"': case '\'':
+            p = scan_string(p + 1, end, *p);
+            break;
+        case 't': case 'T':
+            p = scan_literal(p, end, "true", 4);
+            break;
+        case 'f': case 'F':
+            p = scan_literal(p, end, "false", 5);
+            break;
+        case 'n': case 'N':
+            if (end - p > 1 && (p[1] | 0x20) == 'a') {
+                p = scan_literal(p, end, "nan", 3);
+            } else {
+                p = scan_literal(p, end, "null", 4);
+                is_null = true;
+            }
+            break;
+        case 'i': case 'I':
+            p = scan_literal(p, end, "infinity", 8);
+            break;
+        case '-': case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            p = scan_number(p, end, depth > 0);
+            break;
+        default:
+            return false;
+    }
+    if (!p) return false;
+
+after_value:
+    p = skip_space(p, end, &status);
+    if (status == SPACE_BAD_COMMENT) return false;
+    // json-c stops at the end of the top-level value, and hands back the value
+    // it was on when the input runs out inside a comment
+    if (depth == 0 || status == SPACE_OPEN_COMMENT) return !is_null;
+    if (p >= end) return false;
+
+    if (*p == ',') {
+        // A trailing comma before the closing bracket is allowed
+        p = skip_space(p + 1, end, &status);
+        if (status != SPACE_OK) return false;
+        if (p < end && *p == ((stack & 1) ? '}' : ']')) goto close;
+        if (stack & 1) goto object_key;
+        goto value;
+    }
+    if (*p != ((stack & 1) ? '}' : ']')) return false;
+
+close:
+    p++;
+    stack >>= 1;
+    depth--;
+    is_null = false;
+    goto after_value;
+
+object_key:
+    if (p >= end || (*p != '"' && *p != '\'')) return false;
+    p = scan_string(p + 1, end, *p);
+    if (!p) return false;
+    p = skip_space(p, end, &status);
+    if (status != SPACE_OK || p >= end || *p != ':') return false;
+    p = skip_space(p + 1, end, &status);
+    if (status != SPACE_OK) return false;
+    goto value;
+}
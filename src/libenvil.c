@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "envil.h"
+#include "config.h"
+#include "checks.h"
+#include "logger.h"
+#include "validator.h"
+#include "plugin.h"
+
+struct EnvilContext {
+    CheckRegistry registry;  // Registered checks, each owning its name, description and hooks
+    LogTarget log;
+    EnvilLogFunction log_fn;
+    void* log_data;
+};
+
+struct EnvilPlan {
+    const EnvilContext* context;
+    Config* config;
+};
+
+// Adapts the internal logger callback to the public one
+static void forward_log(LogLevel level, const char* message, void* user_data) {
+    const EnvilContext* ctx = user_data;
+    ctx->log_fn((int)level, message, ctx->log_data);
+}
+
+EnvilContext* envil_context_new(void) {
+    EnvilContext* ctx = calloc(1, sizeof(EnvilContext));
+    if (!ctx) return NULL;
+
+    init_check_registry(&ctx->registry);
+    ctx->log.level = LOG_ERROR;
+    return ctx;
+}
+
+void envil_context_free(EnvilContext* ctx) {
+    if (!ctx) return;
+
+    forget_plugins(&ctx->registry);
+    for (int i = 0; i < ctx->registry.count; i++) {
+        free((char*)ctx->registry.definitions[i].name);
+        free((char*)ctx->registry.definitions[i].description);
+        free(ctx->registry.definitions[i].custom_data);
+    }
+    free(ctx);
+}
+
+void envil_context_set_log(EnvilContext* ctx, int level, EnvilLogFunction log_fn, void* user_data) {
+    if (!ctx) return;
+
+    ctx->log.level = (LogLevel)level;
+    ctx->log.log_fn = log_fn ? forward_log : NULL;
+    ctx->log.user_data = ctx;
+    ctx->log_fn = log_fn;
+    ctx->log_data = user_data;
+}
+
+int envil_context_register_check(EnvilContext* ctx, const char* name, const char* description,
+                                 EnvilCheckFunction check_fn, int has_arg) {
+    if (!ctx || !name || !check_fn) return ENVIL_CONFIG_ERROR;
+    if (registry_find_check(&ctx->registry, name)) return ENVIL_CONFIG_ERROR;
+
+    char* name_copy = strdup(name);
+    char* description_copy = strdup(description ? description : "");
+    const CheckDefinition* def = NULL;
+    if (name_copy && description_copy) {
+        def = registry_add_check(&ctx->registry, name_copy, description_copy, check_fn,
+                                 NULL, has_arg, "Invalid value");
+    }
+    if (!def) {
+        free(name_copy);
+        free(description_copy);
+        return ENVIL_CONFIG_ERROR;
+    }
+    return ENVIL_OK;
+}
+
+int envil_context_load_plugin(EnvilContext* ctx, const char* path) {
+    if (!ctx || !path) return ENVIL_CONFIG_ERROR;
+
+    const LogTarget* previous = logger_use(&ctx->log);
+    int result = load_plugin(&ctx->registry, path);
+    logger_use(previous);
+    return result;
+}
+
+EnvilPlan* envil_plan_load(EnvilContext* ctx, const char* config_path) {
+    if (!ctx) return NULL;
+
+    EnvilPlan* plan = calloc(1, sizeof(EnvilPlan));
+    if (!plan) return NULL;
+
+    const LogTarget* previous = logger_use(&ctx->log);
+    plan->context = ctx;
+    plan->config = load_config_with_registry(config_path, &ctx->registry);
+    logger_use(previous);
+
+    if (!plan->config) {
+        free(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+void envil_plan_free(EnvilPlan* plan) {
+    if (!plan) return;
+
+    free_config(plan->config);
+    free(plan);
+}
+
+int envil_validate(const EnvilPlan* plan, EnvilLookupFunction lookup, void* lookup_data,
+                   EnvilSinkFunction sink, void* sink_data) {
+    if (!plan) return ENVIL_CONFIG_ERROR;
+    ValidationErrors* errors = create_validation_errors();
+    if (!errors) return ENVIL_CONFIG_ERROR;
+
+    const LogTarget* previous = logger_use(&plan->context->log);
+    int result = validate_config_lookup(plan->config, lookup, lookup_data, false, errors, NULL);
+    logger_use(previous);
+
+    if (sink) {
+        for (int i = 0; i < errors->count; i++) {
+            // Messages are shared with the CLI, which ends some with a newline
+            char* message = errors->errors[i].message;
+            size_t len = strlen(message);
+            if (len > 0 && message[len - 1] == '\n') message[len - 1] = '\0';
+            sink(errors->errors[i].name, message, errors->errors[i].error_code, sink_data);
+        }
+    }
+
+    free_validation_errors(errors);
+    return result;
+}
@@ -4,8 +4,29 @@
 #include "logger.h"
 #include "types.h"
 
+// Per-thread override, so library callers each log through their own context
+static _Thread_local const LogTarget* active_target = NULL;
+
+const LogTarget* logger_use(const LogTarget* target) {
+    const LogTarget* previous = active_target;
+    active_target = target;
+    return previous;
+}
+
 void logger(LogLevel level, const char* message, ...) {
-    if (level > g_log_level) return;  // Only log if current level is verbose enough
+    const LogTarget* target = active_target;
+    LogLevel max_level = target ? target->level : g_log_level;
+    if (level > max_level) return;  // Only log if current level is verbose enough
+
+    if (target && target->log_fn) {
+        char buffer[1024];
+        va_list args;
+        va_start(args, message);
+        vsnprintf(buffer, sizeof(buffer), message, args);
+        va_end(args);
+        target->log_fn(level, buffer, target->user_data);
+        return;
+    }
     
     // Add prefix based on log level
     const char* prefix;
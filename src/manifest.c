@@ -0,0 +1,672 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "manifest.h"
+#include "parsers.h"
+#include "config.h"
+#include "checks.h"
+#include "logger.h"
+#include "validator.h"
+
+#define MANIFEST_MAX_DEPTH 64
+#define MANIFEST_MAX_THREADS 16
+
+// What a node is, judged from where it sits; only these nodes are looked into
+typedef enum {
+    ROLE_NONE,
+    ROLE_ROOT,
+    ROLE_METADATA,
+    ROLE_CONTAINERS,   // A containers: or initContainers: list
+    ROLE_CONTAINER,
+    ROLE_ENV,          // A container's env: list
+    ROLE_ENV_ENTRY,
+    ROLE_SERVICES,
+    ROLE_SERVICE,
+    ROLE_ENVIRONMENT,  // A service's environment:, a mapping or a KEY=VALUE list
+} FrameRole;
+
+typedef struct {
+    FrameRole role;
+    bool is_mapping;
+    bool expect_key;
+    char* key;  // Key of the mapping value being read
+    unsigned key_line;
+} Frame;
+
+typedef enum {
+    SCALAR_TEXT,
+    SCALAR_NULL,   // Empty, ~ or null
+    SCALAR_ALIAS,  // *anchor, not resolved
+} ScalarKind;
+
+typedef struct {
+    ManifestFile* manifest;
+    Frame frames[MANIFEST_MAX_DEPTH];
+    int depth;           // May pass MANIFEST_MAX_DEPTH; deeper nodes are skipped
+    int document_first;  // First container of the current document
+    char* kind;
+    char* name;
+    int container;       // Open container or service, -1 outside one
+    char* entry_name;    // Open env entry
+    char* entry_value;
+    bool entry_literal;
+    bool failed;         // Out of memory
+} ManifestParser;
+
+static Frame* top_frame(ManifestParser* p) {
+    return p->depth > 0 && p->depth <= MANIFEST_MAX_DEPTH ? &p->frames[p->depth - 1] : NULL;
+}
+
+static bool key_is(const Frame* frame, const char* key) {
+    return frame->is_mapping && frame->key && strcmp(frame->key, key) == 0;
+}
+
+static char* dup_or_fail(ManifestParser* p, const char* str, size_t len) {
+    char* copy = strndup(str, len);
+    if (!copy) p->failed = true;
+    return copy;
+}
+
+static void add_container(ManifestParser* p, const char* resource, const char* name, unsigned line) {
+    ManifestFile* manifest = p->manifest;
+    if (manifest->count == manifest->capacity) {
+        int capacity = manifest->capacity ? manifest->capacity * 2 : 8;
+        ManifestContainer* containers = realloc(manifest->containers, (size_t)capacity * sizeof(ManifestContainer));
+        if (!containers) {
+            p->failed = true;
+            return;
+        }
+        manifest->containers = containers;
+        manifest->capacity = capacity;
+    }
+    ManifestContainer* container = &manifest->containers[manifest->count];
+    memset(container, 0, sizeof(*container));
+    container->line = line;
+    container->resource = resource ? dup_or_fail(p, resource, strlen(resource)) : NULL;
+    container->container = name ? dup_or_fail(p, name, strlen(name)) : NULL;
+    p->container = manifest->count++;
+}
+
+static void add_var(ManifestParser* p, const char* name, size_t name_len, const char* value, size_t value_len) {
+    if (p->container < 0) return;
+    ManifestContainer* container = &p->manifest->containers[p->container];
+    if (container->var_count == container->var_capacity) {
+        int capacity = container->var_capacity ? container->var_capacity * 2 : 8;
+        ManifestVar* vars = realloc(container->vars, (size_t)capacity * sizeof(ManifestVar));
+        if (!vars) {
+            p->failed = true;
+            return;
+        }
+        container->vars = vars;
+        container->var_capacity = capacity;
+    }
+    ManifestVar* var = &container->vars[container->var_count++];
+    var->name = dup_or_fail(p, name, name_len);
+    var->value = value ? dup_or_fail(p, value, value_len) : NULL;
+}
+
+// A compose value with its $$ escapes undone; NULL when it interpolates ($VAR, ${VAR})
+static char* compose_literal(ManifestParser* p, const char* value, size_t len, size_t* out_len) {
+    char* literal = malloc(len + 1);
+    if (!literal) {
+        p->failed = true;
+        return NULL;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (value[i] == '$') {
+            if (i + 1 < len && value[i + 1] == '$') {
+                i++;
+            } else if (i + 1 < len && (value[i + 1] == '{' || value[i + 1] == '_' ||
+                                      (value[i + 1] >= 'A' && value[i + 1] <= 'Z') ||
+                                      (value[i + 1] >= 'a' && value[i + 1] <= 'z'))) {
+                free(literal);
+                return NULL;
+            }
+        }
+        literal[n++] = value[i];
+    }
+    literal[n] = '\0';
+    *out_len = n;
+    return literal;
+}
+
+static void add_compose_var(ManifestParser* p, const char* name, size_t name_len,
+                            const char* value, size_t value_len, bool literal) {
+    size_t len = 0;
+    char* unescaped = literal ? compose_literal(p, value, value_len, &len) : NULL;
+    add_var(p, name, name_len, unescaped, len);
+    free(unescaped);
+}
+
+static void finish_env_entry(ManifestParser* p) {
+    if (p->entry_name) {
+        // A Kubernetes entry without value or valueFrom sets the variable to ""
+        const char* value = p->entry_literal ? (p->entry_value ? p->entry_value : "") : NULL;
+        add_var(p, p->entry_name, strlen(p->entry_name), value, value ? strlen(value) : 0);
+    }
+    free(p->entry_name);
+    free(p->entry_value);
+    p->entry_name = NULL;
+    p->entry_value = NULL;
+    p->entry_literal = true;
+}
+
+// A value scalar (or alias) in the frame it belongs to
+static void scalar_value(ManifestParser* p, Frame* frame, const char* value, size_t len, ScalarKind kind) {
+    bool text = kind == SCALAR_TEXT;
+    switch (frame->role) {
+        case ROLE_ROOT:
+            if (text && key_is(frame, "kind") && !p->kind) p->kind = dup_or_fail(p, value, len);
+            break;
+        case ROLE_METADATA:
+            if (text && key_is(frame, "name") && !p->name) p->name = dup_or_fail(p, value, len);
+            break;
+        case ROLE_CONTAINER:
+            if (text && key_is(frame, "name") && p->container >= 0) {
+                ManifestContainer* container = &p->manifest->containers[p->container];
+                free(container->container);
+                container->container = dup_or_fail(p, value, len);
+            }
+            break;
+        case ROLE_ENV_ENTRY:
+            if (key_is(frame, "name") && text) {
+                free(p->entry_name);
+                p->entry_name = dup_or_fail(p, value, len);
+            } else if (key_is(frame, "value")) {
+                if (kind == SCALAR_ALIAS) p->entry_literal = false;
+                free(p->entry_value);
+                p->entry_value = dup_or_fail(p, value, len);
+            }
+            break;
+        case ROLE_SERVICE:
+            if (key_is(frame, "env_file") && p->container >= 0) p->manifest->containers[p->container].open_env = true;
+            break;
+        case ROLE_ENVIRONMENT:
+            if (frame->is_mapping) {
+                // KEY: value; an empty value is taken from the host
+                add_compose_var(p, frame->key, strlen(frame->key), value, len, text);
+            } else if (text) {
+                // KEY=value, or KEY alone for the host's value
+                const char* equals = memchr(value, '=', len);
+                size_t name_len = equals ? (size_t)(equals - value) : len;
+                add_compose_var(p, value, name_len, equals ? equals + 1 : "", equals ? len - name_len - 1 : 0,
+                                equals != NULL);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// A mapping now expects its next key
+static void value_done(ManifestParser* p) {
+    Frame* frame = top_frame(p);
+    if (frame && frame->is_mapping) frame->expect_key = true;
+}
+
+static void on_scalar(ManifestParser* p, const char* value, size_t len, ScalarKind kind, unsigned line) {
+    Frame* frame = top_frame(p);
+    if (!frame) return;
+    if (frame->is_mapping && frame->expect_key) {
+        free(frame->key);
+        frame->key = dup_or_fail(p, value, len);
+        frame->key_line = line;
+        frame->expect_key = false;
+        return;
+    }
+    scalar_value(p, frame, value, len, kind);
+    value_done(p);
+}
+
+static void on_node_start(ManifestParser* p, bool is_mapping, unsigned line) {
+    Frame* parent = top_frame(p);
+    FrameRole role = ROLE_NONE;
+
+    if (p->depth == 0) {
+        if (is_mapping) role = ROLE_ROOT;
+    } else if (parent && parent->is_mapping && parent->key) {
+        switch (parent->role) {
+            case ROLE_ROOT:
+                if (is_mapping && key_is(parent, "metadata")) role = ROLE_METADATA;
+                else if (is_mapping && key_is(parent, "services")) role = ROLE_SERVICES;
+                break;
+            case ROLE_SERVICES:
+                if (is_mapping) {
+                    role = ROLE_SERVICE;
+                    add_container(p, NULL, parent->key, parent->key_line);
+                }
+                break;
+            case ROLE_SERVICE:
+                if (key_is(parent, "environment")) role = ROLE_ENVIRONMENT;
+                else if (key_is(parent, "env_file") && p->container >= 0) {
+                    p->manifest->containers[p->container].open_env = true;
+                }
+                break;
+            case ROLE_CONTAINER:
+                if (!is_mapping && key_is(parent, "env")) role = ROLE_ENV;
+                else if (key_is(parent, "envFrom") && p->container >= 0) {
+                    p->manifest->containers[p->container].open_env = true;
+                }
+                break;
+            case ROLE_ENV_ENTRY:
+                if (key_is(parent, "valueFrom")) p->entry_literal = false;
+                break;
+            default:
+                break;
+        }
+        // Pod specs sit at different depths in each kind of resource
+        if (role == ROLE_NONE && !is_mapping && parent->role != ROLE_ENVIRONMENT &&
+            (key_is(parent, "containers") || key_is(parent, "initContainers"))) {
+            role = ROLE_CONTAINERS;
+        }
+    } else if (parent && !parent->is_mapping && is_mapping) {
+        if (parent->role == ROLE_CONTAINERS) {
+            role = ROLE_CONTAINER;
+            add_container(p, "", NULL, line);  // The resource is known at the end of the document
+        } else if (parent->role == ROLE_ENV) {
+            role = ROLE_ENV_ENTRY;
+            finish_env_entry(p);
+        }
+    }
+
+    if (p->depth < MANIFEST_MAX_DEPTH) {
+        p->frames[p->depth] = (Frame){role, is_mapping, true, NULL, 0};
+    }
+    p->depth++;
+}
+
+static void on_node_end(ManifestParser* p) {
+    Frame* frame = top_frame(p);
+    if (frame) {
+        if (frame->role == ROLE_ENV_ENTRY) finish_env_entry(p);
+        if (frame->role == ROLE_CONTAINER || frame->role == ROLE_SERVICE) p->container = -1;
+        free(frame->key);
+    }
+    p->depth--;
+    value_done(p);
+}
+
+static void on_document_start(ManifestParser* p) {
+    p->document_first = p->manifest->count;
+    p->container = -1;
+}
+
+static void on_document_end(ManifestParser* p) {
+    for (int i = p->document_first; i < p->manifest->count; i++) {
+        ManifestContainer* container = &p->manifest->containers[i];
+        if (!container->resource || !p->kind) continue;
+
+        size_t size = strlen(p->kind) + (p->name ? strlen(p->name) + 1 : 0) + 1;
+        char* resource = malloc(size);
+        if (!resource) {
+            p->failed = true;
+            break;
+        }
+        snprintf(resource, size, "%s%s%s", p->kind, p->name ? "/" : "", p->name ? p->name : "");
+        free(container->resource);
+        container->resource = resource;
+    }
+    free(p->kind);
+    free(p->name);
+    p->kind = NULL;
+    p->name = NULL;
+}
+
+static ScalarKind scalar_kind(const yaml_event_t* event) {
+    const char* value = (const char*)event->data.scalar.value;
+    if (event->data.scalar.style == YAML_PLAIN_SCALAR_STYLE &&
+        (*value == '\0' || strcmp(value, "~") == 0 || strcmp(value, "null") == 0 ||
+         strcmp(value, "Null") == 0 || strcmp(value, "NULL") == 0)) {
+        return SCALAR_NULL;
+    }
+    return SCALAR_TEXT;
+}
+
+int parse_manifest(FILE* file, ManifestFile* manifest, char* error, size_t error_size) {
+    const YamlLibrary* yaml = yaml_library();
+    if (!yaml) {
+        snprintf(error, error_size, "libyaml is not available");
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    yaml_parser_t parser;
+    if (!yaml->parser_initialize(&parser)) {
+        snprintf(error, error_size, "failed to initialize the YAML parser");
+        return ENVIL_CONFIG_ERROR;
+    }
+    yaml->parser_set_input_file(&parser, file);
+
+    ManifestParser p = {.manifest = manifest, .container = -1, .entry_literal = true};
+    int result = ENVIL_OK;
+    for (bool done = false; !done;) {
+        yaml_event_t event;
+        if (!yaml->parser_parse(&parser, &event)) {
+            snprintf(error, error_size, "line %zu: %s", parser.problem_mark.line + 1,
+                     parser.problem ? parser.problem : "invalid YAML");
+            result = ENVIL_CONFIG_ERROR;
+            break;
+        }
+
+        unsigned line = (unsigned)event.start_mark.line + 1;
+        switch (event.type) {
+            case YAML_STREAM_END_EVENT: done = true; break;
+            case YAML_DOCUMENT_START_EVENT: on_document_start(&p); break;
+            case YAML_DOCUMENT_END_EVENT: on_document_end(&p); break;
+            case YAML_MAPPING_START_EVENT: on_node_start(&p, true, line); break;
+            case YAML_SEQUENCE_START_EVENT: on_node_start(&p, false, line); break;
+            case YAML_MAPPING_END_EVENT:
+            case YAML_SEQUENCE_END_EVENT: on_node_end(&p); break;
+            case YAML_SCALAR_EVENT:
+                on_scalar(&p, (const char*)event.data.scalar.value, event.data.scalar.length, scalar_kind(&event),
+                          line);
+                break;
+            case YAML_ALIAS_EVENT: on_scalar(&p, "", 0, SCALAR_ALIAS, line); break;
+            default: break;
+        }
+        yaml->event_delete(&event);
+
+        if (p.failed) {
+            snprintf(error, error_size, "out of memory");
+            result = ENVIL_CONFIG_ERROR;
+            break;
+        }
+    }
+
+    // Left open by a parse error
+    for (int i = 0; i < p.depth && i < MANIFEST_MAX_DEPTH; i++) {
+        free(p.frames[i].key);
+    }
+    free(p.kind);
+    free(p.name);
+    free(p.entry_name);
+    free(p.entry_value);
+    yaml->parser_delete(&parser);
+    return result;
+}
+
+void free_manifest(ManifestFile* manifest) {
+    for (int i = 0; i < manifest->count; i++) {
+        ManifestContainer* container = &manifest->containers[i];
+        for (int j = 0; j < container->var_count; j++) {
+            free(container->vars[j].name);
+            free(container->vars[j].value);
+        }
+        free(container->vars);
+        free(container->resource);
+        free(container->container);
+    }
+    free(manifest->containers);
+    memset(manifest, 0, sizeof(*manifest));
+}
+
+// --- Validation ---
+
+// Later entries win, as in both Kubernetes and compose
+static const ManifestVar* find_manifest_var(const ManifestContainer* container, const char* name) {
+    for (int i = container->var_count - 1; i >= 0; i--) {
+        if (strcmp(container->vars[i].name, name) == 0) return &container->vars[i];
+    }
+    return NULL;
+}
+
+// Serves expr checks reading variables that are not in the config
+static const char* lookup_manifest_var(const char* name, void* user_data) {
+    const ManifestVar* var = find_manifest_var(user_data, name);
+    return var ? var->value : NULL;
+}
+
+static void write_container_label(const ManifestContainer* container, FILE* out) {
+    const char* name = container->container ? container->container : "(unnamed)";
+    if (!container->resource) fprintf(out, "service %s", name);
+    else if (*container->resource) fprintf(out, "%s, container %s", container->resource, name);
+    else fprintf(out, "container %s", name);
+}
+
+static void free_envp(char** envp) {
+    for (char** entry = envp; entry && *entry; entry++) free(*entry);
+    free(envp);
+}
+
+// The container's literal variables as NAME=VALUE entries, for pattern keys
+static char** container_envp(const ManifestContainer* container) {
+    char** envp = calloc((size_t)container->var_count + 1, sizeof(char*));
+    if (!envp) return NULL;
+    int n = 0;
+    for (int i = 0; i < container->var_count; i++) {
+        const ManifestVar* var = &container->vars[i];
+        // Later entries win, so only the last one of a name is matched
+        if (!var->value || find_manifest_var(container, var->name) != var) continue;
+        size_t size = strlen(var->name) + strlen(var->value) + 2;
+        envp[n] = malloc(size);
+        if (!envp[n]) {
+            free_envp(envp);
+            return NULL;
+        }
+        snprintf(envp[n++], size, "%s=%s", var->name, var->value);
+    }
+    return envp;
+}
+
+static int validate_container(const Config* config, const char* path, const ManifestContainer* container, FILE* out) {
+    int count = config->variable_count;
+    const char** values = calloc((size_t)(count ? count : 1), sizeof(char*));
+    int* known = malloc((size_t)(count ? count : 1) * sizeof(int));
+    ValidationErrors* errors = create_validation_errors();
+    char** envp = config->pattern_set ? container_envp(container) : NULL;
+    int result = ENVIL_CONFIG_ERROR;
+
+    if (values && known && errors && (envp || !config->pattern_set)) {
+        for (int i = 0; i < count; i++) {
+            const EnvVariable* var = &config->variables[i];
+            const ManifestVar* set = find_manifest_var(container, var->name);
+            // Not validated, and counted as failing so expr checks reading it are skipped
+            bool skip = set ? !set->value : container->open_env;
+            known[i] = skip ? ENVIL_MISSING_VAR : VERDICT_PENDING;
+            values[i] = set && set->value ? set->value : var->default_value;
+        }
+        result = validate_config_values(config, values, known, envp, lookup_manifest_var, (void*)container,
+                                        false, errors, NULL);
+
+        fprintf(out, "%s:%u: ", path, container->line);
+        write_container_label(container, out);
+        fprintf(out, ": %s\n", result == ENVIL_OK ? "ok" : "failed");
+        for (int i = 0; i < errors->count; i++) {
+            const char* message = errors->errors[i].message;
+            size_t len = strlen(message);
+            if (len > 0 && message[len - 1] == '\n') len--;
+            fprintf(out, "  Error %s: %.*s\n", errors->errors[i].name, (int)len, message);
+        }
+    } else {
+        logger(LOG_ERROR, "Failed to allocate memory for manifest validation\n");
+    }
+
+    free(values);
+    free(known);
+    free_envp(envp);
+    free_validation_errors(errors);
+    return result;
+}
+
+typedef struct {
+    char* text;
+    size_t size;
+    int result;
+    int containers;
+    int failing;
+} ManifestReport;
+
+typedef struct {
+    const Config* config;
+    char** paths;
+    int count;
+    int next;  // Next file to take, shared by the workers
+    unsigned deadline_ms;
+    ManifestReport* reports;  // One per file
+} ManifestJob;
+
+static void validate_manifest_file(ManifestJob* job, int index) {
+    const char* path = job->paths[index];
+    ManifestReport* report = &job->reports[index];
+    FILE* out = open_memstream(&report->text, &report->size);
+    if (!out) {
+        report->result = ENVIL_CONFIG_ERROR;
+        return;
+    }
+
+    FILE* file = fopen(path, "r");
+    ManifestFile manifest = {0};
+    char error[256];
+    if (!file) {
+        fprintf(out, "%s: cannot open: %s\n", path, strerror(errno));
+        report->result = ENVIL_CONFIG_ERROR;
+    } else if (parse_manifest(file, &manifest, error, sizeof(error)) != ENVIL_OK) {
+        fprintf(out, "%s: %s\n", path, error);
+        report->result = ENVIL_CONFIG_ERROR;
+    } else {
+        for (int i = 0; i < manifest.count; i++) {
+            int result = validate_container(job->config, path, &manifest.containers[i], out);
+            report->containers++;
+            if (result != ENVIL_OK) {
+                report->failing++;
+                if (report->result != ENVIL_TIMEOUT_ERROR) report->result = result;
+            }
+        }
+    }
+
+    if (file) fclose(file);
+    free_manifest(&manifest);
+    fclose(out);
+}
+
+static void* manifest_worker(void* arg) {
+    ManifestJob* job = arg;
+    set_check_deadline(job->deadline_ms);
+    for (;;) {
+        int index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (index >= job->count) break;
+        validate_manifest_file(job, index);
+    }
+    set_check_deadline(0);
+    return NULL;
+}
+
+typedef struct {
+    char** paths;
+    int count;
+    int capacity;
+} PathList;
+
+static bool is_yaml_file(const char* name) {
+    const char* ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".yml") == 0 || strcmp(ext, ".yaml") == 0);
+}
+
+static bool add_path(PathList* list, const char* path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        char** paths = realloc(list->paths, (size_t)capacity * sizeof(char*));
+        if (!paths) return false;
+        list->paths = paths;
+        list->capacity = capacity;
+    }
+    list->paths[list->count] = strdup(path);
+    return list->paths[list->count++] != NULL;
+}
+
+// Adds the YAML files under path, skipping hidden entries such as .git
+static bool collect_manifests(const char* path, PathList* list, bool explicit) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        logger(LOG_ERROR, "Error: Cannot read %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        // A file named on the command line is read whatever its extension
+        return explicit || is_yaml_file(path) ? add_path(list, path) : true;
+    }
+
+    DIR* dir = opendir(path);
+    if (!dir) {
+        logger(LOG_ERROR, "Error: Cannot read %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        size_t size = strlen(path) + strlen(entry->d_name) + 2;
+        char* child = malloc(size);
+        if (!child) {
+            ok = false;
+            break;
+        }
+        snprintf(child, size, "%s/%s", path, entry->d_name);
+        ok = collect_manifests(child, list, false);
+        free(child);
+    }
+    closedir(dir);
+    return ok;
+}
+
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+int validate_manifests(const Config* config, const char* path, unsigned deadline_ms, FILE* out) {
+    PathList list = {0};
+    if (!collect_manifests(path, &list, true)) {
+        for (int i = 0; i < list.count; i++) free(list.paths[i]);
+        free(list.paths);
+        return ENVIL_CONFIG_ERROR;
+    }
+    // Reports come out in path order, however the files were shared out
+    if (list.count > 1) qsort(list.paths, (size_t)list.count, sizeof(char*), compare_paths);
+
+    ManifestJob job = {config, list.paths, list.count, 0, deadline_ms, NULL};
+    job.reports = calloc((size_t)(list.count ? list.count : 1), sizeof(ManifestReport));
+    if (!job.reports) {
+        logger(LOG_ERROR, "Failed to allocate memory for manifest reports\n");
+        for (int i = 0; i < list.count; i++) free(list.paths[i]);
+        free(list.paths);
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = cpus > 0 ? (int)cpus : 1;
+    if (thread_count > MANIFEST_MAX_THREADS) thread_count = MANIFEST_MAX_THREADS;
+    if (thread_count > list.count) thread_count = list.count;
+
+    pthread_t threads[MANIFEST_MAX_THREADS];
+    int started = 0;
+    while (started < thread_count && pthread_create(&threads[started], NULL, manifest_worker, &job) == 0) {
+        started++;
+    }
+    if (started == 0) manifest_worker(&job);  // No threads to be had, do it here
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    logger(LOG_DEBUG, "Validated %d manifests with %d threads", list.count, started ? started : 1);
+
+    int result = ENVIL_OK, containers = 0, failing = 0;
+    for (int i = 0; i < list.count; i++) {
+        ManifestReport* report = &job.reports[i];
+        if (report->text) fwrite(report->text, 1, report->size, out);
+        containers += report->containers;
+        failing += report->failing;
+        // A timeout outranks other failures: the report is incomplete
+        if (report->result != ENVIL_OK && result != ENVIL_TIMEOUT_ERROR) result = report->result;
+        free(report->text);
+        free(list.paths[i]);
+    }
+    fprintf(out, "-- %d containers in %d files, %d failing\n", containers, list.count, failing);
+
+    free(job.reports);
+    free(list.paths);
+    return result;
+}
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <string.h>
+#include "netaddr.h"
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool parse_ipv4(const char* str, size_t len, uint8_t addr[4]) {
+    size_t i = 0;
+    for (int part = 0; part < 4; part++) {
+        if (part > 0) {
+            if (i >= len || str[i] != '.') return false;
+            i++;
+        }
+
+        size_t start = i;
+        unsigned value = 0;
+        while (i < len && is_digit(str[i]) && i - start < 3) {
+            value = value * 10 + (unsigned)(str[i] - '0');
+            i++;
+        }
+        // No empty parts, no leading zeros (some parsers read them as octal)
+        if (i == start || value > 255 || (str[start] == '0' && i - start > 1)) return false;
+        addr[part] = (uint8_t)value;
+    }
+    return i == len;
+}
+
+bool parse_ipv6(const char* str, size_t len, uint8_t addr[16]) {
+    uint16_t words[8];
+    int count = 0;
+    int gap = -1;  // Word index where "::" stands
+    size_t i = 0;
+
+    if (len < 2) return false;
+    if (str[0] == ':') {
+        if (str[1] != ':') return false;
+        gap = 0;
+        i = 2;
+    }
+
+    while (i < len) {
+        if (count == 8) return false;
+
+        size_t end = i;
+        while (end < len && str[end] != ':') end++;
+
+        // Dotted IPv4 in the last 32 bits, e.g. ::ffff:192.0.2.1
+        if (memchr(str + i, '.', end - i)) {
+            uint8_t v4[4];
+            if (end != len || count > 6 || !parse_ipv4(str + i, end - i, v4)) return false;
+            words[count++] = (uint16_t)(v4[0] << 8 | v4[1]);
+            words[count++] = (uint16_t)(v4[2] << 8 | v4[3]);
+            break;
+        }
+
+        if (end == i || end - i > 4) return false;
+        uint16_t word = 0;
+        for (size_t k = i; k < end; k++) {
+            int digit = hex_value(str[k]);
+            if (digit < 0) return false;
+            word = (uint16_t)(word << 4 | digit);
+        }
+        words[count++] = word;
+
+        i = end;
+        if (i == len) break;
+        i++;  // The ':'
+        if (i == len) return false;
+        if (str[i] == ':') {
+            if (gap >= 0) return false;
+            gap = count;
+            i++;
+        }
+    }
+
+    // "::" stands for at least one zero word
+    if (gap < 0 ? count != 8 : count > 7) return false;
+
+    int zeros = 8 - count;
+    int out = 0;
+    for (int w = 0; w < count; w++) {
+        if (w == gap) {
+            for (int z = 0; z < zeros; z++, out++) addr[2 * out] = addr[2 * out + 1] = 0;
+        }
+        addr[2 * out] = (uint8_t)(words[w] >> 8);
+        addr[2 * out + 1] = (uint8_t)words[w];
+        out++;
+    }
+    if (gap == count) {
+        for (int z = 0; z < zeros; z++, out++) addr[2 * out] = addr[2 * out + 1] = 0;
+    }
+    return true;
+}
+
+bool parse_hostname(const char* str, size_t len, int* labels) {
+    if (len > 0 && str[len - 1] == '.') len--;
+    if (len == 0 || len > 253) return false;
+
+    int count = 0;
+    size_t start = 0;
+    bool numeric = true;  // Whether the current label is all digits
+    for (size_t i = 0; i <= len; i++) {
+        if (i == len || str[i] == '.') {
+            size_t label_len = i - start;
+            if (label_len == 0 || label_len > 63) return false;
+            if (str[start] == '-' || str[i - 1] == '-') return false;
+            count++;
+            // An all-numeric last label would make 999.1.1.1 a hostname
+            if (i == len && numeric) return false;
+            start = i + 1;
+            numeric = true;
+            continue;
+        }
+
+        char c = str[i];
+        if (is_digit(c)) continue;
+        numeric = false;
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-')) return false;
+    }
+
+    if (labels) *labels = count;
+    return true;
+}
+
+unsigned classify_ipv4(const uint8_t addr[4]) {
+    uint8_t a = addr[0];
+    uint8_t b = addr[1];
+    uint8_t c = addr[2];
+
+    if (a == 127) return NET_LOOPBACK;
+    if (a == 10 || (a == 172 && (b & 0xf0) == 16) || (a == 192 && b == 168) ||
+        (a == 100 && (b & 0xc0) == 64)) {
+        return NET_PRIVATE;
+    }
+    if (a == 169 && b == 254) return NET_LINK_LOCAL;
+    if (a == 0 || a >= 224 ||
+        (a == 192 && b == 0 && (c == 0 || c == 2)) ||
+        (a == 198 && (b & 0xfe) == 18) ||
+        (a == 198 && b == 51 && c == 100) ||
+        (a == 203 && b == 0 && c == 113)) {
+        return NET_OTHER;
+    }
+    return NET_PUBLIC;
+}
+
+unsigned classify_ipv6(const uint8_t addr[16]) {
+    static const uint8_t mapped_prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    static const uint8_t zero[15] = {0};
+
+    if (memcmp(addr, mapped_prefix, 12) == 0) return classify_ipv4(addr + 12);
+    if (memcmp(addr, zero, 15) == 0) return addr[15] == 1 ? NET_LOOPBACK : NET_OTHER;
+    if ((addr[0] & 0xfe) == 0xfc) return NET_PRIVATE;
+    if (addr[0] == 0xfe && (addr[1] & 0xc0) == 0x80) return NET_LINK_LOCAL;
+    if (addr[0] == 0x20 && addr[1] == 0x01 && addr[2] == 0x0d && addr[3] == 0xb8) return NET_OTHER;
+    if ((addr[0] & 0xe0) == 0x20) return NET_PUBLIC;
+    return NET_OTHER;
+}
+
+bool is_net_check(const char* check_name) {
+    return strcmp(check_name, "ip") == 0 || strcmp(check_name, "ipv4") == 0 ||
+           strcmp(check_name, "ipv6") == 0 || strcmp(check_name, "cidr") == 0 ||
+           strcmp(check_name, "hostname") == 0 || strcmp(check_name, "hostport") == 0;
+}
+
+static const struct {
+    const char* name;
+    unsigned classes;
+} class_names[] = {
+    {"any", NET_ANY},
+    {"private", NET_PRIVATE},
+    {"public", NET_PUBLIC},
+    {"loopback", NET_LOOPBACK},
+    {"link-local", NET_LINK_LOCAL},
+    {"fqdn", NET_FQDN},
+};
+
+static bool parse_port(const char* str, size_t len, uint16_t* port) {
+    if (len == 0 || len > 5 || str[0] == '0') return false;
+    unsigned value = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!is_digit(str[i])) return false;
+        value = value * 10 + (unsigned)(str[i] - '0');
+    }
+    if (value > 65535) return false;
+    *port = (uint16_t)value;
+    return true;
+}
+
+bool parse_net_constraint(const char* check_name, const char* str, NetConstraint* constraint) {
+    bool is_hostname = strcmp(check_name, "hostname") == 0;
+    bool is_hostport = strcmp(check_name, "hostport") == 0;
+
+    constraint->classes = 0;
+    constraint->port_min = 1;
+    constraint->port_max = 65535;
+
+    const char* p = str;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        const char* end = p;
+        while (*end && *end != ',') end++;
+        size_t len = (size_t)(end - p);
+        while (len > 0 && p[len - 1] == ' ') len--;
+        if (len == 0) break;
+
+        if (is_hostport && is_digit(*p)) {
+            const char* dash = memchr(p, '-', len);
+            size_t first_len = dash ? (size_t)(dash - p) : len;
+            if (!parse_port(p, first_len, &constraint->port_min)) return false;
+            constraint->port_max = constraint->port_min;
+            if (dash && !parse_port(dash + 1, len - first_len - 1, &constraint->port_max)) return false;
+            if (constraint->port_max < constraint->port_min) return false;
+        } else {
+            unsigned classes = 0;
+            for (size_t i = 0; i < sizeof(class_names) / sizeof(class_names[0]); i++) {
+                if (strlen(class_names[i].name) == len && strncmp(p, class_names[i].name, len) == 0) {
+                    classes = class_names[i].classes;
+                    break;
+                }
+            }
+            if (!classes) return false;
+            // Names have no address class, only fqdn applies to them
+            if (is_hostname && classes != NET_ANY && classes != NET_FQDN) return false;
+            if (!is_hostname && !is_hostport && classes == NET_FQDN) return false;
+            constraint->classes |= classes;
+        }
+        p = end;
+    }
+
+    if (!(constraint->classes & NET_ANY)) constraint->classes |= NET_ANY;
+    return true;
+}
+
+const char* format_net_constraint(const NetConstraint* constraint, char* buf, size_t size) {
+    size_t len = 0;
+    buf[0] = '\0';
+
+    if ((constraint->classes & NET_ANY) != NET_ANY) {
+        // Skip "any" and "fqdn", which are not address classes
+        for (size_t i = 1; i < sizeof(class_names) / sizeof(class_names[0]) - 1 && len < size; i++) {
+            if (!(constraint->classes & class_names[i].classes)) continue;
+            len += (size_t)snprintf(buf + len, size - len, "%s%s", len ? " or " : "", class_names[i].name);
+        }
+    }
+    if ((constraint->classes & NET_FQDN) && len < size) {
+        len += (size_t)snprintf(buf + len, size - len, "%sfully qualified", len ? ", " : "");
+    }
+    if ((constraint->port_min != 1 || constraint->port_max != 65535) && len < size) {
+        if (constraint->port_min == constraint->port_max) {
+            snprintf(buf + len, size - len, "%sport %u", len ? ", " : "", constraint->port_min);
+        } else {
+            snprintf(buf + len, size - len, "%sport %u-%u", len ? ", " : "",
+                     constraint->port_min, constraint->port_max);
+        }
+    }
+    return buf;
+}
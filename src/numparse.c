@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "numparse.h"
+
+// 128-bit approximations of 5^q, two words per power, defined in pow5_table.c
+extern const uint64_t pow5_128[];
+
+#define POW5_MIN_EXPONENT -342
+#define POW5_MAX_EXPONENT 308
+
+// IEEE 754 binary64 layout
+#define MANTISSA_BITS 52
+#define EXPONENT_BIAS 1023
+#define INFINITE_POWER 0x7FF
+
+// Largest number of decimal digits that always fits in a uint64_t
+#define MAX_EXACT_DIGITS 19
+#define MIN_NINETEEN_DIGITS 1000000000000000000ULL
+
+static const double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline uint64_t load_eight(const char* p) {
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    return chunk;
+}
+
+// True if all eight bytes are ASCII digits
+static inline bool is_eight_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+// Converts eight ASCII digits, first digit in the lowest byte
+static inline uint32_t parse_eight_digits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;  // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL;  // 1 + (10000 << 32)
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)chunk;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HAVE_SWAR_DIGITS 1
+#else
+#define HAVE_SWAR_DIGITS 0
+#endif
+
+// Accumulates a run of digits into *value (wrapping), returns the end of the run
+static const char* consume_digits(const char* p, const char* end, uint64_t* value) {
+    uint64_t v = *value;
+#if HAVE_SWAR_DIGITS
+    while (end - p >= 8) {
+        uint64_t chunk = load_eight(p);
+        if (!is_eight_digits(chunk)) break;
+        v = v * 100000000 + parse_eight_digits(chunk);
+        p += 8;
+    }
+#endif
+    while (p < end && (unsigned)(*p - '0') <= 9) {
+        v = v * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    *value = v;
+    return p;
+}
+
+bool parse_int64(const char* str, size_t len, int64_t* out) {
+    if (!str || len == 0) return false;
+
+    const char* p = str;
+    const char* end = str + len;
+    bool negative = *p == '-';
+    if (negative) p++;
+    if (p == end) return false;
+
+    // Leading zeros do not count towards the digit limit
+    while (p < end && *p == '0') p++;
+    if (end - p > MAX_EXACT_DIGITS) return false;
+
+    uint64_t value = 0;
+    if (consume_digits(p, end, &value) != end) return false;
+
+    if (negative) {
+        if (value > (uint64_t)INT64_MAX + 1) return false;
+        *out = value == 0 ? 0 : -(int64_t)(value - 1) - 1;
+    } else {
+        if (value > (uint64_t)INT64_MAX) return false;
+        *out = (int64_t)value;
+    }
+    return true;
+}
+
+typedef struct {
+    uint64_t high;
+    uint64_t low;
+} Uint128;
+
+static inline Uint128 multiply_full(uint64_t a, uint64_t b) {
+    Uint128 result;
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128)a * b;
+    result.high = (uint64_t)(product >> 64);
+    result.low = (uint64_t)product;
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    result.high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    result.low = (cross << 32) | (uint32_t)lo_lo;
+#endif
+    return result;
+}
+
+// floor(log2(10^q)) + 63, valid over the table range
+static inline int32_t binary_exponent(int32_t q) {
+    return (((152170 + 65536) * q) >> 16) + 63;
+}
+
+typedef struct {
+    uint64_t mantissa;
+    int32_t power2;  // Biased exponent, INFINITE_POWER for infinity
+} AdjustedMantissa;
+
+/*
+ * Eisel-Lemire: the nearest double to w * 10^q, for w with at most 19
+ * significant digits. Multiplying the normalized w by a truncated 128-bit
+ * 5^q keeps enough bits that the rounding decision is always exact (Mushtak
+ * and Lemire, "Fast number parsing without fallback").
+ */
+static AdjustedMantissa compute_float(int64_t q, uint64_t w) {
+    AdjustedMantissa answer = {0, 0};
+    if (w == 0 || q < POW5_MIN_EXPONENT) return answer;
+    if (q > POW5_MAX_EXPONENT) {
+        answer.power2 = INFINITE_POWER;
+        return answer;
+    }
+
+    int leading_zeros = __builtin_clzll(w);
+    w <<= leading_zeros;
+
+    // Only the top MANTISSA_BITS + 3 bits matter, refine with the low word of
+    // the power only when the truncated product could carry into them
+    size_t index = 2 * (size_t)(q - POW5_MIN_EXPONENT);
+    const uint64_t precision_mask = UINT64_MAX >> (MANTISSA_BITS + 3);
+    Uint128 product = multiply_full(w, pow5_128[index]);
+    if ((product.high & precision_mask) == precision_mask) {
+        Uint128 second = multiply_full(w, pow5_128[index + 1]);
+        product.low += second.high;
+        if (second.high > product.low) product.high++;
+    }
+
+    int upper_bit = (int)(product.high >> 63);
+    int shift = upper_bit + 64 - MANTISSA_BITS - 3;
+    answer.mantissa = product.high >> shift;
+    answer.power2 = binary_exponent((int32_t)q) + upper_bit - leading_zeros + EXPONENT_BIAS;
+
+    if (answer.power2 <= 0) {
+        // Subnormal
+        if (-answer.power2 + 1 >= 64) {
+            answer.mantissa = 0;
+            answer.power2 = 0;
+            return answer;
+        }
+        answer.mantissa >>= -answer.power2 + 1;
+        answer.mantissa += answer.mantissa & 1;
+        answer.mantissa >>= 1;
+        answer.power2 = answer.mantissa < (1ULL << MANTISSA_BITS) ? 0 : 1;
+        return answer;
+    }
+
+    // Exactly halfway between two doubles: round to even. Only possible for
+    // small exponents, where 5^q is exact in the table
+    if (product.low <= 1 && q >= -4 && q <= 23 && (answer.mantissa & 3) == 1 &&
+        (answer.mantissa << shift) == product.high) {
+        answer.mantissa &= ~1ULL;
+    }
+
+    answer.mantissa += answer.mantissa & 1;
+    answer.mantissa >>= 1;
+    if (answer.mantissa >= (2ULL << MANTISSA_BITS)) {
+        answer.mantissa = 1ULL << MANTISSA_BITS;
+        answer.power2++;
+    }
+    answer.mantissa &= ~(1ULL << MANTISSA_BITS);
+    if (answer.power2 >= INFINITE_POWER) {
+        answer.power2 = INFINITE_POWER;
+        answer.mantissa = 0;
+    }
+    return answer;
+}
+
+static double to_double(AdjustedMantissa am, bool negative) {
+    uint64_t bits = am.mantissa | ((uint64_t)am.power2 << MANTISSA_BITS);
+    if (negative) bits |= 1ULL << 63;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool matches_word(const char* p, const char* end, const char* word) {
+    size_t len = strlen(word);
+    if ((size_t)(end - p) != len) return false;
+    for (size_t i = 0; i < len; i++) {
+        if ((p[i] | 0x20) != word[i]) return false;
+    }
+    return true;
+}
+
+/*
+ * Slow path for long inputs whose truncated mantissa is ambiguous. The
+ * significant digits are rewritten as "DIGITSeEXP", with no radix character,
+ * so strtod gives the same answer in every locale.
+ */
+static bool parse_double_fallback(const char* int_start, const char* int_end,
+                                  const char* frac_start, const char* frac_end,
+                                  int64_t exp_number, bool negative, double* out) {
+    size_t digits = (size_t)(int_end - int_start) + (size_t)(frac_end - frac_start);
+    char stack_buf[128];
+    char* buf = stack_buf;
+    if (digits + 32 > sizeof(stack_buf)) {
+        buf = malloc(digits + 32);
+        if (!buf) return false;
+    }
+
+    size_t n = 0;
+    if (negative) buf[n++] = '-';
+    memcpy(buf + n, int_start, (size_t)(int_end - int_start));
+    n += (size_t)(int_end - int_start);
+    memcpy(buf + n, frac_start, (size_t)(frac_end - frac_start));
+    n += (size_t)(frac_end - frac_start);
+    snprintf(buf + n, 32, "e%lld", (long long)(exp_number - (frac_end - frac_start)));
+
+    *out = strtod(buf, NULL);
+    if (buf != stack_buf) free(buf);
+    return true;
+}
+
+bool parse_double(const char* str, size_t len, double* out) {
+    if (!str || len == 0) return false;
+
+    const char* p = str;
+    const char* end = str + len;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+') p++;
+    if (p == end) return false;
+
+    if ((unsigned)(*p - '0') > 9 && *p != '.') {
+        if (matches_word(p, end, "inf") || matches_word(p, end, "infinity")) {
+            *out = negative ? -INFINITY : INFINITY;
+            return true;
+        }
+        if (matches_word(p, end, "nan")) {
+            *out = negative ? -NAN : NAN;
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t w = 0;
+    const char* int_start = p;
+    p = consume_digits(p, end, &w);
+    const char* int_end = p;
+
+    const char* frac_start = p;
+    const char* frac_end = p;
+    if (p < end && *p == '.') {
+        frac_start = ++p;
+        p = consume_digits(p, end, &w);
+        frac_end = p;
+    }
+
+    int64_t digit_count = (int_end - int_start) + (frac_end - frac_start);
+    if (digit_count == 0) return false;
+
+    int64_t exp_number = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) p++;
+        if (p == end) return false;
+        while (p < end && (unsigned)(*p - '0') <= 9) {
+            // Saturate, anything this large rounds to infinity or zero anyway
+            if (exp_number < 0x10000000) exp_number = exp_number * 10 + (*p - '0');
+            p++;
+        }
+        if (exp_negative) exp_number = -exp_number;
+    }
+    if (p != end) return false;
+
+    int64_t q = exp_number - (frac_end - frac_start);
+
+    // More than 19 significant digits: keep the first 19 and remember that
+    // the true mantissa lies in (w, w + 1)
+    bool truncated = false;
+    if (digit_count > MAX_EXACT_DIGITS) {
+        const char* s = int_start;
+        while (s < frac_end && (*s == '0' || *s == '.')) {
+            if (*s == '0') digit_count--;
+            s++;
+        }
+        if (digit_count > MAX_EXACT_DIGITS) {
+            truncated = true;
+            w = 0;
+            s = int_start;
+            while (w < MIN_NINETEEN_DIGITS && s < int_end) {
+                w = w * 10 + (uint64_t)(*s++ - '0');
+            }
+            if (w >= MIN_NINETEEN_DIGITS) {
+                q = exp_number + (int_end - s);
+            } else {
+                s = frac_start;
+                while (w < MIN_NINETEEN_DIGITS && s < frac_end) {
+                    w = w * 10 + (uint64_t)(*s++ - '0');
+                }
+                q = exp_number - (s - frac_start);
+            }
+        }
+    }
+
+#if FLT_EVAL_METHOD == 0
+    // Clinger's fast path: both operands exact, one correctly rounded operation
+    if (!truncated && q >= -22 && q <= 22 && w <= (1ULL << 53)) {
+        double value = (double)w;
+        value = q < 0 ? value / exact_powers_of_ten[-q] : value * exact_powers_of_ten[q];
+        *out = negative ? -value : value;
+        return true;
+    }
+#endif
+
+    AdjustedMantissa am = compute_float(q, w);
+    if (truncated && am.power2 != INFINITE_POWER) {
+        AdjustedMantissa upper = compute_float(q, w + 1);
+        if (upper.mantissa != am.mantissa || upper.power2 != am.power2) {
+            return parse_double_fallback(int_start, int_end, frac_start, frac_end,
+                                         exp_number, negative, out);
+        }
+    }
+    *out = to_double(am, negative);
+    return true;
+}
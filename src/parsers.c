@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include "parsers.h"
+#include "logger.h"
+
+// Sonames tried in order, the development symlink last
+static const char* yaml_sonames[] = {"libyaml-0.so.2", "libyaml.so", NULL};
+static const char* json_sonames[] = {"libjson-c.so.5", "libjson-c.so.4", "libjson-c.so", NULL};
+
+static YamlLibrary yaml;
+static JsonLibrary json;
+static bool yaml_loaded = false;
+static bool json_loaded = false;
+static pthread_once_t yaml_once = PTHREAD_ONCE_INIT;
+static pthread_once_t json_once = PTHREAD_ONCE_INIT;
+
+static void* open_library(const char** sonames) {
+    for (int i = 0; sonames[i]; i++) {
+        void* handle = dlopen(sonames[i], RTLD_NOW | RTLD_LOCAL);
+        if (handle) return handle;
+    }
+    return NULL;
+}
+
+// Resolves one symbol into a table field, clearing ok when it is missing
+#define RESOLVE(handle, table, field, symbol, ok) do { \
+        (table).field = (__typeof__((table).field))dlsym(handle, symbol); \
+        if (!(table).field) (ok) = false; \
+    } while (0)
+
+static void load_yaml(void) {
+    void* handle = open_library(yaml_sonames);
+    if (!handle) return;
+
+    bool ok = true;
+    RESOLVE(handle, yaml, parser_initialize, "yaml_parser_initialize", ok);
+    RESOLVE(handle, yaml, parser_set_input_file, "yaml_parser_set_input_file", ok);
+    RESOLVE(handle, yaml, parser_load, "yaml_parser_load", ok);
+    RESOLVE(handle, yaml, parser_parse, "yaml_parser_parse", ok);
+    RESOLVE(handle, yaml, event_delete, "yaml_event_delete", ok);
+    RESOLVE(handle, yaml, parser_delete, "yaml_parser_delete", ok);
+    RESOLVE(handle, yaml, document_get_root_node, "yaml_document_get_root_node", ok);
+    RESOLVE(handle, yaml, document_get_node, "yaml_document_get_node", ok);
+    RESOLVE(handle, yaml, document_delete, "yaml_document_delete", ok);
+
+    if (!ok) {
+        dlclose(handle);
+        return;
+    }
+    yaml_loaded = true;
+}
+
+static void load_json(void) {
+    void* handle = open_library(json_sonames);
+    if (!handle) return;
+
+    bool ok = true;
+    RESOLVE(handle, json, tokener_parse_verbose, "json_tokener_parse_verbose", ok);
+    RESOLVE(handle, json, tokener_error_desc, "json_tokener_error_desc", ok);
+    RESOLVE(handle, json, object_put, "json_object_put", ok);
+    RESOLVE(handle, json, object_get_type, "json_object_get_type", ok);
+    RESOLVE(handle, json, object_get_string, "json_object_get_string", ok);
+    RESOLVE(handle, json, object_object_get_ex, "json_object_object_get_ex", ok);
+    RESOLVE(handle, json, object_object_length, "json_object_object_length", ok);
+    RESOLVE(handle, json, iter_begin, "json_object_iter_begin", ok);
+    RESOLVE(handle, json, iter_end, "json_object_iter_end", ok);
+    RESOLVE(handle, json, iter_next, "json_object_iter_next", ok);
+    RESOLVE(handle, json, iter_equal, "json_object_iter_equal", ok);
+    RESOLVE(handle, json, iter_peek_name, "json_object_iter_peek_name", ok);
+    RESOLVE(handle, json, iter_peek_value, "json_object_iter_peek_value", ok);
+    RESOLVE(handle, json, array_length, "json_object_array_length", ok);
+    RESOLVE(handle, json, array_get_idx, "json_object_array_get_idx", ok);
+
+    if (!ok) {
+        dlclose(handle);
+        return;
+    }
+    json_loaded = true;
+}
+
+const YamlLibrary* yaml_library(void) {
+    pthread_once(&yaml_once, load_yaml);
+    if (!yaml_loaded) {
+        logger(LOG_ERROR, "Error: YAML configs need libyaml, which could not be loaded\n");
+        return NULL;
+    }
+    return &yaml;
+}
+
+const JsonLibrary* json_library(void) {
+    pthread_once(&json_once, load_json);
+    if (!json_loaded) {
+        logger(LOG_ERROR, "Error: JSON configs need json-c, which could not be loaded\n");
+        return NULL;
+    }
+    return &json;
+}
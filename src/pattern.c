@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pattern.h"
+
+typedef struct {
+    int child;      // First child, -1 for none
+    int sibling;    // Next child of the same parent, -1 for none
+    int patterns;   // First pattern whose literal prefix ends here, -1 for none
+    unsigned char byte;
+} TrieNode;
+
+typedef struct {
+    char* text;        // Copy of the pattern
+    const char* rest;  // The pattern from its first wildcard on
+    int next;          // Next pattern ending at the same node, -1 for none
+} PatternEntry;
+
+struct PatternSet {
+    TrieNode* nodes;  // nodes[0] is the root
+    int node_count;
+    int node_capacity;
+    PatternEntry* entries;
+    int count;
+};
+
+bool is_pattern(const char* key) {
+    return strpbrk(key, "*?") != NULL;
+}
+
+static int add_node(PatternSet* set, unsigned char byte) {
+    if (set->node_count == set->node_capacity) {
+        int capacity = set->node_capacity ? set->node_capacity * 2 : 32;
+        TrieNode* nodes = realloc(set->nodes, (size_t)capacity * sizeof(TrieNode));
+        if (!nodes) return -1;
+        set->nodes = nodes;
+        set->node_capacity = capacity;
+    }
+    set->nodes[set->node_count] = (TrieNode){-1, -1, -1, byte};
+    return set->node_count++;
+}
+
+static int find_child(const PatternSet* set, int node, unsigned char byte) {
+    for (int child = set->nodes[node].child; child >= 0; child = set->nodes[child].sibling) {
+        if (set->nodes[child].byte == byte) return child;
+    }
+    return -1;
+}
+
+PatternSet* compile_patterns(const char* const* patterns, int count) {
+    PatternSet* set = calloc(1, sizeof(PatternSet));
+    if (!set) return NULL;
+    set->entries = calloc((size_t)(count ? count : 1), sizeof(PatternEntry));
+    if (!set->entries || add_node(set, 0) < 0) {
+        free_patterns(set);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        PatternEntry* entry = &set->entries[i];
+        entry->text = strdup(patterns[i]);
+        set->count++;
+        if (!entry->text) {
+            free_patterns(set);
+            return NULL;
+        }
+
+        // The literal prefix goes into the trie, the rest is matched as a glob
+        int node = 0;
+        const char* p = entry->text;
+        for (; *p && *p != '*' && *p != '?'; p++) {
+            int child = find_child(set, node, (unsigned char)*p);
+            if (child < 0) {
+                child = add_node(set, (unsigned char)*p);
+                if (child < 0) {
+                    free_patterns(set);
+                    return NULL;
+                }
+                set->nodes[child].sibling = set->nodes[node].child;
+                set->nodes[node].child = child;
+            }
+            node = child;
+        }
+        entry->rest = p;
+        entry->next = set->nodes[node].patterns;
+        set->nodes[node].patterns = i;
+    }
+    return set;
+}
+
+// Matches a glob against [s, end); a mismatch after a * retries one character further
+static bool glob_match(const char* p, const char* s, const char* end) {
+    const char* star = NULL;
+    const char* retry = NULL;
+    while (s < end) {
+        if (*p == '*') {
+            star = ++p;
+            retry = s;
+        } else if (*p && (*p == '?' || *p == *s)) {
+            p++;
+            s++;
+        } else if (star) {
+            p = star;
+            s = ++retry;
+        } else {
+            return false;
+        }
+    }
+    while (*p == '*') p++;
+    return *p == '\0';
+}
+
+int match_patterns(const PatternSet* set, const char* name, size_t name_len, int* matches) {
+    int count = 0;
+    int node = 0;
+    for (size_t i = 0;; i++) {
+        for (int e = set->nodes[node].patterns; e >= 0; e = set->entries[e].next) {
+            if (glob_match(set->entries[e].rest, name + i, name + name_len)) {
+                // Insertion keeps config order; a name rarely matches more than a few
+                int k = count++;
+                while (k > 0 && matches[k - 1] > e) {
+                    matches[k] = matches[k - 1];
+                    k--;
+                }
+                matches[k] = e;
+            }
+        }
+        if (i == name_len) break;
+        node = find_child(set, node, (unsigned char)name[i]);
+        if (node < 0) break;
+    }
+    return count;
+}
+
+void free_patterns(PatternSet* set) {
+    if (!set) return;
+    for (int i = 0; i < set->count; i++) {
+        free(set->entries[i].text);
+    }
+    free(set->entries);
+    free(set->nodes);
+    free(set);
+}
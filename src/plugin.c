@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include "plugin.h"
+#include "envil_plugin.h"
+#include "logger.h"
+#include "validator.h"
+
+#define MAX_PLUGINS 16
+
+// Objects loaded so far and where their checks went. Handles are never
+// closed: the registries keep pointers to the plugins' functions.
+typedef struct {
+    void* handle;
+    const CheckRegistry* registry;
+} LoadedPlugin;
+
+static LoadedPlugin loaded[MAX_PLUGINS];
+static int loaded_count = 0;
+static pthread_mutex_t loaded_lock = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+    CheckRegistry* registry;
+    const char* path;
+} PluginLoad;
+
+static int register_plugin_check(EnvilPluginHost* host, const EnvilPluginCheck* check) {
+    const PluginLoad* load = host->host_data;
+    if (!check || !check->name || !*check->name || !check->check) {
+        logger(LOG_ERROR, "Plugin %s registered a check without a name or function\n", load->path);
+        return ENVIL_CONFIG_ERROR;
+    }
+    if (registry_find_check(load->registry, check->name)) {
+        logger(LOG_ERROR, "Plugin %s: a check named '%s' already exists\n", load->path, check->name);
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    char* name = strdup(check->name);
+    char* description = strdup(check->description ? check->description : "");
+    bool pure = (check->flags & ENVIL_PLUGIN_CHECK_PURE) != 0;
+    bool needs_hooks = check->parse || check->free || pure;
+    CheckHooks* hooks = needs_hooks ? malloc(sizeof(CheckHooks)) : NULL;
+    if (hooks) *hooks = (CheckHooks){check->parse, check->free, pure};
+
+    const CheckDefinition* def = NULL;
+    if (name && description && (hooks || !needs_hooks)) {
+        def = registry_add_check(load->registry, name, description, check->check, hooks, check->has_arg,
+                                 check->error_message ? check->error_message : "Invalid value");
+    }
+    if (!def) {
+        logger(LOG_ERROR, "Plugin %s: cannot register '%s', at most %d checks can be added\n",
+               load->path, check->name, MAX_CHECKS);
+        free(name);
+        free(description);
+        free(hooks);
+        return ENVIL_CONFIG_ERROR;
+    }
+    if (check->cost) load->registry->definitions[load->registry->count - 1].cost = check->cost;
+
+    logger(LOG_DEBUG, "Plugin %s registered check '%s'", load->path, check->name);
+    return ENVIL_OK;
+}
+
+// Drops the checks registered from index first on, after a failed init
+static void withdraw_checks(CheckRegistry* registry, int first) {
+    for (int i = first; i < registry->count; i++) {
+        free((char*)registry->definitions[i].name);
+        free((char*)registry->definitions[i].description);
+        free(registry->definitions[i].custom_data);
+    }
+    registry->count = first;
+}
+
+int load_plugin(CheckRegistry* registry, const char* path) {
+    if (!registry) registry = get_default_registry();
+
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        logger(LOG_ERROR, "Cannot load plugin %s: %s\n", path, dlerror());
+        return ENVIL_CONFIG_ERROR;
+    }
+
+    pthread_mutex_lock(&loaded_lock);
+    int result = ENVIL_OK;
+    bool already_loaded = false;
+    for (int i = 0; i < loaded_count; i++) {
+        already_loaded = already_loaded || (loaded[i].handle == handle && loaded[i].registry == registry);
+    }
+
+    if (already_loaded) {
+        dlclose(handle);  // Drops the reference this call added
+    } else if (loaded_count == MAX_PLUGINS) {
+        logger(LOG_ERROR, "Cannot load plugin %s: at most %d plugins can be loaded\n", path, MAX_PLUGINS);
+        result = ENVIL_CONFIG_ERROR;
+    } else {
+        EnvilPluginInit init = (EnvilPluginInit)dlsym(handle, ENVIL_PLUGIN_ENTRY);
+        if (!init) {
+            logger(LOG_ERROR, "Plugin %s does not export %s; it was built for another envil version\n",
+                   path, ENVIL_PLUGIN_ENTRY);
+            result = ENVIL_CONFIG_ERROR;
+        } else {
+            PluginLoad load = {registry, path};
+            EnvilPluginHost host = {ENVIL_PLUGIN_ABI, register_plugin_check, &load};
+            int first = registry->count;
+            if (init(&host) != ENVIL_OK) {
+                logger(LOG_ERROR, "Plugin %s failed to initialize\n", path);
+                withdraw_checks(registry, first);
+                result = ENVIL_CONFIG_ERROR;
+            } else {
+                loaded[loaded_count++] = (LoadedPlugin){handle, registry};
+                logger(LOG_INFO, "Loaded plugin %s (%d checks)", path, registry->count - first);
+            }
+        }
+    }
+    pthread_mutex_unlock(&loaded_lock);
+
+    // A refused object may still be mapped for another registry; dlclose only drops this reference
+    if (result != ENVIL_OK) dlclose(handle);
+    return result;
+}
+
+void forget_plugins(const CheckRegistry* registry) {
+    pthread_mutex_lock(&loaded_lock);
+    int kept = 0;
+    for (int i = 0; i < loaded_count; i++) {
+        if (loaded[i].registry != registry) loaded[kept++] = loaded[i];
+    }
+    loaded_count = kept;
+    pthread_mutex_unlock(&loaded_lock);
+}
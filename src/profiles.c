@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "profiles.h"
+#include "config.h"
+#include "checks.h"
+#include "dotenv.h"
+#include "logger.h"
+#include "pattern.h"
+#include "validator.h"
+
+extern char** environ;
+
+#define PROFILES_MAX_THREADS 16
+
+typedef struct {
+    char* path;
+    char* label;       // Column heading: the file name without .env
+    EnvFile* env;
+    int result;
+    int* cells;        // Error code of each variable then each pattern, ENVIL_OK when it passed
+    ValidationErrors* errors;
+} Profile;
+
+typedef struct {
+    Profile* profiles;
+    int count;
+    int capacity;
+} ProfileList;
+
+typedef struct {
+    const Config* config;
+    ProfileList* list;
+    int next;  // Next profile to take, shared by the workers
+    unsigned deadline_ms;
+} ProfileJob;
+
+static bool add_profile(ProfileList* list, const char* path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 8;
+        Profile* profiles = realloc(list->profiles, (size_t)capacity * sizeof(Profile));
+        if (!profiles) return false;
+        list->profiles = profiles;
+        list->capacity = capacity;
+    }
+
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t len = strlen(base);
+    if (len > 4 && strcmp(base + len - 4, ".env") == 0) len -= 4;
+
+    Profile* profile = &list->profiles[list->count];
+    memset(profile, 0, sizeof(*profile));
+    profile->path = strdup(path);
+    profile->label = strndup(base, len);
+    list->count++;
+    return profile->path && profile->label;
+}
+
+static int compare_profiles(const void* a, const void* b) {
+    return strcmp(((const Profile*)a)->path, ((const Profile*)b)->path);
+}
+
+// Adds the .env files of a directory, in name order
+static bool add_profile_dir(ProfileList* list, const char* dir_path) {
+    DIR* dir = opendir(dir_path);
+    if (!dir) {
+        logger(LOG_ERROR, "Error: Cannot read %s: %s\n", dir_path, strerror(errno));
+        return false;
+    }
+
+    int first = list->count;
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (entry->d_name[0] == '.' || len <= 4 || strcmp(entry->d_name + len - 4, ".env") != 0) continue;
+
+        size_t size = strlen(dir_path) + len + 2;
+        char* path = malloc(size);
+        if (!path) {
+            ok = false;
+            break;
+        }
+        snprintf(path, size, "%s/%s", dir_path, entry->d_name);
+        ok = add_profile(list, path);
+        free(path);
+    }
+    closedir(dir);
+
+    if (ok && list->count == first) logger(LOG_WARNING, "No .env files in %s", dir_path);
+    qsort(list->profiles + first, (size_t)(list->count - first), sizeof(Profile), compare_profiles);
+    return ok;
+}
+
+static bool collect_profiles(const char* spec, ProfileList* list) {
+    char* copy = strdup(spec);
+    if (!copy) return false;
+
+    bool ok = true;
+    char* saveptr = NULL;
+    for (char* item = strtok_r(copy, ",", &saveptr); ok && item; item = strtok_r(NULL, ",", &saveptr)) {
+        struct stat st;
+        if (stat(item, &st) == 0 && S_ISDIR(st.st_mode)) ok = add_profile_dir(list, item);
+        else ok = add_profile(list, item);
+    }
+    free(copy);
+    return ok;
+}
+
+static void free_profiles(ProfileList* list) {
+    for (int i = 0; i < list->count; i++) {
+        Profile* profile = &list->profiles[i];
+        free(profile->path);
+        free(profile->label);
+        free(profile->cells);
+        if (profile->env) free_env_file(profile->env);
+        if (profile->errors) free_validation_errors(profile->errors);
+    }
+    free(list->profiles);
+}
+
+// The profile first, then the process environment
+static const char* lookup_profile_var(const char* name, void* user_data) {
+    const Profile* profile = user_data;
+    const char* value = env_file_get(profile->env, name);
+    return value ? value : getenv(name);
+}
+
+static void free_envp(char** envp) {
+    for (char** entry = envp; entry && *entry; entry++) free(*entry);
+    free(envp);
+}
+
+// The profile's variables and then the rest of the environment, as NAME=VALUE
+// entries for pattern keys
+static char** profile_envp(const Profile* profile) {
+    int environ_count = 0;
+    while (environ[environ_count]) environ_count++;
+    char** envp = calloc((size_t)(profile->env->count + environ_count + 1), sizeof(char*));
+    if (!envp) return NULL;
+
+    int n = 0;
+    for (int i = 0; i < profile->env->count; i++) {
+        const EnvEntry* entry = &profile->env->entries[i];
+        size_t size = strlen(entry->name) + strlen(entry->value) + 2;
+        envp[n] = malloc(size);
+        if (!envp[n]) {
+            free_envp(envp);
+            return NULL;
+        }
+        snprintf(envp[n++], size, "%s=%s", entry->name, entry->value);
+    }
+    for (int i = 0; i < environ_count; i++) {
+        const char* equals = strchr(environ[i], '=');
+        if (!equals) continue;
+        char* name = strndup(environ[i], (size_t)(equals - environ[i]));
+        bool overridden = !name || env_file_get(profile->env, name) != NULL;
+        free(name);
+        if (overridden) continue;
+        envp[n] = strdup(environ[i]);
+        if (!envp[n++]) {
+            free_envp(envp);
+            return NULL;
+        }
+    }
+    return envp;
+}
+
+static void validate_profile(const Config* config, Profile* profile) {
+    int count = config->variable_count;
+    const char** values = malloc((size_t)(count ? count : 1) * sizeof(char*));
+    int rows = count + config->pattern_count;
+    profile->cells = calloc((size_t)(rows ? rows : 1), sizeof(int));
+    int* matches = config->pattern_count ? malloc((size_t)config->pattern_count * sizeof(int)) : NULL;
+    profile->errors = create_validation_errors();
+    char** envp = config->pattern_set ? profile_envp(profile) : NULL;
+    if (!values || !profile->cells || !profile->errors || (config->pattern_set && (!envp || !matches))) {
+        logger(LOG_ERROR, "Failed to allocate memory for profile %s\n", profile->path);
+        free(values);
+        free(matches);
+        free_envp(envp);
+        profile->result = ENVIL_CONFIG_ERROR;
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        values[i] = lookup_profile_var(var->name, profile);
+        if (!values[i]) values[i] = var->default_value;
+    }
+    profile->result = validate_config_values(config, values, NULL, envp, lookup_profile_var, profile,
+                                             false, profile->errors, NULL);
+    free(values);
+    free_envp(envp);
+
+    // Errors name their variable; the first one of each fills its cell, and
+    // the first one of a pattern's members fills the pattern's
+    for (int e = 0; e < profile->errors->count; e++) {
+        const ValidationError* error = &profile->errors->errors[e];
+        int i = 0;
+        while (i < count && strcmp(config->variables[i].name, error->name) != 0) i++;
+        if (i < count) {
+            if (profile->cells[i] == ENVIL_OK) profile->cells[i] = error->error_code;
+            continue;
+        }
+        int match_count = matches ? match_patterns(config->pattern_set, error->name, strlen(error->name), matches) : 0;
+        for (int m = 0; m < match_count; m++) {
+            if (profile->cells[count + matches[m]] == ENVIL_OK) profile->cells[count + matches[m]] = error->error_code;
+        }
+    }
+    free(matches);
+}
+
+static void* profile_worker(void* arg) {
+    ProfileJob* job = arg;
+    set_check_deadline(job->deadline_ms);
+    for (;;) {
+        int index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (index >= job->list->count) break;
+        validate_profile(job->config, &job->list->profiles[index]);
+    }
+    set_check_deadline(0);
+    return NULL;
+}
+
+static const char* cell_text(int code) {
+    switch (code) {
+        case ENVIL_OK: return "ok";
+        case ENVIL_MISSING_VAR: return "missing";
+        case ENVIL_TYPE_ERROR: return "type";
+        case ENVIL_TIMEOUT_ERROR: return "timeout";
+        default: return "FAIL";
+    }
+}
+
+// A matrix row is a variable, or a pattern after the variables
+static const char* row_name(const Config* config, int row) {
+    if (row < config->variable_count) return config->variables[row].name;
+    return config->patterns[row - config->variable_count].name;
+}
+
+static void write_matrix(const Config* config, const ProfileList* list, FILE* out) {
+    int rows = config->variable_count + config->pattern_count;
+    int name_width = (int)strlen("VARIABLE");
+    for (int i = 0; i < rows; i++) {
+        int len = (int)strlen(row_name(config, i));
+        if (len > name_width) name_width = len;
+    }
+    int* widths = malloc((size_t)(list->count ? list->count : 1) * sizeof(int));
+    if (!widths) return;
+    for (int p = 0; p < list->count; p++) {
+        int len = (int)strlen(list->profiles[p].label);
+        widths[p] = len > 7 ? len : 7;  // Fits every cell_text
+    }
+
+    fprintf(out, "%-*s", name_width, "VARIABLE");
+    for (int p = 0; p < list->count; p++) {
+        fprintf(out, "  %-*s", p + 1 < list->count ? widths[p] : 0, list->profiles[p].label);
+    }
+    fputc('\n', out);
+
+    for (int i = 0; i < rows; i++) {
+        fprintf(out, "%-*s", name_width, row_name(config, i));
+        for (int p = 0; p < list->count; p++) {
+            fprintf(out, "  %-*s", p + 1 < list->count ? widths[p] : 0, cell_text(list->profiles[p].cells[i]));
+        }
+        fputc('\n', out);
+    }
+    free(widths);
+
+    // The messages behind the cells, profile by profile
+    int failing = 0;
+    for (int p = 0; p < list->count; p++) {
+        const Profile* profile = &list->profiles[p];
+        if (profile->result == ENVIL_OK) continue;
+        failing++;
+        fprintf(out, "%s:\n", profile->label);
+        for (int e = 0; e < profile->errors->count; e++) {
+            const char* message = profile->errors->errors[e].message;
+            size_t len = strlen(message);
+            if (len > 0 && message[len - 1] == '\n') len--;
+            fprintf(out, "  Error %s: %.*s\n", profile->errors->errors[e].name, (int)len, message);
+        }
+    }
+    fprintf(out, "-- %d profiles, %d failing\n", list->count, failing);
+}
+
+int validate_profiles(const Config* config, const char* spec, unsigned deadline_ms, FILE* out) {
+    ProfileList list = {0};
+    if (!collect_profiles(spec, &list)) {
+        free_profiles(&list);
+        return ENVIL_CONFIG_ERROR;
+    }
+    // Every profile is read before any is validated, so a typo fails fast
+    for (int p = 0; p < list.count; p++) {
+        list.profiles[p].env = load_env_file(list.profiles[p].path);
+        if (!list.profiles[p].env) {
+            free_profiles(&list);
+            return ENVIL_CONFIG_ERROR;
+        }
+    }
+
+    ProfileJob job = {config, &list, 0, deadline_ms};
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = cpus > 0 ? (int)cpus : 1;
+    if (thread_count > PROFILES_MAX_THREADS) thread_count = PROFILES_MAX_THREADS;
+    if (thread_count > list.count) thread_count = list.count;
+
+    pthread_t threads[PROFILES_MAX_THREADS];
+    int started = 0;
+    while (started < thread_count && pthread_create(&threads[started], NULL, profile_worker, &job) == 0) {
+        started++;
+    }
+    if (started == 0) profile_worker(&job);  // No threads to be had, do it here
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    logger(LOG_DEBUG, "Validated %d profiles with %d threads", list.count, started ? started : 1);
+
+    int result = ENVIL_OK;
+    for (int p = 0; p < list.count; p++) {
+        int profile_result = list.profiles[p].result;
+        // A timeout outranks other failures: the report is incomplete
+        if (profile_result != ENVIL_OK && result != ENVIL_TIMEOUT_ERROR) result = profile_result;
+        if (!list.profiles[p].cells || !list.profiles[p].errors) {
+            free_profiles(&list);
+            return ENVIL_CONFIG_ERROR;
+        }
+    }
+    write_matrix(config, &list, out);
+
+    free_profiles(&list);
+    return result;
+}
@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/random.h>
+#include "snapshot.h"
+#include "cache.h"
+#include "config.h"
+#include "hash.h"
+#include "logger.h"
+#include "validator.h"
+
+extern char** environ;
+
+#define SNAPSHOT_HEADER "envil-snapshot 1"
+#define SNAPSHOT_SECOND_SEED 0x84222325cbf29ce4ULL
+#define VALUE_KEY_SIZE 33  // 128-bit fingerprint as hex, plus terminator
+
+typedef struct {
+    char* name;
+    uint64_t definition_hash;
+    char value_key[VALUE_KEY_SIZE];
+    int result;
+    char* message;  // NULL when the variable passed
+} SnapshotEntry;
+
+typedef struct {
+    uint64_t salt;            // Mixed into value fingerprints; random for each new series of snapshots
+    SnapshotEntry* entries;   // Sorted by name
+    int count;
+} Snapshot;
+
+static void value_key(uint64_t salt, const char* value, char* key) {
+    uint64_t hi = hash_string(hash_bytes(HASH_SEED, &salt, sizeof(salt)), value);
+    uint64_t lo = hash_string(hash_bytes(SNAPSHOT_SECOND_SEED, &salt, sizeof(salt)), value);
+    snprintf(key, VALUE_KEY_SIZE, "%016llx%016llx", (unsigned long long)hi, (unsigned long long)lo);
+}
+
+static uint64_t new_salt(void) {
+    uint64_t salt;
+    if (getrandom(&salt, sizeof(salt), 0) != (ssize_t)sizeof(salt)) {
+        salt = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+    }
+    return salt;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    return strcmp(((const SnapshotEntry*)a)->name, ((const SnapshotEntry*)b)->name);
+}
+
+static const SnapshotEntry* find_entry(const Snapshot* snapshot, const char* name) {
+    SnapshotEntry key = {.name = (char*)name};
+    return bsearch(&key, snapshot->entries, (size_t)snapshot->count, sizeof(SnapshotEntry), compare_entries);
+}
+
+static void free_snapshot(Snapshot* snapshot) {
+    for (int i = 0; i < snapshot->count; i++) {
+        free(snapshot->entries[i].name);
+        free(snapshot->entries[i].message);
+    }
+    free(snapshot->entries);
+}
+
+// Parses NAME\tDEFINITION\tVALUE\tRESULT[\tMESSAGE]
+static bool parse_entry(char* line, SnapshotEntry* entry) {
+    char* fields[5] = {line, NULL, NULL, NULL, NULL};
+    for (int i = 1; i < 5; i++) {
+        char* tab = strchr(fields[i - 1], '\t');
+        if (!tab) break;
+        *tab = '\0';
+        fields[i] = tab + 1;
+    }
+    if (!fields[3] || !*fields[0] || strlen(fields[2]) != VALUE_KEY_SIZE - 1) return false;
+
+    char* end;
+    entry->definition_hash = strtoull(fields[1], &end, 16);
+    if (*fields[1] == '\0' || *end != '\0') return false;
+    long result = strtol(fields[3], &end, 10);
+    if (*fields[3] == '\0' || *end != '\0' || result < ENVIL_OK || result > ENVIL_TIMEOUT_ERROR) return false;
+
+    entry->result = (int)result;
+    memcpy(entry->value_key, fields[2], VALUE_KEY_SIZE);
+    entry->name = strdup(fields[0]);
+    entry->message = fields[4] && *fields[4] ? strdup(fields[4]) : NULL;
+    return entry->name != NULL;
+}
+
+static bool read_snapshot(const char* path, Snapshot* snapshot) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        logger(LOG_ERROR, "Error: Cannot read snapshot %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    char* line = NULL;
+    size_t line_size = 0;
+    int capacity = 0, line_number = 0;
+    bool ok = true;
+    ssize_t len;
+    while (ok && (len = getline(&line, &line_size, file)) > 0) {
+        line_number++;
+        if (line[len - 1] == '\n') line[--len] = '\0';
+
+        if (line_number == 1) {
+            char* end;
+            size_t header_len = strlen(SNAPSHOT_HEADER);
+            ok = strncmp(line, SNAPSHOT_HEADER " ", header_len + 1) == 0;
+            if (ok) snapshot->salt = strtoull(line + header_len + 1, &end, 16);
+            ok = ok && *end == '\0';
+            continue;
+        }
+        if (snapshot->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            SnapshotEntry* entries = realloc(snapshot->entries, (size_t)capacity * sizeof(SnapshotEntry));
+            if (!entries) {
+                ok = false;
+                break;
+            }
+            snapshot->entries = entries;
+        }
+        ok = parse_entry(line, &snapshot->entries[snapshot->count]);
+        if (ok) snapshot->count++;
+    }
+    free(line);
+    fclose(file);
+
+    if (!ok || line_number == 0) {
+        logger(LOG_ERROR, "Error: Invalid snapshot %s (line %d)\n", path, line_number);
+        return false;
+    }
+    qsort(snapshot->entries, (size_t)snapshot->count, sizeof(SnapshotEntry), compare_entries);
+    return true;
+}
+
+// Writes the message on one line, whatever it contains
+static void write_message(FILE* file, const char* message) {
+    for (const char* p = message; *p; p++) {
+        fputc(*p == '\t' || *p == '\n' || *p == '\r' ? ' ' : *p, file);
+    }
+}
+
+static bool write_snapshot(const char* path, const Config* config, uint64_t salt,
+                           char (*keys)[VALUE_KEY_SIZE], const int* results, const char* const* messages) {
+    size_t size = strlen(path) + 8;
+    char* tmp_path = malloc(size);
+    if (!tmp_path) return false;
+    snprintf(tmp_path, size, "%s.XXXXXX", path);
+
+    // Fingerprints of secrets are still worth keeping private
+    int fd = mkstemp(tmp_path);
+    FILE* file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!file) {
+        logger(LOG_ERROR, "Error: Cannot write snapshot %s: %s\n", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp_path);
+        }
+        free(tmp_path);
+        return false;
+    }
+
+    fprintf(file, "%s %016llx\n", SNAPSHOT_HEADER, (unsigned long long)salt);
+    for (int i = 0; i < config->variable_count; i++) {
+        fprintf(file, "%s\t%016llx\t%s\t%d", config->variables[i].name,
+                (unsigned long long)config->variables[i].definition_hash, keys[i], results[i]);
+        if (messages[i]) {
+            fputc('\t', file);
+            write_message(file, messages[i]);
+        }
+        fputc('\n', file);
+    }
+
+    bool ok = fclose(file) == 0;
+    if (!ok || rename(tmp_path, path) != 0) {
+        logger(LOG_ERROR, "Error: Cannot write snapshot %s: %s\n", path, strerror(errno));
+        unlink(tmp_path);
+        ok = false;
+    } else {
+        logger(LOG_INFO, "Wrote snapshot %s", path);
+    }
+    free(tmp_path);
+    return ok;
+}
+
+int validate_snapshot(const Config* config, const char* since_path, const char* snapshot_path,
+                      bool print_value, ValidationErrors* errors, CheckStats* stats) {
+    Snapshot since = {0};
+    if (since_path && !read_snapshot(since_path, &since)) {
+        free_snapshot(&since);
+        return ENVIL_CONFIG_ERROR;
+    }
+    uint64_t salt = since_path ? since.salt : new_salt();
+
+    int count = config->variable_count;
+    size_t n = (size_t)(count ? count : 1);
+    const char** values = malloc(n * sizeof(char*));
+    char (*keys)[VALUE_KEY_SIZE] = malloc(n * sizeof(*keys));
+    const SnapshotEntry** recorded = calloc(n, sizeof(SnapshotEntry*));
+    bool* recheck = malloc(n * sizeof(bool));
+    int* known = malloc(n * sizeof(int));
+    int* results = calloc(n, sizeof(int));
+    const char** messages = calloc(n, sizeof(char*));
+    ValidationErrors* fresh = create_validation_errors();
+    bool* used = NULL;  // Fresh errors already reported under a config variable
+    int result = ENVIL_CONFIG_ERROR;
+    if (!values || !keys || !recorded || !recheck || !known || !results || !messages || !fresh) {
+        logger(LOG_ERROR, "Failed to allocate memory for snapshot validation\n");
+        goto cleanup;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        const char* raw = getenv(var->name);
+        values[i] = raw ? raw : var->default_value;
+        // The definition hash covers the default, so the raw value is enough
+        value_key(salt, raw, keys[i]);
+
+        recorded[i] = since_path ? find_entry(&since, var->name) : NULL;
+        recheck[i] = !recorded[i] || recorded[i]->definition_hash != var->definition_hash ||
+                     strcmp(recorded[i]->value_key, keys[i]) != 0 ||
+                     recorded[i]->result == ENVIL_TIMEOUT_ERROR || !variable_is_cacheable(var);
+    }
+    spread_rechecks(config, recheck);
+
+    int rechecked = 0;
+    for (int i = 0; i < count; i++) {
+        known[i] = recheck[i] ? VERDICT_PENDING : recorded[i]->result;
+        rechecked += recheck[i];
+    }
+    validate_config_values(config, values, known, environ, NULL, NULL, print_value, fresh, stats);
+    if (since_path) logger(LOG_INFO, "Revalidated %d of %d variables since %s", rechecked, count, since_path);
+
+    // Fresh and recorded failures together, in config order
+    used = calloc((size_t)(fresh->count ? fresh->count : 1), sizeof(bool));
+    if (!used) {
+        logger(LOG_ERROR, "Failed to allocate memory for snapshot validation\n");
+        goto cleanup;
+    }
+    result = ENVIL_OK;
+    for (int i = 0; i < count; i++) {
+        const char* name = config->variables[i].name;
+        if (recheck[i]) {
+            for (int e = 0; e < fresh->count; e++) {
+                const ValidationError* error = &fresh->errors[e];
+                if (strcmp(error->name, name) != 0) continue;
+                used[e] = true;
+                if (!messages[i]) {
+                    results[i] = error->error_code;
+                    messages[i] = error->message;
+                }
+                add_validation_error(errors, name, error->message, error->error_code);
+            }
+        } else if (recorded[i]->result != ENVIL_OK) {
+            results[i] = recorded[i]->result;
+            messages[i] = recorded[i]->message ? recorded[i]->message : "validation failed";
+            add_validation_error(errors, name, messages[i], results[i]);
+        }
+        // A timeout outranks other failures: the report is incomplete
+        if (results[i] != ENVIL_OK && result != ENVIL_TIMEOUT_ERROR) result = results[i];
+    }
+    // Members of pattern keys are not recorded, and were all validated afresh
+    for (int e = 0; e < fresh->count; e++) {
+        const ValidationError* error = &fresh->errors[e];
+        if (used[e]) continue;
+        add_validation_error(errors, error->name, error->message, error->error_code);
+        if (result != ENVIL_TIMEOUT_ERROR) result = error->error_code;
+    }
+
+    if (snapshot_path && !write_snapshot(snapshot_path, config, salt, keys, results, messages)) {
+        result = ENVIL_CONFIG_ERROR;
+    }
+
+cleanup:
+    free(values);
+    free(keys);
+    free(recorded);
+    free(recheck);
+    free(known);
+    free(results);
+    free(messages);
+    free(used);
+    free_validation_errors(fresh);
+    free_snapshot(&since);
+    return result;
+}
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include "stats.h"
+#include "checks.h"
+#include "logger.h"
+
+#define STATS_HEADER "envil-stats 1\n"
+
+// Weight of the static estimates, in runs, against recorded ones
+#define STATIC_WEIGHT 2
+
+static int find_entry(const CheckStats* stats, uint64_t key, bool* found) {
+    int lo = 0;
+    int hi = stats->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (stats->entries[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = lo < stats->count && stats->entries[lo].key == key;
+    return lo;
+}
+
+static CheckStat* insert_entry(CheckStats* stats, uint64_t key) {
+    bool found;
+    int index = find_entry(stats, key, &found);
+    if (found) return &stats->entries[index];
+
+    if (stats->count >= stats->capacity) {
+        int new_capacity = stats->capacity ? stats->capacity * 2 : 16;
+        CheckStat* new_entries = realloc(stats->entries, new_capacity * sizeof(CheckStat));
+        if (!new_entries) return NULL;
+        stats->entries = new_entries;
+        stats->capacity = new_capacity;
+    }
+    memmove(&stats->entries[index + 1], &stats->entries[index],
+            (stats->count - index) * sizeof(CheckStat));
+    stats->count++;
+
+    CheckStat* entry = &stats->entries[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->key = key;
+    return entry;
+}
+
+CheckStats* load_check_stats(const char* path) {
+    CheckStats* stats = calloc(1, sizeof(CheckStats));
+    if (!stats) return NULL;
+
+    FILE* file = fopen(path, "r");
+    if (!file) return stats;
+
+    char line[128];
+    if (!fgets(line, sizeof(line), file) || strcmp(line, STATS_HEADER) != 0) {
+        logger(LOG_WARNING, "Ignoring invalid stats file %s", path);
+        fclose(file);
+        return stats;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        unsigned long long key, runs, rejections, total_ns;
+        if (sscanf(line, "%llx %llu %llu %llu", &key, &runs, &rejections, &total_ns) != 4 ||
+            rejections > runs) {
+            continue;
+        }
+        CheckStat* entry = insert_entry(stats, key);
+        if (!entry) break;
+        entry->runs = runs;
+        entry->rejections = rejections;
+        entry->total_ns = total_ns;
+    }
+    fclose(file);
+    return stats;
+}
+
+void save_check_stats(const CheckStats* stats, const char* path) {
+    if (!stats || !stats->dirty) return;
+
+    char tmp_path[PATH_MAX + 16];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+    int fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        logger(LOG_WARNING, "Cannot write stats file %s: %s", path, strerror(errno));
+        return;
+    }
+
+    FILE* file = fdopen(fd, "w");
+    if (!file) {
+        close(fd);
+        unlink(tmp_path);
+        return;
+    }
+
+    bool ok = fputs(STATS_HEADER, file) >= 0;
+    for (int i = 0; ok && i < stats->count; i++) {
+        const CheckStat* entry = &stats->entries[i];
+        ok = fprintf(file, "%016llx %llu %llu %llu\n", (unsigned long long)entry->key,
+                     (unsigned long long)entry->runs, (unsigned long long)entry->rejections,
+                     (unsigned long long)entry->total_ns) > 0;
+    }
+    ok = (fclose(file) == 0) && ok;
+
+    // Concurrent runs each replace the whole file, the last one wins
+    if (!ok || rename(tmp_path, path) != 0) {
+        logger(LOG_WARNING, "Cannot write stats file %s", path);
+        unlink(tmp_path);
+    }
+}
+
+void free_check_stats(CheckStats* stats) {
+    if (!stats) return;
+    free(stats->entries);
+    free(stats);
+}
+
+void estimate_check(const CheckStats* stats, const Check* check, double* cost, double* reject_rate) {
+    double static_cost = check->definition->cost ? check->definition->cost : DEFAULT_CHECK_COST;
+    *cost = static_cost;
+    *reject_rate = 0.5;
+    if (!stats) return;
+
+    bool found;
+    int index = find_entry(stats, check->stats_key, &found);
+    if (!found) return;
+
+    // Smoothed towards the static guesses, so one slow outlier cannot flip the order
+    const CheckStat* entry = &stats->entries[index];
+    *cost = (static_cost * STATIC_WEIGHT + (double)entry->total_ns) / (double)(STATIC_WEIGHT + entry->runs);
+    *reject_rate = ((double)entry->rejections + 1.0) / ((double)entry->runs + 2.0);
+}
+
+void record_check_run(CheckStats* stats, const Check* check, bool rejected, uint64_t ns) {
+    CheckStat* entry = insert_entry(stats, check->stats_key);
+    if (!entry) return;
+
+    if (entry->runs >= STATS_MAX_RUNS) {
+        entry->runs /= 2;
+        entry->rejections /= 2;
+        entry->total_ns /= 2;
+    }
+    entry->runs++;
+    entry->rejections += rejected;
+    entry->total_ns += ns;
+    stats->dirty = true;
+}
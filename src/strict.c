@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strict.h"
+#include "logger.h"
+#include "pattern.h"
+#include "validator.h"
+
+typedef struct {
+    const char* text;
+    size_t len;
+} Name;
+
+// A declared name with the byte at skip left out, skip -1 for none
+typedef struct {
+    const char* text;
+    int skip;
+    int var;
+} NearKey;
+
+static int compare_names(const void* a, const void* b) {
+    const Name* x = a;
+    const Name* y = b;
+    int cmp = memcmp(x->text, y->text, x->len < y->len ? x->len : y->len);
+    if (cmp != 0) return cmp;
+    return x->len < y->len ? -1 : x->len > y->len;
+}
+
+static unsigned char key_char(const NearKey* key, int i) {
+    return (unsigned char)key->text[key->skip >= 0 && i >= key->skip ? i + 1 : i];
+}
+
+static int compare_near_text(const NearKey* a, const NearKey* b) {
+    for (int i = 0;; i++) {
+        unsigned char x = key_char(a, i), y = key_char(b, i);
+        if (x != y) return x < y ? -1 : 1;
+        if (!x) return 0;
+    }
+}
+
+static int compare_near_keys(const void* a, const void* b) {
+    int cmp = compare_near_text(a, b);
+    if (cmp != 0) return cmp;
+    // Ties keep config order, so the first declared near miss is suggested
+    return ((const NearKey*)a)->var - ((const NearKey*)b)->var;
+}
+
+// True when one substitution, insertion, deletion or swap of neighbours turns a into b
+static bool one_edit_apart(const char* a, const char* b) {
+    size_t la = strlen(a), lb = strlen(b);
+    if (la < lb) {
+        const char* t = a; a = b; b = t;
+        size_t tl = la; la = lb; lb = tl;
+    }
+    if (la - lb > 1) return false;
+    size_t i = 0;
+    while (i < lb && a[i] == b[i]) i++;
+    if (la != lb) return strcmp(a + i + 1, b + i) == 0;
+    if (i == la) return false;
+    if (strcmp(a + i + 1, b + i + 1) == 0) return true;
+    return i + 1 < la && a[i] == b[i + 1] && a[i + 1] == b[i] && strcmp(a + i + 2, b + i + 2) == 0;
+}
+
+// The first declared name one edit away from name, NULL for none
+static const char* suggest(const Config* config, const NearKey* index, int index_count, const char* name) {
+    int best = -1;
+    int len = (int)strlen(name);
+    // Equal texts with name as is or missing one byte cover every single edit
+    for (int skip = -1; skip < len; skip++) {
+        NearKey query = {name, skip, -1};
+        int lo = 0, hi = index_count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (compare_near_text(&index[mid], &query) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        for (int i = lo; i < index_count && compare_near_text(&index[i], &query) == 0; i++) {
+            int var = index[i].var;
+            if ((best < 0 || var < best) && one_edit_apart(name, config->variables[var].name)) best = var;
+        }
+    }
+    return best >= 0 ? config->variables[best].name : NULL;
+}
+
+static NearKey* build_near_index(const Config* config, int* count) {
+    int total = 0;
+    for (int v = 0; v < config->variable_count; v++) {
+        total += (int)strlen(config->variables[v].name) + 1;
+    }
+    NearKey* index = malloc((size_t)(total ? total : 1) * sizeof(NearKey));
+    if (!index) return NULL;
+
+    int n = 0;
+    for (int v = 0; v < config->variable_count; v++) {
+        const char* name = config->variables[v].name;
+        int len = (int)strlen(name);
+        for (int skip = -1; skip < len; skip++) {
+            index[n++] = (NearKey){name, skip, v};
+        }
+    }
+    qsort(index, (size_t)n, sizeof(NearKey), compare_near_keys);
+    *count = n;
+    return index;
+}
+
+// The declared prefixes up to and including the first _, sorted
+static Name* declared_prefixes(const Config* config, int* count) {
+    int total = config->variable_count + config->pattern_count;
+    Name* prefixes = malloc((size_t)(total ? total : 1) * sizeof(Name));
+    if (!prefixes) return NULL;
+
+    int n = 0;
+    for (int i = 0; i < total; i++) {
+        bool is_var = i < config->variable_count;
+        const char* name = is_var ? config->variables[i].name : config->patterns[i - config->variable_count].name;
+        size_t len = strcspn(name, is_var ? "_" : "_*?");
+        if (name[len] == '_') prefixes[n++] = (Name){name, len + 1};
+    }
+    qsort(prefixes, (size_t)n, sizeof(Name), compare_names);
+    *count = n;
+    return prefixes;
+}
+
+static bool in_scope(const char* name, size_t len, const char* prefix, const Name* prefixes, int prefix_count) {
+    if (*prefix) return strncmp(name, prefix, strlen(prefix)) == 0;
+    const char* underscore = memchr(name, '_', len);
+    if (!underscore) return false;
+    Name key = {name, (size_t)(underscore - name) + 1};
+    return bsearch(&key, prefixes, (size_t)prefix_count, sizeof(Name), compare_names) != NULL;
+}
+
+int check_undeclared(const Config* config, const char* prefix, char* const* envp, ValidationErrors* errors) {
+    int env_count = 0;
+    while (envp[env_count]) env_count++;
+
+    int declared_count = config->variable_count;
+    Name* declared = malloc((size_t)(declared_count ? declared_count : 1) * sizeof(Name));
+    Name* present = malloc((size_t)(env_count ? env_count : 1) * sizeof(Name));
+    int* matches = config->pattern_count ? malloc((size_t)config->pattern_count * sizeof(int)) : NULL;
+    int prefix_count = 0, index_count = 0;
+    Name* prefixes = *prefix ? NULL : declared_prefixes(config, &prefix_count);
+    NearKey* index = NULL;
+    int result = ENVIL_CONFIG_ERROR;
+    if (!declared || !present || (config->pattern_count && !matches) || (!*prefix && !prefixes)) goto cleanup;
+
+    for (int i = 0; i < declared_count; i++) {
+        declared[i] = (Name){config->variables[i].name, strlen(config->variables[i].name)};
+    }
+    qsort(declared, (size_t)declared_count, sizeof(Name), compare_names);
+
+    // Names in scope, less those a pattern declares
+    int present_count = 0;
+    for (int i = 0; i < env_count; i++) {
+        const char* equals = strchr(envp[i], '=');
+        if (!equals) continue;
+        size_t len = (size_t)(equals - envp[i]);
+        if (!in_scope(envp[i], len, prefix, prefixes, prefix_count)) continue;
+        if (matches && match_patterns(config->pattern_set, envp[i], len, matches) > 0) continue;
+        present[present_count++] = (Name){envp[i], len};
+    }
+    qsort(present, (size_t)present_count, sizeof(Name), compare_names);
+
+    result = ENVIL_OK;
+    int undeclared = 0;
+    for (int p = 0, d = 0; p < present_count; p++) {
+        if (p > 0 && compare_names(&present[p - 1], &present[p]) == 0) continue;
+        while (d < declared_count && compare_names(&declared[d], &present[p]) < 0) d++;
+        if (d < declared_count && compare_names(&declared[d], &present[p]) == 0) continue;
+
+        // Only built once something is undeclared, which a passing run never needs
+        if (!index && !(index = build_near_index(config, &index_count))) {
+            result = ENVIL_CONFIG_ERROR;
+            break;
+        }
+        char* name = strndup(present[p].text, present[p].len);
+        if (!name) {
+            result = ENVIL_CONFIG_ERROR;
+            break;
+        }
+        const char* suggestion = suggest(config, index, index_count, name);
+        char message[512];
+        if (suggestion) {
+            snprintf(message, sizeof(message), "not declared in the config (did you mean %s?)", suggestion);
+        } else {
+            snprintf(message, sizeof(message), "not declared in the config");
+        }
+        add_validation_error(errors, name, message, ENVIL_VALUE_ERROR);
+        free(name);
+        undeclared++;
+        result = ENVIL_VALUE_ERROR;
+    }
+    logger(LOG_INFO, "Strict: %d of %d names in scope are not declared", undeclared, present_count);
+
+cleanup:
+    if (result == ENVIL_CONFIG_ERROR) logger(LOG_ERROR, "Failed to allocate memory for the strict check\n");
+    free(declared);
+    free(present);
+    free(matches);
+    free(prefixes);
+    free(index);
+    return result;
+}
@@ -15,6 +15,10 @@ const char* get_type_name(EnvType type) {
             return "float";
         case TYPE_JSON:
             return "json";
+        case TYPE_DURATION:
+            return "duration";
+        case TYPE_BYTESIZE:
+            return "bytesize";
         default:
             return "unknown";
     }
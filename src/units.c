@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <string.h>
+#include "units.h"
+
+typedef struct {
+    const char* name;
+    int64_t scale;
+} Unit;
+
+// Smallest first; format_duration picks from this order
+static const Unit duration_units[] = {
+    {"ns", 1},
+    {"us", 1000},
+    {"\xc2\xb5s", 1000},  // µs
+    {"ms", 1000000},
+    {"s", 1000000000},
+    {"m", 60 * (int64_t)1000000000},
+    {"h", 3600 * (int64_t)1000000000},
+    {"d", 86400 * (int64_t)1000000000},
+};
+
+#define KIB ((int64_t)1 << 10)
+
+static const Unit size_units[] = {
+    {"", 1}, {"B", 1},
+    {"k", 1000}, {"kB", 1000}, {"KB", 1000},
+    {"MB", 1000000}, {"GB", 1000000000},
+    {"TB", 1000000000000}, {"PB", 1000000000000000}, {"EB", 1000000000000000000},
+    {"K", KIB}, {"Ki", KIB}, {"KiB", KIB},
+    {"M", KIB << 10}, {"Mi", KIB << 10}, {"MiB", KIB << 10},
+    {"G", KIB << 20}, {"Gi", KIB << 20}, {"GiB", KIB << 20},
+    {"T", KIB << 30}, {"Ti", KIB << 30}, {"TiB", KIB << 30},
+    {"P", KIB << 40}, {"Pi", KIB << 40}, {"PiB", KIB << 40},
+    {"E", KIB << 50}, {"Ei", KIB << 50}, {"EiB", KIB << 50},
+};
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Positions of the digits of "12.5", kept as text so that the fraction can be
+// scaled exactly once the unit is known, without going through a double
+typedef struct {
+    size_t int_start, int_end;
+    size_t frac_start, frac_end;
+} Decimal;
+
+// Reads digits[.digits] at *pos
+static bool read_decimal(const char* str, size_t len, size_t* pos, Decimal* decimal) {
+    size_t i = *pos;
+    decimal->int_start = i;
+    while (i < len && is_digit(str[i])) i++;
+    decimal->int_end = i;
+    decimal->frac_start = decimal->frac_end = i;
+    if (i < len && str[i] == '.') {
+        decimal->frac_start = ++i;
+        while (i < len && is_digit(str[i])) i++;
+        decimal->frac_end = i;
+        if (decimal->frac_end == decimal->frac_start) return false;  // "5." is not a number
+    }
+    if (decimal->int_end == decimal->int_start && decimal->frac_end == decimal->frac_start) return false;
+    *pos = i;
+    return true;
+}
+
+// value * scale, truncated below 1, or false on overflow
+static bool scale_decimal(const char* str, const Decimal* decimal, int64_t scale, int64_t* value) {
+    int64_t total = 0;
+    for (size_t i = decimal->int_start; i < decimal->int_end; i++) {
+        if (__builtin_mul_overflow(total, 10, &total) ||
+            __builtin_add_overflow(total, str[i] - '0', &total)) {
+            return false;
+        }
+    }
+    if (__builtin_mul_overflow(total, scale, &total)) return false;
+
+    // fraction * scale / 10^digits, exact for the first 18 digits
+    int64_t fraction = 0, denominator = 1;
+    for (size_t i = decimal->frac_start; i < decimal->frac_end && denominator <= 100000000000000000; i++) {
+        fraction = fraction * 10 + (str[i] - '0');
+        denominator *= 10;
+    }
+    int64_t fraction_part = (int64_t)((__int128)fraction * scale / denominator);
+    if (__builtin_add_overflow(total, fraction_part, &total)) return false;
+    *value = total;
+    return true;
+}
+
+// Matches the longest unit name at str[pos]
+static const Unit* match_unit(const Unit* units, size_t count, const char* str, size_t len, size_t pos) {
+    const Unit* best = NULL;
+    size_t best_len = 0;
+    for (size_t u = 0; u < count; u++) {
+        size_t name_len = strlen(units[u].name);
+        if (name_len >= best_len && name_len <= len - pos && strncmp(str + pos, units[u].name, name_len) == 0) {
+            best = &units[u];
+            best_len = name_len;
+        }
+    }
+    return best;
+}
+
+bool parse_duration(const char* str, size_t len, int64_t* ns) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < len && (str[i] == '-' || str[i] == '+')) negative = str[i++] == '-';
+    if (i == len) return false;
+
+    if (len - i == 1 && str[i] == '0') {
+        *ns = 0;
+        return true;
+    }
+
+    int64_t total = 0;
+    while (i < len) {
+        Decimal decimal;
+        if (!read_decimal(str, len, &i, &decimal)) return false;
+
+        const Unit* unit = match_unit(duration_units, sizeof(duration_units) / sizeof(duration_units[0]), str, len, i);
+        if (!unit) return false;
+        i += strlen(unit->name);
+
+        int64_t part;
+        if (!scale_decimal(str, &decimal, unit->scale, &part) || __builtin_add_overflow(total, part, &total)) {
+            return false;
+        }
+    }
+
+    *ns = negative ? -total : total;
+    return true;
+}
+
+bool parse_byte_size(const char* str, size_t len, int64_t* bytes) {
+    size_t i = 0;
+    Decimal decimal;
+    if (!read_decimal(str, len, &i, &decimal)) return false;
+
+    // The whole rest must be one unit name
+    for (size_t u = 0; u < sizeof(size_units) / sizeof(size_units[0]); u++) {
+        if (strlen(size_units[u].name) == len - i && strncmp(str + i, size_units[u].name, len - i) == 0) {
+            return scale_decimal(str, &decimal, size_units[u].scale, bytes);
+        }
+    }
+    return false;
+}
+
+const char* format_duration(int64_t ns, char* buf, size_t size) {
+    // Largest first; "us" rather than "µs" keeps the output ASCII
+    static const int order[] = {7, 6, 5, 4, 3, 1, 0};
+    for (size_t k = 0; k < sizeof(order) / sizeof(order[0]); k++) {
+        const Unit* unit = &duration_units[order[k]];
+        if (ns != 0 && ns % unit->scale == 0) {
+            snprintf(buf, size, "%lld%s", (long long)(ns / unit->scale), unit->name);
+            return buf;
+        }
+    }
+    snprintf(buf, size, "%llds", (long long)ns);  // Only 0 gets here
+    return buf;
+}
+
+const char* format_byte_size(int64_t bytes, char* buf, size_t size) {
+    static const char* const binary[] = {"KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+    static const char* const decimal[] = {"kB", "MB", "GB", "TB", "PB", "EB"};
+
+    const char* unit = "B";
+    int64_t amount = bytes;
+    int64_t binary_scale = KIB, decimal_scale = 1000;
+    for (int k = 0; k < 6 && bytes != 0; k++) {
+        if (bytes % binary_scale == 0) {
+            unit = binary[k];
+            amount = bytes / binary_scale;
+        } else if (bytes % decimal_scale == 0) {
+            unit = decimal[k];
+            amount = bytes / decimal_scale;
+        }
+        if (k < 5) {
+            binary_scale <<= 10;
+            decimal_scale *= 1000;
+        }
+    }
+    snprintf(buf, size, "%lld%s", (long long)amount, unit);
+    return buf;
+}
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <string.h>
+#include "url.h"
+#include "validator.h"
+
+static const char* const component_names[URL_COMPONENT_COUNT] = {
+    "scheme", "userinfo", "host", "port", "path", "query",
+};
+
+const char* url_component_name(UrlComponent component) {
+    return component < URL_COMPONENT_COUNT ? component_names[component] : "?";
+}
+
+bool find_url_component(const char* name, size_t len, UrlComponent* component) {
+    for (int i = 0; i < URL_COMPONENT_COUNT; i++) {
+        if (strlen(component_names[i]) == len && strncmp(name, component_names[i], len) == 0) {
+            *component = (UrlComponent)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static void set_span(UrlParts* parts, UrlComponent component, const char* start, size_t len) {
+    parts->parts[component] = (UrlSpan){start, len, true};
+}
+
+// Scans up to the first of the stop characters, or the end
+static size_t span_until(const char* str, size_t start, size_t len, const char* stops) {
+    while (start < len && !strchr(stops, str[start])) start++;
+    return start;
+}
+
+bool parse_url(const char* str, size_t len, UrlParts* parts) {
+    memset(parts, 0, sizeof(*parts));
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)str[i];
+        if (c <= ' ' || c == 0x7f) return false;
+    }
+
+    size_t i = 0;
+    if (len == 0 || !is_alpha(str[0])) return false;
+    while (i < len && (is_alpha(str[i]) || is_digit(str[i]) || str[i] == '+' || str[i] == '-' || str[i] == '.')) i++;
+    if (i == len || str[i] != ':') return false;
+    set_span(parts, URL_SCHEME, str, i);
+    i++;
+
+    if (len - i >= 2 && str[i] == '/' && str[i + 1] == '/') {
+        size_t start = i + 2;
+        size_t end = span_until(str, start, len, "/?#");
+
+        // The last '@' ends the userinfo, which may itself contain '@' in a password
+        size_t host_start = start;
+        for (size_t k = start; k < end; k++) {
+            if (str[k] == '@') host_start = k + 1;
+        }
+        if (host_start > start) set_span(parts, URL_USERINFO, str + start, host_start - 1 - start);
+
+        size_t port_start = end;
+        if (host_start < end && str[host_start] == '[') {
+            const char* close = memchr(str + host_start, ']', end - host_start);
+            if (!close) return false;
+            size_t close_at = (size_t)(close - str);
+            set_span(parts, URL_HOST, str + host_start + 1, close_at - host_start - 1);
+            if (close_at + 1 < end) {
+                if (str[close_at + 1] != ':') return false;
+                port_start = close_at + 2;
+            }
+        } else {
+            size_t colon = end;
+            for (size_t k = host_start; k < end; k++) {
+                if (str[k] == ':') colon = k;
+            }
+            // "postgres:///db" has no host (a local socket), rather than an empty one
+            if (colon > host_start) set_span(parts, URL_HOST, str + host_start, colon - host_start);
+            if (colon < end) port_start = colon + 1;
+        }
+
+        // "host:" has an empty port, which RFC 3986 allows and means the default
+        if (port_start < end) {
+            for (size_t k = port_start; k < end; k++) {
+                if (!is_digit(str[k])) return false;
+            }
+            set_span(parts, URL_PORT, str + port_start, end - port_start);
+        }
+        i = end;
+    }
+
+    size_t path_end = span_until(str, i, len, "?#");
+    if (path_end > i) set_span(parts, URL_PATH, str + i, path_end - i);
+    i = path_end;
+
+    if (i < len && str[i] == '?') {
+        size_t query_end = span_until(str, i + 1, len, "#");
+        set_span(parts, URL_QUERY, str + i + 1, query_end - i - 1);
+    }
+    return true;
+}
+
+int find_url_failure(const UrlCheck* url, const char* str, size_t len, int* result) {
+    UrlParts parts;
+    *result = ENVIL_VALUE_ERROR;
+    if (!parse_url(str, len, &parts)) return URL_INVALID;
+
+    // Components are never longer than the value; one buffer serves them all
+    char small[256];
+    char* buffer = len < sizeof(small) ? small : malloc(len + 1);
+    if (!buffer) return URL_INVALID;
+
+    int failed = -1;
+    for (int i = 0; i < url->count && failed < 0; i++) {
+        const UrlComponentCheck* entry = &url->checks[i];
+        const UrlSpan* span = &parts.parts[entry->component];
+        if (!span->present) {
+            if (!entry->check.definition) failed = i;
+            continue;
+        }
+        if (!entry->check.definition) continue;
+
+        memcpy(buffer, span->start, span->len);
+        buffer[span->len] = '\0';
+        int check_result = validate_check(&entry->check, buffer);
+        if (check_result != ENVIL_OK) {
+            *result = check_result;
+            failed = i;
+        }
+    }
+
+    if (buffer != small) free(buffer);
+    if (failed < 0) *result = ENVIL_OK;
+    return failed;
+}
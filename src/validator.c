@@ -2,100 +2,490 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <math.h>
 #include <unistd.h>
 #include <stdarg.h>
-#include <json-c/json.h>
+#include <time.h>
 #include "validator.h"
+#include "jsonscan.h"
+#include "numparse.h"
 #include "types.h"
 #include "logger.h"
+#include "stats.h"
+#include "netaddr.h"
+#include "formats.h"
+#include "fscheck.h"
+#include "url.h"
+#include "units.h"
+#include "expr.h"
+#include "checks.h"
 
 #define INITIAL_ERROR_CAPACITY 8
 
+// Variables with more checks than this run them in canonical order
+#define MAX_ORDERED_CHECKS 64
+
 bool is_integer(const char *str) {
-    if (!str || !*str) return false;
-    
-    // Handle negative numbers
-    if (*str == '-') str++;
-    
-    // Check that all remaining characters are digits
-    while (*str) {
-        if (!isdigit(*str)) return false;
-        str++;
-    }
-    return true;
+    if (!str) return false;
+
+    int64_t value;
+    return parse_int64(str, strlen(str), &value);
 }
 
 bool is_float(const char *str) {
-    if (!str || !*str) return false;
-    
-    char *endptr;
-    strtod(str, &endptr);
-    return *endptr == '\0';
+    if (!str) return false;
+
+    double value;
+    return parse_double(str, strlen(str), &value);
 }
 
 bool is_json(const char *str) {
     if (!str || !*str) return false;
     
-    struct json_object *obj = json_tokener_parse(str);
-    if (obj == NULL) {
-        return false;
+    return json_validate(str, strlen(str));
+}
+
+void analyze_value(ValueInfo *info, const char *str) {
+    info->str = str;
+    info->length = 0;
+    info->flags = 0;
+    info->number.is_float = false;
+    info->number.int_value = 0;
+    info->number.float_value = 0;
+    info->number.unit = UNIT_NONE;
+}
+
+size_t value_length(ValueInfo *info) {
+    if (!(info->flags & VALUE_LENGTH_KNOWN)) {
+        info->length = strlen(info->str);
+        info->flags |= VALUE_LENGTH_KNOWN;
     }
-    
-    json_object_put(obj); // Free the object
+    return info->length;
+}
+
+// Int64 when the text is an in-range integer, double otherwise
+static bool parse_number_text(const char *str, size_t len, Number *number) {
+    int64_t int_value;
+    if (parse_int64(str, len, &int_value)) {
+        number->is_float = false;
+        number->int_value = int_value;
+        number->float_value = (double)int_value;
+        number->unit = UNIT_NONE;
+        return true;
+    }
+
+    double float_value;
+    if (!parse_double(str, len, &float_value)) return false;
+
+    number->is_float = true;
+    number->int_value = 0;
+    number->float_value = float_value;
+    number->unit = UNIT_NONE;
     return true;
 }
 
-int validate_type(EnvType type, const char *value) {
-    if (!value) return ENVIL_TYPE_ERROR;
+// Classifies the value and parses it as a number, once
+static void parse_value_number(ValueInfo *info) {
+    if (info->flags & VALUE_NUMBER_PARSED) return;
+    info->flags |= VALUE_NUMBER_PARSED;
+
+    if (parse_number_text(info->str, value_length(info), &info->number)) {
+        info->flags |= VALUE_IS_NUMBER;
+        if (!info->number.is_float) info->flags |= VALUE_IS_INTEGER;
+    }
+}
+
+bool value_is_integer(ValueInfo *info) {
+    parse_value_number(info);
+    return info->flags & VALUE_IS_INTEGER;
+}
+
+const Number *value_number(ValueInfo *info) {
+    parse_value_number(info);
+    return (info->flags & VALUE_IS_NUMBER) ? &info->number : NULL;
+}
+
+bool parse_number(const char *str, Number *number) {
+    if (!str) return false;
+
+    return parse_number_text(str, strlen(str), number);
+}
+
+static bool parse_quantity_text(const char *str, size_t len, NumberUnit unit, Number *number) {
+    int64_t amount;
+    bool valid = unit == UNIT_DURATION ? parse_duration(str, len, &amount) : parse_byte_size(str, len, &amount);
+    if (!valid) return false;
+
+    number->is_float = false;
+    number->int_value = amount;
+    number->float_value = (double)amount;
+    number->unit = unit;
+    return true;
+}
+
+const Number *value_quantity(ValueInfo *info, NumberUnit unit) {
+    if (unit == UNIT_NONE) return value_number(info);
+
+    bool is_duration = unit == UNIT_DURATION;
+    unsigned parsed = is_duration ? VALUE_DURATION_PARSED : VALUE_BYTESIZE_PARSED;
+    unsigned valid = is_duration ? VALUE_IS_DURATION : VALUE_IS_BYTESIZE;
+    Number *quantity = is_duration ? &info->duration : &info->bytesize;
+
+    if (!(info->flags & parsed)) {
+        info->flags |= parsed;
+        if (parse_quantity_text(info->str, value_length(info), unit, quantity)) info->flags |= valid;
+    }
+    return (info->flags & valid) ? quantity : NULL;
+}
+
+bool parse_threshold(const char *str, Number *number) {
+    if (!str) return false;
+
+    size_t len = strlen(str);
+    if (parse_number_text(str, len, number)) return true;
+    // Duration and size units do not overlap ("m" is minutes, "M" mebibytes)
+    return parse_quantity_text(str, len, UNIT_DURATION, number) ||
+           parse_quantity_text(str, len, UNIT_BYTES, number);
+}
+
+// Exact int64 vs double comparison, no rounding of the integer to double
+static int compare_int_double(int64_t i, double d) {
+    if (d >= 9223372036854775808.0) return -1;
+    if (d < -9223372036854775808.0) return 1;
+
+    int64_t truncated = (int64_t)d;
+    if (i != truncated) return i < truncated ? -1 : 1;
+
+    double fraction = d - (double)truncated;
+    return fraction > 0 ? -1 : (fraction < 0 ? 1 : 0);
+}
+
+bool compare_numbers(const Number *a, const Number *b, int *result) {
+    if ((a->is_float && isnan(a->float_value)) || (b->is_float && isnan(b->float_value))) {
+        return false;  // Unordered
+    }
+
+    if (!a->is_float && !b->is_float) {
+        *result = (a->int_value > b->int_value) - (a->int_value < b->int_value);
+    } else if (a->is_float && b->is_float) {
+        *result = (a->float_value > b->float_value) - (a->float_value < b->float_value);
+    } else if (!a->is_float) {
+        *result = compare_int_double(a->int_value, b->float_value);
+    } else {
+        *result = -compare_int_double(b->int_value, a->float_value);
+    }
+    return true;
+}
+
+const char *format_number(const Number *number, char *buf, size_t size) {
+    if (number->unit == UNIT_DURATION) {
+        format_duration(number->int_value, buf, size);
+    } else if (number->unit == UNIT_BYTES) {
+        format_byte_size(number->int_value, buf, size);
+    } else if (!number->is_float) {
+        snprintf(buf, size, "%lld", (long long)number->int_value);
+    } else if (number->float_value == trunc(number->float_value) && fabs(number->float_value) < 1e15) {
+        // Integral thresholds written as floats (e.g. -10.0) print as such
+        snprintf(buf, size, "%.1f", number->float_value);
+    } else {
+        // Shortest representation that round-trips
+        snprintf(buf, size, "%.17g", number->float_value);
+        for (int precision = 1; precision < 17; precision++) {
+            char shorter[64];
+            snprintf(shorter, sizeof(shorter), "%.*g", precision, number->float_value);
+            if (strtod(shorter, NULL) == number->float_value) {
+                snprintf(buf, size, "%s", shorter);
+                break;
+            }
+        }
+    }
+    return buf;
+}
+
+int validate_type_value(EnvType type, ValueInfo *value) {
+    if (!value || !value->str) return ENVIL_TYPE_ERROR;
 
     switch (type) {
         case TYPE_STRING:
             return ENVIL_OK;
         case TYPE_INTEGER:
-            return is_integer(value) ? ENVIL_OK : ENVIL_TYPE_ERROR;
+            return value_is_integer(value) ? ENVIL_OK : ENVIL_TYPE_ERROR;
         case TYPE_JSON:
-            return is_json(value) ? ENVIL_OK : ENVIL_TYPE_ERROR;
+            return value_length(value) > 0 && json_validate(value->str, value_length(value))
+                   ? ENVIL_OK : ENVIL_TYPE_ERROR;
         case TYPE_FLOAT:
-            return is_float(value) ? ENVIL_OK : ENVIL_TYPE_ERROR;
+            return value_number(value) ? ENVIL_OK : ENVIL_TYPE_ERROR;
+        case TYPE_DURATION:
+            return value_quantity(value, UNIT_DURATION) ? ENVIL_OK : ENVIL_TYPE_ERROR;
+        case TYPE_BYTESIZE:
+            return value_quantity(value, UNIT_BYTES) ? ENVIL_OK : ENVIL_TYPE_ERROR;
         default:
             return ENVIL_TYPE_ERROR;
     }
 }
 
+int validate_type(EnvType type, const char *value) {
+    if (!value) return ENVIL_TYPE_ERROR;
+
+    ValueInfo info;
+    analyze_value(&info, value);
+    return validate_type_value(type, &info);
+}
+
+// Returns the argument a check callback expects for the stored check value
+static const void *check_argument(const Check *check) {
+    const char *name = check->definition->name;
+
+    if (strcmp(name, "enum") == 0) return check->value.enum_values;
+    if (strcmp(name, "cmd") == 0) return &check->value.cmd_value;
+    if (strcmp(name, "type") == 0) return &check->value.int_value;
+    if (strcmp(name, "gt") == 0 || strcmp(name, "lt") == 0 ||
+        strcmp(name, "ge") == 0 || strcmp(name, "le") == 0) {
+        return &check->value.number_value;
+    }
+    if (strcmp(name, "len") == 0 || strcmp(name, "lengt") == 0 || strcmp(name, "lenlt") == 0) {
+        return &check->value.size_value;
+    }
+    if (strcmp(name, "eq") == 0 || strcmp(name, "ne") == 0) return check->value.str_value;
+    if (strcmp(name, "regex") == 0) return check->value.regex_check;
+    if (is_net_check(name)) return &check->value.net_value;
+    if (strcmp(name, "uuid") == 0) return &check->value.int_value;
+    if (strcmp(name, "base64") == 0 || strcmp(name, "base64url") == 0 || strcmp(name, "hex") == 0) {
+        return &check->value.size_value;
+    }
+    if (strcmp(name, "semver") == 0) return check->value.semver_range;
+    if (strcmp(name, "url") == 0) return check->value.url_check;
+    if (strcmp(name, "max_size") == 0) return &check->value.size_value;
+    if (strcmp(name, "expr") == 0) return check->value.expr;
+    if (is_fs_check(name)) return &check->value.int_value;
+    if (!is_builtin_check(name)) return check->value.custom_value;
+    return &check->value;
+}
+
+int validate_check_value(const Check *check, ValueInfo *value) {
+    if (!check || !value || !value->str || !check->definition) return ENVIL_VALUE_ERROR;
+
+    if (check->definition->value_callback) {
+        return check->definition->value_callback(value, check_argument(check));
+    }
+    return check->definition->callback(value->str, check_argument(check));
+}
+
 int validate_check(const Check *check, const char *value) {
     if (!check || !value || !check->definition) return ENVIL_VALUE_ERROR;
-    
-    if (strcmp(check->definition->name, "enum") == 0) {
-        return check->definition->callback(value, check->value.enum_values);
-    }
-    if (strcmp(check->definition->name, "cmd") == 0) {
-        return check->definition->callback(value, &check->value.cmd_value);
+
+    ValueInfo info;
+    analyze_value(&info, value);
+    return validate_check_value(check, &info);
+}
+
+static bool is_type_check(const Check *check) {
+    return strcmp(check->definition->name, "type") == 0;
+}
+
+static void describe_failure(const Check *check, ValueInfo *value, char *message, size_t size);
+
+// Names the part of a URL that failed, e.g. " (port: failed le check (...))"
+static void describe_url_failure(const UrlCheck *url, ValueInfo *value, char *message, size_t size) {
+    int result;
+    int failed = find_url_failure(url, value->str, value_length(value), &result);
+    if (failed == URL_INVALID) {
+        snprintf(message, size, " (not a valid URL)");
+        return;
     }
-    if (strcmp(check->definition->name, "type") == 0) {
-        return check->definition->callback(value, &check->value.int_value);
+    if (failed < 0) return;
+
+    const UrlComponentCheck *entry = &url->checks[failed];
+    const char *component = url_component_name(entry->component);
+    if (!entry->check.definition) {
+        snprintf(message, size, " (%s is missing)", component);
+    } else if (is_type_check(&entry->check)) {
+        snprintf(message, size, " (%s: invalid type - expected %s)", component,
+                 get_type_name(entry->check.value.int_value));
+    } else {
+        char inner[256];
+        describe_failure(&entry->check, NULL, inner, sizeof(inner));
+        snprintf(message, size, " (%s: %s)", component, inner);
     }
-    if (strcmp(check->definition->name, "len") == 0) {
-        return check->definition->callback(value, &check->value.int_value);
+}
+
+// Describes a failed check other than type, e.g. "failed gt check (value must be greater than 1024)".
+// value is only needed for url checks.
+static void describe_failure(const Check *check, ValueInfo *value, char *message, size_t size) {
+    const char *name = check->definition->name;
+    char number[64];
+    size_t len = (size_t)snprintf(message, size, "failed %s check", name);
+    if (len >= size) return;
+
+    if (strcmp(name, "gt") == 0) {
+        snprintf(message + len, size - len, " (value must be greater than %s)", format_number(&check->value.number_value, number, sizeof(number)));
+    } else if (strcmp(name, "lt") == 0) {
+        snprintf(message + len, size - len, " (value must be less than %s)", format_number(&check->value.number_value, number, sizeof(number)));
+    } else if (strcmp(name, "ge") == 0) {
+        snprintf(message + len, size - len, " (value must be greater than or equal to %s)", format_number(&check->value.number_value, number, sizeof(number)));
+    } else if (strcmp(name, "le") == 0) {
+        snprintf(message + len, size - len, " (value must be less than or equal to %s)", format_number(&check->value.number_value, number, sizeof(number)));
+    } else if (strcmp(name, "eq") == 0) {
+        snprintf(message + len, size - len, " (value must be equal to %s)", check->value.str_value);
+    } else if (strcmp(name, "ne") == 0) {
+        snprintf(message + len, size - len, " (value must not be equal to %s)", check->value.str_value);
+    } else if (strcmp(name, "len") == 0) {
+        snprintf(message + len, size - len, " (length must be exactly %zu)", check->value.size_value);
+    } else if (strcmp(name, "lengt") == 0) {
+        snprintf(message + len, size - len, " (length must be greater than %zu)", check->value.size_value);
+    } else if (strcmp(name, "lenlt") == 0) {
+        snprintf(message + len, size - len, " (length must be less than %zu)", check->value.size_value);
+    } else if (strcmp(name, "regex") == 0) {
+        snprintf(message + len, size - len, " (value must match pattern: %s)", check->value.regex_check->pattern);
+    } else if (is_net_check(name)) {
+        char constraint[128];
+        format_net_constraint(&check->value.net_value, constraint, sizeof(constraint));
+        if (*constraint) snprintf(message + len, size - len, " (must be %s)", constraint);
+    } else if (strcmp(name, "uuid") == 0 && check->value.int_value) {
+        len += (size_t)snprintf(message + len, size - len, " (version must be");
+        for (int version = 1; version <= 8 && len < size; version++) {
+            if (check->value.int_value & (1 << version)) {
+                len += (size_t)snprintf(message + len, size - len, " %d", version);
+            }
+        }
+        if (len < size) snprintf(message + len, size - len, ")");
+    } else if ((strcmp(name, "base64") == 0 || strcmp(name, "base64url") == 0 ||
+                strcmp(name, "hex") == 0) && check->value.size_value) {
+        snprintf(message + len, size - len, " (must encode %zu bytes)", check->value.size_value);
+    } else if (strcmp(name, "semver") == 0 && check->value.semver_range->count) {
+        snprintf(message + len, size - len, " (version must satisfy %s)", check->value.semver_range->text);
+    } else if (strcmp(name, "url") == 0 && value) {
+        describe_url_failure(check->value.url_check, value, message + len, size - len);
+    } else if (strcmp(name, "expr") == 0) {
+        // False and not evaluable (arithmetic on text, division by zero) read differently
+        bool evaluable = !value || eval_expr(check->value.expr, value->str) != EXPR_ERROR;
+        snprintf(message + len, size - len, " (%s: %s)", evaluable ? "must hold" : "cannot evaluate",
+                 expr_source(check->value.expr));
+    } else if (strcmp(name, "max_size") == 0) {
+        snprintf(message + len, size - len, " (file must be at most %zu bytes)", check->value.size_value);
+    } else if (is_fs_check(name)) {
+        static const struct { const char* name; const char* property; } properties[] = {
+            {"path_exists", "exist"}, {"file", "be a regular file"}, {"dir", "be a directory"},
+            {"socket", "be a socket"}, {"readable", "be readable"}, {"writable", "be writable"},
+        };
+        for (size_t i = 0; i < sizeof(properties) / sizeof(properties[0]); i++) {
+            if (strcmp(name, properties[i].name) == 0) {
+                snprintf(message + len, size - len, " (path must %s%s)",
+                         check->value.int_value ? "" : "not ", properties[i].property);
+                break;
+            }
+        }
+    } else if (strcmp(name, "enum") == 0) {
+        len += (size_t)snprintf(message + len, size - len, " (allowed values: ");
+        for (char **values = check->value.enum_values; *values && len < size; values++) {
+            len += (size_t)snprintf(message + len, size - len, "%s%s", *values, *(values + 1) ? ", " : "");
+        }
+        if (len < size) snprintf(message + len, size - len, ")");
     }
-    if (strcmp(check->definition->name, "gt") == 0 || strcmp(check->definition->name, "lt") == 0) {
-        return check->definition->callback(value, &check->value.int_value);
+}
+
+void describe_check_failure(const Check *check, char *message, size_t size) {
+    describe_failure(check, NULL, message, size);
+}
+
+// Runs one check, timing it when statistics are being collected
+static int run_check(const Check *check, ValueInfo *info, CheckStats *stats) {
+    logger(LOG_INFO, "Running check: %s", check->definition->name);
+    if (!stats) return validate_check_value(check, info);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int result = validate_check_value(check, info);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int64_t ns = (int64_t)(end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+    record_check_run(stats, check, result != ENVIL_OK, ns > 0 ? (uint64_t)ns : 0);
+    return result;
+}
+
+// Runs the checks of a variable: type checks first, then the others by expected
+// cost per rejection, so the check most likely to end the run cheaply goes
+// first. The failure reported does not depend on that order. It is the one a
+// run in canonical order (type checks, then config order) would stop at, so
+// when a check fails, the checks before it in canonical order that were skipped
+// are run too. Returns ENVIL_OK, or the failing result with *failed set to the
+// index of the check.
+static int run_checks(const EnvVariable *var, ValueInfo *info, CheckStats *stats, int *failed) {
+    int n = var->check_count;
+
+    if (n > MAX_ORDERED_CHECKS) {
+        // Too many to reorder on the stack: canonical order, which needs no backfill
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < n; i++) {
+                const Check *check = &var->checks[i];
+                if (is_type_check(check) != (pass == 0)) continue;
+                int result = run_check(check, info, stats);
+                if (result != ENVIL_OK) {
+                    *failed = i;
+                    return result;
+                }
+            }
+        }
+        return ENVIL_OK;
     }
-    if (strcmp(check->definition->name, "eq") == 0 || strcmp(check->definition->name, "ne") == 0) {
-        return check->definition->callback(value, check->value.str_value);
+
+    int canonical[MAX_ORDERED_CHECKS];  // Check index at each canonical position
+    int order[MAX_ORDERED_CHECKS];      // Canonical positions in run order
+    double rank[MAX_ORDERED_CHECKS];    // By canonical position
+    bool ran[MAX_ORDERED_CHECKS] = {false};
+    int type_count = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (is_type_check(&var->checks[i])) canonical[type_count++] = i;
     }
-    if (strcmp(check->definition->name, "lengt") == 0 || strcmp(check->definition->name, "lenlt") == 0) {
-        return check->definition->callback(value, &check->value.str_value);
+    for (int i = 0, p = type_count; i < n; i++) {
+        if (!is_type_check(&var->checks[i])) canonical[p++] = i;
     }
-    if (strcmp(check->definition->name, "regex") == 0) {
-        return check->definition->callback(value, check->value.str_value);
+
+    // Insertion sort keeps equally ranked checks in config order
+    for (int p = 0; p < n; p++) {
+        order[p] = p;
+        if (p < type_count) continue;
+
+        double cost, reject_rate;
+        estimate_check(stats, &var->checks[canonical[p]], &cost, &reject_rate);
+        rank[p] = cost / reject_rate;
+
+        int k = p;
+        while (k > type_count && rank[order[k - 1]] > rank[p]) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = p;
     }
-    if (strcmp(check->definition->name, "ge") == 0 || strcmp(check->definition->name, "le") == 0) {
-        return check->definition->callback(value, &check->value.int_value);
+
+    int result = ENVIL_OK;
+    int first_failed = n;
+    for (int k = 0; k < n; k++) {
+        int p = order[k];
+        ran[p] = true;
+        result = run_check(&var->checks[canonical[p]], info, stats);
+        if (result != ENVIL_OK) {
+            first_failed = p;
+            break;
+        }
     }
-    if (strcmp(check->definition->name, "regex") == 0) {
-        return check->definition->callback(value, &check->value.str_value);
+    if (result == ENVIL_OK) return ENVIL_OK;
+
+    // Everything run so far before first_failed passed; try the rest of them
+    for (int p = 0; p < first_failed; p++) {
+        if (ran[p]) continue;
+        int earlier = run_check(&var->checks[canonical[p]], info, stats);
+        if (earlier != ENVIL_OK) {
+            first_failed = p;
+            result = earlier;
+            break;
+        }
     }
-    return check->definition->callback(value, &check->value);
+
+    *failed = canonical[first_failed];
+    return result;
 }
 
 int validate_variable(const EnvVariable *var, const char *value) {
@@ -126,62 +516,27 @@ int validate_variable(const EnvVariable *var, const char *value) {
 
     logger(LOG_INFO, "Checking value: '%s'", value);
 
-    // Run type check first if present
-    for (int i = 0; i < var->check_count; i++) {
-        const Check *check = &var->checks[i];
-        if (strcmp(check->definition->name, "type") == 0) {
-            logger(LOG_INFO, "Running type check: %s", get_type_name(check->value.int_value));
-            int check_result = validate_check(check, value);
-            if (check_result != ENVIL_OK) {
-                logger(LOG_INFO, "Error: Variable '%s' has invalid type - expected %s", 
-                    var->name, get_type_name(check->value.int_value));
-                return check_result;
-            }
-            logger(LOG_INFO, "Type check passed");
-        }
-    }
+    // Analyzed once, shared by every check of this variable
+    ValueInfo info;
+    analyze_value(&info, value);
 
-    // Run remaining checks
-    for (int i = 0; i < var->check_count; i++) {
-        const Check *check = &var->checks[i];
-        if (strcmp(check->definition->name, "type") != 0) {
-            logger(LOG_INFO, "Running check: %s", check->definition->name);
-            
-            int check_result = validate_check(check, value);
-            if (check_result != ENVIL_OK) {
-                logger(LOG_INFO, "Error: Variable '%s' failed %s check", var->name, check->definition->name);
-                
-                if (strcmp(check->definition->name, "gt") == 0) {
-                    logger(LOG_INFO, " (value must be greater than %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "lt") == 0) {
-                    logger(LOG_INFO, " (value must be less than %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "eq") == 0) {
-                    logger(LOG_INFO, " (value must be equal to %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "ne") == 0) {
-                    logger(LOG_INFO, " (value must not be equal to %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "len") == 0) {
-                    logger(LOG_INFO, " (length must be exactly %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "lengt") == 0) {
-                    logger(LOG_INFO, " (length must be greater than %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "lenlt") == 0) {
-                    logger(LOG_INFO, " (length must be less than %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "regex") == 0) {
-                    logger(LOG_INFO, " (value must match pattern: %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "enum") == 0) {
-                    logger(LOG_INFO, " (allowed values: ");
-                    char **values = check->value.enum_values;
-                    while (*values) {
-                        logger(LOG_INFO, "%s", *values);
-                        if (*(values + 1)) logger(LOG_INFO, ", ");
-                        values++;
-                    }
-                    logger(LOG_INFO, ")");
-                }
-                logger(LOG_INFO, "");
-                return check_result;
-            }
-            logger(LOG_INFO, "Check passed: %s", check->definition->name);
+    int failed;
+    int check_result = run_checks(var, &info, NULL, &failed);
+    if (check_result != ENVIL_OK) {
+        const Check *check = &var->checks[failed];
+        if (is_type_check(check)) {
+            logger(LOG_INFO, "Error: Variable '%s' has invalid type - expected %s", 
+                var->name, get_type_name(check->value.int_value));
+        } else if (check_result == ENVIL_TIMEOUT_ERROR && cmd_check_not_run()) {
+            logger(LOG_INFO, "Error: Variable '%s' %s check not run: deadline passed", var->name, check->definition->name);
+        } else if (check_result == ENVIL_TIMEOUT_ERROR) {
+            logger(LOG_INFO, "Error: Variable '%s' %s check did not finish in time", var->name, check->definition->name);
+        } else {
+            char message[512];
+            describe_failure(check, &info, message, sizeof(message));
+            logger(LOG_INFO, "Error: Variable '%s' %s", var->name, message);
         }
+        return check_result;
     }
 
     logger(LOG_INFO, "All validations passed for '%s'", var->name);
@@ -189,23 +544,14 @@ int validate_variable(const EnvVariable *var, const char *value) {
 }
 
 int validate_variable_with_errors(const EnvVariable *var, const char *value, ValidationErrors* errors) {
+    return validate_variable_with_stats(var, value, errors, NULL);
+}
+
+int validate_variable_with_stats(const EnvVariable *var, const char *value, ValidationErrors* errors, CheckStats* stats) {
     if (!var || !errors) return ENVIL_CONFIG_ERROR;
     
     logger(LOG_INFO, "Validating variable '%s' with value '%s'", var->name, value ? value : "NULL");
-    const char *type_str = NULL;
-
-    ///
     logger(LOG_INFO, "Number of checks: %d", var->check_count);
-    for (int i = 0; i < var->check_count; i++) {
-        const Check *check = &var->checks[i];
-        logger(LOG_INFO, "Check: %s", check->definition->name);
-        if (strcmp(check->definition->name, "type") == 0) {
-            type_str = get_type_name(check->value.int_value);
-            logger(LOG_INFO, "Variable '%s' has type check: %s", var->name, type_str);
-            break;
-        }
-    }
-    ///
 
     // Check if variable exists or has default
     if (!value) {
@@ -219,66 +565,27 @@ int validate_variable_with_errors(const EnvVariable *var, const char *value, Val
 
     logger(LOG_INFO, "Checking value: '%s'", value);
 
-    // Run all checks, with type check first if present
-    for (int i = 0; i < var->check_count; i++) {
-        const Check *check = &var->checks[i];
-        
-        // Run type check first
-        if (strcmp(check->definition->name, "type") == 0) {
-            logger(LOG_INFO, "Running type check: %s", get_type_name(check->value.int_value));
-            int check_result = validate_check(check, value);
-            if (check_result != ENVIL_OK) {
-                char message[256];
-                snprintf(message, sizeof(message), "invalid type - expected %s\n", get_type_name(check->value.int_value));
-                add_validation_error(errors, var->name, message, check_result);
-                return check_result;
-            }
-            logger(LOG_INFO, "Type check passed");
-        }
-    }
+    // Analyzed once, shared by every check of this variable
+    ValueInfo info;
+    analyze_value(&info, value);
 
-    // Run remaining checks
-    for (int i = 0; i < var->check_count; i++) {
-        const Check *check = &var->checks[i];
-        if (strcmp(check->definition->name, "type") != 0) {
-            logger(LOG_INFO, "Running check: %s", check->definition->name);
-            int check_result = validate_check(check, value);
-            if (check_result != ENVIL_OK) {
-                char message[512] = {0};
-                snprintf(message, sizeof(message), "failed %s check", check->definition->name);
-                
-                if (strcmp(check->definition->name, "gt") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (value must be greater than %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "lt") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (value must be less than %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "eq") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (value must be equal to %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "ne") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (value must not be equal to %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "len") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (length must be exactly %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "lengt") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (length must be greater than %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "lenlt") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (length must be less than %d)", check->value.int_value);
-                } else if (strcmp(check->definition->name, "regex") == 0) {
-                    snprintf(message + strlen(message), sizeof(message) - strlen(message), " (value must match pattern: %s)", check->value.str_value);
-                } else if (strcmp(check->definition->name, "enum") == 0) {
-                    strcat(message, " (allowed values: ");
-                    char **values = check->value.enum_values;
-                    while (*values) {
-                        strcat(message, *values);
-                        if (*(values + 1)) strcat(message, ", ");
-                        values++;
-                    }
-                    strcat(message, ")");
-                }
-                
-                add_validation_error(errors, var->name, message, check_result);
-                return check_result;
-            }
-            logger(LOG_INFO, "Check passed: %s", check->definition->name);
+    int failed;
+    int check_result = run_checks(var, &info, stats, &failed);
+    if (check_result != ENVIL_OK) {
+        const Check *check = &var->checks[failed];
+        char message[512];
+        if (is_type_check(check)) {
+            snprintf(message, sizeof(message), "invalid type - expected %s\n", get_type_name(check->value.int_value));
+        } else if (check_result == ENVIL_TIMEOUT_ERROR && cmd_check_not_run()) {
+            // The last check run is the one reported, backfilled ones included
+            snprintf(message, sizeof(message), "%s check not run: deadline passed", check->definition->name);
+        } else if (check_result == ENVIL_TIMEOUT_ERROR) {
+            snprintf(message, sizeof(message), "%s check did not finish in time and was killed", check->definition->name);
+        } else {
+            describe_failure(check, &info, message, sizeof(message));
         }
+        add_validation_error(errors, var->name, message, check_result);
+        return check_result;
     }
 
     logger(LOG_INFO, "All validations passed for '%s'", var->name);
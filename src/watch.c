@@ -0,0 +1,427 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include "watch.h"
+#include "config.h"
+#include "dotenv.h"
+#include "expr.h"
+#include "logger.h"
+#include "validator.h"
+
+#define WATCH_DEBOUNCE_MS 50
+#define WATCH_EVENT_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE)
+
+// Last verdict for one config variable
+typedef struct {
+    char *name;
+    uint64_t definition_hash;
+    char *value;    // Raw value the verdict was computed for, NULL if unset
+    int result;
+    char *message;  // First validation error, NULL when the variable passed
+} WatchEntry;
+
+// A watched file, identified by its parent directory watch and basename
+typedef struct {
+    const char *path;
+    const char *basename;
+    int wd;
+} WatchedFile;
+
+struct WatchState {
+    Config *config;
+    char **env_paths;
+    EnvFile **env_files;
+    int env_file_count;
+    WatchEntry *entries;  // Parallel to config->variables
+    bool print_value;
+    FILE *report;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static bool same_value(const char* a, const char* b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+// Dotenv files override the process environment, later files win
+static const char* resolve_value(const WatchState* state, const char* name) {
+    for (int i = state->env_file_count - 1; i >= 0; i--) {
+        const char* value = env_file_get(state->env_files[i], name);
+        if (value) return value;
+    }
+    return getenv(name);
+}
+
+static void free_entry(WatchEntry* entry) {
+    free(entry->name);
+    free(entry->value);
+    free(entry->message);
+}
+
+// Serves the names expr checks read outside the config
+static const char* lookup_value(const char* name, void* data) {
+    return resolve_value(data, name);
+}
+
+// True when an expr check of var reads a name outside the config, whose
+// value the dotenv files may have changed
+static bool reads_outside_config(const EnvVariable* var) {
+    for (int j = 0; j < var->check_count; j++) {
+        if (strcmp(var->checks[j].definition->name, "expr") != 0) continue;
+        const Expr* expr = var->checks[j].value.expr;
+        for (int k = 0; k < expr_name_count(expr); k++) {
+            if (expr_name_binding(expr, k) < 0) return true;
+        }
+    }
+    return false;
+}
+
+static void report_entry(const WatchState* state, char marker, const WatchEntry* entry, const EnvVariable* var) {
+    if (entry->result != ENVIL_OK) {
+        fprintf(state->report, "%c %s: %s\n", marker, entry->name,
+               entry->message ? entry->message : "validation failed");
+        return;
+    }
+
+    const char* value = entry->value ? entry->value : var->default_value;
+    if (state->print_value && value) {
+        fprintf(state->report, "%c %s=%s\n", marker, entry->name, value);
+    } else {
+        fprintf(state->report, "%c %s: ok%s\n", marker, entry->name, entry->value ? "" : " (default)");
+    }
+}
+
+int watch_result(const WatchState* state) {
+    int result = ENVIL_OK;
+    for (int i = 0; i < state->config->variable_count; i++) {
+        if (state->entries[i].result != ENVIL_OK) {
+            result = state->entries[i].result;
+        }
+    }
+    return result;
+}
+
+static void report_summary(const WatchState* state, int rechecked) {
+    int failing = 0;
+    for (int i = 0; i < state->config->variable_count; i++) {
+        if (state->entries[i].result != ENVIL_OK) failing++;
+    }
+    fprintf(state->report, "-- %d rechecked, %d of %d failing\n", rechecked, failing, state->config->variable_count);
+    fflush(state->report);
+}
+
+/**
+ * Revalidates the entries marked in recheck, and those whose expr checks read
+ * one of them, as a run over the whole config would: expr checks see the
+ * dotenv values and the verdicts of the variables they read. Entries marked
+ * in added (may be NULL) are reported as new. Returns the number rechecked.
+ */
+static int revalidate(WatchState* state, bool* recheck, const bool* added) {
+    const Config* config = state->config;
+    int count = config->variable_count;
+    const char** raw_values = malloc((size_t)(count ? count : 1) * sizeof(char*));
+    const char** values = malloc((size_t)(count ? count : 1) * sizeof(char*));
+    int* known = malloc((size_t)(count ? count : 1) * sizeof(int));
+    ValidationErrors* errors = create_validation_errors();
+    int rechecked = 0;
+    if (!raw_values || !values || !known || !errors) {
+        logger(LOG_ERROR, "Failed to allocate memory for watch state\n");
+        goto cleanup;
+    }
+
+    spread_rechecks(config, recheck);
+    for (int i = 0; i < count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        raw_values[i] = resolve_value(state, var->name);
+        values[i] = raw_values[i] ? raw_values[i] : var->default_value;
+        known[i] = recheck[i] ? VERDICT_PENDING : state->entries[i].result;
+    }
+    // Pattern keys are matched against no environment: watch mode leaves them out
+    validate_config_values(config, values, known, NULL, lookup_value, state, false, errors, NULL);
+
+    for (int i = 0; i < count; i++) {
+        if (!recheck[i]) continue;
+        WatchEntry* entry = &state->entries[i];
+        free(entry->value);
+        free(entry->message);
+        entry->value = raw_values[i] ? strdup(raw_values[i]) : NULL;
+        entry->message = NULL;
+        entry->result = ENVIL_OK;
+        // The first failure of the variable stands for it
+        for (int e = 0; e < errors->count; e++) {
+            if (strcmp(errors->errors[e].name, entry->name) != 0) continue;
+            entry->result = errors->errors[e].error_code;
+            entry->message = strdup(errors->errors[e].message);
+            size_t len = entry->message ? strlen(entry->message) : 0;
+            if (len > 0 && entry->message[len - 1] == '\n') entry->message[len - 1] = '\0';
+            break;
+        }
+        report_entry(state, added && added[i] ? '+' : '~', entry, &config->variables[i]);
+        rechecked++;
+    }
+
+cleanup:
+    free(raw_values);
+    free(values);
+    free(known);
+    free_validation_errors(errors);
+    return rechecked;
+}
+
+bool watch_apply_config(WatchState* state, Config* new_config) {
+    size_t n = (size_t)(new_config->variable_count ? new_config->variable_count : 1);
+    WatchEntry* new_entries = calloc(n, sizeof(WatchEntry));
+    bool* recheck = calloc(n, sizeof(bool));
+    bool* added = calloc(n, sizeof(bool));
+    if (!new_entries || !recheck || !added) {
+        logger(LOG_ERROR, "Failed to allocate memory for watch state\n");
+        free(new_entries);
+        free(recheck);
+        free(added);
+        free_config(new_config);
+        return false;
+    }
+
+    int old_count = state->config ? state->config->variable_count : 0;
+    if (new_config->pattern_count > 0) {
+        logger(LOG_WARNING, "Pattern keys are not validated in watch mode");
+    }
+
+    // Carry each entry over by name; a new definition or value needs a recheck
+    for (int i = 0; i < new_config->variable_count; i++) {
+        const EnvVariable* var = &new_config->variables[i];
+        WatchEntry* old = NULL;
+        for (int j = 0; j < old_count; j++) {
+            if (state->entries[j].name && strcmp(state->entries[j].name, var->name) == 0) {
+                old = &state->entries[j];
+                break;
+            }
+        }
+
+        if (old) {
+            recheck[i] = old->definition_hash != var->definition_hash ||
+                         !same_value(old->value, resolve_value(state, var->name));
+            new_entries[i] = *old;
+            memset(old, 0, sizeof(*old));
+        } else {
+            new_entries[i].name = strdup(var->name);
+            recheck[i] = added[i] = true;
+        }
+        new_entries[i].definition_hash = var->definition_hash;
+    }
+
+    WatchEntry* old_entries = state->entries;
+    Config* old_config = state->config;
+    state->entries = new_entries;
+    state->config = new_config;
+    int rechecked = revalidate(state, recheck, added);
+
+    // Whatever was not carried over has been removed from the config
+    for (int j = 0; j < old_count; j++) {
+        if (old_entries[j].name) {
+            fprintf(state->report, "- %s: removed\n", old_entries[j].name);
+            free_entry(&old_entries[j]);
+        }
+    }
+    free(old_entries);
+    free_config(old_config);
+    free(recheck);
+    free(added);
+    report_summary(state, rechecked);
+    return true;
+}
+
+void watch_refresh_values(WatchState* state) {
+    const Config* config = state->config;
+    bool* recheck = calloc((size_t)(config->variable_count ? config->variable_count : 1), sizeof(bool));
+    if (!recheck) {
+        logger(LOG_ERROR, "Failed to allocate memory for watch state\n");
+        return;
+    }
+
+    for (int i = 0; i < config->variable_count; i++) {
+        const EnvVariable* var = &config->variables[i];
+        recheck[i] = !same_value(state->entries[i].value, resolve_value(state, var->name)) ||
+                     reads_outside_config(var);
+    }
+    report_summary(state, revalidate(state, recheck, NULL));
+    free(recheck);
+}
+
+static int add_file_watch(int fd, WatchedFile* file, const char* path) {
+    char dir[PATH_MAX];
+    const char* slash = strrchr(path, '/');
+
+    if (slash) {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        if (len >= sizeof(dir)) return 0;
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+        file->basename = slash + 1;
+    } else {
+        strcpy(dir, ".");
+        file->basename = path;
+    }
+
+    // Watch the directory rather than the file: editors usually replace files
+    // by renaming a temporary over them, which would orphan a file watch
+    file->path = path;
+    file->wd = inotify_add_watch(fd, dir, WATCH_EVENT_MASK);
+    if (file->wd < 0) {
+        logger(LOG_ERROR, "Error: Cannot watch %s: %s\n", dir, strerror(errno));
+        return 0;
+    }
+    return 1;
+}
+
+// Drains pending events, marking which of the watched files changed
+static void collect_events(int fd, WatchedFile* files, int file_count, bool* changed) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + len; ) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->len > 0) {
+                for (int i = 0; i < file_count; i++) {
+                    if (files[i].wd == event->wd && strcmp(files[i].basename, event->name) == 0) {
+                        changed[i] = true;
+                    }
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+void watch_reload_env_file(WatchState* state, int index) {
+    const char* path = state->env_paths[index];
+    free_env_file(state->env_files[index]);
+    // A missing file simply contributes no values until it reappears
+    state->env_files[index] = access(path, F_OK) == 0 ? load_env_file(path) : NULL;
+}
+
+WatchState* create_watch_state(char** env_files, int env_file_count, bool print_value, FILE* report) {
+    WatchState* state = calloc(1, sizeof(WatchState));
+    if (!state || !(state->env_files = calloc(env_file_count + 1, sizeof(EnvFile*)))) {
+        logger(LOG_ERROR, "Failed to allocate memory for watch state\n");
+        free(state);
+        return NULL;
+    }
+    state->env_paths = env_files;
+    state->env_file_count = env_file_count;
+    state->print_value = print_value;
+    state->report = report;
+    for (int i = 0; i < env_file_count; i++) {
+        watch_reload_env_file(state, i);
+    }
+    return state;
+}
+
+void free_watch_state(WatchState* state) {
+    if (!state) return;
+    if (state->config) {
+        for (int i = 0; i < state->config->variable_count; i++) {
+            free_entry(&state->entries[i]);
+        }
+        free_config(state->config);
+    }
+    free(state->entries);
+    for (int i = 0; i < state->env_file_count; i++) {
+        free_env_file(state->env_files[i]);
+    }
+    free(state->env_files);
+    free(state);
+}
+
+int watch_config(const char* config_path, char** env_files, int env_file_count, bool print_value) {
+    int result = ENVIL_CONFIG_ERROR;
+    WatchState* state = NULL;
+    WatchedFile* files = calloc(env_file_count + 1, sizeof(WatchedFile));
+    bool* changed = calloc(env_file_count + 1, sizeof(bool));
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (!files || !changed) {
+        logger(LOG_ERROR, "Failed to allocate memory for watch state\n");
+        goto cleanup;
+    }
+    if (fd < 0) {
+        logger(LOG_ERROR, "Error: inotify unavailable: %s\n", strerror(errno));
+        goto cleanup;
+    }
+
+    // Index 0 is the config, the dotenv sources follow
+    if (!add_file_watch(fd, &files[0], config_path)) goto cleanup;
+    for (int i = 0; i < env_file_count; i++) {
+        if (!add_file_watch(fd, &files[i + 1], env_files[i])) goto cleanup;
+    }
+
+    state = create_watch_state(env_files, env_file_count, print_value, stdout);
+    if (!state) goto cleanup;
+    Config* config = load_config(config_path);
+    if (!config || !watch_apply_config(state, config)) goto cleanup;
+    result = watch_result(state);
+
+    struct sigaction sa = {0};
+    sa.sa_handler = handle_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    while (!stop_requested) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            logger(LOG_ERROR, "Error: poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        // Coalesce the burst of events a single save usually produces
+        memset(changed, 0, (env_file_count + 1) * sizeof(bool));
+        do {
+            collect_events(fd, files, env_file_count + 1, changed);
+        } while (poll(&pfd, 1, WATCH_DEBOUNCE_MS) > 0);
+
+        bool env_changed = false;
+        for (int i = 0; i < env_file_count; i++) {
+            if (changed[i + 1]) {
+                logger(LOG_INFO, "Env file changed: %s", env_files[i]);
+                watch_reload_env_file(state, i);
+                env_changed = true;
+            }
+        }
+
+        if (changed[0]) {
+            logger(LOG_INFO, "Config changed: %s", config_path);
+            Config* new_config = load_config(config_path);
+            if (!new_config) {
+                fprintf(stderr, "Error: keeping previous config, %s failed to load\n", config_path);
+            } else {
+                watch_apply_config(state, new_config);
+            }
+        } else if (env_changed) {
+            watch_refresh_values(state);
+        }
+        result = watch_result(state);
+    }
+
+cleanup:
+    if (fd >= 0) close(fd);
+    free_watch_state(state);
+    free(files);
+    free(changed);
+    return result;
+}
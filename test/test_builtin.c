@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/wait.h>
+
+static char builtin_path[PATH_MAX];
+
+// Runs a bash script with the builtin enabled, returns its exit code
+static int run_bash(const char* script) {
+    char command[PATH_MAX + 1024];
+    snprintf(command, sizeof(command), "enable -f '%s' envil || exit 99\n%s", builtin_path, script);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        freopen("/dev/null", "w", stderr);
+        execlp("bash", "bash", "--norc", "-c", command, (char*)NULL);
+        _exit(98);
+    }
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status));
+    return WEXITSTATUS(status);
+}
+
+void test_builtin() {
+    printf("Testing the bash builtin...\n");
+
+    assert(realpath("lib/bash/envil.so", builtin_path) != NULL);
+    if (run_bash("exit 0") == 98) {
+        printf("bash not found, skipping\n");
+        return;
+    }
+
+    // A default is exported once validation passed, in the shell itself
+    assert(run_bash("unset P; envil -e P -d 5432 --type integer --assign && "
+                    "[ \"$P\" = 5432 ] && [ \"$(printenv P)\" = 5432 ]") == 0);
+    assert(run_bash("unset P; envil -e P -d x --type integer --assign; r=$?; "
+                    "[ -z \"$P\" ] && exit $r") == 3);
+
+    // Checks see the shell's exports, each run parsing its own command line
+    assert(run_bash("export P=80; envil -e P --type integer --gt 1024; a=$?; "
+                    "export P=8080; envil -e P --type integer --gt 1024; b=$?; "
+                    "[ $a = 4 ] && [ $b = 0 ]") == 0);
+
+    // What would block or replace the shell is refused, and nothing exits it
+    assert(run_bash("envil -e P -w; envil -e P -- true; envil --nope; echo alive | grep -q alive") == 0);
+
+    printf("Bash builtin tests passed!\n");
+}
+
+int main() {
+    printf("Running builtin tests...\n\n");
+
+    test_builtin();
+
+    printf("\nAll builtin tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "checks.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+static char cache_dir[64];
+
+// Runs fn with stdout sent to a buffer, returned NUL-terminated
+static char* capture_stdout(void (*fn)(void* data), void* data) {
+    static char output[4096];
+    char path[] = "/tmp/envil_cache_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    fn(data);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    ssize_t n = pread(fd, output, sizeof(output) - 1, 0);
+    assert(n >= 0);
+    output[n] = '\0';
+    close(fd);
+    unlink(path);
+    return output;
+}
+
+static int count_entries(const char* dir) {
+    DIR* d = opendir(dir);
+    if (!d) return 0;
+    int count = 0;
+    for (struct dirent* entry; (entry = readdir(d));) {
+        if (entry->d_name[0] != '.') count++;
+    }
+    closedir(d);
+    return count;
+}
+
+static void clear_cache(void) {
+    char command[128];
+    snprintf(command, sizeof(command), "rm -rf %s", cache_dir);
+    assert(system(command) == 0);
+}
+
+static Config* load_yaml(const char* yaml, CheckRegistry* registry) {
+    char path[] = "/tmp/envil_cache_XXXXXX.yml";
+    write_temp_file(path, yaml);
+    Config* config = load_config_with_registry(path, registry);
+    unlink(path);
+    assert(config != NULL);
+    return config;
+}
+
+static int check_even(const char* value, const void* argument) {
+    (void)argument;
+    return atoi(value) % 2 == 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+void test_fingerprint() {
+    printf("Testing cache fingerprints...\n");
+
+    setenv("ENVIL_CACHE_PORT", "8080", 1);
+    unsetenv("ENVIL_CACHE_MODE");
+    setenv("ENVIL_CACHE_FLAG_A", "on", 1);
+    const char* yaml =
+        "ENVIL_CACHE_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "ENVIL_CACHE_MODE:\n"
+        "  default: dev\n"
+        "\"ENVIL_CACHE_FLAG_*\":\n"
+        "  checks:\n"
+        "    enum: on,off\n";
+    Config* config = load_yaml(yaml, NULL);
+    char key[CACHE_KEY_SIZE], other[CACHE_KEY_SIZE];
+    cache_fingerprint(config, false, key);
+    assert(strlen(key) == CACHE_KEY_SIZE - 1);
+
+    // Stable for the same config and environment, whatever else is set
+    setenv("ENVIL_CACHE_UNRELATED", "x", 1);
+    cache_fingerprint(config, false, other);
+    assert(strcmp(key, other) == 0);
+    Config* reloaded = load_yaml(yaml, NULL);
+    cache_fingerprint(reloaded, false, other);
+    assert(strcmp(key, other) == 0);
+    free_config(reloaded);
+
+    // --print changes the output, so the key
+    cache_fingerprint(config, true, other);
+    assert(strcmp(key, other) != 0);
+
+    // A variable's value, set or unset
+    setenv("ENVIL_CACHE_PORT", "8081", 1);
+    cache_fingerprint(config, false, other);
+    assert(strcmp(key, other) != 0);
+    setenv("ENVIL_CACHE_PORT", "8080", 1);
+    setenv("ENVIL_CACHE_MODE", "dev", 1);
+    cache_fingerprint(config, false, other);
+    assert(strcmp(key, other) != 0);
+    unsetenv("ENVIL_CACHE_MODE");
+
+    // The entries matching a pattern key, new ones included
+    setenv("ENVIL_CACHE_FLAG_A", "off", 1);
+    cache_fingerprint(config, false, other);
+    assert(strcmp(key, other) != 0);
+    setenv("ENVIL_CACHE_FLAG_A", "on", 1);
+    setenv("ENVIL_CACHE_FLAG_B", "on", 1);
+    cache_fingerprint(config, false, other);
+    assert(strcmp(key, other) != 0);
+    unsetenv("ENVIL_CACHE_FLAG_B");
+    cache_fingerprint(config, false, other);
+    assert(strcmp(key, other) == 0);
+
+    // A definition, default included
+    Config* changed = load_yaml(
+        "ENVIL_CACHE_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "ENVIL_CACHE_MODE:\n"
+        "  default: prod\n"
+        "\"ENVIL_CACHE_FLAG_*\":\n"
+        "  checks:\n"
+        "    enum: on,off\n", NULL);
+    cache_fingerprint(changed, false, other);
+    assert(strcmp(key, other) != 0);
+    free_config(changed);
+
+    free_config(config);
+    unsetenv("ENVIL_CACHE_UNRELATED");
+    unsetenv("ENVIL_CACHE_FLAG_A");
+    printf("Cache fingerprint tests passed!\n");
+}
+
+void test_cacheable() {
+    printf("Testing which configs are cached...\n");
+
+    const char* cacheable[] = {
+        "A:\n  checks:\n    type: integer\n    regex: ^[0-9]+$\n",
+        "A:\n  checks:\n    cmd:\n      run: \"true\"\n      pure: true\n",
+        "A:\n  checks:\n    expr: value <= B\nB:\n  default: \"2\"\n",
+        "A:\n  checks:\n    url: scheme.enum=https\n",
+    };
+    const char* not_cacheable[] = {
+        "A:\n  checks:\n    cmd: \"true\"\n",
+        "A:\n  checks:\n    cmd:\n      run: \"true\"\n",
+        "A:\n  checks:\n    file: true\n",
+        "A:\n  checks:\n    dir: true\n",
+        "A:\n  checks:\n    expr: value <= OUTSIDE\n",
+        "A:\n  checks:\n    type: integer\n\"B_*\":\n  checks:\n    cmd: \"true\"\n",
+    };
+    for (size_t i = 0; i < sizeof(cacheable) / sizeof(cacheable[0]); i++) {
+        Config* config = load_yaml(cacheable[i], NULL);
+        assert(config_is_cacheable(config));
+        free_config(config);
+    }
+    for (size_t i = 0; i < sizeof(not_cacheable) / sizeof(not_cacheable[0]); i++) {
+        Config* config = load_yaml(not_cacheable[i], NULL);
+        assert(!config_is_cacheable(config));
+        free_config(config);
+    }
+
+    // Registered checks are cached only when declared pure
+    CheckHooks impure = {NULL, NULL, false};
+    CheckHooks pure = {NULL, NULL, true};
+    CheckRegistry registry;
+    init_check_registry(&registry);
+    assert(registry_add_check(&registry, "even", "Even number", check_even, NULL, 0, "not even"));
+    assert(registry_add_check(&registry, "even_impure", "Even number", check_even, &impure, 0, "not even"));
+    assert(registry_add_check(&registry, "even_pure", "Even number", check_even, &pure, 0, "not even"));
+    const char* registered[] = {"even", "even_impure", "even_pure"};
+    for (int i = 0; i < 3; i++) {
+        char yaml[128];
+        snprintf(yaml, sizeof(yaml), "A:\n  checks:\n    %s: \"\"\n", registered[i]);
+        Config* config = load_yaml(yaml, &registry);
+        assert(config_is_cacheable(config) == (i == 2));
+        assert(variable_is_cacheable(&config->variables[0]) == (i == 2));
+        free_config(config);
+    }
+    printf("Cacheable config tests passed!\n");
+}
+
+static void replay_test_key(void* data) {
+    assert(cache_replay(data));
+}
+
+void test_store_replay() {
+    printf("Testing cache store and replay...\n");
+
+    clear_cache();
+    const char* key = "0123456789abcdef0123456789abcdef";
+    assert(!cache_replay(key));
+
+    // The directory is created on demand, the entry is private and complete
+    cache_store(key, "A=1\nB=2\n", 8);
+    assert(count_entries(cache_dir) == 1);
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, key);
+    struct stat st;
+    assert(stat(path, &st) == 0);
+    assert((st.st_mode & 0777) == 0600);
+    assert(strcmp(capture_stdout(replay_test_key, (void*)key), "A=1\nB=2\n") == 0);
+
+    // Storing again replaces the entry in one rename, leaving no temporary behind
+    cache_store(key, "", 0);
+    assert(count_entries(cache_dir) == 1);
+    assert(strcmp(capture_stdout(replay_test_key, (void*)key), "") == 0);
+
+    // An entry without the header is ignored
+    write_file(path, "A=1\n");
+    assert(!cache_replay(key));
+    printf("Cache store and replay tests passed!\n");
+}
+
+static const char* run_config_path;
+
+static void run_cached_config(void* data) {
+    *(int*)data = handle_config_option(run_config_path, true, true, NULL, NULL, true);
+}
+
+void test_cached_run() {
+    printf("Testing cached config runs...\n");
+
+    clear_cache();
+    char config_path[] = "/tmp/envil_cache_XXXXXX.yml";
+    write_temp_file(config_path,
+        "ENVIL_CACHE_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "ENVIL_CACHE_MODE:\n"
+        "  default: dev\n");
+    run_config_path = config_path;
+    setenv("ENVIL_CACHE_PORT", "8080", 1);
+    unsetenv("ENVIL_CACHE_MODE");
+
+    // A failing run is not stored
+    setenv("ENVIL_CACHE_PORT", "x", 1);
+    int result;
+    capture_stdout(run_cached_config, &result);
+    assert(result == ENVIL_TYPE_ERROR);
+    assert(count_entries(cache_dir) == 0);
+    assert(getenv("ENVIL_CACHE_MODE") == NULL);
+
+    // A passing run is stored with its output
+    setenv("ENVIL_CACHE_PORT", "8080", 1);
+    const char* output = capture_stdout(run_cached_config, &result);
+    assert(result == ENVIL_OK);
+    assert(strcmp(output, "ENVIL_CACHE_PORT=8080\nENVIL_CACHE_MODE=dev\n") == 0);
+    assert(count_entries(cache_dir) == 1);
+
+    // The same run again replays the entry, and still exports the defaults
+    unsetenv("ENVIL_CACHE_MODE");
+    DIR* d = opendir(cache_dir);
+    struct dirent* entry;
+    while ((entry = readdir(d)) && entry->d_name[0] == '.') {}
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+    closedir(d);
+    write_file(path, "envil-cache 1\nREPLAYED\n");
+    output = capture_stdout(run_cached_config, &result);
+    assert(result == ENVIL_OK);
+    assert(strcmp(output, "REPLAYED\n") == 0);
+    assert(strcmp(getenv("ENVIL_CACHE_MODE"), "dev") == 0);
+
+    unsetenv("ENVIL_CACHE_PORT");
+    unsetenv("ENVIL_CACHE_MODE");
+    unlink(config_path);
+    printf("Cached config run tests passed!\n");
+}
+
+int main() {
+    printf("Running cache tests...\n\n");
+
+    char dir[] = "/tmp/envil_cache_XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    // A missing nested directory, created by the first store
+    snprintf(cache_dir, sizeof(cache_dir), "%s/a/b", dir);
+    setenv("ENVIL_CACHE_DIR", cache_dir, 1);
+
+    test_fingerprint();
+    test_cacheable();
+    test_store_replay();
+    test_cached_run();
+
+    char command[128];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    assert(system(command) == 0);
+    printf("\nAll cache tests passed!\n");
+    return 0;
+}
@@ -2,7 +2,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "checks.h"
+#include "netaddr.h"
+#include "formats.h"
+#include "fscheck.h"
+#include "url.h"
+#include "units.h"
+#include "expr.h"
+#include "config.h"
 #include "types.h"
 #include "validator.h"
 
@@ -42,19 +54,19 @@ void test_check_gt() {
     printf("Testing check_gt...\n");
     
     // Test integer comparisons
-    int threshold = 10;
+    Number threshold = {.int_value = 10};
     assert(check_gt("15", &threshold) == ENVIL_OK);
     assert(check_gt("5", &threshold) == ENVIL_VALUE_ERROR);
     assert(check_gt("10", &threshold) == ENVIL_VALUE_ERROR); // Equal should fail
     assert(check_gt("abc", &threshold) == ENVIL_VALUE_ERROR);
     
     // Test negative numbers
-    threshold = -10;
+    threshold.int_value = -10;
     assert(check_gt("-5", &threshold) == ENVIL_OK);
     assert(check_gt("-15", &threshold) == ENVIL_VALUE_ERROR);
     
     // Test with zero threshold
-    threshold = 0;
+    threshold.int_value = 0;
     assert(check_gt("1", &threshold) == ENVIL_OK);
     assert(check_gt("-1", &threshold) == ENVIL_VALUE_ERROR);
     
@@ -65,25 +77,73 @@ void test_check_lt() {
     printf("Testing check_lt...\n");
     
     // Test integer comparisons
-    int threshold = 10;
+    Number threshold = {.int_value = 10};
     assert(check_lt("5", &threshold) == ENVIL_OK);
     assert(check_lt("15", &threshold) == ENVIL_VALUE_ERROR);
     assert(check_lt("10", &threshold) == ENVIL_VALUE_ERROR); // Equal should fail
     assert(check_lt("abc", &threshold) == ENVIL_VALUE_ERROR);
     
     // Test negative numbers
-    threshold = -10;
+    threshold.int_value = -10;
     assert(check_lt("-15", &threshold) == ENVIL_OK);
     assert(check_lt("-5", &threshold) == ENVIL_VALUE_ERROR);
     
     // Test with zero threshold
-    threshold = 0;
+    threshold.int_value = 0;
     assert(check_lt("-1", &threshold) == ENVIL_OK);
     assert(check_lt("1", &threshold) == ENVIL_VALUE_ERROR);
     
     printf("check_lt tests passed!\n");
 }
 
+void test_check_thresholds() {
+    printf("Testing exact thresholds...\n");
+    
+    // Fractional thresholds are no longer truncated
+    Number threshold;
+    assert(parse_number("-10.0", &threshold));
+    assert(threshold.is_float);
+    assert(check_ge("-10", &threshold) == ENVIL_OK);
+    assert(check_ge("-10.5", &threshold) == ENVIL_VALUE_ERROR);
+    assert(parse_number("0.5", &threshold));
+    assert(check_gt("0.75", &threshold) == ENVIL_OK);
+    assert(check_gt("0", &threshold) == ENVIL_VALUE_ERROR);
+    assert(check_le("0.5", &threshold) == ENVIL_OK);
+    
+    // 64-bit limits compare exactly, without a round trip through double
+    assert(parse_number("9007199254740993", &threshold));
+    assert(!threshold.is_float);
+    assert(check_gt("9007199254740994", &threshold) == ENVIL_OK);
+    assert(check_gt("9007199254740993", &threshold) == ENVIL_VALUE_ERROR);
+    assert(check_lt("9007199254740992", &threshold) == ENVIL_OK);
+    assert(parse_number("-9223372036854775808", &threshold));
+    assert(!threshold.is_float);
+    assert(check_ge("-9223372036854775808", &threshold) == ENVIL_OK);
+    
+    // Integer values against a fractional threshold
+    assert(parse_number("2.5", &threshold));
+    assert(check_gt("3", &threshold) == ENVIL_OK);
+    assert(check_lt("2", &threshold) == ENVIL_OK);
+    assert(check_le("3", &threshold) == ENVIL_VALUE_ERROR);
+    
+    assert(!parse_number("ten", &threshold));
+    assert(!parse_number("", &threshold));
+    
+    // One analysis serves every check of a value
+    ValueInfo info;
+    analyze_value(&info, "1234");
+    assert(info.flags == 0);
+    assert(parse_number("1000", &threshold));
+    assert(check_gt_value(&info, &threshold) == ENVIL_OK);
+    assert(info.flags & VALUE_NUMBER_PARSED);
+    assert(value_is_integer(&info));
+    size_t length = 4;
+    assert(check_len_value(&info, &length) == ENVIL_OK);
+    assert(info.flags & VALUE_LENGTH_KNOWN);
+    
+    printf("exact threshold tests passed!\n");
+}
+
 void test_check_len() {
     printf("Testing check_len...\n");
     
@@ -134,10 +194,7 @@ void test_check_cmd() {
     printf("Testing check_cmd...\n");
     
     // Test successful command
-    struct {
-        char* cmd;
-        size_t cmd_len;
-    } cmd_value = {
+    CmdCheck cmd_value = {
         .cmd = "exit 0",
         .cmd_len = strlen("exit 0")
     };
@@ -162,6 +219,296 @@ void test_check_cmd() {
     printf("check_cmd tests passed!\n");
 }
 
+static long elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+void test_check_cmd_timeout() {
+    printf("Testing check_cmd timeouts...\n");
+
+    struct timespec start;
+    CmdCheck cmd_value = {.cmd = "exit 0", .cmd_len = 6, .timeout_ms = 5000};
+    assert(check_cmd("test", &cmd_value) == ENVIL_OK);
+
+    // A hung command is killed, background children included
+    cmd_value.cmd = "sleep 30 & sleep 30";
+    cmd_value.cmd_len = strlen(cmd_value.cmd);
+    cmd_value.timeout_ms = 100;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(check_cmd("test", &cmd_value) == ENVIL_TIMEOUT_ERROR);
+    assert(elapsed_ms(&start) < 2000);
+
+    // A command that closed its output but keeps running
+    cmd_value.cmd = "exec >/dev/null 2>&1; sleep 30";
+    cmd_value.cmd_len = strlen(cmd_value.cmd);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(check_cmd("test", &cmd_value) == ENVIL_TIMEOUT_ERROR);
+    assert(elapsed_ms(&start) < 2000);
+
+    // The deadline bounds checks without a timeout of their own
+    cmd_value.cmd = "sleep 30";
+    cmd_value.cmd_len = strlen(cmd_value.cmd);
+    cmd_value.timeout_ms = 0;
+    set_check_deadline(100);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(check_cmd("test", &cmd_value) == ENVIL_TIMEOUT_ERROR);
+    assert(elapsed_ms(&start) < 2000);
+    assert(check_deadline_passed());
+    assert(!cmd_check_not_run());
+
+    // Past the deadline nothing is started
+    cmd_value.cmd = "exit 0";
+    cmd_value.cmd_len = 6;
+    assert(check_cmd("test", &cmd_value) == ENVIL_TIMEOUT_ERROR);
+    assert(cmd_check_not_run());
+    set_check_deadline(0);
+    assert(check_cmd("test", &cmd_value) == ENVIL_OK);
+    assert(!cmd_check_not_run());
+
+    printf("check_cmd timeout tests passed!\n");
+}
+
+static NetConstraint net_constraint(const char* check_name, const char* str) {
+    NetConstraint constraint;
+    assert(parse_net_constraint(check_name, str, &constraint));
+    return constraint;
+}
+
+void test_check_netaddr() {
+    printf("Testing network address checks...\n");
+
+    NetConstraint any = net_constraint("ip", "any");
+    assert(check_ipv4("192.168.1.1", &any) == ENVIL_OK);
+    assert(check_ipv4("0.0.0.0", &any) == ENVIL_OK);
+    assert(check_ipv4("255.255.255.255", &any) == ENVIL_OK);
+    assert(check_ipv4("256.1.1.1", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv4("01.2.3.4", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv4("1.2.3", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv4("1.2.3.4.", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv4(" 1.2.3.4", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv6("::", &any) == ENVIL_OK);
+    assert(check_ipv6("::1", &any) == ENVIL_OK);
+    assert(check_ipv6("2001:db8::ff00:42:8329", &any) == ENVIL_OK);
+    assert(check_ipv6("::ffff:192.0.2.128", &any) == ENVIL_OK);
+    assert(check_ipv6("1:2:3:4:5:6:7::", &any) == ENVIL_OK);
+    assert(check_ipv6("1:2:3:4:5:6:7:8:9", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv6("1::2::3", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv6(":1::", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ipv6("12345::", &any) == ENVIL_VALUE_ERROR);
+    assert(check_ip("10.0.0.1", &any) == ENVIL_OK);
+    assert(check_ip("fe80::1", &any) == ENVIL_OK);
+    assert(check_ip("example.com", &any) == ENVIL_VALUE_ERROR);
+
+    // Address classes
+    NetConstraint private = net_constraint("ip", "private");
+    assert(check_ip("10.1.2.3", &private) == ENVIL_OK);
+    assert(check_ip("172.31.255.255", &private) == ENVIL_OK);
+    assert(check_ip("172.32.0.1", &private) == ENVIL_VALUE_ERROR);
+    assert(check_ip("fd12:3456::1", &private) == ENVIL_OK);
+    assert(check_ip("::ffff:192.168.0.1", &private) == ENVIL_OK);
+    assert(check_ip("8.8.8.8", &private) == ENVIL_VALUE_ERROR);
+    NetConstraint public = net_constraint("ip", "public");
+    assert(check_ip("8.8.8.8", &public) == ENVIL_OK);
+    assert(check_ip("2606:4700::1111", &public) == ENVIL_OK);
+    assert(check_ip("2001:db8::1", &public) == ENVIL_VALUE_ERROR);
+    assert(check_ip("127.0.0.1", &public) == ENVIL_VALUE_ERROR);
+    assert(check_ip("192.0.2.1", &public) == ENVIL_VALUE_ERROR);
+    NetConstraint local = net_constraint("ip", "loopback, link-local");
+    assert(check_ip("::1", &local) == ENVIL_OK);
+    assert(check_ip("169.254.0.1", &local) == ENVIL_OK);
+    assert(check_ip("10.0.0.1", &local) == ENVIL_VALUE_ERROR);
+
+    // Networks must have their host bits clear and lie wholly in a class
+    assert(check_cidr("10.0.0.0/8", &private) == ENVIL_OK);
+    assert(check_cidr("10.0.0.1/8", &any) == ENVIL_VALUE_ERROR);
+    assert(check_cidr("172.16.0.0/11", &private) == ENVIL_VALUE_ERROR);
+    assert(check_cidr("0.0.0.0/0", &any) == ENVIL_OK);
+    assert(check_cidr("192.168.1.7/32", &private) == ENVIL_OK);
+    assert(check_cidr("192.168.1.0/33", &any) == ENVIL_VALUE_ERROR);
+    assert(check_cidr("2001:db8::/32", &any) == ENVIL_OK);
+    assert(check_cidr("fd00::/8", &private) == ENVIL_OK);
+    assert(check_cidr("fd00::/08", &private) == ENVIL_VALUE_ERROR);
+    assert(check_cidr("10.0.0.0", &any) == ENVIL_VALUE_ERROR);
+
+    NetConstraint fqdn = net_constraint("hostname", "fqdn");
+    assert(check_hostname("localhost", &any) == ENVIL_OK);
+    assert(check_hostname("localhost", &fqdn) == ENVIL_VALUE_ERROR);
+    assert(check_hostname("db-1.internal.example.com.", &fqdn) == ENVIL_OK);
+    assert(check_hostname("-db.example.com", &any) == ENVIL_VALUE_ERROR);
+    assert(check_hostname("db_1.example.com", &any) == ENVIL_VALUE_ERROR);
+    assert(check_hostname("a..b", &any) == ENVIL_VALUE_ERROR);
+    assert(check_hostname("999.1.1.1", &any) == ENVIL_VALUE_ERROR);
+    char long_label[80];
+    memset(long_label, 'a', 64);
+    strcpy(long_label + 64, ".com");
+    assert(check_hostname(long_label, &any) == ENVIL_VALUE_ERROR);
+
+    NetConstraint ports = net_constraint("hostport", "1024-65535");
+    assert(check_hostport("db.example.com:5432", &ports) == ENVIL_OK);
+    assert(check_hostport("10.0.0.1:8080", &ports) == ENVIL_OK);
+    assert(check_hostport("[::1]:8080", &ports) == ENVIL_OK);
+    assert(check_hostport("::1:8080", &ports) == ENVIL_VALUE_ERROR);
+    assert(check_hostport("localhost:80", &ports) == ENVIL_VALUE_ERROR);
+    assert(check_hostport("localhost:65536", &ports) == ENVIL_VALUE_ERROR);
+    assert(check_hostport("localhost:", &ports) == ENVIL_VALUE_ERROR);
+    assert(check_hostport("localhost", &ports) == ENVIL_VALUE_ERROR);
+    NetConstraint private_port = net_constraint("hostport", "private,5432");
+    assert(check_hostport("10.0.0.5:5432", &private_port) == ENVIL_OK);
+    assert(check_hostport("8.8.8.8:5432", &private_port) == ENVIL_VALUE_ERROR);
+    assert(check_hostport("10.0.0.5:5433", &private_port) == ENVIL_VALUE_ERROR);
+
+    // Constraint words are checked per check
+    NetConstraint constraint;
+    assert(!parse_net_constraint("ip", "fqdn", &constraint));
+    assert(!parse_net_constraint("hostname", "private", &constraint));
+    assert(!parse_net_constraint("ip", "1024", &constraint));
+    assert(!parse_net_constraint("hostport", "2000-1000", &constraint));
+    assert(!parse_net_constraint("ip", "privat", &constraint));
+
+    // Differential against inet_pton on generated addresses
+    static const char* parts[] = {"0", "1", "ff", "FFFF", "abcd", "12345", "g", "", ":", "::", ".", "1.2.3.4", "255.0.0.256", "01"};
+    srand(35);
+    for (int i = 0; i < 200000; i++) {
+        char text[64] = "";
+        int count = 1 + rand() % 10;
+        for (int k = 0; k < count && strlen(text) < 48; k++) {
+            strcat(text, parts[rand() % (sizeof(parts) / sizeof(parts[0]))]);
+            if (rand() % 3) strcat(text, ":");
+        }
+        uint8_t ours[16], theirs[16];
+        bool ok = parse_ipv6(text, strlen(text), ours);
+        bool expected = inet_pton(AF_INET6, text, theirs) == 1;
+        assert(ok == expected);
+        if (ok) assert(memcmp(ours, theirs, 16) == 0);
+
+        bool ok4 = parse_ipv4(text + count % 4, strlen(text + count % 4), ours);
+        assert(ok4 == (inet_pton(AF_INET, text + count % 4, theirs) == 1));
+    }
+
+    printf("Network address check tests passed!\n");
+}
+
+static const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t encode_base64(const unsigned char* data, size_t len, char* out) {
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        unsigned n = data[i] << 16 | (i + 1 < len ? data[i + 1] << 8 : 0) | (i + 2 < len ? data[i + 2] : 0);
+        out[o++] = base64_alphabet[n >> 18 & 63];
+        out[o++] = base64_alphabet[n >> 12 & 63];
+        out[o++] = i + 1 < len ? base64_alphabet[n >> 6 & 63] : '=';
+        out[o++] = i + 2 < len ? base64_alphabet[n & 63] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+void test_check_formats() {
+    printf("Testing format checks...\n");
+
+    int any_version = 0;
+    int v4_or_v7 = 1 << 4 | 1 << 7;
+    assert(check_uuid("123e4567-e89b-42d3-a456-426614174000", &any_version) == ENVIL_OK);
+    assert(check_uuid("123E4567-E89B-42D3-A456-426614174000", &v4_or_v7) == ENVIL_OK);
+    assert(check_uuid("017f22e2-79b0-7cc3-98c4-dc0c0c07398f", &v4_or_v7) == ENVIL_OK);
+    assert(check_uuid("123e4567-e89b-12d3-a456-426614174000", &v4_or_v7) == ENVIL_VALUE_ERROR);
+    assert(check_uuid("123e4567-e89b-42d3-c456-426614174000", &v4_or_v7) == ENVIL_VALUE_ERROR);
+    assert(check_uuid("123e4567e89b42d3a456426614174000", &any_version) == ENVIL_VALUE_ERROR);
+    assert(check_uuid("123e4567-e89b-42d3-a456-42661417400g", &any_version) == ENVIL_VALUE_ERROR);
+
+    size_t any_length = 0;
+    size_t sixteen = 16;
+    assert(check_base64("aGVsbG8=", &any_length) == ENVIL_OK);
+    assert(check_base64("aGVsbG8", &any_length) == ENVIL_VALUE_ERROR);
+    assert(check_base64("aGVsbG9=", &any_length) == ENVIL_VALUE_ERROR);  // Stray bits
+    assert(check_base64("aGVs=G8=", &any_length) == ENVIL_VALUE_ERROR);
+    assert(check_base64("", &any_length) == ENVIL_VALUE_ERROR);
+    assert(check_base64("AAECAwQFBgcICQoLDA0ODw==", &sixteen) == ENVIL_OK);
+    assert(check_base64("AAECAwQFBgcICQoLDA0O", &sixteen) == ENVIL_VALUE_ERROR);
+    assert(check_base64url("AAECAwQFBgcICQoLDA0ODw", &sixteen) == ENVIL_OK);
+    assert(check_base64url("_-8", &any_length) == ENVIL_OK);
+    assert(check_base64url("_-8=", &any_length) == ENVIL_OK);
+    assert(check_base64url("+/8=", &any_length) == ENVIL_VALUE_ERROR);
+    assert(check_base64url("A", &any_length) == ENVIL_VALUE_ERROR);
+    assert(check_hex("deadBEEF", &any_length) == ENVIL_OK);
+    assert(check_hex("deadBEE", &any_length) == ENVIL_VALUE_ERROR);
+    assert(check_hex("000102030405060708090a0b0c0d0e0f", &sixteen) == ENVIL_OK);
+    assert(check_hex("000102030405060708090a0b0c0d0e0g", &sixteen) == ENVIL_VALUE_ERROR);
+    assert(check_hex("0001020304050607", &sixteen) == ENVIL_VALUE_ERROR);
+
+    // Generated values cross the 16-byte SSE2 blocks and the scalar tail
+    srand(36);
+    char encoded[512];
+    unsigned char data[256];
+    for (int i = 0; i < 20000; i++) {
+        size_t len = 1 + (size_t)rand() % 200;
+        for (size_t k = 0; k < len; k++) data[k] = (unsigned char)rand();
+        size_t encoded_len = encode_base64(data, len, encoded);
+        size_t decoded_len = 0;
+        assert(parse_base64(encoded, encoded_len, false, &decoded_len) && decoded_len == len);
+
+        // One corrupted character must be caught wherever it lands
+        size_t pos = (size_t)rand() % encoded_len;
+        char bad = "!@#$%^&*()\x80\xff\n -_."[rand() % 18];
+        if (encoded[pos] == '=') continue;
+        encoded[pos] = bad;
+        assert(!parse_base64(encoded, encoded_len, false, NULL));
+
+        char hex[512];
+        for (size_t k = 0; k < len; k++) snprintf(hex + 2 * k, 3, "%02x", data[k]);
+        assert(parse_hex(hex, 2 * len, &decoded_len) && decoded_len == len);
+        hex[(size_t)rand() % (2 * len)] = "gG:/@`\x80 "[rand() % 8];
+        assert(!parse_hex(hex, 2 * len, NULL));
+    }
+
+    // Semantic versions and ranges
+    SemverRange* any = parse_semver_range("any");
+    SemverRange* major2 = parse_semver_range(">=2.0.0 <3");
+    SemverRange* either = parse_semver_range("<1.4 || =2.1.0 || >=3.0.0-rc.1 <3.0.0");
+    assert(any && major2 && either);
+    assert(check_semver("1.0.0", any) == ENVIL_OK);
+    assert(check_semver("1.0.0-alpha.1+build.5", any) == ENVIL_OK);
+    assert(check_semver("1.0", any) == ENVIL_VALUE_ERROR);
+    assert(check_semver("01.0.0", any) == ENVIL_VALUE_ERROR);
+    assert(check_semver("1.0.0-01", any) == ENVIL_VALUE_ERROR);
+    assert(check_semver("1.0.0-", any) == ENVIL_VALUE_ERROR);
+    assert(check_semver("1.0.0.0", any) == ENVIL_VALUE_ERROR);
+    assert(check_semver("v1.0.0", any) == ENVIL_VALUE_ERROR);
+    assert(check_semver("2.0.0", major2) == ENVIL_OK);
+    assert(check_semver("2.99.1", major2) == ENVIL_OK);
+    assert(check_semver("3.0.0", major2) == ENVIL_VALUE_ERROR);
+    assert(check_semver("2.0.0-rc.1", major2) == ENVIL_VALUE_ERROR);
+    assert(check_semver("1.3.9", either) == ENVIL_OK);
+    assert(check_semver("1.4.0", either) == ENVIL_VALUE_ERROR);
+    assert(check_semver("2.1.0", either) == ENVIL_OK);
+    assert(check_semver("3.0.0-rc.2", either) == ENVIL_OK);
+    assert(check_semver("3.0.0-rc.1", either) == ENVIL_OK);
+    assert(check_semver("3.0.0-beta", either) == ENVIL_VALUE_ERROR);
+    assert(check_semver("3.0.0", either) == ENVIL_VALUE_ERROR);
+    free_semver_range(any);
+    free_semver_range(major2);
+    free_semver_range(either);
+
+    // Precedence example from the specification
+    const char* ordered[] = {"1.0.0-alpha", "1.0.0-alpha.1", "1.0.0-alpha.beta", "1.0.0-beta",
+                             "1.0.0-beta.2", "1.0.0-beta.11", "1.0.0-rc.1", "1.0.0"};
+    for (int i = 0; i + 1 < 8; i++) {
+        Semver a, b;
+        assert(parse_semver(ordered[i], strlen(ordered[i]), &a));
+        assert(parse_semver(ordered[i + 1], strlen(ordered[i + 1]), &b));
+        assert(compare_semver(&a, &b) < 0 && compare_semver(&b, &a) > 0);
+    }
+
+    assert(parse_semver_range("") == NULL);
+    assert(parse_semver_range(">=1 ||") == NULL);
+    assert(parse_semver_range("|| 1") == NULL);
+    assert(parse_semver_range(">=x") == NULL);
+
+    printf("Format check tests passed!\n");
+}
+
 void test_check_registry() {
     printf("Testing check registry...\n");
     
@@ -199,6 +546,220 @@ void test_check_registry() {
     printf("check registry tests passed!\n");
 }
 
+void test_check_fs() {
+    printf("Testing filesystem checks...\n");
+
+    char dir[] = "/tmp/envil_test_fsXXXXXX";
+    assert(mkdtemp(dir));
+    char file[64], sock[64], missing[64];
+    snprintf(file, sizeof(file), "%s/file", dir);
+    snprintf(sock, sizeof(sock), "%s/sock", dir);
+    snprintf(missing, sizeof(missing), "%s/missing", dir);
+
+    FILE* f = fopen(file, "w");
+    assert(f);
+    for (int i = 0; i < 100; i++) fputc('x', f);
+    fclose(f);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", sock);
+    assert(fd >= 0 && bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+
+    int yes = 1, no = 0;
+    size_t hundred = 100, small = 99;
+
+    // Once stat'ed on demand, then from a prefetched batch: same answers
+    for (int round = 0; round < 2; round++) {
+        if (round == 1) {
+            const char* paths[] = {dir, file, sock, missing};
+            prefetch_path_stats(paths, 4);
+        }
+        assert(check_path_exists(file, &yes) == ENVIL_OK);
+        assert(check_path_exists(missing, &yes) == ENVIL_VALUE_ERROR);
+        assert(check_path_exists(missing, &no) == ENVIL_OK);
+        assert(check_file(file, &yes) == ENVIL_OK);
+        assert(check_file(dir, &yes) == ENVIL_VALUE_ERROR);
+        assert(check_file(missing, &no) == ENVIL_OK);
+        assert(check_dir(dir, &yes) == ENVIL_OK);
+        assert(check_dir(file, &yes) == ENVIL_VALUE_ERROR);
+        assert(check_socket(sock, &yes) == ENVIL_OK);
+        assert(check_socket(file, &yes) == ENVIL_VALUE_ERROR);
+        assert(check_max_size(file, &hundred) == ENVIL_OK);
+        assert(check_max_size(file, &small) == ENVIL_VALUE_ERROR);
+        assert(check_max_size(missing, &hundred) == ENVIL_VALUE_ERROR);
+    }
+    clear_path_stats();
+
+    assert(check_readable(file, &yes) == ENVIL_OK);
+    assert(check_readable(missing, &yes) == ENVIL_VALUE_ERROR);
+    assert(check_writable(dir, &yes) == ENVIL_OK);
+    assert(check_writable(missing, &no) == ENVIL_OK);
+
+    close(fd);
+    unlink(sock);
+    unlink(file);
+    rmdir(dir);
+}
+
+void test_check_url() {
+    printf("Testing url check...\n");
+
+    UrlParts parts;
+    const char* dsn = "postgresql://user:p@ss@db.local:5432/app?sslmode=require#top";
+    assert(parse_url(dsn, strlen(dsn), &parts));
+    assert(parts.parts[URL_SCHEME].len == 10);
+    assert(strncmp(parts.parts[URL_USERINFO].start, "user:p@ss", parts.parts[URL_USERINFO].len) == 0);
+    assert(strncmp(parts.parts[URL_HOST].start, "db.local", parts.parts[URL_HOST].len) == 0);
+    assert(strncmp(parts.parts[URL_PORT].start, "5432", parts.parts[URL_PORT].len) == 0);
+    assert(strncmp(parts.parts[URL_PATH].start, "/app", parts.parts[URL_PATH].len) == 0);
+    assert(strncmp(parts.parts[URL_QUERY].start, "sslmode=require", parts.parts[URL_QUERY].len) == 0);
+
+    const char* literal = "http://[fe80::1]:8080";
+    assert(parse_url(literal, strlen(literal), &parts));
+    assert(strncmp(parts.parts[URL_HOST].start, "fe80::1", parts.parts[URL_HOST].len) == 0);
+    assert(!parts.parts[URL_PATH].present && !parts.parts[URL_QUERY].present);
+
+    const char* socket_dsn = "postgres:///app";
+    assert(parse_url(socket_dsn, strlen(socket_dsn), &parts) && !parts.parts[URL_HOST].present);
+    assert(parse_url("db.local:5432", 13, &parts));  // A scheme "db.local", as RFC 3986 reads it
+    assert(!parse_url("//db.local", 10, &parts));
+    assert(!parse_url("http://db:80x/", 14, &parts));
+    assert(!parse_url("http://a b/", 11, &parts));
+
+    Check check;
+    EnvType type = TYPE_STRING;
+    assert(process_check("url", "scheme.enum=postgresql,postgres;port.le=65535;host.required=true", &check, &type));
+    assert(check_url("postgresql://db:5432/app", check.value.url_check) == ENVIL_OK);
+    assert(check_url("postgres://db/app", check.value.url_check) == ENVIL_OK);  // No port to check
+    assert(check_url("mysql://db:3306/app", check.value.url_check) == ENVIL_VALUE_ERROR);
+    assert(check_url("postgres://db:70000/app", check.value.url_check) == ENVIL_VALUE_ERROR);
+    assert(check_url("postgres:///app", check.value.url_check) == ENVIL_VALUE_ERROR);
+    assert(check_url("not a url", check.value.url_check) == ENVIL_VALUE_ERROR);
+    free_check_value(&check);
+
+    // Escaped ';' in a value, "any", and malformed specs
+    assert(process_check("url", "path.eq=/a\\;b", &check, &type));
+    assert(check_url("file:/a;b", check.value.url_check) == ENVIL_OK);
+    free_check_value(&check);
+    assert(process_check("url", "any", &check, &type));
+    assert(check_url("https://example.com", check.value.url_check) == ENVIL_OK);
+    free_check_value(&check);
+    assert(!process_check("url", "port", &check, &type));
+    assert(!process_check("url", "fragment.eq=x", &check, &type));
+    assert(!process_check("url", "host.url=any", &check, &type));
+    assert(!process_check("url", "port.le=abc", &check, &type));
+}
+
+void test_check_units() {
+    printf("Testing duration and size values...\n");
+
+    int64_t amount;
+    assert(parse_duration("30s", 3, &amount) && amount == 30000000000);
+    assert(parse_duration("1h30m", 5, &amount) && amount == 5400000000000);
+    assert(parse_duration("1.5h", 4, &amount) && amount == 5400000000000);
+    assert(parse_duration("250ms", 5, &amount) && amount == 250000000);
+    assert(parse_duration("-2us", 4, &amount) && amount == -2000);
+    assert(parse_duration("0", 1, &amount) && amount == 0);
+    assert(!parse_duration("30", 2, &amount));
+    assert(!parse_duration("5.s", 3, &amount));
+    assert(!parse_duration("3M", 2, &amount));
+    assert(!parse_duration("999999999999d", 13, &amount));
+
+    assert(parse_byte_size("512", 3, &amount) && amount == 512);
+    assert(parse_byte_size("1K", 2, &amount) && amount == 1024);
+    assert(parse_byte_size("512Mi", 5, &amount) && amount == 512 << 20);
+    assert(parse_byte_size("2GB", 3, &amount) && amount == 2000000000);
+    assert(parse_byte_size("1.5KiB", 6, &amount) && amount == 1536);
+    assert(!parse_byte_size("10X", 3, &amount));
+    assert(!parse_byte_size("-1", 2, &amount));
+    assert(!parse_byte_size("5m", 2, &amount));
+    assert(!parse_byte_size("16EiB", 5, &amount));
+
+    char buf[32];
+    assert(strcmp(format_duration(5400000000000, buf, sizeof(buf)), "90m") == 0);
+    assert(strcmp(format_duration(1500, buf, sizeof(buf)), "1500ns") == 0);
+    assert(strcmp(format_byte_size(512 << 20, buf, sizeof(buf)), "512MiB") == 0);
+    assert(strcmp(format_byte_size(2000000000, buf, sizeof(buf)), "2GB") == 0);
+
+    EnvType duration = TYPE_DURATION;
+    EnvType bytesize = TYPE_BYTESIZE;
+    assert(check_type("45s", &duration) == ENVIL_OK);
+    assert(check_type("45", &duration) == ENVIL_TYPE_ERROR);
+    assert(check_type("512Mi", &bytesize) == ENVIL_OK);
+    assert(check_type("512 Mi", &bytesize) == ENVIL_TYPE_ERROR);
+
+    // Thresholds with units compare in that unit, whatever unit the value uses
+    Number threshold;
+    assert(parse_threshold("1m", &threshold) && threshold.unit == UNIT_DURATION);
+    assert(check_gt("90s", &threshold) == ENVIL_OK);
+    assert(check_gt("60000ms", &threshold) == ENVIL_VALUE_ERROR);
+    assert(check_le("1m", &threshold) == ENVIL_OK);
+    assert(check_lt("90", &threshold) == ENVIL_VALUE_ERROR);
+    assert(parse_threshold("1GiB", &threshold) && threshold.unit == UNIT_BYTES);
+    assert(check_lt("512Mi", &threshold) == ENVIL_OK);
+    assert(check_ge("1073741824", &threshold) == ENVIL_OK);
+    assert(check_gt("1GB", &threshold) == ENVIL_VALUE_ERROR);
+    assert(parse_threshold("10", &threshold) && threshold.unit == UNIT_NONE);
+    assert(check_gt("1m", &threshold) == ENVIL_VALUE_ERROR);
+}
+
+void test_check_expr() {
+    printf("Testing expr checks...\n");
+
+    Check check;
+    EnvType type = TYPE_STRING;
+    assert(process_check("expr", "value <= 10 && len(value) == 1", &check, &type));
+    assert(check_expr("7", check.value.expr) == ENVIL_OK);
+    assert(check_expr("12", check.value.expr) == ENVIL_VALUE_ERROR);
+    free_check_value(&check);
+
+    // Variables come from the environment set for the thread
+    const char* values[] = {"prod", NULL, "30s"};
+    bool invalid[] = {false, false, false};
+    char error[128];
+    Expr* expr = compile_expr("ENV != 'prod' || defined(TLS_CERT)", error, sizeof(error));
+    assert(expr && expr_name_count(expr) == 2);
+    bind_expr_name(expr, 0, 0);
+    bind_expr_name(expr, 1, 1);
+    ExprEnv env = {values, invalid, NULL, NULL};
+    set_expr_env(&env);
+    assert(eval_expr(expr, "x") == EXPR_FALSE);
+    values[1] = "/etc/tls.pem";
+    assert(eval_expr(expr, "x") == EXPR_TRUE);
+    invalid[0] = true;
+    assert(eval_expr(expr, "x") == EXPR_SKIPPED);
+    free_expr(expr);
+
+    // Units carry through comparisons and arithmetic
+    expr = compile_expr("value * 2 <= TIMEOUT + 1m", error, sizeof(error));
+    assert(expr);
+    bind_expr_name(expr, 0, 2);
+    assert(eval_expr(expr, "45s") == EXPR_TRUE);
+    assert(eval_expr(expr, "46s") == EXPR_FALSE);
+    assert(eval_expr(expr, "abc") == EXPR_ERROR);
+    free_expr(expr);
+    set_expr_env(NULL);
+
+    expr = compile_expr("value / 0 > 1", error, sizeof(error));
+    assert(expr && eval_expr(expr, "4") == EXPR_ERROR);
+    free_expr(expr);
+    expr = compile_expr("!(value == \"a\\\"b\") && num(value) != 3 && -value < 0", error, sizeof(error));
+    assert(expr && eval_expr(expr, "4") == EXPR_TRUE && eval_expr(expr, "a\"b") == EXPR_FALSE);
+    free_expr(expr);
+    expr = compile_expr("value == true", error, sizeof(error));
+    assert(expr && eval_expr(expr, "yes") == EXPR_TRUE && eval_expr(expr, "maybe") == EXPR_FALSE);
+    free_expr(expr);
+
+    assert(!compile_expr("value <", error, sizeof(error)));
+    assert(strstr(error, "column 8"));
+    assert(!compile_expr("1 < value < 3", error, sizeof(error)));
+    assert(!compile_expr("size(value) > 1", error, sizeof(error)));
+    assert(!compile_expr("'open", error, sizeof(error)));
+    assert(!compile_expr("12parsecs > value", error, sizeof(error)));
+    assert(!process_check("expr", "value ==", &check, &type));
+}
+
 void test_check_eq() {
     printf("Testing check_eq...\n");
     
@@ -285,28 +846,53 @@ void test_check_lenlt() {
     printf("check_lenlt tests passed!\n");
 }
 
+// Runs check_regex with pattern compiled as a config load would
+static int match_regex(const char* value, const char* pattern) {
+    RegexCheck* regex = compile_regex_check(pattern);
+    assert(regex != NULL);
+    int result = check_regex(value, regex);
+    free_regex_check(regex);
+    return result;
+}
+
 void test_check_regex() {
     printf("Testing check_regex...\n");
     
     // Test basic patterns
     const char* pattern = "^foo.*$";
-    assert(check_regex("foo", pattern) == ENVIL_OK);
-    assert(check_regex("foobar", pattern) == ENVIL_OK);
-    assert(check_regex("bar", pattern) == ENVIL_VALUE_ERROR);
+    assert(match_regex("foo", pattern) == ENVIL_OK);
+    assert(match_regex("foobar", pattern) == ENVIL_OK);
+    assert(match_regex("bar", pattern) == ENVIL_VALUE_ERROR);
     
     // Test more complex patterns
     pattern = "^[A-Za-z0-9]+$";
-    assert(check_regex("abc123", pattern) == ENVIL_OK);
-    assert(check_regex("ABC123", pattern) == ENVIL_OK);
-    assert(check_regex("abc-123", pattern) == ENVIL_VALUE_ERROR);
-    assert(check_regex("", pattern) == ENVIL_VALUE_ERROR);
+    assert(match_regex("abc123", pattern) == ENVIL_OK);
+    assert(match_regex("ABC123", pattern) == ENVIL_OK);
+    assert(match_regex("abc-123", pattern) == ENVIL_VALUE_ERROR);
+    assert(match_regex("", pattern) == ENVIL_VALUE_ERROR);
     
     // Test email pattern
     pattern = "^[^@]+@[^@]+\\.[^@]+$";
-    assert(check_regex("test@example.com", pattern) == ENVIL_OK);
-    assert(check_regex("test.name@example.co.uk", pattern) == ENVIL_OK);
-    assert(check_regex("invalid-email", pattern) == ENVIL_VALUE_ERROR);
-    assert(check_regex("@example.com", pattern) == ENVIL_VALUE_ERROR);
+    assert(match_regex("test@example.com", pattern) == ENVIL_OK);
+    assert(match_regex("test.name@example.co.uk", pattern) == ENVIL_OK);
+    assert(match_regex("invalid-email", pattern) == ENVIL_VALUE_ERROR);
+    assert(match_regex("@example.com", pattern) == ENVIL_VALUE_ERROR);
+
+    // One compiled pattern serves every call
+    RegexCheck* regex = compile_regex_check("^[0-9]+$");
+    assert(regex != NULL && regex->compiled && strcmp(regex->pattern, "^[0-9]+$") == 0);
+    for (int i = 0; i < 3; i++) {
+        assert(check_regex("123", regex) == ENVIL_OK);
+        assert(check_regex("12a", regex) == ENVIL_VALUE_ERROR);
+    }
+    free_regex_check(regex);
+
+    // A pattern that does not compile fails every value
+    regex = compile_regex_check("[0-9");
+    assert(regex != NULL && !regex->compiled);
+    assert(check_regex("1", regex) == ENVIL_VALUE_ERROR);
+    assert(check_regex("", regex) == ENVIL_VALUE_ERROR);
+    free_regex_check(regex);
     
     printf("check_regex tests passed!\n");
 }
@@ -317,9 +903,17 @@ int main() {
     test_check_type();
     test_check_gt();
     test_check_lt();
+    test_check_thresholds();
     test_check_len();
     test_check_enum();
     test_check_cmd();
+    test_check_cmd_timeout();
+    test_check_netaddr();
+    test_check_formats();
+    test_check_fs();
+    test_check_url();
+    test_check_units();
+    test_check_expr();
     test_check_eq();
     test_check_ne();
     test_check_lengt();
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <regex.h>
+#include "codegen.h"
+#include "config.h"
+#include "dfa.h"
+#include "validator.h"
+#include "test_util.h"
+
+void test_dfa_matches_regexec() {
+    printf("Testing regex DFAs against regexec...\n");
+
+    const char* patterns[] = {
+        "^[a-z]+$", "a|b", "ab*c", "(ab)+", "^$", "$", "^", "a$", "^a", "x{2,3}", "x{2}", "x{2,}",
+        "[[:digit:]]+", "[^a-c]", "\\w+\\s", "\\.", "a.c", "[]a]", "[^]a]", "[a-]", "(a|ab)(c|bcd)(d*)",
+        "^(foo|bar)[0-9]{1,3}$", "a**", "(a*)*b", "[[:alpha:]_][[:alnum:]_]*", "}", "]", "x$|^y",
+        "(^a|b$)", "[\\]", "a\\+", "^[0-9a-fA-F]{8}-[0-9a-fA-F]{4}$", "(a|b)*abb", "\\W\\S",
+    };
+    const char* values[] = {
+        "", "a", "b", "abc", "ac", "abbbc", "abab", "x", "xx", "xxx", "xxxx", "12", "a1", "d", "]", "a-",
+        "abcd", "abcbcd", "foo12", "bar1234", "aab", "_x1", "}", "y", "ya", "xy", "\\", "a+", "Hello",
+        "deadbeef-cafe", "deadbeef-cafg", "babb", "aaabb", "a\nb", "\n", "\t", " ", "\xff", "\xe9t\xe9",
+    };
+    for (size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+        char error[128];
+        Dfa* dfa = compile_dfa(patterns[i], error, sizeof(error));
+        regex_t regex;
+        assert(dfa != NULL);
+        assert(regcomp(&regex, patterns[i], REG_EXTENDED | REG_NOSUB) == 0);
+        for (size_t j = 0; j < sizeof(values) / sizeof(values[0]); j++) {
+            bool expected = regexec(&regex, values[j], 0, NULL, 0) == 0;
+            assert(dfa_match(dfa, values[j], strlen(values[j])) == expected);
+        }
+        regfree(&regex);
+        free_dfa(dfa);
+    }
+
+    // Back-references, boundaries, collation and anchors glibc reads next to a newline
+    const char* rejected[] = {
+        "(a)\\1", "\\bfoo", "[[.a.]]", "[[=a=]]", "a{,3}", "*a", "a||b", "()", "(a", "a)", "[a",
+        "[z-a]", "\\d", ".^a", "a$\n",
+    };
+    for (size_t i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        char error[128] = "";
+        assert(compile_dfa(rejected[i], error, sizeof(error)) == NULL);
+        assert(*error);
+    }
+
+    printf("Regex DFA tests passed!\n");
+}
+
+// One case per line: NAME=VALUE assignments separated by tabs
+static const char* const cases[] = {
+    "",
+    "NAME=web-1",
+    "NAME=Web",
+    "NAME=ab",
+    "NAME=admin",
+    "NAME=x\tPORT=80",
+    "NAME=web\tPORT=abc",
+    "NAME=web\tPORT=65536",
+    "NAME=web\tPORT=-0",
+    "NAME=web\tPORT=99999999999999999999",
+    "NAME=web\tPORT=+2000",
+    "NAME=web\tTIMEOUT=1h\tSIZE=1GiB",
+    "NAME=web\tTIMEOUT=50ms\tSIZE=1.5G",
+    "NAME=web\tTIMEOUT=1m30s\tSIZE=512MB",
+    "NAME=web\tTIMEOUT=-1s\tSIZE=12 kB",
+    "NAME=web\tTIMEOUT=0\tSIZE=0.5KiB",
+    "NAME=web\tTIMEOUT=2\xc2\xb5s\tSIZE=abc",
+    "NAME=web\tRATIO=1.5",
+    "NAME=web\tRATIO=-0.1",
+    "NAME=web\tRATIO=nan",
+    "NAME=web\tRATIO=1e-3",
+    "NAME=web\tRATIO=.5",
+    "NAME=web\tRATIO=5.",
+    "NAME=web\tRATIO=inf",
+    "NAME=web\tRATIO=0x1",
+    "NAME=web\tRATIO= 1",
+    "NAME=web\tRATIO=1",
+    "NAME=web\tLIMIT=-2.5",
+    "NAME=web\tLIMIT=-2",
+    "NAME=web\tLIMIT=9223372036854775807",
+    "NAME=web\tLIMIT=9223372036854775808",
+    "NAME=web\tLIMIT=abc",
+    "NAME=web\tLIMIT=-3e0",
+    "NAME=web\tDELAY=2s",
+    "NAME=web\tDELAY=1999ms",
+    "NAME=web\tDELAY=x",
+    "NAME=web\tMODE=slow",
+    "NAME=web\tMODE=",
+    "NAME=web\tTOKEN=zzzz",
+    "NAME=web\tTOKEN=zzzx",
+    "NAME=web\tTOKEN=ab",
+    "NAME=web\tLEVEL=warn",
+    "NAME=web\tLEVEL=WARN",
+    "NAME=web\tLEVEL=",
+};
+
+typedef struct {
+    char* names[16];
+    char* values[16];
+    int count;
+} Assignments;
+
+static const char* lookup_assignment(const char* name, void* data) {
+    const Assignments* assignments = data;
+    for (int i = 0; i < assignments->count; i++) {
+        if (strcmp(assignments->names[i], name) == 0) return assignments->values[i];
+    }
+    return NULL;
+}
+
+// What the generated validator should print for a case: each failure, then the result
+static void expected_output(const Config* config, const char* line, char* out, size_t size) {
+    char* copy = strdup(line);
+    Assignments assignments = {.count = 0};
+    for (char* field = strtok(copy, "\t"); field; field = strtok(NULL, "\t")) {
+        char* equals = strchr(field, '=');
+        *equals = '\0';
+        assignments.names[assignments.count] = field;
+        assignments.values[assignments.count++] = equals + 1;
+    }
+
+    ValidationErrors* errors = create_validation_errors();
+    int result = validate_config_lookup(config, lookup_assignment, &assignments, false, errors, NULL);
+    size_t len = 0;
+    for (int i = 0; i < errors->count; i++) {
+        // Type errors end in a newline the generated messages leave out
+        len += (size_t)snprintf(out + len, size - len, "%s:%d:%.*s\t", errors->errors[i].name,
+                                errors->errors[i].error_code, (int)strcspn(errors->errors[i].message, "\n"),
+                                errors->errors[i].message);
+    }
+    snprintf(out + len, size - len, "%d", result);
+    free_validation_errors(errors);
+    free(copy);
+}
+
+static const char driver[] =
+    "#include <stdio.h>\n"
+    "#include <string.h>\n"
+    "#include \"env_gen.h\"\n"
+    "static char* names[16];\n"
+    "static char* values[16];\n"
+    "static int count;\n"
+    "static const char* lookup(const char* name, void* data) {\n"
+    "    (void)data;\n"
+    "    for (int i = 0; i < count; i++) if (strcmp(names[i], name) == 0) return values[i];\n"
+    "    return NULL;\n"
+    "}\n"
+    "static void on_error(const char* name, const char* message, int code, void* data) {\n"
+    "    (void)data;\n"
+    "    printf(\"%s:%d:%s\\t\", name, code, message);\n"
+    "}\n"
+    "int main(int argc, char** argv) {\n"
+    "    FILE* file = fopen(argv[argc - 1], \"r\");\n"
+    "    char line[4096];\n"
+    "    while (file && fgets(line, sizeof(line), file)) {\n"
+    "        line[strcspn(line, \"\\n\")] = '\\0';\n"
+    "        count = 0;\n"
+    "        for (char* field = strtok(line, \"\\t\"); field; field = strtok(NULL, \"\\t\")) {\n"
+    "            char* equals = strchr(field, '=');\n"
+    "            *equals = '\\0';\n"
+    "            names[count] = field;\n"
+    "            values[count++] = equals + 1;\n"
+    "        }\n"
+    "        EnvGen env;\n"
+    "        int result = env_gen_load(&env, lookup, NULL, on_error, NULL);\n"
+    "        printf(\"%d\", result);\n"
+    "        if (result == 0) printf(\" %lld %s %lld %lld %.17g %lld %s\", (long long)env.port, env.level,\n"
+    "                                (long long)env.timeout, (long long)env.size, env.ratio, (long long)env.delay, env.name);\n"
+    "        printf(\"\\n\");\n"
+    "    }\n"
+    "    return 0;\n"
+    "}\n";
+
+void test_generated_validator() {
+    printf("Testing the generated validator against envil...\n");
+
+    char config_path[] = "/tmp/envil_codegen_XXXXXX.yml";
+    write_temp_file(config_path,
+        "PORT:\n  default: \"8080\"\n  checks:\n    type: integer\n    gt: 1024\n    le: 65535\n"
+        "LEVEL:\n  default: info\n  checks:\n    enum: debug,info,warn,error\n"
+        "TIMEOUT:\n  default: 30s\n  checks:\n    type: duration\n    ge: 100ms\n    le: 5m\n"
+        "SIZE:\n  default: 64Mi\n  checks:\n    type: bytesize\n    lt: 1GiB\n"
+        "RATIO:\n  default: \"0.5\"\n  checks:\n    type: float\n    ge: 0\n    lt: 1.5\n"
+        "LIMIT:\n  default: \"10\"\n  checks:\n    gt: -2.5\n    le: 9223372036854775807\n"
+        "DELAY:\n  default: 1s\n  checks:\n    type: duration\n    lt: 2s\n"
+        "NAME:\n  checks:\n    regex: ^[a-z][a-z0-9-]*$\n    lengt: 2\n    lenlt: 16\n    ne: admin\n"
+        "MODE:\n  default: fast\n  checks:\n    eq: fast\n"
+        "TOKEN:\n  default: abcd\n  checks:\n    len: 4\n    regex: \"[[:xdigit:]]{2}|x$\"\n");
+    Config* config = load_config(config_path);
+    assert(config != NULL);
+
+    char dir[] = "/tmp/envil_codegen_XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    char path[256], command[1024];
+    snprintf(path, sizeof(path), "%s/env_gen.c", dir);
+    assert(generate_code(config, config_path, path) == ENVIL_OK);
+
+    snprintf(path, sizeof(path), "%s/driver.c", dir);
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(driver, file);
+    fclose(file);
+    snprintf(path, sizeof(path), "%s/cases", dir);
+    file = fopen(path, "w");
+    assert(file != NULL);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) fprintf(file, "%s\n", cases[i]);
+    fclose(file);
+
+    // Compiled on its own: no envil headers or libraries
+    snprintf(command, sizeof(command), "cc -std=c99 -pedantic -Wall -Wextra -Werror -o %s/driver %s/driver.c %s/env_gen.c",
+             dir, dir, dir);
+    assert(system(command) == 0);
+    snprintf(command, sizeof(command), "%s/driver %s/cases", dir, dir);
+    FILE* output = popen(command, "r");
+    assert(output != NULL);
+
+    char line[4096], expected[4096];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        assert(fgets(line, sizeof(line), output) != NULL);
+        line[strcspn(line, "\n")] = '\0';
+        expected_output(config, cases[i], expected, sizeof(expected));
+        // A passing run is followed by the typed fields
+        if (strcmp(expected, "0") == 0) {
+            assert(strncmp(line, "0 ", 2) == 0);
+        } else if (strcmp(line, expected) != 0) {
+            fprintf(stderr, "Case '%s': generated '%s', envil '%s'\n", cases[i], line, expected);
+            assert(0);
+        }
+        if (i == 1) assert(strcmp(line, "0 8080 info 30000000000 67108864 0.5 1000000000 web-1") == 0);
+        if (i == 13) assert(strcmp(line, "0 8080 info 90000000000 512000000 0.5 1000000000 web") == 0);
+    }
+    assert(fgets(line, sizeof(line), output) == NULL);
+    pclose(output);
+
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    assert(system(command) == 0);
+    free_config(config);
+    unlink(config_path);
+    printf("Generated validator tests passed!\n");
+}
+
+void test_unsupported_configs() {
+    printf("Testing configs codegen rejects...\n");
+
+    const char* yamls[] = {
+        "A:\n  checks:\n    cmd: \"true\"\n",
+        "A:\n  checks:\n    type: json\n",
+        "A:\n  checks:\n    regex: (a)\\1\n",
+        "\"A_*\":\n  checks:\n    len: 1\n",
+    };
+    char dir[] = "/tmp/envil_codegen_XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/out.c", dir);
+    for (size_t i = 0; i < sizeof(yamls) / sizeof(yamls[0]); i++) {
+        char config_path[] = "/tmp/envil_codegen_XXXXXX.yml";
+    write_temp_file(config_path,yamls[i]);
+        Config* config = load_config(config_path);
+        assert(config != NULL);
+        assert(generate_code(config, config_path, path) == ENVIL_CONFIG_ERROR);
+        // Nothing is written on an error
+        assert(access(path, F_OK) != 0);
+        free_config(config);
+        unlink(config_path);
+    }
+    rmdir(dir);
+    printf("Unsupported config tests passed!\n");
+}
+
+int main() {
+    printf("Running codegen tests...\n\n");
+
+    test_dfa_matches_regexec();
+    test_generated_validator();
+    test_unsupported_configs();
+
+    printf("\nAll codegen tests passed!\n");
+    return 0;
+}
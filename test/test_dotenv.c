@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "dotenv.h"
+#include "test_util.h"
+
+void test_load_env_file() {
+    printf("Testing load_env_file...\n");
+
+    char path[] = "/tmp/envil_test_dotenvXXXXXX";
+    write_temp_file(path,
+        "# comment line\n"
+        "\n"
+        "PORT=8080\n"
+        "export HOST=localhost\n"
+        "NAME = \"hello world\"\n"
+        "QUOTED='single # not a comment'\n"
+        "ESCAPED=\"a\\nb\"\n"
+        "INLINE=value # trailing comment\n"
+        "EMPTY=\n"
+        "PORT=9090\n"
+        "not a valid line\n");
+
+    EnvFile* file = load_env_file(path);
+    assert(file != NULL);
+    assert(strcmp(env_file_get(file, "PORT"), "9090") == 0);  // Later definition wins
+    assert(strcmp(env_file_get(file, "HOST"), "localhost") == 0);
+    assert(strcmp(env_file_get(file, "NAME"), "hello world") == 0);
+    assert(strcmp(env_file_get(file, "QUOTED"), "single # not a comment") == 0);
+    assert(strcmp(env_file_get(file, "ESCAPED"), "a\nb") == 0);
+    assert(strcmp(env_file_get(file, "INLINE"), "value") == 0);
+    assert(strcmp(env_file_get(file, "EMPTY"), "") == 0);
+    assert(env_file_get(file, "MISSING") == NULL);
+    assert(file->count == 7);
+
+    free_env_file(file);
+    unlink(path);
+
+    assert(load_env_file("/nonexistent/envil.env") == NULL);
+
+    printf("load_env_file tests passed!\n");
+}
+
+int main() {
+    printf("Running dotenv tests...\n\n");
+
+    test_load_env_file();
+
+    printf("\nAll dotenv tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "envil.h"
+#include "test_util.h"
+
+typedef struct {
+    const char** names;
+    const char** values;
+    int count;
+} FakeEnv;
+
+typedef struct {
+    int count;
+    char last_name[64];
+    int last_code;
+} Failures;
+
+static const char* lookup_fake(const char* name, void* user_data) {
+    const FakeEnv* env = user_data;
+    for (int i = 0; i < env->count; i++) {
+        if (strcmp(env->names[i], name) == 0) return env->values[i];
+    }
+    return NULL;
+}
+
+static void collect_failure(const char* name, const char* message, int error_code, void* user_data) {
+    Failures* failures = user_data;
+    failures->count++;
+    snprintf(failures->last_name, sizeof(failures->last_name), "%s", name);
+    failures->last_code = error_code;
+    size_t len = strlen(message);
+    assert(len == 0 || message[len - 1] != '\n');
+}
+
+static void count_log(int level, const char* message, void* user_data) {
+    (void)level;
+    (void)message;
+    (*(int*)user_data)++;
+}
+
+static int check_even(const char* value, const void* argument) {
+    (void)argument;
+    size_t len = strlen(value);
+    return len > 0 && (value[len - 1] - '0') % 2 == 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+static int check_prefix(const char* value, const void* argument) {
+    const char* prefix = argument;
+    return strncmp(value, prefix, strlen(prefix)) == 0 ? ENVIL_OK : ENVIL_VALUE_ERROR;
+}
+
+void test_plan_validate() {
+    printf("Testing plan load and validate...\n");
+
+    char path[] = "/tmp/envil_lib_XXXXXX.yml";
+    write_temp_file(path,
+        "PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "    gt: 1024\n"
+        "MODE:\n"
+        "  default: dev\n"
+        "  checks:\n"
+        "    enum: dev,prod\n");
+
+    EnvilContext* ctx = envil_context_new();
+    assert(ctx != NULL);
+    EnvilPlan* plan = envil_plan_load(ctx, path);
+    assert(plan != NULL);
+
+    const char* names[] = {"PORT", "MODE"};
+    const char* good[] = {"8080", "prod"};
+    FakeEnv env = {names, good, 2};
+    Failures failures = {0};
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_OK);
+    assert(failures.count == 0);
+
+    // Unset MODE falls back to its default
+    env.count = 1;
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_OK);
+
+    const char* bad[] = {"80", "test"};
+    env.values = bad;
+    env.count = 2;
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_VALUE_ERROR);
+    assert(failures.count == 2);
+    assert(strcmp(failures.last_name, "MODE") == 0);
+
+    // Missing required variable
+    memset(&failures, 0, sizeof(failures));
+    env.count = 0;
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_MISSING_VAR);
+    assert(failures.count == 1);
+    assert(strcmp(failures.last_name, "PORT") == 0);
+
+    envil_plan_free(plan);
+
+    // Errors are reported through the context's log, not g_log_level
+    int log_count = 0;
+    envil_context_set_log(ctx, ENVIL_LOG_ERROR, count_log, &log_count);
+    assert(envil_plan_load(ctx, "/nonexistent/envil.yml") == NULL);
+    assert(log_count > 0);
+
+    envil_context_free(ctx);
+    unlink(path);
+
+    printf("Plan load and validate tests passed!\n");
+}
+
+void test_custom_checks() {
+    printf("Testing context check registration...\n");
+
+    char path[] = "/tmp/envil_lib_XXXXXX.json";
+    write_temp_file(path, "{\"ID\": {\"checks\": {\"even\": \"yes\", \"prefix\": \"4\"}}}");
+
+    // Checks are per context: another context reports them as unknown
+    EnvilContext* plain = envil_context_new();
+    int log_count = 0;
+    envil_context_set_log(plain, ENVIL_LOG_ERROR, count_log, &log_count);
+    EnvilPlan* plan = envil_plan_load(plain, path);
+    assert(plan != NULL);
+    assert(log_count == 2);
+    envil_plan_free(plan);
+    envil_context_free(plain);
+
+    EnvilContext* ctx = envil_context_new();
+    assert(envil_context_register_check(ctx, "even", "Last digit is even", check_even, 1) == ENVIL_OK);
+    assert(envil_context_register_check(ctx, "prefix", "Starts with", check_prefix, 1) == ENVIL_OK);
+    assert(envil_context_register_check(ctx, "even", "Duplicate", check_even, 1) == ENVIL_CONFIG_ERROR);
+    assert(envil_context_register_check(ctx, "gt", "Shadows a built-in", check_even, 1) == ENVIL_CONFIG_ERROR);
+
+    plan = envil_plan_load(ctx, path);
+    assert(plan != NULL);
+
+    const char* names[] = {"ID"};
+    const char* values[] = {"42"};
+    FakeEnv env = {names, values, 1};
+    assert(envil_validate(plan, lookup_fake, &env, NULL, NULL) == ENVIL_OK);
+    values[0] = "43";
+    assert(envil_validate(plan, lookup_fake, &env, NULL, NULL) == ENVIL_VALUE_ERROR);
+    values[0] = "52";
+    assert(envil_validate(plan, lookup_fake, &env, NULL, NULL) == ENVIL_VALUE_ERROR);
+
+    envil_plan_free(plan);
+    envil_context_free(ctx);
+    unlink(path);
+
+    printf("Context check registration tests passed!\n");
+}
+
+typedef struct {
+    const EnvilPlan* plan;
+    const char* value;
+    int expected;
+    int mismatches;
+} ThreadJob;
+
+static void* validate_repeatedly(void* arg) {
+    ThreadJob* job = arg;
+    const char* names[] = {"LEVEL"};
+    const char* values[] = {job->value};
+    FakeEnv env = {names, values, 1};
+    for (int i = 0; i < 2000; i++) {
+        if (envil_validate(job->plan, lookup_fake, &env, NULL, NULL) != job->expected) {
+            job->mismatches++;
+        }
+    }
+    return NULL;
+}
+
+void test_shared_plan() {
+    printf("Testing one plan shared across threads...\n");
+
+    char path[] = "/tmp/envil_lib_XXXXXX.yml";
+    write_temp_file(path,
+        "LEVEL:\n"
+        "  checks:\n"
+        "    type: float\n"
+        "    ge: 0.5\n"
+        "    regex: ^[0-9.e]+$\n");
+
+    EnvilContext* ctx = envil_context_new();
+    envil_context_set_log(ctx, ENVIL_LOG_NONE, NULL, NULL);
+    EnvilPlan* plan = envil_plan_load(ctx, path);
+    assert(plan != NULL);
+
+    pthread_t threads[4];
+    ThreadJob jobs[4] = {
+        {plan, "0.75", ENVIL_OK, 0},
+        {plan, "-0.25", ENVIL_VALUE_ERROR, 0},
+        {plan, "abc", ENVIL_TYPE_ERROR, 0},
+        {plan, "1e3", ENVIL_OK, 0},
+    };
+    for (int i = 0; i < 4; i++) {
+        assert(pthread_create(&threads[i], NULL, validate_repeatedly, &jobs[i]) == 0);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        assert(jobs[i].mismatches == 0);
+    }
+
+    envil_plan_free(plan);
+    envil_context_free(ctx);
+    unlink(path);
+
+    printf("Shared plan tests passed!\n");
+}
+
+void test_expr_checks() {
+    printf("Testing expr checks across variables...\n");
+
+    char path[] = "/tmp/envil_lib_XXXXXX.yml";
+    write_temp_file(path,
+        "MIN_POOL:\n"
+        "  checks:\n"
+        "    expr: value <= MAX_POOL\n"
+        "MAX_POOL:\n"
+        "  default: 20\n"
+        "  checks:\n"
+        "    type: integer\n");
+
+    EnvilContext* ctx = envil_context_new();
+    envil_context_set_log(ctx, ENVIL_LOG_NONE, NULL, NULL);
+    EnvilPlan* plan = envil_plan_load(ctx, path);
+    assert(plan != NULL);
+
+    // MAX_POOL is read through the plan's lookup, default included
+    const char* names[] = {"MIN_POOL", "MAX_POOL"};
+    const char* values[] = {"5", "4"};
+    FakeEnv env = {names, values, 1};
+    Failures failures = {0};
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_OK);
+    env.count = 2;
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_VALUE_ERROR);
+    assert(failures.count == 1);
+    assert(strcmp(failures.last_name, "MIN_POOL") == 0);
+
+    // MAX_POOL is validated first; once it fails, the expression is not reported too
+    memset(&failures, 0, sizeof(failures));
+    values[1] = "many";
+    assert(envil_validate(plan, lookup_fake, &env, collect_failure, &failures) == ENVIL_TYPE_ERROR);
+    assert(failures.count == 1);
+    assert(strcmp(failures.last_name, "MAX_POOL") == 0);
+
+    envil_plan_free(plan);
+    envil_context_free(ctx);
+    unlink(path);
+
+    printf("Expr check tests passed!\n");
+}
+
+int main() {
+    printf("Running libenvil tests...\n\n");
+
+    test_plan_validate();
+    test_custom_checks();
+    test_shared_plan();
+    test_expr_checks();
+
+    printf("\nAll libenvil tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include "manifest.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+static FILE* open_text(const char* content) {
+    FILE* file = tmpfile();
+    assert(file != NULL);
+    fputs(content, file);
+    rewind(file);
+    return file;
+}
+
+static const ManifestVar* find_var(const ManifestContainer* container, const char* name) {
+    for (int i = 0; i < container->var_count; i++) {
+        if (strcmp(container->vars[i].name, name) == 0) return &container->vars[i];
+    }
+    return NULL;
+}
+
+void test_parse_kubernetes() {
+    printf("Testing Kubernetes manifest parsing...\n");
+
+    FILE* file = open_text(
+        "apiVersion: apps/v1\n"
+        "kind: Deployment\n"
+        "metadata:\n"
+        "  name: api\n"
+        "spec:\n"
+        "  template:\n"
+        "    spec:\n"
+        "      initContainers:\n"
+        "        - name: migrate\n"
+        "          env:\n"
+        "            - name: PORT\n"
+        "              value: \"8080\"\n"
+        "      containers:\n"
+        "        - name: web\n"
+        "          envFrom:\n"
+        "            - configMapRef: {name: shared}\n"
+        "          env:\n"
+        "            - name: PORT\n"
+        "              value: \"80\"\n"
+        "            - name: SECRET\n"
+        "              valueFrom:\n"
+        "                secretKeyRef: {name: s, key: k}\n"
+        "            - name: EMPTY\n"
+        "---\n"
+        "kind: Pod\n"
+        "metadata: {name: solo}\n"
+        "spec:\n"
+        "  containers: [{name: sidecar, env: [{name: MODE, value: prod}]}]\n");
+
+    ManifestFile manifest = {0};
+    char error[256];
+    assert(parse_manifest(file, &manifest, error, sizeof(error)) == ENVIL_OK);
+    fclose(file);
+    assert(manifest.count == 3);
+
+    const ManifestContainer* migrate = &manifest.containers[0];
+    assert(strcmp(migrate->resource, "Deployment/api") == 0);
+    assert(strcmp(migrate->container, "migrate") == 0);
+    assert(migrate->line == 9);
+    assert(!migrate->open_env);
+    assert(strcmp(find_var(migrate, "PORT")->value, "8080") == 0);
+
+    const ManifestContainer* web = &manifest.containers[1];
+    assert(strcmp(web->container, "web") == 0);
+    assert(web->open_env);
+    assert(web->var_count == 3);
+    assert(strcmp(find_var(web, "PORT")->value, "80") == 0);
+    assert(find_var(web, "SECRET")->value == NULL);
+    assert(strcmp(find_var(web, "EMPTY")->value, "") == 0);
+
+    const ManifestContainer* sidecar = &manifest.containers[2];
+    assert(strcmp(sidecar->resource, "Pod/solo") == 0);
+    assert(strcmp(find_var(sidecar, "MODE")->value, "prod") == 0);
+
+    free_manifest(&manifest);
+
+    // A broken file reports its line
+    file = open_text("kind: Pod\nspec: [\n");
+    assert(parse_manifest(file, &manifest, error, sizeof(error)) == ENVIL_CONFIG_ERROR);
+    assert(strncmp(error, "line ", 5) == 0);
+    fclose(file);
+    free_manifest(&manifest);
+
+    printf("Kubernetes manifest parsing tests passed!\n");
+}
+
+void test_parse_compose() {
+    printf("Testing compose file parsing...\n");
+
+    FILE* file = open_text(
+        "services:\n"
+        "  web:\n"
+        "    image: web\n"
+        "    environment:\n"
+        "      PORT: 8080\n"
+        "      HOST:\n"
+        "      URL: http://${HOST}/\n"
+        "      PRICE: $$5\n"
+        "  worker:\n"
+        "    env_file: .env\n"
+        "    environment:\n"
+        "      - MODE=prod\n"
+        "      - TOKEN\n");
+
+    ManifestFile manifest = {0};
+    char error[256];
+    assert(parse_manifest(file, &manifest, error, sizeof(error)) == ENVIL_OK);
+    fclose(file);
+    assert(manifest.count == 2);
+
+    const ManifestContainer* web = &manifest.containers[0];
+    assert(web->resource == NULL);
+    assert(strcmp(web->container, "web") == 0);
+    assert(!web->open_env);
+    assert(strcmp(find_var(web, "PORT")->value, "8080") == 0);
+    assert(find_var(web, "HOST")->value == NULL);
+    assert(find_var(web, "URL")->value == NULL);
+    assert(strcmp(find_var(web, "PRICE")->value, "$5") == 0);
+
+    const ManifestContainer* worker = &manifest.containers[1];
+    assert(worker->open_env);
+    assert(strcmp(find_var(worker, "MODE")->value, "prod") == 0);
+    assert(find_var(worker, "TOKEN")->value == NULL);
+
+    free_manifest(&manifest);
+    printf("Compose file parsing tests passed!\n");
+}
+
+void test_validate_manifests() {
+    printf("Testing manifest directory validation...\n");
+
+    char dir[] = "/tmp/envil_manifests_XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    char config_path[64], deploy_path[64], compose_path[64], note_path[64];
+    snprintf(config_path, sizeof(config_path), "%s.yml", dir);  // Beside the directory, not in it
+    snprintf(deploy_path, sizeof(deploy_path), "%s/deploy.yaml", dir);
+    snprintf(compose_path, sizeof(compose_path), "%s/compose.yml", dir);
+    snprintf(note_path, sizeof(note_path), "%s/notes.txt", dir);
+
+    write_file(config_path,
+        "PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "    gt: 1024\n"
+        "MODE:\n"
+        "  default: dev\n"
+        "  checks:\n"
+        "    enum: dev,prod\n");
+    write_file(deploy_path,
+        "kind: Deployment\n"
+        "metadata: {name: api}\n"
+        "spec:\n"
+        "  template:\n"
+        "    spec:\n"
+        "      containers:\n"
+        "        - name: web\n"
+        "          env: [{name: PORT, value: \"80\"}]\n"
+        "        - name: sidecar\n"
+        "          env: [{name: PORT, valueFrom: {fieldRef: {fieldPath: x}}}]\n");
+    write_file(compose_path,
+        "services:\n"
+        "  worker:\n"
+        "    environment: [PORT=8080, MODE=prod]\n");
+    write_file(note_path, "not: [a manifest\n");
+
+    Config* config = load_config(config_path);
+    assert(config != NULL);
+
+    char* report = NULL;
+    size_t report_size = 0;
+    FILE* out = open_memstream(&report, &report_size);
+    assert(out != NULL);
+    assert(validate_manifests(config, dir, 0, out) == ENVIL_VALUE_ERROR);
+    fclose(out);
+
+    // Files come in path order; notes.txt is not a manifest
+    const char* compose_line = strstr(report, "compose.yml:2: service worker: ok\n");
+    const char* web_line = strstr(report, "deploy.yaml:7: Deployment/api, container web: failed\n  Error PORT: ");
+    assert(compose_line != NULL);
+    assert(web_line != NULL);
+    assert(compose_line < web_line);
+    assert(strstr(report, "deploy.yaml:9: Deployment/api, container sidecar: ok\n") != NULL);
+    assert(strstr(report, "-- 3 containers in 2 files, 1 failing\n") != NULL);
+    free(report);
+
+    // A single file is read whatever its name
+    out = fopen("/dev/null", "w");
+    assert(validate_manifests(config, compose_path, 0, out) == ENVIL_OK);
+    assert(validate_manifests(config, note_path, 0, out) == ENVIL_CONFIG_ERROR);
+    fclose(out);
+
+    free_config(config);
+    unlink(config_path);
+    unlink(deploy_path);
+    unlink(compose_path);
+    unlink(note_path);
+    rmdir(dir);
+    printf("Manifest directory validation tests passed!\n");
+}
+
+int main() {
+    printf("Running manifest tests...\n\n");
+
+    test_parse_kubernetes();
+    test_parse_compose();
+    test_validate_manifests();
+
+    printf("\nAll manifest tests passed!\n");
+    return 0;
+}
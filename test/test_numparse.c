@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include "numparse.h"
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+// xorshift64*, deterministic so failures reproduce
+static uint64_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+// Checks parse_double against strtod on one input, bit for bit
+static void assert_same_as_strtod(const char* str) {
+    char* endptr;
+    double expected = strtod(str, &endptr);
+    bool expected_ok = endptr != str && *endptr == '\0';
+
+    double actual;
+    bool actual_ok = parse_double(str, strlen(str), &actual);
+    if (actual_ok != expected_ok ||
+        (actual_ok && memcmp(&actual, &expected, sizeof(double)) != 0 &&
+         !(isnan(actual) && isnan(expected)))) {
+        fprintf(stderr, "Mismatch on \"%s\": %.17g vs strtod %.17g\n", str, actual, expected);
+        assert(0);
+    }
+}
+
+void test_parse_int64() {
+    printf("Testing int64 parsing...\n");
+
+    int64_t value;
+    assert(parse_int64("0", 1, &value) && value == 0);
+    assert(parse_int64("-0", 2, &value) && value == 0);
+    assert(parse_int64("007", 3, &value) && value == 7);
+    assert(parse_int64("123456789012", 12, &value) && value == 123456789012LL);
+    assert(parse_int64("9223372036854775807", 19, &value) && value == INT64_MAX);
+    assert(parse_int64("-9223372036854775808", 20, &value) && value == INT64_MIN);
+    assert(parse_int64("0000000000000000000000042", 25, &value) && value == 42);
+
+    assert(!parse_int64("9223372036854775808", 19, &value));
+    assert(!parse_int64("-9223372036854775809", 20, &value));
+    assert(!parse_int64("99999999999999999999", 20, &value));
+    assert(!parse_int64("", 0, &value));
+    assert(!parse_int64("-", 1, &value));
+    assert(!parse_int64("+1", 2, &value));
+    assert(!parse_int64(" 1", 2, &value));
+    assert(!parse_int64("1.0", 3, &value));
+    assert(!parse_int64("12345678x", 9, &value));
+    assert(!parse_int64("1234567:", 8, &value));
+    assert(!parse_int64("12345/78", 8, &value));
+
+    // Length bounds the parse, the text need not be NUL-terminated
+    assert(parse_int64("123abc", 3, &value) && value == 123);
+
+    // Differential against strtoll over random digit strings
+    char buf[32];
+    for (int i = 0; i < 200000; i++) {
+        int digits = 1 + (int)(next_random() % 21);
+        int n = 0;
+        if (next_random() & 1) buf[n++] = '-';
+        for (int d = 0; d < digits; d++) buf[n++] = (char)('0' + next_random() % 10);
+        buf[n] = '\0';
+
+        errno = 0;
+        char* endptr;
+        long long expected = strtoll(buf, &endptr, 10);
+        bool expected_ok = errno == 0 && *endptr == '\0';
+        bool actual_ok = parse_int64(buf, (size_t)n, &value);
+        assert(actual_ok == expected_ok);
+        if (actual_ok) assert(value == expected);
+    }
+
+    printf("Int64 parsing tests passed!\n");
+}
+
+void test_parse_double_cases() {
+    printf("Testing double parsing edge cases...\n");
+
+    const char* cases[] = {
+        "0", "-0", "0.0", "1", "1.", ".5", "-.5", "+1.5", "1e10", "1E-10", "1e+10",
+        "123.456", "0.1", "0.3", "3.14159265358979323846264338327950288",
+        "9007199254740992", "9007199254740993", "9007199254740993.0", "9007199254740995",
+        "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "4.9406564584124654e-324",
+        "2.4703282292062327e-324", "2.4703282292062328e-324", "1e-400", "1e400", "-1e400",
+        "1e-324", "1e23", "8.589973e9", "7.3177701707893310e+15",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "0.1000000000000000055511151231257827021181583404541015624",
+        "0.1000000000000000055511151231257827021181583404541015626",
+        "179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497791.9999999999999999999999999999999999999999999999999999999999999999999999",
+        "0.000000000000000000000000000000000000000000001e45",
+        "1000000000000000000000000000000000000000e-40", "00000000000000000000001.5",
+        "1e2147483648", "1e-2147483649", "0e999999999", "1e999999999999999999",
+        "inf", "-Inf", "INFINITY", "nan", "-NaN",
+        "", "-", "+", ".", "e5", "1e", "1e+", "1.5.5", "1x", " 1", "1 ", "0x10", "in", "nanx",
+        "infinit", "--1", "1e5.5",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (strcmp(cases[i], "0x10") == 0 || strcmp(cases[i], " 1") == 0) {
+            // strtod accepts these, the parser deliberately does not
+            double value;
+            assert(!parse_double(cases[i], strlen(cases[i]), &value));
+            continue;
+        }
+        assert_same_as_strtod(cases[i]);
+    }
+
+    printf("Double parsing edge case tests passed!\n");
+}
+
+void test_parse_double_fuzz() {
+    printf("Fuzzing double parsing against strtod...\n");
+
+    char buf[128];
+
+    // Random decimal strings: short and long mantissas, wide exponents
+    for (int i = 0; i < 500000; i++) {
+        int n = 0;
+        uint64_t r = next_random();
+        if (r & 1) buf[n++] = '-';
+        int int_digits = (int)((r >> 1) % 24);
+        int frac_digits = (int)((r >> 6) % 24);
+        for (int d = 0; d < int_digits; d++) buf[n++] = (char)('0' + next_random() % 10);
+        if ((r >> 11) & 1 || int_digits == 0) {
+            buf[n++] = '.';
+            if (int_digits == 0 && frac_digits == 0) frac_digits = 1;
+            for (int d = 0; d < frac_digits; d++) buf[n++] = (char)('0' + next_random() % 10);
+        }
+        if ((r >> 12) & 1) {
+            n += snprintf(buf + n, sizeof(buf) - (size_t)n, "e%d", (int)(next_random() % 700) - 350);
+        }
+        buf[n] = '\0';
+        assert_same_as_strtod(buf);
+    }
+
+    // Shortest and longer printings of random doubles, including subnormals
+    for (int i = 0; i < 200000; i++) {
+        uint64_t bits = next_random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (isnan(value) || isinf(value)) continue;
+        snprintf(buf, sizeof(buf), "%.*g", 1 + (int)(next_random() % 25), value);
+        assert_same_as_strtod(buf);
+    }
+
+    // Halfway points between neighbouring doubles, printed exactly enough to
+    // exercise round-to-even and the slow path
+    for (int i = 0; i < 100000; i++) {
+        uint64_t bits = next_random() >> 2;
+        double low, high;
+        memcpy(&low, &bits, sizeof(low));
+        high = nextafter(low, INFINITY);
+        if (isinf(high) || isnan(low)) continue;
+        long double midpoint = ((long double)low + (long double)high) / 2;
+        snprintf(buf, sizeof(buf), "%.40Le", midpoint);
+        assert_same_as_strtod(buf);
+    }
+
+    printf("Double parsing fuzz tests passed!\n");
+}
+
+int main() {
+    printf("Running numparse tests...\n\n");
+
+    test_parse_int64();
+    test_parse_double_cases();
+    test_parse_double_fuzz();
+
+    printf("\nAll numparse tests passed!\n");
+    return 0;
+}
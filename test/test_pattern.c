@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include "pattern.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+static int match(const PatternSet* set, const char* name, int* matches) {
+    return match_patterns(set, name, strlen(name), matches);
+}
+
+void test_match_patterns() {
+    printf("Testing pattern matching...\n");
+
+    const char* patterns[] = {"FEATURE_*", "QUEUE_*_URL", "SVC_?_PORT", "*_DEBUG", "FEATURE_X*"};
+    PatternSet* set = compile_patterns(patterns, 5);
+    assert(set != NULL);
+    int matches[5];
+
+    assert(is_pattern("FEATURE_*"));
+    assert(!is_pattern("FEATURE"));
+
+    assert(match(set, "FEATURE_A", matches) == 1 && matches[0] == 0);
+    assert(match(set, "FEATURE_", matches) == 1);
+    assert(match(set, "FEATURE", matches) == 0);
+    assert(match(set, "QUEUE_ORDERS_URL", matches) == 1 && matches[0] == 1);
+    assert(match(set, "QUEUE_A_URL_URL", matches) == 1);
+    assert(match(set, "QUEUE_URL", matches) == 0);
+    assert(match(set, "SVC_A_PORT", matches) == 1 && matches[0] == 2);
+    assert(match(set, "SVC_AB_PORT", matches) == 0);
+    assert(match(set, "PATH", matches) == 0);
+
+    // Every matching pattern, in config order
+    assert(match(set, "FEATURE_X_DEBUG", matches) == 3);
+    assert(matches[0] == 0 && matches[1] == 3 && matches[2] == 4);
+
+    // Only the name before = is matched
+    assert(match_patterns(set, "FEATURE_A=1", strlen("FEATURE_A"), matches) == 1);
+
+    free_patterns(set);
+    printf("Pattern matching tests passed!\n");
+}
+
+void test_config_patterns() {
+    printf("Testing pattern keys in a config...\n");
+
+    char config_path[] = "/tmp/envil_pattern_XXXXXX.yml";
+    write_temp_file(config_path,
+        "\"ENVIL_PAT_FLAG_*\":\n"
+        "  checks:\n"
+        "    enum: on,off\n"
+        "ENVIL_PAT_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n");
+
+    setenv("ENVIL_PAT_PORT", "8080", 1);
+    setenv("ENVIL_PAT_FLAG_A", "on", 1);
+    setenv("ENVIL_PAT_FLAG_B", "off", 1);
+    Config* config = load_config(config_path);
+    assert(config != NULL);
+    assert(config->variable_count == 1);
+    assert(config->pattern_count == 1);
+
+    ValidationErrors* errors = create_validation_errors();
+    assert(validate_config(config, false, errors) == ENVIL_OK);
+    free_validation_errors(errors);
+
+    // A failing member is reported under its own name
+    setenv("ENVIL_PAT_FLAG_B", "maybe", 1);
+    errors = create_validation_errors();
+    assert(validate_config(config, false, errors) == ENVIL_VALUE_ERROR);
+    assert(errors->count == 1);
+    assert(strcmp(errors->errors[0].name, "ENVIL_PAT_FLAG_B") == 0);
+    free_validation_errors(errors);
+    free_config(config);
+
+    // A pattern has no single value to default
+    FILE* file = fopen(config_path, "w");
+    assert(file != NULL);
+    fputs("\"ENVIL_PAT_*\":\n  default: x\n", file);
+    fclose(file);
+    assert(load_config(config_path) == NULL);
+
+    unsetenv("ENVIL_PAT_PORT");
+    unsetenv("ENVIL_PAT_FLAG_A");
+    unsetenv("ENVIL_PAT_FLAG_B");
+    unlink(config_path);
+    printf("Config pattern tests passed!\n");
+}
+
+int main() {
+    printf("Running pattern tests...\n\n");
+
+    test_match_patterns();
+    test_config_patterns();
+
+    printf("\nAll pattern tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "plugin.h"
+#include "config.h"
+#include "checks.h"
+#include "validator.h"
+
+// Built by make plugins, which make test runs first
+#define LUHN_PLUGIN "bin/plugins/luhn.so"
+
+static void free_registry(CheckRegistry* registry) {
+    forget_plugins(registry);
+    for (int i = 0; i < registry->count; i++) {
+        free((char*)registry->definitions[i].name);
+        free((char*)registry->definitions[i].description);
+        free(registry->definitions[i].custom_data);
+    }
+    registry->count = 0;
+}
+
+void test_load_plugin() {
+    printf("Testing plugin loading...\n");
+
+    CheckRegistry registry;
+    init_check_registry(&registry);
+    assert(load_plugin(&registry, LUHN_PLUGIN) == ENVIL_OK);
+    assert(registry.count == 1);
+
+    const CheckDefinition* luhn = registry_find_check(&registry, "luhn");
+    assert(luhn != NULL);
+    assert(luhn->cost == 40);
+    assert(((const CheckHooks*)luhn->custom_data)->pure);
+
+    // Loading it again, as a reloaded config does, registers nothing twice
+    assert(load_plugin(&registry, LUHN_PLUGIN) == ENVIL_OK);
+    assert(registry.count == 1);
+
+    assert(load_plugin(&registry, "bin/plugins/missing.so") == ENVIL_CONFIG_ERROR);
+    assert(registry.count == 1);
+
+    free_registry(&registry);
+    printf("Plugin loading tests passed!\n");
+}
+
+void test_plugin_arguments() {
+    printf("Testing plugin argument hooks...\n");
+
+    CheckRegistry registry;
+    init_check_registry(&registry);
+    assert(load_plugin(&registry, LUHN_PLUGIN) == ENVIL_OK);
+
+    // The argument is parsed once, by the plugin, and freed by it
+    Check check;
+    EnvType type = TYPE_STRING;
+    assert(process_registry_check(&registry, "luhn", "16", &check, &type));
+    assert(*(const size_t*)check.value.custom_value == 16);
+    assert(validate_check(&check, "4539578763621486") == ENVIL_OK);
+    assert(validate_check(&check, "4539578763621487") == ENVIL_VALUE_ERROR);
+    assert(validate_check(&check, "79927398713") == ENVIL_VALUE_ERROR);
+    free_check_value(&check);
+
+    assert(process_registry_check(&registry, "luhn", "any", &check, &type));
+    assert(validate_check(&check, "79927398713") == ENVIL_OK);
+    free_check_value(&check);
+
+    assert(!process_registry_check(&registry, "luhn", "sixteen", &check, &type));
+
+    free_registry(&registry);
+    printf("Plugin argument tests passed!\n");
+}
+
+int main() {
+    printf("Running plugin tests...\n\n");
+
+    test_load_plugin();
+    test_plugin_arguments();
+
+    printf("\nAll plugin tests passed!\n");
+    return 0;
+}
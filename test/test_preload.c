@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/wait.h>
+#include "validator.h"
+#include "test_util.h"
+
+static char preload_path[PATH_MAX];
+
+// Runs a shell command with the preload library and config, returns its exit code
+static int run_preloaded(const char* config_path, const char* command) {
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        setenv("LD_PRELOAD", preload_path, 1);
+        setenv("ENVIL_CONFIG", config_path, 1);
+        freopen("/dev/null", "w", stderr);
+        execl("/bin/sh", "sh", "-c", command, (char*)NULL);
+        _exit(127);
+    }
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status));
+    return WEXITSTATUS(status);
+}
+
+void test_preload() {
+    printf("Testing the preload library...\n");
+
+    assert(realpath("lib/libenvil_preload.so", preload_path) != NULL);
+    char config_path[] = "/tmp/envil_preload_XXXXXX.yml";
+    write_temp_file(config_path,
+        "ENVIL_PRELOAD_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n");
+
+    // A passing environment runs the program, which no longer sees the config
+    setenv("ENVIL_PRELOAD_PORT", "8080", 1);
+    assert(run_preloaded(config_path, "test -z \"$ENVIL_CONFIG\"") == ENVIL_OK);
+
+    // A failing one stops it before main, with the validation's exit code
+    setenv("ENVIL_PRELOAD_PORT", "http", 1);
+    assert(run_preloaded(config_path, "exit 42") == ENVIL_TYPE_ERROR);
+    assert(run_preloaded("/nonexistent.yml", "exit 42") == ENVIL_CONFIG_ERROR);
+
+    unsetenv("ENVIL_PRELOAD_PORT");
+    unlink(config_path);
+    printf("Preload library tests passed!\n");
+}
+
+int main() {
+    printf("Running preload tests...\n\n");
+
+    test_preload();
+
+    printf("\nAll preload tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include "profiles.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+void test_validate_profiles() {
+    printf("Testing profile matrix validation...\n");
+
+    char dir[] = "/tmp/envil_profiles_XXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    char config_path[64], dev_path[64], prod_path[64], notes_path[64];
+    snprintf(config_path, sizeof(config_path), "%s/config.yml", dir);
+    snprintf(dev_path, sizeof(dev_path), "%s/dev.env", dir);
+    snprintf(prod_path, sizeof(prod_path), "%s/prod.env", dir);
+    snprintf(notes_path, sizeof(notes_path), "%s/notes.txt", dir);
+
+    write_file(config_path,
+        "ENVIL_TEST_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "    gt: 1024\n"
+        "ENVIL_TEST_MODE:\n"
+        "  checks:\n"
+        "    enum: dev,prod\n"
+        "ENVIL_TEST_SHARED:\n"
+        "  checks:\n"
+        "    eq: base\n");
+    write_file(dev_path, "ENVIL_TEST_PORT=8080\nENVIL_TEST_MODE=dev\n");
+    write_file(prod_path, "ENVIL_TEST_PORT=80\n");
+    write_file(notes_path, "not a profile\n");
+    setenv("ENVIL_TEST_SHARED", "base", 1);
+
+    Config* config = load_config(config_path);
+    assert(config != NULL);
+
+    char* report = NULL;
+    size_t report_size = 0;
+    FILE* out = open_memstream(&report, &report_size);
+    assert(out != NULL);
+    // The directory holds dev.env and prod.env; the process environment fills in ENVIL_TEST_SHARED
+    assert(validate_profiles(config, dir, 0, out) == ENVIL_MISSING_VAR);
+    fclose(out);
+
+    assert(strstr(report, "VARIABLE           dev      prod\n") == report);
+    assert(strstr(report, "ENVIL_TEST_PORT    ok       FAIL\n") != NULL);
+    assert(strstr(report, "ENVIL_TEST_MODE    ok       missing\n") != NULL);
+    assert(strstr(report, "ENVIL_TEST_SHARED  ok       ok\n") != NULL);
+    assert(strstr(report, "prod:\n  Error ENVIL_TEST_PORT: ") != NULL);
+    assert(strstr(report, "dev:\n") == NULL);
+    assert(strstr(report, "-- 2 profiles, 1 failing\n") != NULL);
+    free(report);
+
+    // A list keeps its order; a missing profile fails before anything runs
+    out = fopen("/dev/null", "w");
+    char list[200];
+    snprintf(list, sizeof(list), "%s,%s", prod_path, dev_path);
+    assert(validate_profiles(config, list, 0, out) == ENVIL_MISSING_VAR);
+    assert(validate_profiles(config, dev_path, 0, out) == ENVIL_OK);
+    snprintf(list, sizeof(list), "%s,%s/missing.env", dev_path, dir);
+    assert(validate_profiles(config, list, 0, out) == ENVIL_CONFIG_ERROR);
+    fclose(out);
+
+    free_config(config);
+    unsetenv("ENVIL_TEST_SHARED");
+    unlink(config_path);
+    unlink(dev_path);
+    unlink(prod_path);
+    unlink(notes_path);
+    rmdir(dir);
+    printf("Profile matrix validation tests passed!\n");
+}
+
+int main() {
+    printf("Running profile tests...\n\n");
+
+    test_validate_profiles();
+
+    printf("\nAll profile tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include "snapshot.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+static char* read_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    assert(file != NULL);
+    static char buf[4096];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, file);
+    buf[n] = '\0';
+    fclose(file);
+    return buf;
+}
+
+// Rewrites the recorded verdict of name, to tell a reused verdict from a fresh one
+static void forge_verdict(const char* path, const char* name, const char* verdict) {
+    char* content = strdup(read_file(path));
+    char* line = strstr(content, name);
+    assert(line != NULL);
+    char* end = strchr(line, '\n');
+    *end = '\0';
+    char* result = strrchr(line, '\t');
+    *result = '\0';
+
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+    fprintf(file, "%s\t%s\n%s", content, verdict, end + 1);
+    fclose(file);
+    free(content);
+}
+
+static int find_error(const ValidationErrors* errors, const char* name) {
+    for (int i = 0; i < errors->count; i++) {
+        if (strcmp(errors->errors[i].name, name) == 0) return errors->errors[i].error_code;
+    }
+    return ENVIL_OK;
+}
+
+void test_snapshot_since() {
+    printf("Testing snapshot and --since...\n");
+
+    char config_path[] = "/tmp/envil_snapshot_XXXXXX.yml";
+    write_temp_file(config_path,
+        "ENVIL_SNAP_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "    gt: 1024\n"
+        "ENVIL_SNAP_LIMIT:\n"
+        "  checks:\n"
+        "    expr: \"value > ENVIL_SNAP_PORT\"\n"
+        "ENVIL_SNAP_MODE:\n"
+        "  default: dev\n"
+        "  checks:\n"
+        "    enum: dev,prod\n");
+    char snapshot_path[64];
+    snprintf(snapshot_path, sizeof(snapshot_path), "%s.snap", config_path);
+    setenv("ENVIL_SNAP_PORT", "8080", 1);
+    setenv("ENVIL_SNAP_LIMIT", "9000", 1);
+    unsetenv("ENVIL_SNAP_MODE");
+
+    Config* config = load_config(config_path);
+    assert(config != NULL);
+    ValidationErrors* errors = create_validation_errors();
+    assert(validate_snapshot(config, NULL, snapshot_path, false, errors, NULL) == ENVIL_OK);
+    assert(errors->count == 0);
+    free_validation_errors(errors);
+
+    // Values are fingerprinted, never stored
+    assert(strstr(read_file(snapshot_path), "8080") == NULL);
+
+    // Nothing changed: every verdict comes from the snapshot
+    forge_verdict(snapshot_path, "ENVIL_SNAP_MODE", "4\tforged");
+    errors = create_validation_errors();
+    assert(validate_snapshot(config, snapshot_path, NULL, false, errors, NULL) == ENVIL_VALUE_ERROR);
+    assert(errors->count == 1);
+    assert(strcmp(errors->errors[0].message, "forged") == 0);
+    free_validation_errors(errors);
+
+    // A changed value is revalidated, and so is the expr check reading it
+    forge_verdict(snapshot_path, "ENVIL_SNAP_LIMIT", "4\tforged");
+    setenv("ENVIL_SNAP_MODE", "prod", 1);
+    setenv("ENVIL_SNAP_PORT", "9500", 1);
+    errors = create_validation_errors();
+    assert(validate_snapshot(config, snapshot_path, NULL, false, errors, NULL) == ENVIL_VALUE_ERROR);
+    assert(errors->count == 1);
+    assert(find_error(errors, "ENVIL_SNAP_LIMIT") == ENVIL_VALUE_ERROR);
+    assert(strcmp(errors->errors[0].message, "forged") != 0);
+    free_validation_errors(errors);
+
+    // A snapshot that is not one is refused
+    write_file(snapshot_path, "PORT=8080\n");
+    errors = create_validation_errors();
+    assert(validate_snapshot(config, snapshot_path, NULL, false, errors, NULL) == ENVIL_CONFIG_ERROR);
+    free_validation_errors(errors);
+
+    free_config(config);
+    unsetenv("ENVIL_SNAP_PORT");
+    unsetenv("ENVIL_SNAP_LIMIT");
+    unsetenv("ENVIL_SNAP_MODE");
+    unlink(config_path);
+    unlink(snapshot_path);
+    printf("Snapshot and --since tests passed!\n");
+}
+
+int main() {
+    printf("Running snapshot tests...\n\n");
+
+    test_snapshot_since();
+
+    printf("\nAll snapshot tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include "strict.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+static const char* find_message(const ValidationErrors* errors, const char* name) {
+    for (int i = 0; i < errors->count; i++) {
+        if (strcmp(errors->errors[i].name, name) == 0) return errors->errors[i].message;
+    }
+    return NULL;
+}
+
+void test_check_undeclared() {
+    printf("Testing undeclared variables...\n");
+
+    char config_path[] = "/tmp/envil_strict_XXXXXX.yml";
+    write_temp_file(config_path,
+        "APP_PORT:\n"
+        "  default: \"80\"\n"
+        "APP_LOG_LEVEL:\n"
+        "  default: info\n"
+        "\"APP_FEATURE_*\":\n"
+        "  checks:\n"
+        "    enum: on,off\n"
+        "DB_URL:\n"
+        "  default: x\n");
+    Config* config = load_config(config_path);
+    assert(config != NULL);
+
+    char* clean[] = {"APP_PORT=8080", "APP_FEATURE_A=on", "PATH=/bin", "HOME=/root", NULL};
+    ValidationErrors* errors = create_validation_errors();
+    assert(check_undeclared(config, "", clean, errors) == ENVIL_OK);
+    assert(errors->count == 0);
+    free_validation_errors(errors);
+
+    // Scoped to the declared prefixes APP_ and DB_, with near misses suggested
+    char* typos[] = {
+        "APP_PROT=8080", "APP_LOGLEVEL=debug", "DB_URLS=x", "APP_SECRET=1", "APP_PROT=dup",
+        "DB=x", "PATH=/bin", NULL
+    };
+    errors = create_validation_errors();
+    assert(check_undeclared(config, "", typos, errors) == ENVIL_VALUE_ERROR);
+    assert(errors->count == 4);
+    // In name order, each name once
+    assert(strcmp(errors->errors[0].name, "APP_LOGLEVEL") == 0);
+    assert(strcmp(errors->errors[3].name, "DB_URLS") == 0);
+    assert(strstr(find_message(errors, "APP_PROT"), "did you mean APP_PORT?") != NULL);
+    assert(strstr(find_message(errors, "APP_LOGLEVEL"), "did you mean APP_LOG_LEVEL?") != NULL);
+    assert(strstr(find_message(errors, "DB_URLS"), "did you mean DB_URL?") != NULL);
+    assert(strstr(find_message(errors, "APP_SECRET"), "did you mean") == NULL);
+    free_validation_errors(errors);
+
+    // An explicit prefix replaces the declared ones
+    errors = create_validation_errors();
+    assert(check_undeclared(config, "PA", typos, errors) == ENVIL_VALUE_ERROR);
+    assert(errors->count == 1);
+    assert(strcmp(errors->errors[0].name, "PATH") == 0);
+    free_validation_errors(errors);
+
+    free_config(config);
+    unlink(config_path);
+    printf("Undeclared variable tests passed!\n");
+}
+
+int main() {
+    printf("Running strict tests...\n\n");
+
+    test_check_undeclared();
+
+    printf("\nAll strict tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef ENVIL_TEST_UTIL_H
+#define ENVIL_TEST_UTIL_H
+
+// Fixtures shared by the test suites. Header only: each test/*.c is its own binary.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static inline void write_file(const char* path, const char* content) {
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(content, file);
+    fclose(file);
+}
+
+// Creates a file from a template such as "/tmp/envil_test_XXXXXX.yml", whose
+// XXXXXX may be followed by an extension, and writes content to it
+static inline void write_temp_file(char* path, const char* content) {
+    const char* placeholder = strstr(path, "XXXXXX");
+    assert(placeholder != NULL);
+    int fd = mkstemps(path, (int)strlen(placeholder + 6));
+    assert(fd >= 0);
+    close(fd);
+    write_file(path, content);
+}
+
+#endif // ENVIL_TEST_UTIL_H
@@ -2,9 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
+#include <json-c/json.h>
 #include "validator.h"
+#include "jsonscan.h"
 #include "checks.h"
 #include "types.h"
+#include "stats.h"
+#include "config.h"
 
 // Test validation of different types
 void test_type_validation() {
@@ -35,18 +40,93 @@ void test_type_validation() {
     printf("Type validation tests passed!\n");
 }
 
+// Test the JSON scanner against json-c, which it replaces for type: json,
+// including the extensions json-c accepts and its rejection of a bare null
+void test_json_differential() {
+    printf("Testing JSON scanner against json-c...\n");
+
+    const char* corpus[] = {
+        "{}", "[]", "\"\"", "0", "-0", "1.5e-3", "1E+5", "1e400", "-12.25",
+        "true", "false", " [1] ", "\t{\n\"a\" : 1\r\n}",
+        "{\"a\":[{\"b\":null}],\"c\":{\"d\":[true,false,\"x\"]}}",
+        "\"\\u00e9\\ud800\\n\\t\\\\\\/\\\"\"", "\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\"",
+        "[1,2,3,[4,[5,[6]]]]", "{\"long\":\"0123456789abcdef0123456789abcdef0123456789\"}",
+        "{\"k\":\"escape after sixteen bytes\\\" here\"}",
+        "", "   ", "{", "[", "}", "]", "[1 2]", "{\"a\" 1}", "{\"a\":}", "{,}", "[,1]",
+        "{\"a\":1 \"b\":2}", "\"abc", "\"a\\x\"", "\"\\uZZZZ\"", "\"\\u12\"", "-", "--1", "+1",
+        ".5", "{1:2}", "[1,,2]", "\"unterminated 0123456789abcdef0123456789",
+        // Where json-c departs from RFC 8259
+        "null", " NULL ", "[1,]", "{\"a\":1,}", "NaN", "-Infinity", "[inFinity]", "TRUE",
+        "/*c*/1", "[1 // c\n]", "1 /* open", "[null /* open", "1 /", "/***/1",
+        "{'a':1}", "'it\"s'", "'\\''", "[1] x", "1x", "[1x]", "01", "1.", "-.5", "12e+",
+        "[1e+]", "[-e]", "\"\x01\"", "\"\xc0\xaf\"", "\"\xed\xa0\x80\"",
+    };
+
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        struct json_object* obj = json_tokener_parse(corpus[i]);
+        bool expected = obj != NULL;
+        if (obj) json_object_put(obj);
+        assert(json_validate(corpus[i], strlen(corpus[i])) == expected);
+    }
+
+    // Nesting limit matches json-c: 32 containers deep rejects any inner value
+    char doc[256];
+    for (int depth = 30; depth <= 33; depth++) {
+        int n = 0;
+        for (int i = 0; i < depth; i++) doc[n++] = '[';
+        doc[n++] = '1';
+        for (int i = 0; i < depth; i++) doc[n++] = ']';
+        doc[n] = '\0';
+
+        struct json_object* obj = json_tokener_parse(doc);
+        bool expected = obj != NULL;
+        if (obj) json_object_put(obj);
+        assert(json_validate(doc, n) == expected);
+    }
+
+    // Large documents, long enough to exercise the vectorized string scan
+    size_t big_len = 4 * 1024 * 1024;
+    char* big = malloc(big_len + 1);
+    assert(big != NULL);
+    size_t n = 0;
+    big[n++] = '[';
+    while (n + 64 < big_len) {
+        n += snprintf(big + n, big_len - n, "{\"id\":%zu,\"name\":\"value \\\"%zu\\\" caf\xc3\xa9\"},", n, n);
+    }
+    big[n++] = '0';
+    big[n++] = ']';
+    big[n] = '\0';
+    assert(json_validate(big, n) == true);
+    char* escape = strstr(big + n / 2, "value");
+    escape[0] = '\\';  // An unknown escape somewhere in the middle
+    escape[1] = 'x';
+    assert(json_validate(big, n) == false);
+    assert(json_tokener_parse(big) == NULL);
+    free(big);
+
+    // json-c's verdicts, pinned in case the corpus loop is ever loosened
+    assert(json_validate("[1] x", 5) == true);
+    assert(json_validate("{'a':1}", 7) == true);
+    assert(json_validate("/*c*/1", 6) == true);
+    assert(json_validate("null", 4) == false);
+    assert(is_json("NaN") == true);
+    assert(is_json("[1,]") == true);
+
+    printf("JSON scanner tests passed!\n");
+}
+
 // Test individual check functions
 void test_check_functions() {
     printf("Testing check functions...\n");
     
     // Test gt check
-    int gt_val = 10;
+    Number gt_val = {.int_value = 10};
     assert(check_gt("15", &gt_val) == ENVIL_OK);
     assert(check_gt("5", &gt_val) == ENVIL_VALUE_ERROR);
     assert(check_gt("abc", &gt_val) == ENVIL_VALUE_ERROR);
     
     // Test lt check
-    int lt_val = 10;
+    Number lt_val = {.int_value = 10};
     assert(check_lt("5", &lt_val) == ENVIL_OK);
     assert(check_lt("15", &lt_val) == ENVIL_VALUE_ERROR);
     assert(check_lt("abc", &lt_val) == ENVIL_VALUE_ERROR);
@@ -120,11 +200,11 @@ void test_variable_validation() {
     
     // Greater than check
     checks[1].definition = get_check_definition("gt");
-    checks[1].value.int_value = 0;
+    checks[1].value.number_value = (Number){.int_value = 0};
     
     // Less than check
     checks[2].definition = get_check_definition("lt");
-    checks[2].value.int_value = 100;
+    checks[2].value.number_value = (Number){.int_value = 100};
     
     var.checks = checks;
     var.check_count = 3;
@@ -194,18 +274,160 @@ void test_validation_errors() {
     
     // Clean up
     free_validation_errors(errors);
+
+    // A cmd check killed at the deadline is told apart from one never started
+    Check cmd;
+    EnvType type = TYPE_STRING;
+    assert(process_check("cmd", "sleep 30", &cmd, &type));
+    EnvVariable var = {.name = "SLOW", .required = true, .checks = &cmd, .check_count = 1};
+    set_check_deadline(50);
+    errors = create_validation_errors();
+    assert(validate_variable_with_errors(&var, "x", errors) == ENVIL_TIMEOUT_ERROR);
+    assert(strcmp(errors->errors[0].message, "cmd check did not finish in time and was killed") == 0);
+    free_validation_errors(errors);
+    errors = create_validation_errors();
+    assert(validate_variable_with_errors(&var, "x", errors) == ENVIL_TIMEOUT_ERROR);
+    assert(strcmp(errors->errors[0].message, "cmd check not run: deadline passed") == 0);
+    free_validation_errors(errors);
+    set_check_deadline(0);
+    free_check_value(&cmd);
     
     printf("Validation errors tests passed!\n");
 }
 
+static int counted_runs = 0;
+
+static int check_counted(const char* value, const void* param) {
+    (void)value;
+    (void)param;
+    counted_runs++;
+    return ENVIL_OK;
+}
+
+// Test cost-based check ordering and that it never changes the reported error
+void test_check_ordering() {
+    printf("Testing check ordering...\n");
+
+    const CheckDefinition* counted = register_check("counted", "Counts its runs", check_counted, NULL, 1, "Never fails");
+    assert(counted != NULL && counted->cost == DEFAULT_CHECK_COST);
+
+    Check checks[3] = {0};
+    EnvType type = TYPE_STRING;
+    assert(process_check("regex", "^[a-z]+$", &checks[0], &type));
+    checks[0].stats_key = 1;
+    checks[1].definition = counted;
+    checks[1].stats_key = 2;
+    checks[2].definition = get_check_definition("lenlt");
+    checks[2].value.size_value = 5;
+    checks[2].stats_key = 3;
+
+    EnvVariable var = {.name = "ORDERED", .required = true, .checks = checks, .check_count = 3};
+    ValidationErrors* errors;
+
+    // lenlt is cheapest and fails first, but regex comes first in the config
+    errors = create_validation_errors();
+    assert(validate_variable_with_errors(&var, "TOOLONG", errors) == ENVIL_VALUE_ERROR);
+    assert(errors->count == 1);
+    assert(strstr(errors->errors[0].message, "failed regex check") != NULL);
+    assert(counted_runs == 0);
+    free_validation_errors(errors);
+
+    // With regex passing, lenlt is reported and the costlier checks still ran
+    counted_runs = 0;
+    errors = create_validation_errors();
+    assert(validate_variable_with_errors(&var, "toolong", errors) == ENVIL_VALUE_ERROR);
+    assert(strstr(errors->errors[0].message, "failed lenlt check") != NULL);
+    assert(counted_runs == 1);
+    free_validation_errors(errors);
+
+    // A failing check placed first skips the rest entirely
+    Check first_fails[2] = {checks[2], checks[1]};
+    var.checks = first_fails;
+    var.check_count = 2;
+    counted_runs = 0;
+    errors = create_validation_errors();
+    assert(validate_variable_with_errors(&var, "toolong", errors) == ENVIL_VALUE_ERROR);
+    assert(counted_runs == 0);
+    free_validation_errors(errors);
+
+    // Recorded runs move the estimates away from the static ones
+    CheckStats* stats = load_check_stats("/nonexistent/envil-stats");
+    assert(stats != NULL && stats->count == 0);
+    double cost, reject_rate;
+    estimate_check(stats, &checks[2], &cost, &reject_rate);
+    assert(cost == 20 && reject_rate == 0.5);
+    for (int i = 0; i < 100; i++) {
+        record_check_run(stats, &checks[2], false, 1000);
+        record_check_run(stats, &checks[1], true, 10);
+    }
+    estimate_check(stats, &checks[2], &cost, &reject_rate);
+    assert(cost > 900 && reject_rate < 0.02);
+    estimate_check(stats, &checks[1], &cost, &reject_rate);
+    assert(cost < 50 && reject_rate > 0.98);
+
+    // Learned order runs counted first, the reported error is unchanged
+    var.checks = checks;
+    var.check_count = 3;
+    counted_runs = 0;
+    errors = create_validation_errors();
+    assert(validate_variable_with_stats(&var, "toolong", errors, stats) == ENVIL_VALUE_ERROR);
+    assert(strstr(errors->errors[0].message, "failed lenlt check") != NULL);
+    free_validation_errors(errors);
+
+    // Round trip through a stats file
+    char path[] = "/tmp/envil_stats_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    save_check_stats(stats, path);
+    CheckStats* loaded = load_check_stats(path);
+    assert(loaded->count == stats->count);
+    for (int i = 0; i < stats->count; i++) {
+        assert(memcmp(&loaded->entries[i], &stats->entries[i], sizeof(CheckStat)) == 0);
+    }
+    free_check_stats(loaded);
+    free_check_stats(stats);
+    unlink(path);
+    free_check_value(&checks[0]);
+
+    printf("Check ordering tests passed!\n");
+}
+
+void test_export_defaults() {
+    printf("Testing exported defaults...\n");
+
+    EnvVariable vars[3] = {
+        {.name = "ENVIL_EXPORT_UNSET", .default_value = "80"},
+        {.name = "ENVIL_EXPORT_SET", .default_value = "80"},
+        {.name = "ENVIL_EXPORT_NONE"},
+    };
+    Config config = {.variables = vars, .variable_count = 3};
+    unsetenv("ENVIL_EXPORT_UNSET");
+    setenv("ENVIL_EXPORT_SET", "8080", 1);
+    unsetenv("ENVIL_EXPORT_NONE");
+
+    // Only unset variables take their default; a value set by hand wins
+    export_config_defaults(&config);
+    assert(strcmp(getenv("ENVIL_EXPORT_UNSET"), "80") == 0);
+    assert(strcmp(getenv("ENVIL_EXPORT_SET"), "8080") == 0);
+    assert(getenv("ENVIL_EXPORT_NONE") == NULL);
+
+    unsetenv("ENVIL_EXPORT_UNSET");
+    unsetenv("ENVIL_EXPORT_SET");
+    printf("Exported default tests passed!\n");
+}
+
 int main() {
     printf("Running validator tests...\n\n");
     
     test_type_validation();
+    test_json_differential();
     test_check_functions();
     test_check_registry();
     test_variable_validation();
+    test_check_ordering();
     test_validation_errors();
+    test_export_defaults();
     
     printf("\nAll validator tests passed!\n");
     return 0;
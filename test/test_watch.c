@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "watch.h"
+#include "config.h"
+#include "validator.h"
+#include "test_util.h"
+
+static char* report_buf;
+static size_t report_len;
+static size_t report_seen;
+
+// The report written since the last call
+static const char* take_report(FILE* report) {
+    fflush(report);
+    const char* text = report_buf + report_seen;
+    report_seen = report_len;
+    return text;
+}
+
+void test_watch_updates() {
+    printf("Testing watch state updates...\n");
+
+    unsetenv("ENVIL_WATCH_PORT");
+    unsetenv("ENVIL_WATCH_MODE");
+    unsetenv("ENVIL_WATCH_HOST");
+    unsetenv("ENVIL_WATCH_NEW");
+    char env_path[] = "/tmp/envil_watch_XXXXXX.env";
+    write_temp_file(env_path, "ENVIL_WATCH_PORT=8080\nENVIL_WATCH_HOST=localhost\n");
+    char config_path[] = "/tmp/envil_watch_XXXXXX.yml";
+    write_temp_file(config_path,
+        "ENVIL_WATCH_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "    gt: 1024\n"
+        "ENVIL_WATCH_MODE:\n"
+        "  default: dev\n"
+        "  checks:\n"
+        "    enum: dev,prod\n"
+        "ENVIL_WATCH_HOST:\n"
+        "  checks:\n"
+        "    lengt: 0\n");
+
+    FILE* report = open_memstream(&report_buf, &report_len);
+    assert(report != NULL);
+    char* env_files[] = {env_path};
+    WatchState* state = create_watch_state(env_files, 1, false, report);
+    assert(state != NULL);
+
+    // The first config adds every variable
+    assert(watch_apply_config(state, load_config(config_path)));
+    assert(strcmp(take_report(report),
+                  "+ ENVIL_WATCH_PORT: ok\n"
+                  "+ ENVIL_WATCH_MODE: ok (default)\n"
+                  "+ ENVIL_WATCH_HOST: ok\n"
+                  "-- 3 rechecked, 0 of 3 failing\n") == 0);
+    assert(watch_result(state) == ENVIL_OK);
+
+    // Reloading an unchanged config keeps every verdict
+    assert(watch_apply_config(state, load_config(config_path)));
+    assert(strcmp(take_report(report), "-- 0 rechecked, 0 of 3 failing\n") == 0);
+
+    // A changed definition is rechecked, new and removed variables are reported
+    write_file(config_path,
+        "ENVIL_WATCH_PORT:\n"
+        "  checks:\n"
+        "    type: integer\n"
+        "    gt: 1024\n"
+        "ENVIL_WATCH_MODE:\n"
+        "  default: test\n"
+        "  checks:\n"
+        "    enum: dev,prod\n"
+        "ENVIL_WATCH_NEW:\n"
+        "  default: x\n");
+    assert(watch_apply_config(state, load_config(config_path)));
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_MODE: failed enum check (allowed values: dev, prod)\n"
+                  "+ ENVIL_WATCH_NEW: ok (default)\n"
+                  "- ENVIL_WATCH_HOST: removed\n"
+                  "-- 2 rechecked, 1 of 3 failing\n") == 0);
+    assert(watch_result(state) == ENVIL_VALUE_ERROR);
+
+    // An env file change rechecks only the values it changed
+    write_file(env_path, "ENVIL_WATCH_PORT=80\nENVIL_WATCH_MODE=prod\n");
+    watch_reload_env_file(state, 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_PORT: failed gt check (value must be greater than 1024)\n"
+                  "~ ENVIL_WATCH_MODE: ok\n"
+                  "-- 2 rechecked, 1 of 3 failing\n") == 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report), "-- 0 rechecked, 1 of 3 failing\n") == 0);
+
+    // The process environment shows through once the file goes away
+    setenv("ENVIL_WATCH_PORT", "9000", 1);
+    unlink(env_path);
+    watch_reload_env_file(state, 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_PORT: ok\n"
+                  "~ ENVIL_WATCH_MODE: failed enum check (allowed values: dev, prod)\n"
+                  "-- 2 rechecked, 1 of 3 failing\n") == 0);
+
+    free_watch_state(state);
+    fclose(report);
+    free(report_buf);
+    unsetenv("ENVIL_WATCH_PORT");
+    unlink(config_path);
+    printf("Watch state update tests passed!\n");
+}
+
+void test_watch_expr() {
+    printf("Testing expr checks in watch mode...\n");
+
+    char env_path[] = "/tmp/envil_watch_XXXXXX.env";
+    write_temp_file(env_path, "ENVIL_WATCH_MIN=50\nENVIL_WATCH_MAX=10\n");
+    char config_path[] = "/tmp/envil_watch_XXXXXX.yml";
+    write_temp_file(config_path,
+        "ENVIL_WATCH_MIN:\n"
+        "  checks:\n"
+        "    expr: value <= ENVIL_WATCH_MAX && value >= ENVIL_WATCH_FLOOR\n"
+        "ENVIL_WATCH_MAX:\n"
+        "  default: \"20\"\n"
+        "  checks:\n"
+        "    type: integer\n");
+    // The dotenv files win over the environment, for expr checks too
+    setenv("ENVIL_WATCH_MAX", "100", 1);
+    setenv("ENVIL_WATCH_FLOOR", "0", 1);
+
+    FILE* report = open_memstream(&report_buf, &report_len);
+    report_seen = 0;
+    assert(report != NULL);
+    char* env_files[] = {env_path};
+    WatchState* state = create_watch_state(env_files, 1, false, report);
+    assert(state != NULL);
+    assert(watch_apply_config(state, load_config(config_path)));
+    assert(strcmp(take_report(report),
+                  "+ ENVIL_WATCH_MIN: failed expr check (must hold: value <= ENVIL_WATCH_MAX && value >= ENVIL_WATCH_FLOOR)\n"
+                  "+ ENVIL_WATCH_MAX: ok\n"
+                  "-- 2 rechecked, 1 of 2 failing\n") == 0);
+
+    // A variable read by an expr check rechecks the reader
+    write_file(env_path, "ENVIL_WATCH_MIN=50\nENVIL_WATCH_MAX=60\n");
+    watch_reload_env_file(state, 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_MIN: ok\n"
+                  "~ ENVIL_WATCH_MAX: ok\n"
+                  "-- 2 rechecked, 0 of 2 failing\n") == 0);
+    write_file(env_path, "ENVIL_WATCH_MIN=50\nENVIL_WATCH_MAX=3\n");
+    watch_reload_env_file(state, 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_MIN: failed expr check (must hold: value <= ENVIL_WATCH_MAX && value >= ENVIL_WATCH_FLOOR)\n"
+                  "~ ENVIL_WATCH_MAX: ok\n"
+                  "-- 2 rechecked, 1 of 2 failing\n") == 0);
+
+    // As in a normal run, an expr check reading an invalid variable is skipped
+    write_file(env_path, "ENVIL_WATCH_MIN=50\nENVIL_WATCH_MAX=x\n");
+    watch_reload_env_file(state, 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_MIN: ok\n"
+                  "~ ENVIL_WATCH_MAX: invalid type - expected integer\n"
+                  "-- 2 rechecked, 1 of 2 failing\n") == 0);
+    assert(watch_result(state) == ENVIL_TYPE_ERROR);
+
+    // Names outside the config come from the dotenv files as well
+    write_file(env_path, "ENVIL_WATCH_MIN=50\nENVIL_WATCH_MAX=60\nENVIL_WATCH_FLOOR=55\n");
+    watch_reload_env_file(state, 0);
+    watch_refresh_values(state);
+    assert(strcmp(take_report(report),
+                  "~ ENVIL_WATCH_MIN: failed expr check (must hold: value <= ENVIL_WATCH_MAX && value >= ENVIL_WATCH_FLOOR)\n"
+                  "~ ENVIL_WATCH_MAX: ok\n"
+                  "-- 2 rechecked, 1 of 2 failing\n") == 0);
+
+    free_watch_state(state);
+    fclose(report);
+    free(report_buf);
+    unsetenv("ENVIL_WATCH_MAX");
+    unsetenv("ENVIL_WATCH_FLOOR");
+    unlink(env_path);
+    unlink(config_path);
+    printf("Watch expr tests passed!\n");
+}
+
+int main() {
+    printf("Running watch tests...\n\n");
+
+    test_watch_updates();
+    test_watch_expr();
+
+    printf("\nAll watch tests passed!\n");
+    return 0;
+}